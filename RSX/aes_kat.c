@@ -1,13 +1,16 @@
 #include "aes_kat.h"
+#include "cpufeatures.h"
+#include "keycache.h"
 #include "rsx.h"
 #include <stdio.h>
 #include <string.h>
 
-#ifdef RSX_AESNI_ENABLED
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#	define AES_KAT_X86
 #	if defined(_MSC_VER)
 #		include <intrin.h>
 #	elif defined(__GNUC__)
-#		include <x86intrin.h>
+#		include <cpuid.h>
 #	endif
 #endif
 
@@ -54,16 +57,54 @@ static void hex_to_bin(const char* str, uint8_t* output, size_t length)
 	};
 }
 
+static bool upper_state_clean()
+{
+	bool res;
+
+	res = true;
+
+#if defined(AES_KAT_X86) && (defined(_MSC_VER) || defined(__GNUC__))
+	/* the 512 bit kernels must return with the upper halves of ymm0-15 (bit 2) and zmm0-15 (bit 6) zeroed,
+	or the SSE code that follows them stalls; xgetbv with ecx = 1 reports the register state that is in use */
+	if (cpu_features_get()->avx == true)
+	{
+		uint32_t regs[4];
+		uint64_t inuse;
+#	if defined(_MSC_VER)
+		int info[4];
+
+		__cpuidex(info, 0x0D, 1);
+		regs[0] = (uint32_t)info[0];
+#	else
+		__cpuid_count(0x0D, 1, regs[0], regs[1], regs[2], regs[3]);
+#	endif
+
+		/* cpuid leaf 0Dh sub-leaf 1, eax bit 2: xgetbv with ecx = 1 is supported */
+		if ((regs[0] & 0x04) != 0)
+		{
+#	if defined(_MSC_VER)
+			inuse = (uint64_t)_xgetbv(1);
+#	else
+			uint32_t lo;
+			uint32_t hi;
+
+			__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(1));
+			inuse = ((uint64_t)hi << 32) | lo;
+#	endif
+			res = ((inuse & 0x44) == 0);
+		}
+	}
+#endif
+
+	return res;
+}
+
 static bool aes128_cbc_monte_carlo(const uint8_t* key, const uint8_t* iv, const uint8_t message[4][16], const uint8_t expected[4][16])
 {
 	rsx_keyparams kp = { key, 16 };
 	uint8_t ivc[16];
 	uint8_t out[16];
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[AES128_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[AES128_ROUNDKEY_DIMENSION];
-#endif
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
 	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
 	size_t i;
 	bool status;
@@ -113,11 +154,7 @@ static bool aes256_cbc_monte_carlo(const uint8_t* key, const uint8_t* iv, const
 	rsx_keyparams kp = { key, 32 };
 	uint8_t ivc[16];
 	uint8_t out[16];
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[AES256_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[AES256_ROUNDKEY_DIMENSION];
-#endif
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
 	rsx_state state = { rkeys, AES256_ROUNDKEY_DIMENSION };
 	size_t i;
 	bool status;
@@ -162,106 +199,164 @@ static bool aes256_cbc_monte_carlo(const uint8_t* key, const uint8_t* iv, const
 	return status;
 }
 
-static bool aes128_ctr_monte_carlo(const uint8_t* key, const uint8_t* nonce, const uint8_t message[4][16], const uint8_t expected[4][16])
+static bool aes256_cbc_blocks_monte_carlo(const uint8_t* key, const uint8_t* iv, const uint8_t message[4][16], const uint8_t expected[4][16])
 {
-	rsx_keyparams kp = { key, 16 };
-	uint8_t ncc[16];
-	uint8_t out[16];
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[AES128_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[AES128_ROUNDKEY_DIMENSION];
-#endif
-	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
-	size_t i;
+	rsx_keyparams kp = { key, 32 };
+	uint8_t ivc[16];
+	uint8_t out[4][16];
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES256_ROUNDKEY_DIMENSION };
 	bool status;
 
-	memcpy(&ncc[0], &nonce[0], 16);
+	memcpy(&ivc[0], &iv[0], 16);
 	status = true;
 
-	/* test encryption */
-	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	rsx_initialize(&state, &kp, false);
+	rsx_cbc_decrypt_blocks(&state, out[0], ivc, expected[0], 64);
+
+	if (are_equal8(out[0], message[0], 64) == false || are_equal8(ivc, expected[3], 16) == false)
 	{
 		status = false;
 	}
 
-	for (i = 0; i < 4; i++)
-	{
-		rsx_ctr_transform(&state, out, ncc, message[i]);
+	/* in place */
+	memcpy(&ivc[0], &iv[0], 16);
+	memcpy(&out[0][0], &expected[0][0], 64);
+	rsx_cbc_decrypt_blocks(&state, out[0], ivc, out[0], 64);
 
-		if (are_equal8(out, expected[i], 16) == false)
-		{
-			status = false;
-		}
+	if (are_equal8(out[0], message[0], 64) == false)
+	{
+		status = false;
 	}
 
-	memcpy(&ncc[0], &nonce[0], 16);
+	return status;
+}
 
-	/* test decryption */
-	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+static bool rsx256_cbc_blocks_equivalence(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 32 };
+	uint8_t msg[1024];
+	uint8_t enc[1024];
+	uint8_t out[1024];
+	uint8_t iva[16] = { 0 };
+	uint8_t ivb[16] = { 0 };
+	size_t i;
+	bool clean;
+	rsx_roundkey rkeys[RSX256_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX256_ROUNDKEY_DIMENSION };
+
+	for (i = 0; i < length; i++)
 	{
-		status = false;
+		msg[i] = (uint8_t)i;
 	}
 
-	for (i = 0; i < 4; i++)
-	{
-		rsx_ctr_transform(&state, out, ncc, expected[i]);
+	rsx_initialize(&state, &kp, true);
 
-		if (are_equal8(out, message[i], 16) == false)
-		{
-			status = false;
-		}
+	for (i = 0; i < length; i += 16)
+	{
+		rsx_cbc_encrypt(&state, enc + i, iva, msg + i);
 	}
 
-	return status;
+	/* decrypt in place with the multi-block api */
+	rsx_initialize(&state, &kp, false);
+	memcpy(out, enc, length);
+	rsx_cbc_decrypt_blocks(&state, out, ivb, out, length);
+	clean = upper_state_clean();
+
+	return (are_equal8(out, msg, length) == true && are_equal8(ivb, enc + length - 16, 16) == true && clean == true);
 }
 
-static bool aes256_ctr_monte_carlo(const uint8_t* key, const uint8_t* nonce, const uint8_t message[4][16], const uint8_t expected[4][16])
+static bool aes256_cbc_jobs_vector(const uint8_t* key, const uint8_t* iv, const uint8_t message[4][16], const uint8_t expected[4][16])
 {
 	rsx_keyparams kp = { key, 32 };
-	uint8_t ncc[16];
-	uint8_t out[16];
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[AES256_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[AES256_ROUNDKEY_DIMENSION];
-#endif	
+	rsx_cbc_job jobs[3];
+	uint8_t ivc[3][16];
+	uint8_t out[3][64];
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
 	rsx_state state = { rkeys, AES256_ROUNDKEY_DIMENSION };
 	size_t i;
 	bool status;
 
-	memcpy(&ncc[0], &nonce[0], 16);
+	/* the same vector as three streams of 4, 2, and 3 blocks, the last in place */
+	for (i = 0; i < 3; ++i)
+	{
+		memcpy(ivc[i], iv, 16);
+		memcpy(out[i], message[0], 64);
+		jobs[i].output = out[i];
+		jobs[i].iv = ivc[i];
+		jobs[i].input = (i == 2) ? out[i] : message[0];
+	}
+
+	jobs[0].length = 64;
+	jobs[1].length = 32;
+	jobs[2].length = 48;
 	status = true;
 
-	/* test encryption */
-	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	rsx_initialize(&state, &kp, true);
+	rsx_cbc_encrypt_jobs(&state, jobs, 3);
+
+	if (are_equal8(out[0], expected[0], 64) == false || are_equal8(ivc[0], expected[3], 16) == false)
 	{
 		status = false;
 	}
 
-	for (i = 0; i < 4; i++)
+	if (are_equal8(out[1], expected[0], 32) == false || are_equal8(ivc[1], expected[1], 16) == false)
 	{
-		rsx_ctr_transform(&state, out, ncc, message[i]);
+		status = false;
+	}
 
-		if (are_equal8(out, expected[i], 16) == false)
-		{
-			status = false;
-		}
+	if (are_equal8(out[2], expected[0], 48) == false || are_equal8(ivc[2], expected[2], 16) == false)
+	{
+		status = false;
 	}
 
-	memcpy(&ncc[0], &nonce[0], 16);
+	return status;
+}
 
-	/* test decryption */
-	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+static bool rsx512_cbc_jobs_equivalence(const uint8_t* key, size_t count)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_cbc_job jobs[20];
+	uint8_t msg[1024];
+	uint8_t enc[20][1024];
+	uint8_t exp[1024];
+	uint8_t ivc[20][16];
+	uint8_t iva[16];
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	size_t i;
+	size_t j;
+	bool status;
+
+	for (i = 0; i < sizeof(msg); i++)
 	{
-		status = false;
+		msg[i] = (uint8_t)i;
 	}
 
-	for (i = 0; i < 4; i++)
+	/* uneven lengths, including empty streams, so lanes are refilled mid-pass */
+	for (i = 0; i < count; ++i)
 	{
-		rsx_ctr_transform(&state, out, ncc, expected[i]);
+		memset(ivc[i], (int)i, 16);
+		jobs[i].output = enc[i];
+		jobs[i].iv = ivc[i];
+		jobs[i].input = msg;
+		jobs[i].length = ((i * 7) % 13) * 16 * (i % 3);
+	}
 
-		if (are_equal8(out, message[i], 16) == false)
+	rsx_initialize(&state, &kp, true);
+	rsx_cbc_encrypt_jobs(&state, jobs, count);
+	status = true;
+
+	for (i = 0; i < count; ++i)
+	{
+		memset(iva, (int)i, 16);
+
+		for (j = 0; j < jobs[i].length; j += 16)
+		{
+			rsx_cbc_encrypt(&state, exp + j, iva, msg + j);
+		}
+
+		if (are_equal8(enc[i], exp, jobs[i].length) == false || are_equal8(ivc[i], iva, 16) == false)
 		{
 			status = false;
 		}
@@ -270,19 +365,17 @@ static bool aes256_ctr_monte_carlo(const uint8_t* key, const uint8_t* nonce, con
 	return status;
 }
 
-static bool aes128_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+static bool aes128_ctr_monte_carlo(const uint8_t* key, const uint8_t* nonce, const uint8_t message[4][16], const uint8_t expected[4][16])
 {
-	uint8_t out[16];
 	rsx_keyparams kp = { key, 16 };
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[AES128_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[AES128_ROUNDKEY_DIMENSION];
-#endif
+	uint8_t ncc[16];
+	uint8_t out[16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
 	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
 	size_t i;
 	bool status;
 
+	memcpy(&ncc[0], &nonce[0], 16);
 	status = true;
 
 	/* test encryption */
@@ -293,7 +386,7 @@ static bool aes128_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][
 
 	for (i = 0; i < 4; i++)
 	{
-		rsx_ecb_encrypt(&state, out, message[i]);
+		rsx_ctr_transform(&state, out, ncc, message[i]);
 
 		if (are_equal8(out, expected[i], 16) == false)
 		{
@@ -301,15 +394,17 @@ static bool aes128_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][
 		}
 	}
 
+	memcpy(&ncc[0], &nonce[0], 16);
+
 	/* test decryption */
-	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
 	{
 		status = false;
 	}
 
 	for (i = 0; i < 4; i++)
 	{
-		rsx_ecb_decrypt(&state, out, expected[i]);
+		rsx_ctr_transform(&state, out, ncc, expected[i]);
 
 		if (are_equal8(out, message[i], 16) == false)
 		{
@@ -320,19 +415,17 @@ static bool aes128_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][
 	return status;
 }
 
-static bool aes256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+static bool aes256_ctr_monte_carlo(const uint8_t* key, const uint8_t* nonce, const uint8_t message[4][16], const uint8_t expected[4][16])
 {
-	uint8_t out[16];
 	rsx_keyparams kp = { key, 32 };
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[AES256_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[AES256_ROUNDKEY_DIMENSION];
-#endif
+	uint8_t ncc[16];
+	uint8_t out[16];
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
 	rsx_state state = { rkeys, AES256_ROUNDKEY_DIMENSION };
 	size_t i;
 	bool status;
 
+	memcpy(&ncc[0], &nonce[0], 16);
 	status = true;
 
 	/* test encryption */
@@ -343,7 +436,7 @@ static bool aes256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][
 
 	for (i = 0; i < 4; i++)
 	{
-		rsx_ecb_encrypt(&state, out, message[i]);
+		rsx_ctr_transform(&state, out, ncc, message[i]);
 
 		if (are_equal8(out, expected[i], 16) == false)
 		{
@@ -351,15 +444,17 @@ static bool aes256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][
 		}
 	}
 
+	memcpy(&ncc[0], &nonce[0], 16);
+
 	/* test decryption */
-	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
 	{
 		status = false;
 	}
 
 	for (i = 0; i < 4; i++)
 	{
-		rsx_ecb_decrypt(&state, out, expected[i]);
+		rsx_ctr_transform(&state, out, ncc, expected[i]);
 
 		if (are_equal8(out, message[i], 16) == false)
 		{
@@ -370,241 +465,2830 @@ static bool aes256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][
 	return status;
 }
 
-static void print_array8(const uint8_t* a, size_t count, size_t line)
+static bool aes128_ctr_blocks_monte_carlo(const uint8_t* key, const uint8_t* nonce, const uint8_t message[4][16], const uint8_t expected[4][16])
 {
-	size_t i;
+	rsx_keyparams kp = { key, 16 };
+	uint8_t ncc[16];
+	uint8_t out[4][16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	bool status;
 
-	for (i = 0; i < count; ++i)
-	{
-		if (i != 0 && i % line == 0)
-		{
-			printf("\n");
-		}
+	memcpy(&ncc[0], &nonce[0], 16);
+	status = true;
 
-		printf("0x%02X, ", a[i]);
+	/* test encryption */
+	rsx_initialize(&state, &kp, true);
+	rsx_ctr_transform_blocks(&state, out[0], ncc, message[0], 64);
+
+	if (are_equal8(out[0], expected[0], 64) == false)
+	{
+		status = false;
 	}
-}
 
-static void print_array32(const uint32_t* a, size_t count, size_t line)
-{
-	size_t i;
+	memcpy(&ncc[0], &nonce[0], 16);
 
-	for (i = 0; i < count; ++i)
-	{
-		if (i != 0 && i % line == 0)
-		{
-			printf("\n");
-		}
+	/* test decryption */
+	rsx_ctr_transform_blocks(&state, out[0], ncc, expected[0], 64);
 
-		printf("%d ", a[i]);
+	if (are_equal8(out[0], message[0], 64) == false)
+	{
+		status = false;
 	}
+
+	return status;
 }
 
-static bool rsx256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+static bool rsx512_ctr_blocks_equivalence(const uint8_t* key, size_t length)
 {
-	uint8_t out[16];
-	rsx_keyparams kp = { key, 32 };
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[RSX256_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[RSX256_ROUNDKEY_DIMENSION];
-#endif
-	rsx_state state = { rkeys, RSX256_ROUNDKEY_DIMENSION };
+	rsx_keyparams kp = { key, 64 };
+	uint8_t msg[1024];
+	uint8_t exp[1024];
+	uint8_t inp[1024];
+	uint8_t out[1024];
+	uint8_t nexp[16];
+	uint8_t ncc[16];
+	uint8_t ncp[16];
+	uint8_t tmpb[16];
+	uint8_t tmpo[16];
 	size_t i;
-	bool status;
+	bool clean;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
 
-	status = true;
+	rsx_initialize(&state, &kp, true);
 
-	/* test encryption */
-	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	/* start the counter close to a 64 bit carry, so the carry crosses a lane boundary */
+	hex_to_bin("0000000000000000FFFFFFFFFFFFFFF5", nexp, 16);
+	memcpy(&ncc[0], &nexp[0], 16);
+	memcpy(&ncp[0], &nexp[0], 16);
+
+	for (i = 0; i < length; i++)
 	{
-		status = false;
+		msg[i] = (uint8_t)i;
 	}
 
-	for (i = 0; i < 4; i++)
+	/* expected output from the single block transform */
+	for (i = 0; i + 16 <= length; i += 16)
 	{
-		rsx_ecb_encrypt(&state, out, message[i]);
-
-		if (are_equal8(out, expected[i], 16) == false)
-		{
-			status = false;
-		}
+		rsx_ctr_transform(&state, exp + i, nexp, msg + i);
 	}
 
-	/* test decryption */
-	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	if (i != length)
 	{
-		status = false;
+		memset(tmpb, 0, 16);
+		memcpy(tmpb, msg + i, length - i);
+		rsx_ctr_transform(&state, tmpo, nexp, tmpb);
+		memcpy(exp + i, tmpo, length - i);
 	}
 
-	for (i = 0; i < 4; i++)
-	{
-		rsx_ecb_decrypt(&state, out, expected[i]);
+	rsx_ctr_transform_blocks(&state, out, ncc, msg, length);
+	clean = upper_state_clean();
 
-		if (are_equal8(out, message[i], 16) == false)
-		{
-			status = false;
-		}
-	}
+	/* in place, the output overwrites the input */
+	memcpy(inp, msg, length);
+	rsx_ctr_transform_blocks(&state, inp, ncp, inp, length);
 
-	return status;
+	return (are_equal8(out, exp, length) == true && are_equal8(ncc, nexp, 16) == true && clean == true &&
+		are_equal8(inp, exp, length) == true && are_equal8(ncp, nexp, 16) == true);
 }
 
-static bool rsx512_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+static bool rsx512_ctr_parallel_equivalence(threadpool_state* pool, const uint8_t* key, const char* nonce, size_t length, size_t minchunk)
 {
-	uint8_t out[16];
 	rsx_keyparams kp = { key, 64 };
-#if defined(RSX_AESNI_ENABLED)
-	__m128i rkeys[RSX512_ROUNDKEY_DIMENSION];
-#else
-	uint32_t rkeys[RSX512_ROUNDKEY_DIMENSION];
-#endif
-	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	uint8_t msg[4096];
+	uint8_t exp[4096];
+	uint8_t out[4096];
+	uint8_t nexp[16];
+	uint8_t ncc[16];
 	size_t i;
-	bool status;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
 
-	status = true;
+	rsx_initialize(&state, &kp, true);
+	hex_to_bin(nonce, nexp, 16);
+	memcpy(&ncc[0], &nexp[0], 16);
 
-	/* test encryption */
-	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	for (i = 0; i < length; i++)
 	{
-		status = false;
+		msg[i] = (uint8_t)(i * 7);
 	}
 
-	for (i = 0; i < 4; i++)
-	{
-		rsx_ecb_encrypt(&state, out, message[i]);
+	/* expected output and final counter from the serial transform */
+	rsx_ctr_transform_blocks(&state, exp, nexp, msg, length);
+	rsx_ctr_transform_parallel(pool, &state, out, ncc, msg, length, minchunk);
 
-		if (are_equal8(out, expected[i], 16) == false)
-		{
-			status = false;
-		}
-	}
+	return (are_equal8(out, exp, length) == true && are_equal8(ncc, nexp, 16) == true);
+}
 
-	/* test decryption */
-	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
-	{
-		status = false;
-	}
+static bool dualkey_equivalence(const uint8_t* key, size_t keylen, size_t rkeylen, bool lazy)
+{
+	rsx_keyparams kp = { key, keylen };
+	rsx_dualkey_ctx ctx;
+	rsx_roundkey encexp[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey decexp[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey enckeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey deckeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state encref = { encexp, rkeylen };
+	rsx_state decref = { decexp, rkeylen };
+	rsx_state encstate = { enckeys, rkeylen };
+	rsx_state decstate = { deckeys, rkeylen };
+	uint8_t msg[16] = { 0 };
+	uint8_t enc[16];
+	uint8_t dec[16];
+	bool status;
 
-	for (i = 0; i < 4; i++)
-	{
-		rsx_ecb_decrypt(&state, out, expected[i]);
+	rsx_initialize(&encref, &kp, true);
+	rsx_initialize(&decref, &kp, false);
+	status = (rsx_dualkey_initialize(&ctx, &encstate, &decstate, &kp, lazy) == MQC_STATUS_SUCCESS);
 
-		if (are_equal8(out, message[i], 16) == false)
-		{
-			status = false;
-		}
+	/* the derived schedule matches a decryption expansion, and the two states invert each other */
+	if (status == true)
+	{
+		rsx_ecb_encrypt(&encstate, enc, msg);
+		rsx_ecb_decrypt(rsx_dualkey_decryption(&ctx), dec, enc);
+		status = (are_equal8((uint8_t*)enckeys, (uint8_t*)encexp, rkeylen * sizeof(rsx_roundkey)) == true &&
+			are_equal8((uint8_t*)deckeys, (uint8_t*)decexp, rkeylen * sizeof(rsx_roundkey)) == true &&
+			are_equal8(dec, msg, 16) == true);
+		rsx_dualkey_dispose(&ctx);
 	}
 
 	return status;
 }
 
-bool aes128_cbc_kat_test()
+static bool keycache_equivalence(keycache_state* cache, const uint8_t* key, size_t keylen, size_t rkeylen, const uint8_t* keyid)
 {
-	uint8_t exp[4][16];
-	uint8_t msg[4][16];
-	uint8_t iv[16];
-	uint8_t key[16];
+	rsx_keyparams kp = { key, keylen };
+	rsx_roundkey encexp[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey decexp[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey enckeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey deckeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state encref = { encexp, rkeylen };
+	rsx_state decref = { decexp, rkeylen };
+	rsx_state encstate = { enckeys, rkeylen };
+	rsx_state decstate = { deckeys, rkeylen };
+	bool status;
 
-	/* SP800-38a F2.1 */
+	/* the cached schedules must match a fresh expansion in both directions */
+	rsx_initialize(&encref, &kp, true);
+	rsx_initialize(&decref, &kp, false);
+	status = (keycache_get(cache, &encstate, &decstate, &kp, keyid) == MQC_STATUS_SUCCESS);
 
-	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
-	hex_to_bin("000102030405060708090A0B0C0D0E0F", iv, 16);
+	return (status == true && are_equal8((uint8_t*)enckeys, (uint8_t*)encexp, rkeylen * sizeof(rsx_roundkey)) == true &&
+		are_equal8((uint8_t*)deckeys, (uint8_t*)decexp, rkeylen * sizeof(rsx_roundkey)) == true);
+}
 
-	hex_to_bin("7649ABAC8119B246CEE98E9B12E9197D", exp[0], 16);
+typedef struct keycache_task_ctx
+{
+	keycache_state* cache;
+	bool results[64];
+} keycache_task_ctx;
+
+static void keycache_task(void* context, size_t index)
+{
+	keycache_task_ctx* ctx = (keycache_task_ctx*)context;
+	uint8_t id[KEYCACHE_ID_SIZE] = { 0 };
+	uint8_t key[64] = { 0 };
+
+	/* eight tenants, each looked up eight times from whichever thread takes the task */
+	id[0] = (uint8_t)(index % 8);
+	key[0] = (uint8_t)(index % 8);
+	ctx->results[index] = keycache_equivalence(ctx->cache, key, 64, RSX512_ROUNDKEY_DIMENSION, id);
+}
+
+static bool rsx512_ctr_stream_equivalence(const uint8_t* key, const size_t* sizes, size_t count)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_ctr_ctx ctx;
+	uint8_t msg[1024];
+	uint8_t exp[1024];
+	uint8_t out[1024];
+	uint8_t nexp[16];
+	size_t length;
+	size_t pos;
+	size_t i;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+
+	rsx_initialize(&state, &kp, true);
+	hex_to_bin("0000000000000000FFFFFFFFFFFFFFF5", nexp, 16);
+	rsx_ctr_initialize(&ctx, &state, nexp);
+	length = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		length += sizes[i];
+	}
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 3);
+	}
+
+	/* the whole message in one call */
+	rsx_ctr_transform_blocks(&state, exp, nexp, msg, length);
+
+	/* the same message split into uneven updates */
+	pos = 0;
+
+	for (i = 0; i < count; i++)
+	{
+		rsx_ctr_update(&ctx, out + pos, msg + pos, sizes[i]);
+		pos += sizes[i];
+	}
+
+	return (are_equal8(out, exp, length) == true && are_equal8(ctx.nonce, nexp, 16) == true);
+}
+
+static bool rsx512_ctr_packets_equivalence(const uint8_t* key, size_t count)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_ctr_packet packets[24];
+	uint8_t msg[512];
+	uint8_t exp[512];
+	uint8_t out[24][512];
+	uint8_t nonces[24][16];
+	uint8_t nexp[16];
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	size_t i;
+	bool status;
+
+	for (i = 0; i < sizeof(msg); i++)
+	{
+		msg[i] = (uint8_t)(i * 5);
+	}
+
+	/* uneven packet lengths, some packets empty, and counters that carry into the upper 64 bits */
+	for (i = 0; i < count; ++i)
+	{
+		hex_to_bin("0000000000000000FFFFFFFFFFFFFFF0", nonces[i], 16);
+		nonces[i][15] = (uint8_t)(0xF0 + (i % 16));
+		nonces[i][0] = (uint8_t)i;
+		packets[i].output = out[i];
+		packets[i].nonce = nonces[i];
+		packets[i].input = msg;
+		packets[i].length = ((i * 37) % 29) * 17;
+		memset(out[i], 0, sizeof(out[i]));
+	}
+
+	rsx_initialize(&state, &kp, true);
+	rsx_ctr_transform_packets(&state, packets, count);
+	status = true;
+
+	for (i = 0; i < count; ++i)
+	{
+		memcpy(nexp, nonces[i], 16);
+		rsx_ctr_transform_blocks(&state, exp, nexp, msg, packets[i].length);
+
+		/* a partial last block must not write past the packet */
+		if (are_equal8(out[i], exp, packets[i].length) == false || out[i][packets[i].length] != 0)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+static bool rsx_ctr_keyed_equivalence(size_t rkeylen, size_t keylen, const uint8_t* distcode, size_t codelen, size_t count)
+{
+	rsx_keyed_packet packets[11];
+	uint8_t keys[11][64];
+	uint8_t nonces[11][16];
+	uint8_t msg[256];
+	uint8_t exp[256];
+	uint8_t out[11][256];
+	uint8_t nexp[16];
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, rkeylen };
+	rsx_keyparams kp = { NULL, keylen, (uint8_t*)distcode, codelen };
+	size_t i;
+	size_t j;
+	bool status;
+
+	for (i = 0; i < sizeof(msg); i++)
+	{
+		msg[i] = (uint8_t)(i * 7);
+	}
+
+	/* a distinct key and counter for each object, lengths that end inside a block */
+	for (i = 0; i < count; ++i)
+	{
+		for (j = 0; j < 64; ++j)
+		{
+			keys[i][j] = (uint8_t)((i * 29) + (j * 3) + 1);
+		}
+
+		hex_to_bin("000102030405060708090A0B0C0D0EF0", nonces[i], 16);
+		nonces[i][15] = (uint8_t)(0xF0 + i);
+		packets[i].output = out[i];
+		packets[i].key = keys[i];
+		packets[i].nonce = nonces[i];
+		packets[i].input = msg;
+		packets[i].length = ((i * 53) % 241) + 1;
+		memset(out[i], 0, sizeof(out[i]));
+	}
+
+	status = (rsx_ctr_transform_keyed(packets, count, rkeylen, distcode, codelen) == MQC_STATUS_SUCCESS);
+
+	for (i = 0; i < count; ++i)
+	{
+		kp.key = keys[i];
+		rsx_initialize(&state, &kp, true);
+		memcpy(nexp, nonces[i], 16);
+		rsx_ctr_transform_blocks(&state, exp, nexp, msg, packets[i].length);
+
+		if (are_equal8(out[i], exp, packets[i].length) == false || out[i][packets[i].length] != 0)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+static bool aes_gcm_vector(const char* key, size_t keylen, const char* nonce, size_t noncelen, const char* aad, size_t aadlen, const char* message, const char* expected, size_t length, const char* tag)
+{
+	rsx_keyparams kp = { NULL, keylen };
+	rsx_gcm_ctx ctx;
+	uint8_t bkey[32];
+	uint8_t bnonce[64];
+	uint8_t badd[32];
+	uint8_t msg[64];
+	uint8_t exp[64];
+	uint8_t out[64];
+	uint8_t etag[16];
+	uint8_t otag[16];
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, (keylen == AES128_KEY_SIZE) ? AES128_ROUNDKEY_DIMENSION : AES256_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin(key, bkey, keylen);
+	hex_to_bin(nonce, bnonce, noncelen);
+	hex_to_bin(aad, badd, aadlen);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, length);
+	hex_to_bin(tag, etag, 16);
+	kp.key = bkey;
+
+	rsx_initialize(&state, &kp, true);
+	rsx_gcm_initialize(&ctx, &state);
+	status = true;
+
+	/* test encryption */
+	if (rsx_gcm_encrypt(&ctx, out, otag, 16, bnonce, noncelen, badd, aadlen, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false || are_equal8(otag, etag, 16) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption, in place */
+	if (rsx_gcm_decrypt(&ctx, out, etag, 16, bnonce, noncelen, badd, aadlen, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified tag is rejected */
+	etag[15] ^= 1;
+
+	if (rsx_gcm_decrypt(&ctx, out, etag, 16, bnonce, noncelen, badd, aadlen, exp, length) != MQC_STATUS_AUTHFAIL)
+	{
+		status = false;
+	}
+
+	rsx_gcm_dispose(&ctx);
+
+	return status;
+}
+
+static bool rsx512_gcm_roundtrip(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_gcm_ctx ctx;
+	uint8_t msg[4096];
+	uint8_t enc[4096];
+	uint8_t dec[4096];
+	uint8_t nonce[12];
+	uint8_t aad[21];
+	uint8_t tag[16];
+	size_t i;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 5);
+	}
+
+	for (i = 0; i < sizeof(aad); i++)
+	{
+		aad[i] = (uint8_t)i;
+	}
+
+	hex_to_bin("CAFEBABEFACEDBADDECAF888", nonce, 12);
+	rsx_initialize(&state, &kp, true);
+	rsx_gcm_initialize(&ctx, &state);
+	status = true;
+
+	/* the 8 block aggregated hash, the single block hash, and a partial block */
+	rsx_gcm_encrypt(&ctx, enc, tag, 16, nonce, 12, aad, sizeof(aad), msg, length);
+
+	if (rsx_gcm_decrypt(&ctx, dec, tag, 16, nonce, 12, aad, sizeof(aad), enc, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(dec, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified cipher-text is rejected, and the output is erased */
+	enc[length / 2] ^= 0x80;
+
+	if (rsx_gcm_decrypt(&ctx, dec, tag, 16, nonce, 12, aad, sizeof(aad), enc, length) != MQC_STATUS_AUTHFAIL || dec[0] != 0)
+	{
+		status = false;
+	}
+
+	rsx_gcm_dispose(&ctx);
+
+	return status;
+}
+
+static bool rsx512_ctrkmac_equivalence(const uint8_t* key, size_t length, size_t aadlen)
+{
+	const uint8_t custom[15] = { 'R', 'S', 'X', '-', 'C', 'T', 'R', '-', 'K', 'M', 'A', 'C', '2', '5', '6' };
+	rsx_keyparams kp = { key, 64 };
+	rsx_ctrkmac_ctx ctx;
+	uint8_t mac[5000];
+	uint8_t msg[3000];
+	uint8_t exp[3000];
+	uint8_t out[3000];
+	uint8_t aad[300];
+	uint8_t nonce[16];
+	uint8_t ncc[16];
+	uint8_t etag[32];
+	uint8_t otag[32];
+	size_t mlen;
+	size_t i;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 11);
+	}
+
+	for (i = 0; i < aadlen; i++)
+	{
+		aad[i] = (uint8_t)(i + 1);
+	}
+
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+	rsx_initialize(&state, &kp, true);
+	rsx_ctrkmac_initialize(&ctx, &state, key + 32, 32);
+	status = true;
+
+	/* expected cipher-text from the multi-block CTR transform */
+	memcpy(ncc, nonce, 16);
+	rsx_ctr_transform_blocks(&state, exp, ncc, msg, length);
+
+	/* expected tag: one KMAC-256 call over nonce || aad, zero padded to the rate, || cipher-text || lengths */
+	memset(mac, 0, sizeof(mac));
+	memcpy(mac, nonce, 16);
+	memcpy(mac + 16, aad, aadlen);
+	mlen = ((16 + aadlen + CSHAKE256_RATE - 1) / CSHAKE256_RATE) * CSHAKE256_RATE;
+	memcpy(mac + mlen, exp, length);
+	mlen += length;
+
+	for (i = 0; i < 8; i++)
+	{
+		mac[mlen + i] = (uint8_t)((uint64_t)aadlen >> (8 * i));
+		mac[mlen + 8 + i] = (uint8_t)((uint64_t)length >> (8 * i));
+	}
+
+	kmac256(etag, 32, mac, mlen + 16, key + 32, 32, custom, sizeof(custom));
+
+	if (rsx_ctrkmac_encrypt(&ctx, out, otag, 32, nonce, aad, aadlen, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false || are_equal8(otag, etag, 32) == false)
+	{
+		status = false;
+	}
+
+	/* decryption in place */
+	if (rsx_ctrkmac_decrypt(&ctx, out, etag, 32, nonce, aad, aadlen, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified tag is rejected, and the output is rolled back to the cipher-text */
+	memcpy(out, exp, length);
+	etag[0] ^= 1;
+
+	if (rsx_ctrkmac_decrypt(&ctx, out, etag, 32, nonce, aad, aadlen, out, length) != MQC_STATUS_AUTHFAIL ||
+		are_equal8(out, exp, length) == false)
+	{
+		status = false;
+	}
+
+	rsx_ctrkmac_dispose(&ctx);
+
+	return status;
+}
+
+static bool aes_gcmsiv_vector(const char* key, size_t keylen, const char* nonce, const char* aad, size_t aadlen, const char* message, const char* expected, size_t length, const char* tag)
+{
+	rsx_keyparams kp = { NULL, keylen };
+	uint8_t bkey[32];
+	uint8_t bnonce[12];
+	uint8_t badd[32];
+	uint8_t msg[64];
+	uint8_t exp[64];
+	uint8_t out[64];
+	uint8_t etag[16];
+	uint8_t otag[16];
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, (keylen == AES128_KEY_SIZE) ? AES128_ROUNDKEY_DIMENSION : AES256_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin(key, bkey, keylen);
+	hex_to_bin(nonce, bnonce, 12);
+	hex_to_bin(aad, badd, aadlen);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, length);
+	hex_to_bin(tag, etag, 16);
+	kp.key = bkey;
+
+	rsx_initialize(&state, &kp, true);
+	status = true;
+
+	/* test encryption */
+	if (rsx_gcmsiv_encrypt(&state, out, otag, bnonce, badd, aadlen, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false || are_equal8(otag, etag, 16) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption, in place */
+	if (rsx_gcmsiv_decrypt(&state, out, etag, bnonce, badd, aadlen, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified tag is rejected */
+	etag[0] ^= 1;
+
+	if (rsx_gcmsiv_decrypt(&state, out, etag, bnonce, badd, aadlen, exp, length) != MQC_STATUS_AUTHFAIL)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool rsx512_gcmsiv_batch_equivalence(const uint8_t* key, size_t count)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_gcmsiv_record recs[20];
+	uint8_t msg[20 * 200];
+	uint8_t enc[20 * 200];
+	uint8_t dec[20 * 200];
+	uint8_t nonces[20 * 12];
+	uint8_t tags[20 * 16];
+	uint8_t etag[16];
+	uint8_t aad[13];
+	size_t len;
+	size_t i;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < sizeof(msg); i++)
+	{
+		msg[i] = (uint8_t)(i * 13);
+	}
+
+	for (i = 0; i < sizeof(nonces); i++)
+	{
+		nonces[i] = (uint8_t)(i + 7);
+	}
+
+	for (i = 0; i < sizeof(aad); i++)
+	{
+		aad[i] = (uint8_t)i;
+	}
+
+	rsx_initialize(&state, &kp, true);
+	status = true;
+
+	/* records of 64 to 197 bytes, over more than one batch */
+	for (i = 0; i < count; i++)
+	{
+		len = 64 + ((i * 37) % 134);
+		recs[i].output = enc + (i * 200);
+		recs[i].tag = tags + (i * 16);
+		recs[i].nonce = nonces + (i * 12);
+		recs[i].aad = aad;
+		recs[i].aadlen = i % sizeof(aad);
+		recs[i].input = msg + (i * 200);
+		recs[i].length = len;
+	}
+
+	if (rsx_gcmsiv_encrypt_batch(&state, recs, count) != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	/* each record matches the single message function */
+	for (i = 0; i < count; i++)
+	{
+		rsx_gcmsiv_encrypt(&state, dec, etag, recs[i].nonce, aad, recs[i].aadlen, recs[i].input, recs[i].length);
+
+		if (are_equal8(dec, recs[i].output, recs[i].length) == false || are_equal8(etag, recs[i].tag, 16) == false)
+		{
+			status = false;
+		}
+
+		recs[i].input = recs[i].output;
+		recs[i].output = dec + (i * 200);
+	}
+
+	if (rsx_gcmsiv_decrypt_batch(&state, recs, count) != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		if (are_equal8(recs[i].output, msg + (i * 200), recs[i].length) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* one forged record fails alone */
+	tags[16 * (count / 2)] ^= 1;
+
+	if (rsx_gcmsiv_decrypt_batch(&state, recs, count) != MQC_STATUS_AUTHFAIL ||
+		recs[count / 2].status != MQC_STATUS_AUTHFAIL || recs[0].status != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool aes_ocb_vector(const char* nonce, const char* aad, size_t aadlen, const char* message, const char* expected, size_t length, const char* tag)
+{
+	uint8_t bkey[16];
+	rsx_keyparams kp = { bkey, 16 };
+	rsx_ocb_ctx ctx;
+	uint8_t bnonce[12];
+	uint8_t badd[64];
+	uint8_t msg[64];
+	uint8_t exp[64];
+	uint8_t out[64];
+	uint8_t etag[16];
+	uint8_t otag[16];
+	rsx_roundkey rkeys1[AES128_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys2[AES128_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { rkeys1, AES128_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { rkeys2, AES128_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin("000102030405060708090A0B0C0D0E0F", bkey, 16);
+	hex_to_bin(nonce, bnonce, 12);
+	hex_to_bin(aad, badd, aadlen);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, length);
+	hex_to_bin(tag, etag, 16);
+
+	rsx_initialize(&encstate, &kp, true);
+	rsx_initialize(&decstate, &kp, false);
+	rsx_ocb_initialize(&ctx, &encstate, &decstate);
+	status = true;
+
+	/* test encryption */
+	if (rsx_ocb_encrypt(&ctx, out, otag, 16, bnonce, 12, badd, aadlen, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false || are_equal8(otag, etag, 16) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption, in place */
+	if (rsx_ocb_decrypt(&ctx, out, etag, 16, bnonce, 12, badd, aadlen, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified tag is rejected */
+	etag[15] ^= 1;
+
+	if (rsx_ocb_decrypt(&ctx, out, etag, 16, bnonce, 12, badd, aadlen, exp, length) != MQC_STATUS_AUTHFAIL)
+	{
+		status = false;
+	}
+
+	rsx_ocb_dispose(&ctx);
+
+	return status;
+}
+
+static bool rsx512_ocb_roundtrip(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_ocb_ctx ctx;
+	uint8_t msg[4200];
+	uint8_t enc[4200];
+	uint8_t dec[4200];
+	uint8_t nonce[12];
+	uint8_t aad[37];
+	uint8_t tag[16];
+	size_t i;
+	rsx_roundkey rkeys1[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys2[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { rkeys1, RSX512_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { rkeys2, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 7);
+	}
+
+	for (i = 0; i < sizeof(aad); i++)
+	{
+		aad[i] = (uint8_t)(i + 3);
+	}
+
+	hex_to_bin("BBAA99887766554433221100", nonce, 12);
+	rsx_initialize(&encstate, &kp, true);
+	rsx_initialize(&decstate, &kp, false);
+	rsx_ocb_initialize(&ctx, &encstate, &decstate);
+	status = true;
+
+	rsx_ocb_encrypt(&ctx, enc, tag, 16, nonce, 12, aad, sizeof(aad), msg, length);
+
+	if (rsx_ocb_decrypt(&ctx, dec, tag, 16, nonce, 12, aad, sizeof(aad), enc, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(dec, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified cipher-text is rejected, and the output is erased */
+	enc[length / 2] ^= 0x80;
+
+	if (rsx_ocb_decrypt(&ctx, dec, tag, 16, nonce, 12, aad, sizeof(aad), enc, length) != MQC_STATUS_AUTHFAIL || dec[0] != 0)
+	{
+		status = false;
+	}
+
+	/* an encrypt only context can not decrypt */
+	rsx_ocb_initialize(&ctx, &encstate, NULL);
+
+	if (rsx_ocb_decrypt(&ctx, dec, tag, 16, nonce, 12, aad, sizeof(aad), enc, length) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	rsx_ocb_dispose(&ctx);
+
+	return status;
+}
+
+static bool aes_xts_vector(const char* key1, const char* key2, const char* tweak, const char* message, const char* expected, size_t length)
+{
+	rsx_keyparams kp1 = { NULL, 16 };
+	rsx_keyparams kp2 = { NULL, 16 };
+	uint8_t bkey1[16];
+	uint8_t bkey2[16];
+	uint8_t btweak[16];
+	uint8_t msg[64];
+	uint8_t exp[64];
+	uint8_t out[64];
+	rsx_roundkey rkeys1[AES128_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys2[AES128_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys3[AES128_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { rkeys1, AES128_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { rkeys2, AES128_ROUNDKEY_DIMENSION };
+	rsx_state twkstate = { rkeys3, AES128_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin(key1, bkey1, 16);
+	hex_to_bin(key2, bkey2, 16);
+	hex_to_bin(tweak, btweak, 16);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, length);
+	kp1.key = bkey1;
+	kp2.key = bkey2;
+
+	rsx_initialize(&encstate, &kp1, true);
+	rsx_initialize(&decstate, &kp1, false);
+	rsx_initialize(&twkstate, &kp2, true);
+	status = true;
+
+	/* test encryption */
+	if (rsx_xts_encrypt(&encstate, &twkstate, out, btweak, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption, in place */
+	if (rsx_xts_decrypt(&decstate, &twkstate, out, btweak, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool rsx512_xts_roundtrip(const uint8_t* key, const uint8_t* tweakkey, size_t length)
+{
+	rsx_keyparams kp1 = { key, 64 };
+	rsx_keyparams kp2 = { tweakkey, 32 };
+	uint8_t msg[4200];
+	uint8_t enc[4200];
+	uint8_t dec[4200];
+	uint8_t tweak[16] = { 0 };
+	size_t i;
+	rsx_roundkey rkeys1[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys2[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys3[AES256_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { rkeys1, RSX512_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { rkeys2, RSX512_ROUNDKEY_DIMENSION };
+	rsx_state twkstate = { rkeys3, AES256_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 3);
+	}
+
+	/* sector 1234 */
+	tweak[0] = 0xD2;
+	tweak[1] = 0x04;
+
+	rsx_initialize(&encstate, &kp1, true);
+	rsx_initialize(&decstate, &kp1, false);
+	rsx_initialize(&twkstate, &kp2, true);
+	status = true;
+
+	rsx_xts_encrypt(&encstate, &twkstate, enc, tweak, msg, length);
+
+	if (rsx_xts_decrypt(&decstate, &twkstate, dec, tweak, enc, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(dec, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* in place encryption matches, and the last blocks differ from the next sector's */
+	memcpy(dec, msg, length);
+	rsx_xts_encrypt(&encstate, &twkstate, dec, tweak, dec, length);
+
+	if (are_equal8(dec, enc, length) == false)
+	{
+		status = false;
+	}
+
+	tweak[0] += 1;
+	rsx_xts_encrypt(&encstate, &twkstate, dec, tweak, msg, length);
+
+	if (are_equal8(dec + length - 16, enc + length - 16, 16) == true)
+	{
+		status = false;
+	}
+
+	/* a data unit shorter than a block is rejected */
+	if (rsx_xts_encrypt(&encstate, &twkstate, dec, tweak, msg, 15) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool aes_hctr2_vector(const char* key, size_t keylen, const char* tweak, size_t tweaklen, const char* message, const char* expected, size_t length)
+{
+	rsx_keyparams kp = { NULL, keylen };
+	rsx_hctr2_ctx ctx;
+	uint8_t bkey[32];
+	uint8_t btweak[32];
+	uint8_t msg[64];
+	uint8_t exp[64];
+	uint8_t out[64];
+	rsx_roundkey rkeys1[AES256_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys2[AES256_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { rkeys1, (keylen == AES128_KEY_SIZE) ? AES128_ROUNDKEY_DIMENSION : AES256_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { rkeys2, (keylen == AES128_KEY_SIZE) ? AES128_ROUNDKEY_DIMENSION : AES256_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin(key, bkey, keylen);
+	hex_to_bin(tweak, btweak, tweaklen);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, length);
+	kp.key = bkey;
+
+	rsx_initialize(&encstate, &kp, true);
+	rsx_initialize(&decstate, &kp, false);
+	rsx_hctr2_initialize(&ctx, &encstate, &decstate);
+	status = true;
+
+	/* test encryption */
+	if (rsx_hctr2_encrypt(&ctx, out, btweak, tweaklen, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption, in place */
+	if (rsx_hctr2_decrypt(&ctx, out, btweak, tweaklen, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	rsx_hctr2_dispose(&ctx);
+
+	return status;
+}
+
+static bool rsx512_hctr2_roundtrip(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_hctr2_ctx ctx;
+	uint8_t msg[4200];
+	uint8_t enc[4200];
+	uint8_t dec[4200];
+	uint8_t tweak[16] = { 0 };
+	size_t i;
+	rsx_roundkey rkeys1[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey rkeys2[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { rkeys1, RSX512_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { rkeys2, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 3);
+	}
+
+	/* sector 1234 */
+	tweak[0] = 0xD2;
+	tweak[1] = 0x04;
+
+	rsx_initialize(&encstate, &kp, true);
+	rsx_initialize(&decstate, &kp, false);
+	rsx_hctr2_initialize(&ctx, &encstate, &decstate);
+	status = true;
+
+	rsx_hctr2_encrypt(&ctx, enc, tweak, sizeof(tweak), msg, length);
+
+	if (rsx_hctr2_decrypt(&ctx, dec, tweak, sizeof(tweak), enc, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(dec, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* in place encryption matches */
+	memcpy(dec, msg, length);
+	rsx_hctr2_encrypt(&ctx, dec, tweak, sizeof(tweak), dec, length);
+
+	if (are_equal8(dec, enc, length) == false)
+	{
+		status = false;
+	}
+
+	/* a change to the last byte of the sector reaches the first and last cipher-text blocks */
+	memcpy(dec, msg, length);
+	dec[length - 1] ^= 1;
+	rsx_hctr2_encrypt(&ctx, dec, tweak, sizeof(tweak), dec, length);
+
+	if (are_equal8(dec, enc, 16) == true || are_equal8(dec + length - 16, enc + length - 16, 16) == true)
+	{
+		status = false;
+	}
+
+	/* and so does a change to the tweak */
+	tweak[0] += 1;
+	rsx_hctr2_encrypt(&ctx, dec, tweak, sizeof(tweak), msg, length);
+
+	if (are_equal8(dec, enc, 16) == true || are_equal8(dec + length - 16, enc + length - 16, 16) == true)
+	{
+		status = false;
+	}
+
+	/* a sector shorter than a block is rejected */
+	if (rsx_hctr2_encrypt(&ctx, dec, tweak, sizeof(tweak), msg, 15) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	rsx_hctr2_dispose(&ctx);
+
+	/* an encrypt only context can not decrypt */
+	rsx_hctr2_initialize(&ctx, &encstate, NULL);
+
+	if (rsx_hctr2_decrypt(&ctx, dec, tweak, sizeof(tweak), enc, length) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	rsx_hctr2_dispose(&ctx);
+
+	return status;
+}
+
+static bool aes_ccm_vector(const char* key, const char* nonce, size_t noncelen, const char* aad, size_t aadlen, const char* message, const char* expected, size_t length, const char* tag, size_t taglen)
+{
+	rsx_keyparams kp = { NULL, 16 };
+	uint8_t bkey[16];
+	uint8_t bnonce[13];
+	uint8_t badd[32];
+	uint8_t msg[64];
+	uint8_t exp[64];
+	uint8_t out[64];
+	uint8_t etag[16];
+	uint8_t otag[16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin(key, bkey, 16);
+	hex_to_bin(nonce, bnonce, noncelen);
+	hex_to_bin(aad, badd, aadlen);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, length);
+	hex_to_bin(tag, etag, taglen);
+	kp.key = bkey;
+
+	rsx_initialize(&state, &kp, true);
+	status = true;
+
+	/* test encryption */
+	if (rsx_ccm_encrypt(&state, out, otag, taglen, bnonce, noncelen, badd, aadlen, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, exp, length) == false || are_equal8(otag, etag, taglen) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption, in place */
+	if (rsx_ccm_decrypt(&state, out, etag, taglen, bnonce, noncelen, badd, aadlen, out, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* a modified tag is rejected */
+	etag[0] ^= 1;
+
+	if (rsx_ccm_decrypt(&state, out, etag, taglen, bnonce, noncelen, badd, aadlen, exp, length) != MQC_STATUS_AUTHFAIL)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool rsx512_ccm_roundtrip(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 64 };
+	uint8_t msg[4200];
+	uint8_t enc[4200];
+	uint8_t dec[4200];
+	uint8_t nonce[13] = { 0 };
+	uint8_t ctr[16] = { 0 };
+	uint8_t aad[20];
+	uint8_t tag[16];
+	size_t i;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 7);
+	}
+
+	for (i = 0; i < sizeof(aad); i++)
+	{
+		aad[i] = (uint8_t)i;
+	}
+
+	nonce[0] = 0x42;
+	rsx_initialize(&state, &kp, true);
+	status = true;
+
+	rsx_ccm_encrypt(&state, enc, tag, 16, nonce, 13, aad, sizeof(aad), msg, length);
+
+	/* the whole blocks of the cipher-text are the counter keystream from block one; flags 1 for a 13 byte nonce */
+	ctr[0] = 0x01;
+	ctr[1] = 0x42;
+	ctr[15] = 0x01;
+	rsx_ctr_transform_blocks(&state, dec, ctr, msg, length - (length % 16));
+
+	if (are_equal8(dec, enc, length - (length % 16)) == false)
+	{
+		status = false;
+	}
+
+	if (rsx_ccm_decrypt(&state, dec, tag, 16, nonce, 13, aad, sizeof(aad), enc, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(dec, msg, length) == false)
+	{
+		status = false;
+	}
+
+	/* modified cipher-text is rejected, and the output is erased */
+	enc[length - 1] ^= 1;
+
+	if (rsx_ccm_decrypt(&state, dec, tag, 16, nonce, 13, aad, sizeof(aad), enc, length) != MQC_STATUS_AUTHFAIL || dec[0] != 0)
+	{
+		status = false;
+	}
+
+	/* an odd tag length, and a nonce shorter than 7 bytes, are rejected */
+	if (rsx_ccm_encrypt(&state, enc, tag, 7, nonce, 13, aad, sizeof(aad), msg, length) != MQC_ERROR_INVALID ||
+		rsx_ccm_encrypt(&state, enc, tag, 16, nonce, 6, aad, sizeof(aad), msg, length) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool aes_cmac_vector(const char* message, size_t length, const char* expected)
+{
+	rsx_keyparams kp = { NULL, 16 };
+	rsx_cmac_ctx ctx;
+	uint8_t bkey[16];
+	uint8_t msg[64];
+	uint8_t exp[16];
+	uint8_t tag[16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", bkey, 16);
+	hex_to_bin(message, msg, length);
+	hex_to_bin(expected, exp, 16);
+	kp.key = bkey;
+
+	rsx_initialize(&state, &kp, true);
+	rsx_cmac_initialize(&ctx, &state);
+	status = true;
+
+	if (rsx_cmac_compute(&ctx, tag, 16, msg, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(tag, exp, 16) == false)
+	{
+		status = false;
+	}
+
+	/* an empty message can be passed as NULL */
+	if (length == 0 &&
+		(rsx_cmac_compute(&ctx, tag, 16, NULL, 0) != MQC_STATUS_SUCCESS ||
+		are_equal8(tag, exp, 16) == false ||
+		rsx_cmac_verify(&ctx, exp, 16, NULL, 0) != MQC_STATUS_SUCCESS))
+	{
+		status = false;
+	}
+
+	/* a truncated tag verifies, a modified tag does not */
+	if (rsx_cmac_verify(&ctx, exp, 8, msg, length) != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	exp[0] ^= 1;
+
+	if (rsx_cmac_verify(&ctx, exp, 16, msg, length) != MQC_STATUS_AUTHFAIL)
+	{
+		status = false;
+	}
+
+	rsx_cmac_dispose(&ctx);
+
+	return status;
+}
+
+static bool aes_pmac_vector(const uint8_t* message, size_t length, const char* expected)
+{
+	rsx_keyparams kp = { NULL, 16 };
+	rsx_pmac_ctx ctx;
+	uint8_t bkey[16];
+	uint8_t exp[16];
+	uint8_t tag[16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	bool status;
+
+	hex_to_bin("000102030405060708090A0B0C0D0E0F", bkey, 16);
+	hex_to_bin(expected, exp, 16);
+	kp.key = bkey;
+
+	rsx_initialize(&state, &kp, true);
+	rsx_pmac_initialize(&ctx, &state);
+	status = true;
+
+	if (rsx_pmac_compute(&ctx, tag, 16, message, length) != MQC_STATUS_SUCCESS ||
+		are_equal8(tag, exp, 16) == false)
+	{
+		status = false;
+	}
+
+	/* an empty message can be passed as NULL */
+	if (length == 0 &&
+		(rsx_pmac_compute(&ctx, tag, 16, NULL, 0) != MQC_STATUS_SUCCESS ||
+		are_equal8(tag, exp, 16) == false ||
+		rsx_pmac_verify(&ctx, exp, 16, NULL, 0) != MQC_STATUS_SUCCESS))
+	{
+		status = false;
+	}
+
+	if (rsx_pmac_verify(&ctx, exp, 16, message, length) != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	exp[15] ^= 1;
+
+	if (rsx_pmac_verify(&ctx, exp, 16, message, length) != MQC_STATUS_AUTHFAIL)
+	{
+		status = false;
+	}
+
+	rsx_pmac_dispose(&ctx);
+
+	return status;
+}
+
+static bool rsx512_mac_tamper(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 64 };
+	rsx_cmac_ctx cctx;
+	rsx_pmac_ctx pctx;
+	uint8_t msg[1100];
+	uint8_t ctag[16];
+	uint8_t ptag[16];
+	size_t i;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	bool status;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)(i * 5);
+	}
+
+	rsx_initialize(&state, &kp, true);
+	rsx_cmac_initialize(&cctx, &state);
+	rsx_pmac_initialize(&pctx, &state);
+	status = true;
+
+	rsx_cmac_compute(&cctx, ctag, 16, msg, length);
+	rsx_pmac_compute(&pctx, ptag, 16, msg, length);
+
+	if (rsx_cmac_verify(&cctx, ctag, 16, msg, length) != MQC_STATUS_SUCCESS ||
+		rsx_pmac_verify(&pctx, ptag, 16, msg, length) != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	/* a change to any block of the message is detected */
+	for (i = 0; i < length; i += 97)
+	{
+		msg[i] ^= 0x20;
+
+		if (rsx_cmac_verify(&cctx, ctag, 16, msg, length) != MQC_STATUS_AUTHFAIL ||
+			rsx_pmac_verify(&pctx, ptag, 16, msg, length) != MQC_STATUS_AUTHFAIL)
+		{
+			status = false;
+		}
+
+		msg[i] ^= 0x20;
+	}
+
+	/* tags shorter than 8 bytes are rejected */
+	if (rsx_cmac_compute(&cctx, ctag, 4, msg, length) != MQC_ERROR_INVALID ||
+		rsx_pmac_compute(&pctx, ptag, 4, msg, length) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	rsx_cmac_dispose(&cctx);
+	rsx_pmac_dispose(&pctx);
+
+	return status;
+}
+
+static bool aes128_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+{
+	uint8_t out[16];
+	rsx_keyparams kp = { key, 16 };
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	size_t i;
+	bool status;
+
+	status = true;
+
+	/* test encryption */
+	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_encrypt(&state, out, message[i]);
+
+		if (are_equal8(out, expected[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* test decryption */
+	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_decrypt(&state, out, expected[i]);
+
+		if (are_equal8(out, message[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+static bool aes256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+{
+	uint8_t out[16];
+	rsx_keyparams kp = { key, 32 };
+	rsx_roundkey rkeys[AES256_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES256_ROUNDKEY_DIMENSION };
+	size_t i;
+	bool status;
+
+	status = true;
+
+	/* test encryption */
+	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_encrypt(&state, out, message[i]);
+
+		if (are_equal8(out, expected[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* test decryption */
+	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_decrypt(&state, out, expected[i]);
+
+		if (are_equal8(out, message[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+static bool aes128_ecb_blocks_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+{
+	uint8_t out[4][16];
+	rsx_keyparams kp = { key, 16 };
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	bool status;
+
+	status = true;
+
+	/* test encryption */
+	rsx_initialize(&state, &kp, true);
+	rsx_ecb_encrypt_blocks(&state, out[0], message[0], 64);
+
+	if (are_equal8(out[0], expected[0], 64) == false)
+	{
+		status = false;
+	}
+
+	/* test decryption */
+	rsx_initialize(&state, &kp, false);
+	rsx_ecb_decrypt_blocks(&state, out[0], expected[0], 64);
+
+	if (are_equal8(out[0], message[0], 64) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool rsx512_ecb_blocks_equivalence(const uint8_t* key, size_t length)
+{
+	rsx_keyparams kp = { key, 64 };
+	uint8_t msg[1024];
+	uint8_t exp[1024];
+	uint8_t out[1024];
+	size_t i;
+	bool status;
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+
+	status = true;
+
+	for (i = 0; i < length; i++)
+	{
+		msg[i] = (uint8_t)i;
+	}
+
+	rsx_initialize(&state, &kp, true);
+
+	for (i = 0; i < length; i += 16)
+	{
+		rsx_ecb_encrypt(&state, exp + i, msg + i);
+	}
+
+	rsx_ecb_encrypt_blocks(&state, out, msg, length);
+
+	if (upper_state_clean() == false || are_equal8(out, exp, length) == false)
+	{
+		status = false;
+	}
+
+	rsx_initialize(&state, &kp, false);
+	rsx_ecb_decrypt_blocks(&state, out, exp, length);
+
+	if (upper_state_clean() == false || are_equal8(out, msg, length) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static void print_array8(const uint8_t* a, size_t count, size_t line)
+{
+	size_t i;
+
+	for (i = 0; i < count; ++i)
+	{
+		if (i != 0 && i % line == 0)
+		{
+			printf("\n");
+		}
+
+		printf("0x%02X, ", a[i]);
+	}
+}
+
+static void print_array32(const uint32_t* a, size_t count, size_t line)
+{
+	size_t i;
+
+	for (i = 0; i < count; ++i)
+	{
+		if (i != 0 && i % line == 0)
+		{
+			printf("\n");
+		}
+
+		printf("%d ", a[i]);
+	}
+}
+
+static bool rsx256_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+{
+	uint8_t out[16];
+	rsx_keyparams kp = { key, 32 };
+	rsx_roundkey rkeys[RSX256_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX256_ROUNDKEY_DIMENSION };
+	size_t i;
+	bool status;
+
+	status = true;
+
+	/* test encryption */
+	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_encrypt(&state, out, message[i]);
+
+		if (are_equal8(out, expected[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* test decryption */
+	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_decrypt(&state, out, expected[i]);
+
+		if (are_equal8(out, message[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+static bool rsx512_ecb_monte_carlo(const uint8_t* key, const uint8_t message[4][16], const uint8_t expected[4][16])
+{
+	uint8_t out[16];
+	rsx_keyparams kp = { key, 64 };
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+	size_t i;
+	bool status;
+
+	status = true;
+
+	/* test encryption */
+	if (rsx_initialize(&state, &kp, true) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_encrypt(&state, out, message[i]);
+
+		if (are_equal8(out, expected[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* test decryption */
+	if (rsx_initialize(&state, &kp, false) != MQC_STATUS_FAILURE)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		rsx_ecb_decrypt(&state, out, expected[i]);
+
+		if (are_equal8(out, message[i], 16) == false)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+bool aes128_cbc_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t iv[16];
+	uint8_t key[16];
+
+	/* SP800-38a F2.1 */
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
+	hex_to_bin("000102030405060708090A0B0C0D0E0F", iv, 16);
+
+	hex_to_bin("7649ABAC8119B246CEE98E9B12E9197D", exp[0], 16);
 	hex_to_bin("5086CB9B507219EE95DB113A917678B2", exp[1], 16);
 	hex_to_bin("73BED6B8E3C1743B7116E69E22229516", exp[2], 16);
 	hex_to_bin("3FF1CAA1681FAC09120ECA307586E1A7", exp[3], 16);
 
-	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
-	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
-	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
-	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	return aes128_cbc_monte_carlo(key, iv, msg, exp);
+}
+
+bool aes256_cbc_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t iv[16];
+	uint8_t key[32];
+
+	/* SP800-38a F2.5 */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
+	hex_to_bin("000102030405060708090A0B0C0D0E0F", iv, 16);
+
+	hex_to_bin("F58C4C04D6E5F1BA779EABFB5F7BFBD6", exp[0], 16);
+	hex_to_bin("9CFC4E967EDB808D679F777BC6702C7D", exp[1], 16);
+	hex_to_bin("39F23369A9D9BACFA530E26304231461", exp[2], 16);
+	hex_to_bin("B2EB05E2C39BE9FCDA6C19078C6A9D1B", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	return aes256_cbc_monte_carlo(key, iv, msg, exp);
+}
+
+bool aes256_cbc_blocks_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t iv[16];
+	uint8_t key[32];
+	bool status;
+
+	/* SP800-38a F2.6 */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
+	hex_to_bin("000102030405060708090A0B0C0D0E0F", iv, 16);
+
+	hex_to_bin("F58C4C04D6E5F1BA779EABFB5F7BFBD6", exp[0], 16);
+	hex_to_bin("9CFC4E967EDB808D679F777BC6702C7D", exp[1], 16);
+	hex_to_bin("39F23369A9D9BACFA530E26304231461", exp[2], 16);
+	hex_to_bin("B2EB05E2C39BE9FCDA6C19078C6A9D1B", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	status = aes256_cbc_blocks_monte_carlo(key, iv, msg, exp);
+
+	/* two full lane batches and a remainder, against the single block chain */
+
+	if (rsx256_cbc_blocks_equivalence(key, 16 * 21) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes256_cbc_jobs_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t iv[16];
+	uint8_t key[64];
+	size_t i;
+	bool status;
+
+	/* SP800-38a F2.5 */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
+	hex_to_bin("000102030405060708090A0B0C0D0E0F", iv, 16);
+
+	hex_to_bin("F58C4C04D6E5F1BA779EABFB5F7BFBD6", exp[0], 16);
+	hex_to_bin("9CFC4E967EDB808D679F777BC6702C7D", exp[1], 16);
+	hex_to_bin("39F23369A9D9BACFA530E26304231461", exp[2], 16);
+	hex_to_bin("B2EB05E2C39BE9FCDA6C19078C6A9D1B", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	status = aes256_cbc_jobs_vector(key, iv, msg, exp);
+
+	for (i = 0; i < sizeof(key); ++i)
+	{
+		key[i] = (uint8_t)(i * 3);
+	}
+
+	/* more streams than lanes, against the single block chain */
+
+	if (rsx512_cbc_jobs_equivalence(key, 20) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes128_ctr_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t key[16];
+	uint8_t nonce[16];
+
+	/* SP800-38a F5.1 */
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+
+	hex_to_bin("874D6191B620E3261BEF6864990DB6CE", exp[0], 16);
+	hex_to_bin("9806F66B7970FDFF8617187BB9FFFDFF", exp[1], 16);
+	hex_to_bin("5AE4DF3EDBD5D35E5B4F09020DB03EAB", exp[2], 16);
+	hex_to_bin("1E031DDA2FBE03D1792170A0F3009CEE", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	return aes128_ctr_monte_carlo(key, nonce, msg, exp);
+}
+
+bool aes256_ctr_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t key[32];
+	uint8_t nonce[16];
+
+	/* SP800-38a F5.5 */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+
+	hex_to_bin("601EC313775789A5B7A7F504BBF3D228", exp[0], 16);
+	hex_to_bin("F443E3CA4D62B59ACA84E990CACAF5C5", exp[1], 16);
+	hex_to_bin("2B0930DAA23DE94CE87017BA2D84988D", exp[2], 16);
+	hex_to_bin("DFC9C58DB67AADA613C2DD08457941A6", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	return aes256_ctr_monte_carlo(key, nonce, msg, exp);
+}
+
+bool aes128_ctr_blocks_kat_test()
+{
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t key[16];
+	uint8_t xkey[64];
+	uint8_t nonce[16];
+	bool status;
+
+	/* SP800-38a F5.1 */
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+
+	hex_to_bin("874D6191B620E3261BEF6864990DB6CE", exp[0], 16);
+	hex_to_bin("9806F66B7970FDFF8617187BB9FFFDFF", exp[1], 16);
+	hex_to_bin("5AE4DF3EDBD5D35E5B4F09020DB03EAB", exp[2], 16);
+	hex_to_bin("1E031DDA2FBE03D1792170A0F3009CEE", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	status = aes128_ctr_blocks_monte_carlo(key, nonce, msg, exp);
+
+	/* multi-lane, single block, and partial block paths against the single block transform */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_ctr_blocks_equivalence(xkey, 16 * 37 + 9) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_ctr_blocks_equivalence(xkey, 7) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes128_ctr_stream_kat_test()
+{
+	const size_t sizes1[6] = { 1, 7, 8, 33, 16, 64 };
+	const size_t sizes2[7] = { 15, 1, 0, 129, 3, 13, 300 };
+	rsx_ctr_ctx ctx;
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t out[4][16];
+	uint8_t key[16];
+	uint8_t xkey[64];
+	uint8_t nonce[16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	rsx_keyparams kp = { key, 16 };
+	bool status;
+
+	/* SP800-38a F5.1, fed in 5, 22, 0 and 37 byte updates */
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+
+	hex_to_bin("874D6191B620E3261BEF6864990DB6CE", exp[0], 16);
+	hex_to_bin("9806F66B7970FDFF8617187BB9FFFDFF", exp[1], 16);
+	hex_to_bin("5AE4DF3EDBD5D35E5B4F09020DB03EAB", exp[2], 16);
+	hex_to_bin("1E031DDA2FBE03D1792170A0F3009CEE", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	rsx_initialize(&state, &kp, true);
+	rsx_ctr_initialize(&ctx, &state, nonce);
+	rsx_ctr_update(&ctx, out[0], msg[0], 5);
+	rsx_ctr_update(&ctx, out[0] + 5, msg[0] + 5, 22);
+	rsx_ctr_update(&ctx, out[0] + 27, msg[0] + 27, 0);
+	rsx_ctr_update(&ctx, out[0] + 27, msg[0] + 27, 37);
+	rsx_ctr_dispose(&ctx);
+
+	status = are_equal8(out[0], exp[0], 64);
+
+	/* multi-block updates that start and end inside a keystream block */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_ctr_stream_equivalence(xkey, sizes1, 6) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_ctr_stream_equivalence(xkey, sizes2, 7) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes128_ctr_packets_kat_test()
+{
+	rsx_ctr_packet packets[4];
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t out[4][16];
+	uint8_t key[16];
+	uint8_t xkey[64];
+	uint8_t nonce[4][16];
+	rsx_roundkey rkeys[AES128_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, AES128_ROUNDKEY_DIMENSION };
+	rsx_keyparams kp = { key, 16 };
+	bool status;
+
+	/* SP800-38a F5.1, as packets of 32, 9, 0 and 16 bytes, each with the counter of its first block; the last in place */
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce[0], 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFF01", nonce[1], 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFF02", nonce[2], 16);
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFF02", nonce[3], 16);
+
+	hex_to_bin("874D6191B620E3261BEF6864990DB6CE", exp[0], 16);
+	hex_to_bin("9806F66B7970FDFF8617187BB9FFFDFF", exp[1], 16);
+	hex_to_bin("5AE4DF3EDBD5D35E5B4F09020DB03EAB", exp[2], 16);
+	hex_to_bin("1E031DDA2FBE03D1792170A0F3009CEE", exp[3], 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	memset(out, 0, sizeof(out));
+	memcpy(out[3], msg[3], 16);
+
+	packets[0].output = out[0];
+	packets[0].nonce = nonce[0];
+	packets[0].input = msg[0];
+	packets[0].length = 32;
+	packets[1].output = out[2];
+	packets[1].nonce = nonce[1];
+	packets[1].input = msg[2];
+	packets[1].length = 9;
+	packets[2].output = out[2] + 9;
+	packets[2].nonce = nonce[2];
+	packets[2].input = msg[2] + 9;
+	packets[2].length = 0;
+	packets[3].output = out[3];
+	packets[3].nonce = nonce[3];
+	packets[3].input = out[3];
+	packets[3].length = 16;
+
+	rsx_initialize(&state, &kp, true);
+	rsx_ctr_transform_packets(&state, packets, 4);
+
+	status = (are_equal8(out[0], exp[0], 32) == true && are_equal8(out[2], exp[2], 9) == true && are_equal8(out[3], exp[3], 16) == true);
+
+	/* the untouched bytes after the short packet */
+	if (out[2][9] != 0 || out[2][15] != 0)
+	{
+		status = false;
+	}
+
+	/* more packets than lanes, against the multi-block transform of each packet */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_ctr_packets_equivalence(xkey, 24) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes_ctr_keyed_kat_test()
+{
+	rsx_keyed_packet packets[5];
+	uint8_t exp[4][16];
+	uint8_t msg[4][16];
+	uint8_t out[5][64];
+	uint8_t key[32];
+	uint8_t nonce[16];
+	const uint8_t dcode[6] = { 'R', 'S', 'X', '-', 'K', 'A' };
+	size_t i;
+	bool status;
+
+	/* SP800-38a F5.1 and F5.5; five objects with the same key, four through the grouped expansion and one through the single */
+
+	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+
+	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
+	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
+	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
+	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+
+	for (i = 0; i < 5; ++i)
+	{
+		packets[i].output = out[i];
+		packets[i].key = key;
+		packets[i].nonce = nonce;
+		packets[i].input = msg[0];
+		packets[i].length = 64 - (i * 9);
+	}
+
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
+
+	hex_to_bin("874D6191B620E3261BEF6864990DB6CE", exp[0], 16);
+	hex_to_bin("9806F66B7970FDFF8617187BB9FFFDFF", exp[1], 16);
+	hex_to_bin("5AE4DF3EDBD5D35E5B4F09020DB03EAB", exp[2], 16);
+	hex_to_bin("1E031DDA2FBE03D1792170A0F3009CEE", exp[3], 16);
+
+	status = (rsx_ctr_transform_keyed(packets, 5, AES128_ROUNDKEY_DIMENSION, NULL, 0) == MQC_STATUS_SUCCESS);
+
+	for (i = 0; i < 5; ++i)
+	{
+		if (are_equal8(out[i], exp[0], packets[i].length) == false)
+		{
+			status = false;
+		}
+	}
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
+
+	hex_to_bin("601EC313775789A5B7A7F504BBF3D228", exp[0], 16);
+	hex_to_bin("F443E3CA4D62B59ACA84E990CACAF5C5", exp[1], 16);
+	hex_to_bin("2B0930DAA23DE94CE87017BA2D84988D", exp[2], 16);
+	hex_to_bin("DFC9C58DB67AADA613C2DD08457941A6", exp[3], 16);
+
+	if (rsx_ctr_transform_keyed(packets, 5, AES256_ROUNDKEY_DIMENSION, NULL, 0) != MQC_STATUS_SUCCESS)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 5; ++i)
+	{
+		if (are_equal8(out[i], exp[0], packets[i].length) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* distinct keys for every cipher, against rsx_initialize and the multi-block transform of each object */
+
+	if (rsx_ctr_keyed_equivalence(AES128_ROUNDKEY_DIMENSION, AES128_KEY_SIZE, NULL, 0, 11) == false)
+	{
+		status = false;
+	}
+
+	if (rsx_ctr_keyed_equivalence(AES256_ROUNDKEY_DIMENSION, AES256_KEY_SIZE, NULL, 0, 9) == false)
+	{
+		status = false;
+	}
+
+	if (rsx_ctr_keyed_equivalence(RSX256_ROUNDKEY_DIMENSION, RSX256_KEY_SIZE, dcode, sizeof(dcode), 11) == false)
+	{
+		status = false;
+	}
+
+	if (rsx_ctr_keyed_equivalence(RSX512_ROUNDKEY_DIMENSION, RSX512_KEY_SIZE, NULL, 0, 10) == false)
+	{
+		status = false;
+	}
+
+	if (rsx_ctr_transform_keyed(packets, 1, AES128_ROUNDKEY_DIMENSION + 1, NULL, 0) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool rsx512_ctr_parallel_kat_test()
+{
+	const size_t threads[3] = { 1, 3, 4 };
+	threadpool_state* pool;
+	uint8_t xkey[64];
+	size_t i;
+	bool status;
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+	status = true;
+
+	/* the serial fallback, without a pool */
+	if (rsx512_ctr_parallel_equivalence(NULL, xkey, "000102030405060708090A0B0C0D0E0F", 16 * 37 + 9, 16) == false)
+	{
+		status = false;
+	}
+
+	for (i = 0; i < 3; ++i)
+	{
+		pool = threadpool_create(threads[i]);
+
+		if (pool == NULL)
+		{
+			status = false;
+			break;
+		}
+
+		/* segment offsets that carry across the 64 bit half, and wrap the 128 bit counter */
+		if (rsx512_ctr_parallel_equivalence(pool, xkey, "0000000000000000FFFFFFFFFFFFFFF5", 4096, 16) == false)
+		{
+			status = false;
+		}
+
+		if (rsx512_ctr_parallel_equivalence(pool, xkey, "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFF80", 16 * 201 + 11, 256) == false)
+		{
+			status = false;
+		}
+
+		/* uneven segment sizes, and an input too short to split */
+		if (rsx512_ctr_parallel_equivalence(pool, xkey, "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", 1000, 100) == false)
+		{
+			status = false;
+		}
+
+		if (rsx512_ctr_parallel_equivalence(pool, xkey, "F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", 7, 0) == false)
+		{
+			status = false;
+		}
+
+		threadpool_destroy(pool);
+	}
+
+	return status;
+}
+
+bool rsx_dualkey_kat_test()
+{
+	const size_t dims[4] = { AES128_ROUNDKEY_DIMENSION, AES256_ROUNDKEY_DIMENSION, RSX256_ROUNDKEY_DIMENSION, RSX512_ROUNDKEY_DIMENSION };
+	const size_t keylens[4] = { 16, 32, 32, 64 };
+	rsx_dualkey_ctx ctx;
+	uint8_t key[64];
+	size_t i;
+	bool status;
+	rsx_keyparams kp = { key, 16 };
+	rsx_roundkey enckeys[AES256_ROUNDKEY_DIMENSION];
+	rsx_roundkey deckeys[AES256_ROUNDKEY_DIMENSION];
+	rsx_state encstate = { enckeys, AES256_ROUNDKEY_DIMENSION };
+	rsx_state decstate = { deckeys, AES128_ROUNDKEY_DIMENSION };
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 64);
+	status = true;
+
+	for (i = 0; i < 4; ++i)
+	{
+		if (dualkey_equivalence(key, keylens[i], dims[i], false) == false ||
+			dualkey_equivalence(key, keylens[i], dims[i], true) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* the two states must be sized for the same cipher */
+	if (rsx_dualkey_initialize(&ctx, &encstate, &decstate, &kp, false) != MQC_ERROR_INVALID)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool rsx_keycache_kat_test()
+{
+	const size_t dims[4] = { AES128_ROUNDKEY_DIMENSION, AES256_ROUNDKEY_DIMENSION, RSX256_ROUNDKEY_DIMENSION, RSX512_ROUNDKEY_DIMENSION };
+	const size_t keylens[4] = { 16, 32, 32, 64 };
+	keycache_task_ctx ctx;
+	keycache_stats stats;
+	keycache_state* cache;
+	threadpool_state* pool;
+	uint8_t id[KEYCACHE_ID_SIZE];
+	uint8_t key[64];
+	size_t i;
+	bool status;
+	rsx_keyparams kp = { key, 64 };
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 64);
+	status = false;
+	cache = keycache_create(4 * KEYCACHE_SHARDS);
+
+	if (cache != NULL)
+	{
+		status = true;
+
+		/* a miss and then a hit for each cipher, with the id derived from the key material */
+		for (i = 0; i < 4; ++i)
+		{
+			if (keycache_equivalence(cache, key, keylens[i], dims[i], NULL) == false ||
+				keycache_equivalence(cache, key, keylens[i], dims[i], NULL) == false)
+			{
+				status = false;
+			}
+		}
+
+		/* a different key for the same cipher is a new entry */
+		key[0] ^= 0x01;
+
+		if (keycache_equivalence(cache, key, 64, RSX512_ROUNDKEY_DIMENSION, NULL) == false)
+		{
+			status = false;
+		}
+
+		key[0] ^= 0x01;
+		keycache_statistics(cache, &stats);
+
+		if (stats.hits != 4 || stats.misses != 5 || stats.evictions != 0 || stats.entries != 5)
+		{
+			status = false;
+		}
+
+		/* a removed key is expanded again on the next lookup */
+		if (keycache_remove(cache, &kp, NULL, RSX512_ROUNDKEY_DIMENSION) == false ||
+			keycache_remove(cache, &kp, NULL, RSX512_ROUNDKEY_DIMENSION) == true ||
+			keycache_equivalence(cache, key, 64, RSX512_ROUNDKEY_DIMENSION, NULL) == false)
+		{
+			status = false;
+		}
+
+		keycache_statistics(cache, &stats);
+
+		if (stats.misses != 6 || stats.entries != 5)
+		{
+			status = false;
+		}
+
+		/* no state, and an unknown cipher dimension */
+		if (keycache_get(cache, NULL, NULL, &kp, NULL) != MQC_ERROR_INVALID)
+		{
+			status = false;
+		}
+
+		state.rkeylen = 12;
+
+		if (keycache_get(cache, &state, NULL, &kp, NULL) != MQC_ERROR_INVALID)
+		{
+			status = false;
+		}
+
+		keycache_destroy(cache);
+	}
+
+	/* caller supplied ids in a cache of two entries per shard; the least recently used entries are evicted */
+	cache = keycache_create(2 * KEYCACHE_SHARDS);
+
+	if (cache == NULL)
+	{
+		status = false;
+	}
+	else
+	{
+		memset(id, 0, sizeof(id));
+
+		for (i = 0; i < 64; ++i)
+		{
+			id[0] = (uint8_t)i;
+			key[0] = (uint8_t)i;
+
+			if (keycache_equivalence(cache, key, 16, AES128_ROUNDKEY_DIMENSION, id) == false)
+			{
+				status = false;
+			}
+		}
+
+		/* the most recently added id is always still cached */
+		if (keycache_equivalence(cache, key, 16, AES128_ROUNDKEY_DIMENSION, id) == false)
+		{
+			status = false;
+		}
+
+		keycache_statistics(cache, &stats);
+
+		if (stats.hits != 1 || stats.misses != 64 || stats.entries > 2 * KEYCACHE_SHARDS || stats.evictions != 64 - stats.entries)
+		{
+			status = false;
+		}
+
+		keycache_destroy(cache);
+	}
+
+	/* concurrent lookups of eight ids */
+	cache = keycache_create(0);
+	pool = threadpool_create(4);
+
+	if (cache == NULL || pool == NULL)
+	{
+		status = false;
+	}
+	else
+	{
+		ctx.cache = cache;
+		threadpool_dispatch(pool, keycache_task, &ctx, 64);
+
+		for (i = 0; i < 64; ++i)
+		{
+			if (ctx.results[i] == false)
+			{
+				status = false;
+			}
+		}
+
+		keycache_statistics(cache, &stats);
+
+		if (stats.hits + stats.misses != 64 || stats.misses < 8 || stats.entries != 8)
+		{
+			status = false;
+		}
+	}
+
+	keycache_destroy(cache);
+	threadpool_destroy(pool);
+
+	return status;
+}
+
+bool aes_gcm_kat_test()
+{
+	uint8_t xkey[64];
+	bool status;
+
+	status = true;
+
+	/* McGrew and Viega, The Galois/Counter Mode of Operation, test cases 2, 4, 5 and 16 */
+
+	if (aes_gcm_vector("00000000000000000000000000000000", 16, "000000000000000000000000", 12, "", 0,
+		"00000000000000000000000000000000",
+		"0388DACE60B6A392F328C2B971B2FE78", 16,
+		"AB6E47D42CEC13BDF53A67B21257BDDF") == false)
+	{
+		status = false;
+	}
+
+	if (aes_gcm_vector("FEFFE9928665731C6D6A8F9467308308", 16, "CAFEBABEFACEDBADDECAF888", 12, "FEEDFACEDEADBEEFFEEDFACEDEADBEEFABADDAD2", 20,
+		"D9313225F88406E5A55909C5AFF5269A86A7A9531534F7DA2E4C303D8A318A721C3C0C95956809532FCF0E2449A6B525B16AEDF5AA0DE657BA637B39",
+		"42831EC2217774244B7221B784D0D49CE3AA212F2C02A4E035C17E2329ACA12E21D514B25466931C7D8F6A5AAC84AA051BA30B396A0AAC973D58E091", 60,
+		"5BC94FBC3221A5DB94FAE95AE7121A47") == false)
+	{
+		status = false;
+	}
+
+	if (aes_gcm_vector("FEFFE9928665731C6D6A8F9467308308", 16, "CAFEBABEFACEDBAD", 8, "FEEDFACEDEADBEEFFEEDFACEDEADBEEFABADDAD2", 20,
+		"D9313225F88406E5A55909C5AFF5269A86A7A9531534F7DA2E4C303D8A318A721C3C0C95956809532FCF0E2449A6B525B16AEDF5AA0DE657BA637B39",
+		"61353B4C2806934A777FF51FA22A4755699B2A714FCDC6F83766E5F97B6C742373806900E49F24B22B097544D4896B424989B5E1EBAC0F07C23F4598", 60,
+		"3612D2E79E3B0785561BE14AACA2FCCB") == false)
+	{
+		status = false;
+	}
+
+	if (aes_gcm_vector("FEFFE9928665731C6D6A8F9467308308FEFFE9928665731C6D6A8F9467308308", 32, "CAFEBABEFACEDBADDECAF888", 12, "FEEDFACEDEADBEEFFEEDFACEDEADBEEFABADDAD2", 20,
+		"D9313225F88406E5A55909C5AFF5269A86A7A9531534F7DA2E4C303D8A318A721C3C0C95956809532FCF0E2449A6B525B16AEDF5AA0DE657BA637B39",
+		"522DC1F099567D07F47F37A32A84427D643A8CDCBFE5C0C97598A2BD2555D1AA8CB08E48590DBB3DA7B08B1056828838C5F61E6393BA7A0ABCC9F662", 60,
+		"76FC6ECE0F4E1768CDDF8853BB2D551B") == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over several strides */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_gcm_roundtrip(xkey, 16 * 71 + 5) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_gcm_roundtrip(xkey, 4096) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool rsx512_ctrkmac_kat_test()
+{
+	uint8_t xkey[64];
+	bool status;
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+	status = true;
+
+	/* an empty message, a tail that spills the lengths into another block, and several strides */
+
+	if (rsx512_ctrkmac_equivalence(xkey, 0, 0) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_ctrkmac_equivalence(xkey, 133, 120) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_ctrkmac_equivalence(xkey, 2 * 1088 + 300, 257) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes_gcmsiv_kat_test()
+{
+	uint8_t xkey[64];
+	bool status;
+
+	status = true;
+
+	/* RFC 8452 Appendix C.1 and C.2, AES-128-GCM-SIV and AES-256-GCM-SIV */
+
+	if (aes_gcmsiv_vector("01000000000000000000000000000000", 16, "030000000000000000000000", "", 0, "", "", 0,
+		"DC20E2D83F25705BB49E439ECA56DE25") == false)
+	{
+		status = false;
+	}
+
+	if (aes_gcmsiv_vector("01000000000000000000000000000000", 16, "030000000000000000000000", "", 0,
+		"0100000000000000",
+		"B5D839330AC7B786", 8,
+		"578782FFF6013B815B287C22493A364C") == false)
+	{
+		status = false;
+	}
+
+	if (aes_gcmsiv_vector("01000000000000000000000000000000", 16, "030000000000000000000000", "01", 1,
+		"0200000000000000000000000000000003000000000000000000000000000000",
+		"620048EF3C1E73E57E02BB8562C416A319E73E4CAAC8E96A1ECB2933145A1D71", 32,
+		"E6AF6A7F87287DA059A71684ED3498E1") == false)
+	{
+		status = false;
+	}
+
+	if (aes_gcmsiv_vector("0100000000000000000000000000000000000000000000000000000000000000", 32, "030000000000000000000000", "", 0,
+		"0100000000000000",
+		"C2EF328E5C71C83B", 8,
+		"843122130F7364B761E0B97427E3DF28") == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 batches against single messages */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_gcmsiv_batch_equivalence(xkey, 3) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_gcmsiv_batch_equivalence(xkey, 20) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes_ocb_kat_test()
+{
+	uint8_t xkey[64];
+	bool status;
+
+	status = true;
+
+	/* RFC 7253 Appendix A, AES-128 with a 128 bit tag */
+
+	if (aes_ocb_vector("BBAA99887766554433221100", "", 0, "", "", 0,
+		"785407BFFFC8AD9EDCC5520AC9111EE6") == false)
+	{
+		status = false;
+	}
+
+	if (aes_ocb_vector("BBAA99887766554433221101", "0001020304050607", 8,
+		"0001020304050607",
+		"6820B3657B6F615A", 8,
+		"5725BDA0D3B4EB3A257C9AF1F8F03009") == false)
+	{
+		status = false;
+	}
+
+	if (aes_ocb_vector("BBAA99887766554433221104", "000102030405060708090A0B0C0D0E0F", 16,
+		"000102030405060708090A0B0C0D0E0F",
+		"571D535B60B277188BE5147170A9A22C", 16,
+		"3AD7A4FF3835B8C5701C1CCEC8FC3358") == false)
+	{
+		status = false;
+	}
+
+	if (aes_ocb_vector("BBAA9988776655443322110D", "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F2021222324252627", 40,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F2021222324252627",
+		"D5CA91748410C1751FF8A2F618255B68A0A12E093FF454606E59F9C1D0DDC54B65E8628E568BAD7A", 40,
+		"ED07BA06A4A69483A7035490C5769E60") == false)
+	{
+		status = false;
+	}
 
-	return aes128_cbc_monte_carlo(key, iv, msg, exp);
+	if (aes_ocb_vector("BBAA9988776655443322110F", "", 0,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F2021222324252627",
+		"4412923493C57D5DE0D700F753CCE0D1D2D95060122E9F15A5DDBFC5787E50B5CC55EE507BCB084E", 40,
+		"479AD363AC366B95A98CA5F3000B1479") == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over the 8 and 16 block kernels, with a partial last block */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_ocb_roundtrip(xkey, 16 * 23 + 9) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_ocb_roundtrip(xkey, 4096) == false)
+	{
+		status = false;
+	}
+
+	return status;
 }
 
-bool aes256_cbc_kat_test()
+bool aes_xts_kat_test()
 {
-	uint8_t exp[4][16];
-	uint8_t msg[4][16];
-	uint8_t iv[16];
-	uint8_t key[32];
+	uint8_t xkey[64];
+	uint8_t tkey[32];
+	bool status;
 
-	/* SP800-38a F2.5 */
+	status = true;
 
-	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
-	hex_to_bin("000102030405060708090A0B0C0D0E0F", iv, 16);
+	/* IEEE 1619-2007, XTS-AES-128 vectors 2 and 3, and vectors 15 and 17 with cipher-text stealing */
 
-	hex_to_bin("F58C4C04D6E5F1BA779EABFB5F7BFBD6", exp[0], 16);
-	hex_to_bin("9CFC4E967EDB808D679F777BC6702C7D", exp[1], 16);
-	hex_to_bin("39F23369A9D9BACFA530E26304231461", exp[2], 16);
-	hex_to_bin("B2EB05E2C39BE9FCDA6C19078C6A9D1B", exp[3], 16);
+	if (aes_xts_vector("11111111111111111111111111111111", "22222222222222222222222222222222", "33333333330000000000000000000000",
+		"4444444444444444444444444444444444444444444444444444444444444444",
+		"C454185E6A16936E39334038ACEF838BFB186FFF7480ADC4289382ECD6D394F0", 32) == false)
+	{
+		status = false;
+	}
 
-	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
-	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
-	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
-	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+	if (aes_xts_vector("FFFEFDFCFBFAF9F8F7F6F5F4F3F2F1F0", "22222222222222222222222222222222", "33333333330000000000000000000000",
+		"4444444444444444444444444444444444444444444444444444444444444444",
+		"AF85336B597AFC1A900B2EB21EC949D292DF4C047E0B21532186A5971A227A89", 32) == false)
+	{
+		status = false;
+	}
 
-	return aes256_cbc_monte_carlo(key, iv, msg, exp);
+	if (aes_xts_vector("FFFEFDFCFBFAF9F8F7F6F5F4F3F2F1F0", "BFBEBDBCBBBAB9B8B7B6B5B4B3B2B1B0", "9A785634120000000000000000000000",
+		"000102030405060708090A0B0C0D0E0F10",
+		"6C1625DB4671522D3D7599601DE7CA09ED", 17) == false)
+	{
+		status = false;
+	}
+
+	if (aes_xts_vector("FFFEFDFCFBFAF9F8F7F6F5F4F3F2F1F0", "BFBEBDBCBBBAB9B8B7B6B5B4B3B2B1B0", "9A785634120000000000000000000000",
+		"000102030405060708090A0B0C0D0E0F101112",
+		"E5DF1351C0544BA1350B3363CD8EF4BEEDBF9D", 19) == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over a 4 KiB sector, and a sector with a partial last block */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C2B7E151628AED2A6ABF7158809CF4F3C", tkey, 32);
+
+	if (rsx512_xts_roundtrip(xkey, tkey, 4096) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_xts_roundtrip(xkey, tkey, 4099) == false)
+	{
+		status = false;
+	}
+
+	return status;
 }
 
-bool aes128_ctr_kat_test()
+bool aes_hctr2_kat_test()
 {
-	uint8_t exp[4][16];
-	uint8_t msg[4][16];
-	uint8_t key[16];
-	uint8_t nonce[16];
+	uint8_t xkey[64];
+	bool status;
 
-	/* SP800-38a F5.1 */
+	status = true;
 
-	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
-	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+	/* AES128 and AES256, with and without a tweak, and sectors with a partial last block */
 
-	hex_to_bin("874D6191B620E3261BEF6864990DB6CE", exp[0], 16);
-	hex_to_bin("9806F66B7970FDFF8617187BB9FFFDFF", exp[1], 16);
-	hex_to_bin("5AE4DF3EDBD5D35E5B4F09020DB03EAB", exp[2], 16);
-	hex_to_bin("1E031DDA2FBE03D1792170A0F3009CEE", exp[3], 16);
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F", 16, "", 0,
+		"000102030405060708090A0B0C0D0E0F",
+		"71E3FA3F04B168B129B0F2EE156BDB93", 16) == false)
+	{
+		status = false;
+	}
 
-	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
-	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
-	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
-	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F", 16, "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF", 32,
+		"000102030405060708090A0B0C0D0E0F10",
+		"43745DAF9D1E55F13B7801D82EAE988CF6", 17) == false)
+	{
+		status = false;
+	}
 
-	return aes128_ctr_monte_carlo(key, nonce, msg, exp);
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F", 16, "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF", 32,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E2F",
+		"0E24207C84CCDC3E83EB37204F26CF5E44765546EACC6821A8D6CD5641F7ECED4FC852CAF819A49E6E3C36539E7842A7", 48) == false)
+	{
+		status = false;
+	}
+
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F", 16, "A0A1A2A3A4A5A6A7A8A9AAABAC", 13,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C",
+		"73C6E86575181A1C7B1E82AF53B7FD934D8FA93B1669AD03E8C4D1E59BA0ADD05C2B88D7F819B12DC54541BA507669B66FF2B40EDC2D6C236671FD8952", 61) == false)
+	{
+		status = false;
+	}
+
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F", 32, "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF", 32,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F",
+		"5E975366F2A7A78224BA59AFBD63E41F53A7507DE9DC9B08F04CAA08118D7211", 32) == false)
+	{
+		status = false;
+	}
+
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F", 32, "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF", 32,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F",
+		"C07E641AC32367CE66AD1618FBDBA9D29D3D23416BAC3B57E8DF85F846C038C2127283EB80FCC59DF18CCA860D22B40F82BDEBD30F3C3FF1BC4AFB699D09D087", 64) == false)
+	{
+		status = false;
+	}
+
+	if (aes_hctr2_vector("000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F", 32, "", 0,
+		"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F202122232425262728292A2B2C2D2E",
+		"5FABEE1965DD926B5352F41BA540F6D67AAA9AD3E193558319249F2AE67AB05BBA0F498232FF00BB07D56D9E81E6B2", 47) == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over a 4 KiB sector, and a sector with a partial last block */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_hctr2_roundtrip(xkey, 4096) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_hctr2_roundtrip(xkey, 4099) == false)
+	{
+		status = false;
+	}
+
+	return status;
 }
 
-bool aes256_ctr_kat_test()
+bool aes_ccm_kat_test()
+{
+	uint8_t xkey[64];
+	bool status;
+
+	status = true;
+
+	/* SP800-38C Appendix C, examples 1 to 3 */
+
+	if (aes_ccm_vector("404142434445464748494A4B4C4D4E4F", "10111213141516", 7, "0001020304050607", 8,
+		"20212223",
+		"7162015B", 4,
+		"4DAC255D", 4) == false)
+	{
+		status = false;
+	}
+
+	if (aes_ccm_vector("404142434445464748494A4B4C4D4E4F", "1011121314151617", 8, "000102030405060708090A0B0C0D0E0F", 16,
+		"202122232425262728292A2B2C2D2E2F",
+		"D2A1F0E051EA5F62081A7792073D593D", 16,
+		"1FC64FBFACCD", 6) == false)
+	{
+		status = false;
+	}
+
+	if (aes_ccm_vector("404142434445464748494A4B4C4D4E4F", "101112131415161718191A1B", 12, "000102030405060708090A0B0C0D0E0F10111213", 20,
+		"202122232425262728292A2B2C2D2E2F3031323334353637",
+		"E3B201A9F5B71A7A9B1CEAECCD97E70B6176AAD9A4428AA5", 24,
+		"484392FBC1B09951", 8) == false)
+	{
+		status = false;
+	}
+
+	/* RFC 3610 packet vectors 1 and 2 */
+
+	if (aes_ccm_vector("C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF", "00000003020100A0A1A2A3A4A5", 13, "0001020304050607", 8,
+		"08090A0B0C0D0E0F101112131415161718191A1B1C1D1E",
+		"588C979A61C663D2F066D0C2C0F989806D5F6B61DAC384", 23,
+		"17E8D12CFDF926E0", 8) == false)
+	{
+		status = false;
+	}
+
+	if (aes_ccm_vector("C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF", "00000004030201A0A1A2A3A4A5", 13, "0001020304050607", 8,
+		"08090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F",
+		"72C91A36E135F8CF291CA894085C87E3CC15C439C9E43A3B", 24,
+		"A091D56E10400916", 8) == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over a message with a partial last block */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_ccm_roundtrip(xkey, 4096 + 5) == false)
+	{
+		status = false;
+	}
+
+	if (rsx512_ccm_roundtrip(xkey, 48) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes_cmac_kat_test()
+{
+	uint8_t xkey[64];
+	bool status;
+
+	status = true;
+
+	/* RFC 4493 section 4, AES-128 examples 1 to 4 */
+
+	if (aes_cmac_vector("", 0, "BB1D6929E95937287FA37D129B756746") == false)
+	{
+		status = false;
+	}
+
+	if (aes_cmac_vector("6BC1BEE22E409F96E93D7E117393172A", 16, "070A16B46B4D4144F79BDD9DD04A287C") == false)
+	{
+		status = false;
+	}
+
+	if (aes_cmac_vector("6BC1BEE22E409F96E93D7E117393172AAE2D8A571E03AC9C9EB76FAC45AF8E5130C81C46A35CE411", 40,
+		"DFA66747DE9AE63030CA32611497C827") == false)
+	{
+		status = false;
+	}
+
+	if (aes_cmac_vector("6BC1BEE22E409F96E93D7E117393172AAE2D8A571E03AC9C9EB76FAC45AF8E5130C81C46A35CE411E5FBC1191A0A52EFF69F2445DF4F9B17AD2B417BE66C3710", 64,
+		"51F0BEBF7E3B9D92FC49741779363CFE") == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over a message with a partial last block */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_mac_tamper(xkey, 1029) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes_pmac_kat_test()
+{
+	uint8_t msg[1000];
+	uint8_t xkey[64];
+	size_t i;
+	bool status;
+
+	status = true;
+
+	/* PMAC-AES-128 reference vectors; the key is 00..0F and the messages count up from 00, the last message is 1000 zero bytes */
+
+	for (i = 0; i < 34; ++i)
+	{
+		msg[i] = (uint8_t)i;
+	}
+
+	if (aes_pmac_vector(msg, 0, "4399572CD6EA5341B8D35876A7098AF7") == false ||
+		aes_pmac_vector(msg, 3, "256BA5193C1B991B4DF0C51F388A9E27") == false ||
+		aes_pmac_vector(msg, 16, "EBBD822FA458DAF6DFDAD7C27DA76338") == false ||
+		aes_pmac_vector(msg, 20, "0412CA150BBF79058D8C75A58C993F55") == false ||
+		aes_pmac_vector(msg, 32, "E97AC04E9E5E3399CE5355CD7407BC75") == false ||
+		aes_pmac_vector(msg, 34, "5CBA7D5EB24F7C86CCC54604E53D5512") == false)
+	{
+		status = false;
+	}
+
+	memset(msg, 0, sizeof(msg));
+
+	if (aes_pmac_vector(msg, sizeof(msg), "C2C9FA1D9985F6F0D2AFF915A0E8D910") == false)
+	{
+		status = false;
+	}
+
+	/* RSX512 over a complete last block, through the eight block kernel */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_mac_tamper(xkey, 1024) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+bool aes128_ecb_kat_test()
 {
 	uint8_t exp[4][16];
 	uint8_t msg[4][16];
-	uint8_t key[32];
-	uint8_t nonce[16];
+	uint8_t key[16];
 
-	/* SP800-38a F5.5 */
+	/* SP800-38a F1.1 */
 
-	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", key, 32);
-	hex_to_bin("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF", nonce, 16);
+	hex_to_bin("2B7E151628AED2A6ABF7158809CF4F3C", key, 16);
 
-	hex_to_bin("601EC313775789A5B7A7F504BBF3D228", exp[0], 16);
-	hex_to_bin("F443E3CA4D62B59ACA84E990CACAF5C5", exp[1], 16);
-	hex_to_bin("2B0930DAA23DE94CE87017BA2D84988D", exp[2], 16);
-	hex_to_bin("DFC9C58DB67AADA613C2DD08457941A6", exp[3], 16);
+	hex_to_bin("3AD77BB40D7A3660A89ECAF32466EF97", exp[0], 16);
+	hex_to_bin("F5D3D58503B9699DE785895A96FDBAAF", exp[1], 16);
+	hex_to_bin("43B1CD7F598ECE23881B00E3ED030688", exp[2], 16);
+	hex_to_bin("7B0C785E27E8AD3F8223207104725DD4", exp[3], 16);
 
 	hex_to_bin("6BC1BEE22E409F96E93D7E117393172A", msg[0], 16);
 	hex_to_bin("AE2D8A571E03AC9C9EB76FAC45AF8E51", msg[1], 16);
 	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
 	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
 
-	return aes256_ctr_monte_carlo(key, nonce, msg, exp);
+	return aes128_ecb_monte_carlo(key, msg, exp);
 }
 
-bool aes128_ecb_kat_test()
+bool aes128_ecb_blocks_kat_test()
 {
 	uint8_t exp[4][16];
 	uint8_t msg[4][16];
 	uint8_t key[16];
+	uint8_t xkey[64];
+	bool status;
 
 	/* SP800-38a F1.1 */
 
@@ -620,7 +3304,18 @@ bool aes128_ecb_kat_test()
 	hex_to_bin("30C81C46A35CE411E5FBC1191A0A52EF", msg[2], 16);
 	hex_to_bin("F69F2445DF4F9B17AD2B417BE66C3710", msg[3], 16);
 
-	return aes128_ecb_monte_carlo(key, msg, exp);
+	status = aes128_ecb_blocks_monte_carlo(key, msg, exp);
+
+	/* wide, eight lane, and single block paths against the single block api */
+
+	hex_to_bin("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A30914DFF4", xkey, 64);
+
+	if (rsx512_ecb_blocks_equivalence(xkey, 16 * 45) == false)
+	{
+		status = false;
+	}
+
+	return status;
 }
 
 bool aes256_ecb_kat_test()
@@ -34,6 +34,28 @@ bool aes128_cbc_kat_test();
 */
 bool aes256_cbc_kat_test();
 
+/**
+* \brief Tests the multi-block CBC decryption with the 256bit key KAT vectors from NIST SP800-85a. \n
+* Also decrypts a long RSX256 chain in place, and compares it to the single block encryption.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes256_cbc_blocks_kat_test();
+
+/**
+* \brief Tests the multi-buffer CBC encryption with the 256bit key KAT vectors from NIST SP800-85a. \n
+* Also encrypts more RSX512 streams of uneven length than there are lanes, and compares them to the single block encryption.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes256_cbc_jobs_kat_test();
+
 /**
 * \brief Tests the CTR 128bit key KAT vectors from NIST SP800-85a.
 *
@@ -54,6 +76,172 @@ bool aes128_ctr_kat_test();
 */
 bool aes256_ctr_kat_test();
 
+/**
+* \brief Tests the multi-block CTR transform with the 128bit key KAT vectors from NIST SP800-85a. \n
+* Also compares a long RSX512 run, including a trailing partial block and a 64bit counter carry, against the single block transform.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes128_ctr_blocks_kat_test();
+
+/**
+* \brief Tests the streaming CTR context with the 128bit key KAT vectors from NIST SP800-85a, fed in uneven updates. \n
+* Also compares RSX512 messages split at arbitrary offsets against a single call to the multi-block transform.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes128_ctr_stream_kat_test();
+
+/**
+* \brief Tests the batch CTR transform with the 128bit key KAT vectors from NIST SP800-85a, split into packets with their own counters. \n
+* Also compares more RSX512 packets than there are lanes against the multi-block transform of each packet.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes128_ctr_packets_kat_test();
+
+/**
+* \brief Tests the key-agile CTR batch with the 128 and 256bit key KAT vectors from NIST SP800-85a. \n
+* Also compares batches of objects with distinct AES and RSX keys against rsx_initialize and the multi-block transform of each object.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes_ctr_keyed_kat_test();
+
+/**
+* \brief Compares the parallel CTR transform against the serial RSX512 transform, over several pool sizes and chunk sizes. \n
+* The counters are chosen so that segment offsets carry through the 64bit boundary and wrap the 128bit counter.
+*
+* \return Returns true for success
+*/
+bool rsx512_ctr_parallel_kat_test();
+
+/**
+* \brief Tests the two direction key context. \n
+* The derived decryption schedule is compared to rsx_initialize for every cipher, with the schedule built at once and on first use.
+*
+* \return Returns true for success
+*/
+bool rsx_dualkey_kat_test();
+
+/**
+* \brief Tests the expanded key cache. \n
+* Cached schedules are compared to rsx_initialize in both directions for every cipher, with derived and caller supplied ids;
+* the hit, miss and eviction counters are checked, and eight ids are looked up concurrently from a thread pool.
+*
+* \return Returns true for success
+*/
+bool rsx_keycache_kat_test();
+
+/**
+* \brief Tests the GCM mode with the AES128 and AES256 test cases from the GCM specification, including a hashed 8 byte nonce. \n
+* Also checks RSX512 GCM round trips over several strides, and that modified tags and cipher-text are rejected.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* McGrew, Viega: <a href="https://csrc.nist.gov/csrc/media/projects/block-cipher-techniques/documents/bcm/proposed-modes/gcm/gcm-spec.pdf">The Galois/Counter Mode of Operation (GCM)</a>
+*/
+bool aes_gcm_kat_test();
+
+/**
+* \brief Tests the RSX512 CTR-KMAC mode against the CTR transform and a single KMAC-256 call over the encoded message. \n
+* Also checks in place decryption, and that a rejected tag rolls the output back to the cipher-text.
+*
+* \return Returns true for success
+*/
+bool rsx512_ctrkmac_kat_test();
+
+/**
+* \brief Tests GCM-SIV with the AES128 and AES256 vectors from RFC 8452. \n
+* Also checks that RSX512 record batches match single messages, and that a forged record in a batch fails on its own.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* RFC 8452: <a href="https://tools.ietf.org/html/rfc8452">AES-GCM-SIV: Nonce Misuse-Resistant Authenticated Encryption</a>
+*/
+bool aes_gcmsiv_kat_test();
+
+/**
+* \brief Tests the OCB3 mode with the AES128 vectors from RFC 7253, including partial blocks and empty messages. \n
+* Also checks RSX512 OCB round trips, that modified tags and cipher-text are rejected, and that a context without an inverse state refuses to decrypt.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* RFC 7253: <a href="https://tools.ietf.org/html/rfc7253">The OCB Authenticated-Encryption Algorithm</a>
+*/
+bool aes_ocb_kat_test();
+
+/**
+* \brief Tests the XTS mode with the XTS-AES-128 vectors from IEEE 1619, including two partial last blocks (cipher-text stealing). \n
+* Also checks RSX512 sector round trips, in place operation, and that a different tweak changes the cipher-text.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* IEEE 1619-2007: Standard for Cryptographic Protection of Data on Block-Oriented Storage Devices, Annex B
+*/
+bool aes_xts_kat_test();
+
+/**
+* \brief Tests the HCTR2 mode with AES128 and AES256 vectors, including empty and short tweaks and partial last blocks. \n
+* Also checks RSX512 sector round trips, in place operation, that a change to the last byte or the tweak reaches the first and last blocks, and that a context without an inverse state refuses to decrypt.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* Crowley, Huckleberry, Biggers: <a href="https://eprint.iacr.org/2021/1441">Length-preserving encryption with HCTR2</a>
+*/
+bool aes_hctr2_kat_test();
+
+/**
+* \brief Tests the CCM mode with the AES128 examples from SP800-38C and the packet vectors from RFC 3610. \n
+* Also checks that the RSX512 cipher-text matches the CTR transform, round trips, and that modified tags, cipher-text, and invalid parameters are rejected.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38C: <a href="https://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38c.pdf">The CCM Mode for Authentication and Confidentiality</a> \n
+* RFC 3610: <a href="https://tools.ietf.org/html/rfc3610">Counter with CBC-MAC (CCM)</a>
+*/
+bool aes_ccm_kat_test();
+
+/**
+* \brief Tests CMAC with the AES128 examples from RFC 4493, including truncated tags. \n
+* Also checks that an RSX512 CMAC detects a change to any block, and that short tags are rejected.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* RFC 4493: <a href="https://tools.ietf.org/html/rfc4493">The AES-CMAC Algorithm</a>
+*/
+bool aes_cmac_kat_test();
+
+/**
+* \brief Tests PMAC1 with the PMAC-AES-128 reference vectors, including a 1000 byte message that runs through the eight block kernel. \n
+* Also checks that an RSX512 PMAC detects a change to any block, and that short tags are rejected.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* Rogaway: <a href="https://web.cs.ucdavis.edu/~rogaway/ocb/pmac.htm">PMAC: A Parallelizable Message Authentication Code</a>
+*/
+bool aes_pmac_kat_test();
+
 /**
 * \brief Tests the ECB mode 128bit key KAT vectors from NIST FIPS197 and SP800-85a
 *
@@ -65,6 +253,17 @@ bool aes256_ctr_kat_test();
 */
 bool aes128_ecb_kat_test();
 
+/**
+* \brief Tests the multi-block ECB functions with the 128bit key KAT vectors from NIST SP800-85a. \n
+* Also compares a long RSX512 run, that spans the wide, eight lane, and single block kernels, against the single block api.
+*
+* \return Returns true for success
+*
+* \remarks <b>Test References:</b> \n
+* SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a>
+*/
+bool aes128_ecb_blocks_kat_test();
+
 /**
 * \brief Tests the ECB 256bit key KAT vectors from NIST FIPS197 and SP800-85a.
 *
@@ -0,0 +1,160 @@
+#include "cpufeatures.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#	define CPUFEATURES_X86
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	elif defined(__GNUC__)
+#		include <cpuid.h>
+#	endif
+#endif
+
+#if defined(WINDOWS)
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#endif
+
+/* the feature set is written once, before any caller can read it */
+static cpu_features cpu_feature_set;
+#if defined(WINDOWS)
+static INIT_ONCE cpu_feature_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t cpu_feature_once = PTHREAD_ONCE_INIT;
+#endif
+
+#if defined(CPUFEATURES_X86)
+
+static void cpuid_query(uint32_t leaf, uint32_t subleaf, uint32_t* regs)
+{
+#if defined(_MSC_VER)
+	int info[4];
+
+	__cpuidex(info, (int)leaf, (int)subleaf);
+	regs[0] = (uint32_t)info[0];
+	regs[1] = (uint32_t)info[1];
+	regs[2] = (uint32_t)info[2];
+	regs[3] = (uint32_t)info[3];
+#elif defined(__GNUC__)
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+	regs[0] = 0;
+	regs[1] = 0;
+	regs[2] = 0;
+	regs[3] = 0;
+#endif
+}
+
+static uint64_t xgetbv_query()
+{
+#if defined(_MSC_VER)
+	return (uint64_t)_xgetbv(0);
+#elif defined(__GNUC__)
+	uint32_t lo;
+	uint32_t hi;
+
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+
+	return ((uint64_t)hi << 32) | lo;
+#else
+	return 0;
+#endif
+}
+
+static bool bit_set(uint32_t reg, uint32_t bit)
+{
+	return ((reg >> bit) & 1) == 1;
+}
+
+static void cpu_features_probe(cpu_features* cpuf)
+{
+	uint32_t regs[4];
+	uint64_t xcr0;
+	uint32_t maxleaf;
+	bool avxos;
+	bool zmmos;
+
+	cpuid_query(0, 0, regs);
+	maxleaf = regs[0];
+
+	if (maxleaf >= 1)
+	{
+		cpuid_query(1, 0, regs);
+
+		cpuf->pclmul = bit_set(regs[2], 1);
+		cpuf->ssse3 = bit_set(regs[2], 9);
+		cpuf->sse41 = bit_set(regs[2], 19);
+		cpuf->aesni = bit_set(regs[2], 25);
+
+		/* the os must save the xmm/ymm (and opmask/zmm) state before avx (avx-512) can be used */
+		avxos = false;
+		zmmos = false;
+
+		if (bit_set(regs[2], 27) == true)
+		{
+			xcr0 = xgetbv_query();
+			avxos = ((xcr0 & 0x06) == 0x06);
+			zmmos = avxos && ((xcr0 & 0xE0) == 0xE0);
+		}
+
+		cpuf->avx = avxos && bit_set(regs[2], 28);
+
+		if (maxleaf >= 7)
+		{
+			cpuid_query(7, 0, regs);
+
+			cpuf->bmi1 = bit_set(regs[1], 3);
+			cpuf->avx2 = cpuf->avx && bit_set(regs[1], 5);
+			cpuf->bmi2 = bit_set(regs[1], 8);
+			cpuf->avx512f = zmmos && bit_set(regs[1], 16);
+			cpuf->avx512bw = cpuf->avx512f && bit_set(regs[1], 30);
+			cpuf->avx512vl = cpuf->avx512f && bit_set(regs[1], 31);
+			cpuf->vaes = cpuf->avx && cpuf->aesni && bit_set(regs[2], 9);
+			cpuf->vpclmul = cpuf->avx && cpuf->pclmul && bit_set(regs[2], 10);
+		}
+	}
+}
+
+#else
+
+static void cpu_features_probe(cpu_features* cpuf)
+{
+	(void)cpuf;
+}
+
+#endif
+
+static void cpu_features_publish()
+{
+	cpu_features cpuf;
+
+	/* probe into a local copy, so the shared set is never seen partly written */
+	memset(&cpuf, 0, sizeof(cpuf));
+	cpu_features_probe(&cpuf);
+	cpu_feature_set = cpuf;
+}
+
+#if defined(WINDOWS)
+
+static BOOL CALLBACK cpu_features_once(PINIT_ONCE once, PVOID parameter, PVOID* context)
+{
+	(void)once;
+	(void)parameter;
+	(void)context;
+	cpu_features_publish();
+
+	return TRUE;
+}
+
+#endif
+
+const cpu_features* cpu_features_get()
+{
+#if defined(WINDOWS)
+	InitOnceExecuteOnce(&cpu_feature_once, cpu_features_once, NULL, NULL);
+#else
+	pthread_once(&cpu_feature_once, cpu_features_publish);
+#endif
+
+	return &cpu_feature_set;
+}
@@ -0,0 +1,54 @@
+/**
+* \file cpufeatures.h
+* \brief <b>CPU feature detection</b> \n
+* Probes the processor with cpuid, and the operating system with xgetbv, 
+* and reports the instruction set extensions that the accelerated code paths can use.
+*
+* <b>Example</b> \n
+* \code
+* const cpu_features* cpuf = cpu_features_get();
+*
+* if (cpuf->vaes == true)
+* {
+*	// use the 512 bit kernels
+* }
+* \endcode
+*
+* \remarks The probe runs once, on the first call to cpu_features_get, and the result is cached; concurrent first calls are safe, every caller sees the complete set. \n
+* A feature is reported only when the operating system also saves the register state it depends on.
+*/
+
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include "common.h"
+
+/*! \struct cpu_features
+* The instruction set extensions available on this processor
+*/
+typedef struct cpu_features
+{
+	bool aesni;		/*!< AES-NI instructions */
+	bool avx;		/*!< AVX and the 256 bit register state */
+	bool avx2;		/*!< AVX2 integer instructions */
+	bool avx512bw;	/*!< AVX-512 byte and word instructions */
+	bool avx512f;	/*!< AVX-512 foundation and the 512 bit register state */
+	bool avx512vl;	/*!< AVX-512 vector length extensions */
+	bool bmi1;		/*!< bit manipulation instructions (andn) */
+	bool bmi2;		/*!< bit manipulation instructions (rorx) */
+	bool pclmul;	/*!< carry-less multiply instructions */
+	bool sse41;		/*!< SSE4.1 instructions */
+	bool ssse3;		/*!< SSSE3 instructions (pshufb) */
+	bool vaes;		/*!< AES instructions on 256 and 512 bit registers */
+	bool vpclmul;	/*!< carry-less multiply on 256 and 512 bit registers */
+} cpu_features;
+
+/**
+* \brief Get the processor feature set. \n
+* The cpuid probe is run on the first call, subsequent calls return the cached result.
+*
+* \return Returns a pointer to the (read-only) feature set
+*/
+const cpu_features* cpu_features_get();
+
+#endif
@@ -0,0 +1,513 @@
+#include "keycache.h"
+#include "sha3.h"
+#include "sysrand.h"
+#include <stdlib.h>
+
+#if defined(WINDOWS)
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#endif
+
+#define KEYCACHE_NONE ((size_t)-1)
+#define KEYCACHE_SECRET_SIZE 32
+
+typedef struct keycache_entry
+{
+	rsx_roundkey enckeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey deckeys[RSX512_ROUNDKEY_DIMENSION];
+	uint8_t id[KEYCACHE_ID_SIZE];
+	size_t rkeylen;
+	size_t bucket;
+	size_t chain;	/* the next entry in the bucket, or on the free list */
+	size_t newer;
+	size_t older;
+} keycache_entry;
+
+typedef struct keycache_shard
+{
+#if defined(WINDOWS)
+	SRWLOCK lock;
+#else
+	pthread_mutex_t lock;
+#endif
+	keycache_entry* entries;
+	size_t* buckets;
+	size_t mask;
+	size_t capacity;
+	size_t count;
+	size_t freelist;
+	size_t newest;
+	size_t oldest;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+} keycache_shard;
+
+struct keycache_state
+{
+	keycache_shard shards[KEYCACHE_SHARDS];
+	uint8_t secret[KEYCACHE_SECRET_SIZE];
+};
+
+#if defined(WINDOWS)
+
+static void shard_lock_init(keycache_shard* shard)
+{
+	InitializeSRWLock(&shard->lock);
+}
+
+static void shard_lock_dispose(keycache_shard* shard)
+{
+	(void)shard;
+}
+
+static void shard_lock(keycache_shard* shard)
+{
+	AcquireSRWLockExclusive(&shard->lock);
+}
+
+static void shard_unlock(keycache_shard* shard)
+{
+	ReleaseSRWLockExclusive(&shard->lock);
+}
+
+#else
+
+static void shard_lock_init(keycache_shard* shard)
+{
+	pthread_mutex_init(&shard->lock, NULL);
+}
+
+static void shard_lock_dispose(keycache_shard* shard)
+{
+	pthread_mutex_destroy(&shard->lock);
+}
+
+static void shard_lock(keycache_shard* shard)
+{
+	pthread_mutex_lock(&shard->lock);
+}
+
+static void shard_unlock(keycache_shard* shard)
+{
+	pthread_mutex_unlock(&shard->lock);
+}
+
+#endif
+
+static void cache_clear(void* buffer, size_t length)
+{
+	/* the volatile stores can not be removed as dead, even when the memory is freed next */
+	volatile uint8_t* ptr = (volatile uint8_t*)buffer;
+	size_t i;
+
+	for (i = 0; i < length; ++i)
+	{
+		ptr[i] = 0;
+	}
+}
+
+static bool cache_dimension_valid(size_t rkeylen)
+{
+	return (rkeylen == AES128_ROUNDKEY_DIMENSION || rkeylen == AES256_ROUNDKEY_DIMENSION ||
+		rkeylen == RSX256_ROUNDKEY_DIMENSION || rkeylen == RSX512_ROUNDKEY_DIMENSION);
+}
+
+static void cache_id(const keycache_state* cache, uint8_t* id, const rsx_keyparams* keyparams, const uint8_t* keyid)
+{
+	if (keyid != NULL)
+	{
+		memcpy(id, keyid, KEYCACHE_ID_SIZE);
+	}
+	else
+	{
+		/* the key material never leaves the caller, only its keyed hash is stored */
+		kmac256(id, KEYCACHE_ID_SIZE, keyparams->key, keyparams->keylen, cache->secret, KEYCACHE_SECRET_SIZE, keyparams->distcode, keyparams->codelen);
+	}
+}
+
+static uint64_t cache_hash(const uint8_t* id, size_t rkeylen)
+{
+	uint64_t hash;
+	uint64_t word;
+	size_t i;
+
+	/* caller ids may be small integers padded with zeroes, so every byte is mixed before the shard is chosen */
+	hash = (uint64_t)rkeylen;
+
+	for (i = 0; i < KEYCACHE_ID_SIZE; i += sizeof(uint64_t))
+	{
+		memcpy(&word, id + i, sizeof(uint64_t));
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+		hash ^= hash >> 29;
+	}
+
+	return hash;
+}
+
+static keycache_shard* cache_shard(keycache_state* cache, uint64_t hash)
+{
+	return &cache->shards[(size_t)(hash >> 40) & (KEYCACHE_SHARDS - 1)];
+}
+
+static size_t shard_find(const keycache_shard* shard, const uint8_t* id, size_t rkeylen, size_t bucket)
+{
+	size_t index;
+
+	index = shard->buckets[bucket];
+
+	while (index != KEYCACHE_NONE)
+	{
+		if (shard->entries[index].rkeylen == rkeylen && memcmp(shard->entries[index].id, id, KEYCACHE_ID_SIZE) == 0)
+		{
+			break;
+		}
+
+		index = shard->entries[index].chain;
+	}
+
+	return index;
+}
+
+static void shard_detach(keycache_shard* shard, size_t index)
+{
+	keycache_entry* entry = &shard->entries[index];
+
+	if (entry->newer != KEYCACHE_NONE)
+	{
+		shard->entries[entry->newer].older = entry->older;
+	}
+	else
+	{
+		shard->newest = entry->older;
+	}
+
+	if (entry->older != KEYCACHE_NONE)
+	{
+		shard->entries[entry->older].newer = entry->newer;
+	}
+	else
+	{
+		shard->oldest = entry->newer;
+	}
+}
+
+static void shard_push(keycache_shard* shard, size_t index)
+{
+	keycache_entry* entry = &shard->entries[index];
+
+	entry->newer = KEYCACHE_NONE;
+	entry->older = shard->newest;
+
+	if (shard->newest != KEYCACHE_NONE)
+	{
+		shard->entries[shard->newest].newer = index;
+	}
+	else
+	{
+		shard->oldest = index;
+	}
+
+	shard->newest = index;
+}
+
+static void shard_touch(keycache_shard* shard, size_t index)
+{
+	if (shard->newest != index)
+	{
+		shard_detach(shard, index);
+		shard_push(shard, index);
+	}
+}
+
+static void shard_unlink(keycache_shard* shard, size_t index)
+{
+	keycache_entry* entry = &shard->entries[index];
+	size_t* link;
+
+	link = &shard->buckets[entry->bucket];
+
+	while (*link != index)
+	{
+		link = &shard->entries[*link].chain;
+	}
+
+	*link = entry->chain;
+	shard_detach(shard, index);
+	cache_clear(entry, sizeof(keycache_entry));
+	--shard->count;
+}
+
+static void shard_insert(keycache_shard* shard, const uint8_t* id, size_t rkeylen, size_t bucket, const rsx_roundkey* enckeys, const rsx_roundkey* deckeys)
+{
+	keycache_entry* entry;
+	size_t index;
+
+	if (shard->freelist != KEYCACHE_NONE)
+	{
+		index = shard->freelist;
+		shard->freelist = shard->entries[index].chain;
+	}
+	else
+	{
+		index = shard->oldest;
+		shard_unlink(shard, index);
+		++shard->evictions;
+	}
+
+	entry = &shard->entries[index];
+	memcpy(entry->enckeys, enckeys, rkeylen * sizeof(rsx_roundkey));
+	memcpy(entry->deckeys, deckeys, rkeylen * sizeof(rsx_roundkey));
+	memcpy(entry->id, id, KEYCACHE_ID_SIZE);
+	entry->rkeylen = rkeylen;
+	entry->bucket = bucket;
+	entry->chain = shard->buckets[bucket];
+	shard->buckets[bucket] = index;
+	shard_push(shard, index);
+	++shard->count;
+}
+
+static void shard_copy(const keycache_entry* entry, rsx_state* encstate, rsx_state* decstate)
+{
+	if (encstate != NULL)
+	{
+		memcpy(encstate->roundkeys, entry->enckeys, entry->rkeylen * sizeof(rsx_roundkey));
+	}
+
+	if (decstate != NULL)
+	{
+		memcpy(decstate->roundkeys, entry->deckeys, entry->rkeylen * sizeof(rsx_roundkey));
+	}
+}
+
+keycache_state* keycache_create(size_t capacity)
+{
+	keycache_state* cache;
+	keycache_shard* shard;
+	size_t entries;
+	size_t buckets;
+	size_t i;
+	size_t j;
+	bool res;
+
+	if (capacity == 0)
+	{
+		capacity = KEYCACHE_DEFAULT_CAPACITY;
+	}
+
+	entries = (capacity + KEYCACHE_SHARDS - 1) / KEYCACHE_SHARDS;
+	buckets = 1;
+
+	while (buckets < entries)
+	{
+		buckets <<= 1;
+	}
+
+	cache = (keycache_state*)calloc(1, sizeof(keycache_state));
+
+	if (cache != NULL)
+	{
+		res = (sysrand_getbytes(cache->secret, KEYCACHE_SECRET_SIZE) == RAND_STATUS_SUCCESS);
+
+		for (i = 0; i < KEYCACHE_SHARDS; ++i)
+		{
+			shard = &cache->shards[i];
+			shard_lock_init(shard);
+			shard->freelist = KEYCACHE_NONE;
+			shard->newest = KEYCACHE_NONE;
+			shard->oldest = KEYCACHE_NONE;
+
+			if (res == true)
+			{
+				shard->entries = (keycache_entry*)calloc(entries, sizeof(keycache_entry));
+				shard->buckets = (size_t*)malloc(buckets * sizeof(size_t));
+				res = (shard->entries != NULL && shard->buckets != NULL);
+			}
+
+			if (res == true)
+			{
+				shard->capacity = entries;
+				shard->mask = buckets - 1;
+
+				for (j = 0; j < buckets; ++j)
+				{
+					shard->buckets[j] = KEYCACHE_NONE;
+				}
+
+				/* every entry starts on the free list, in index order */
+				for (j = entries; j != 0; --j)
+				{
+					shard->entries[j - 1].chain = shard->freelist;
+					shard->freelist = j - 1;
+				}
+			}
+		}
+
+		if (res == false)
+		{
+			keycache_destroy(cache);
+			cache = NULL;
+		}
+	}
+
+	return cache;
+}
+
+void keycache_destroy(keycache_state* cache)
+{
+	keycache_shard* shard;
+	size_t i;
+
+	if (cache != NULL)
+	{
+		for (i = 0; i < KEYCACHE_SHARDS; ++i)
+		{
+			shard = &cache->shards[i];
+
+			if (shard->entries != NULL)
+			{
+				cache_clear(shard->entries, shard->capacity * sizeof(keycache_entry));
+				free(shard->entries);
+			}
+
+			free(shard->buckets);
+			shard_lock_dispose(shard);
+		}
+
+		cache_clear(cache->secret, KEYCACHE_SECRET_SIZE);
+		free(cache);
+	}
+}
+
+mqc_status keycache_get(keycache_state* cache, rsx_state* encstate, rsx_state* decstate, rsx_keyparams* keyparams, const uint8_t* keyid)
+{
+	rsx_roundkey enckeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_roundkey deckeys[RSX512_ROUNDKEY_DIMENSION];
+	uint8_t id[KEYCACHE_ID_SIZE];
+	rsx_state encs;
+	rsx_state decs;
+	keycache_shard* shard;
+	uint64_t hash;
+	size_t bucket;
+	size_t index;
+	size_t rkeylen;
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+	rkeylen = (encstate != NULL) ? encstate->rkeylen : ((decstate != NULL) ? decstate->rkeylen : 0);
+
+	if (cache_dimension_valid(rkeylen) == true && (encstate == NULL || decstate == NULL || encstate->rkeylen == decstate->rkeylen))
+	{
+		cache_id(cache, id, keyparams, keyid);
+		hash = cache_hash(id, rkeylen);
+		shard = cache_shard(cache, hash);
+		bucket = (size_t)hash & shard->mask;
+
+		shard_lock(shard);
+		index = shard_find(shard, id, rkeylen, bucket);
+
+		if (index != KEYCACHE_NONE)
+		{
+			shard_copy(&shard->entries[index], encstate, decstate);
+			shard_touch(shard, index);
+			++shard->hits;
+		}
+		else
+		{
+			++shard->misses;
+		}
+
+		shard_unlock(shard);
+
+		if (index == KEYCACHE_NONE)
+		{
+			/* the key schedule runs outside the lock; if two threads miss on the same key, both expand it and the first insert is kept.
+			   the decryption schedule is derived from the encryption schedule, the key is expanded once */
+			encs.roundkeys = enckeys;
+			encs.rkeylen = rkeylen;
+			decs.roundkeys = deckeys;
+			decs.rkeylen = rkeylen;
+			rsx_initialize(&encs, keyparams, true);
+			rsx_inverse_schedule(&decs, &encs);
+
+			if (encstate != NULL)
+			{
+				memcpy(encstate->roundkeys, enckeys, rkeylen * sizeof(rsx_roundkey));
+			}
+
+			if (decstate != NULL)
+			{
+				memcpy(decstate->roundkeys, deckeys, rkeylen * sizeof(rsx_roundkey));
+			}
+
+			shard_lock(shard);
+
+			if (shard_find(shard, id, rkeylen, bucket) == KEYCACHE_NONE)
+			{
+				shard_insert(shard, id, rkeylen, bucket, enckeys, deckeys);
+			}
+
+			shard_unlock(shard);
+
+			cache_clear(enckeys, sizeof(enckeys));
+			cache_clear(deckeys, sizeof(deckeys));
+		}
+
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+bool keycache_remove(keycache_state* cache, rsx_keyparams* keyparams, const uint8_t* keyid, size_t rkeylen)
+{
+	uint8_t id[KEYCACHE_ID_SIZE];
+	keycache_shard* shard;
+	uint64_t hash;
+	size_t bucket;
+	size_t index;
+
+	index = KEYCACHE_NONE;
+
+	if (cache_dimension_valid(rkeylen) == true)
+	{
+		cache_id(cache, id, keyparams, keyid);
+		hash = cache_hash(id, rkeylen);
+		shard = cache_shard(cache, hash);
+		bucket = (size_t)hash & shard->mask;
+
+		shard_lock(shard);
+		index = shard_find(shard, id, rkeylen, bucket);
+
+		if (index != KEYCACHE_NONE)
+		{
+			shard_unlink(shard, index);
+			shard->entries[index].chain = shard->freelist;
+			shard->freelist = index;
+		}
+
+		shard_unlock(shard);
+	}
+
+	return (index != KEYCACHE_NONE);
+}
+
+void keycache_statistics(keycache_state* cache, keycache_stats* stats)
+{
+	keycache_shard* shard;
+	size_t i;
+
+	memset(stats, 0, sizeof(keycache_stats));
+
+	for (i = 0; i < KEYCACHE_SHARDS; ++i)
+	{
+		shard = &cache->shards[i];
+		shard_lock(shard);
+		stats->hits += shard->hits;
+		stats->misses += shard->misses;
+		stats->evictions += shard->evictions;
+		stats->entries += shard->count;
+		shard_unlock(shard);
+	}
+}
@@ -0,0 +1,121 @@
+/**
+* \file keycache.h
+* \brief <b>Expanded key cache</b> \n
+* A bounded cache of expanded cipher key schedules, for callers that re-derive the same keys many times,
+* such as a storage node serving thousands of tenant keys. Each entry holds the encryption and decryption
+* round keys of one key; a hit copies the schedules into the caller's states instead of running the key schedule,
+* which for RSX256 and RSX512 is a cSHAKE256 squeeze followed by the inverse transform.
+*
+* Entries are found by a 32 byte key id. The caller can supply the id (a tenant or key-version number, padded to
+* KEYCACHE_ID_SIZE), or pass NULL and the cache derives it from the key material with KMAC-256,
+* keyed with a random secret drawn when the cache is created; raw keys are never stored or compared.
+* The cipher (the state rkeylen) is part of the match, so one id can be cached for more than one cipher.
+*
+* <b>Example</b> \n
+* \code
+* // a cache of up to 4096 keys
+* keycache_state* cache = keycache_create(4096);
+*
+* rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+* rsx_state state = { rkeys, RSX512_ROUNDKEY_DIMENSION };
+*
+* // the schedule is expanded on the first call, later calls copy it from the cache
+* keycache_get(cache, &state, NULL, &kp, tenantid);
+*
+* keycache_destroy(cache);
+* \endcode
+*
+* \remarks The cache is split into KEYCACHE_SHARDS independently locked shards, chosen by the key id,
+* each with its own least-recently-used order; the key schedule of a miss runs outside the lock. \n
+* Evicted, removed and destroyed entries are zeroized. \n
+* Uses Windows slim reader/writer locks when WINDOWS is defined, otherwise posix mutexes.
+*/
+
+#ifndef KEYCACHE_H
+#define KEYCACHE_H
+
+#include "common.h"
+#include "rsx.h"
+
+/*! \def KEYCACHE_ID_SIZE
+* The byte size of a key id
+*/
+#define KEYCACHE_ID_SIZE 32
+
+/*! \def KEYCACHE_SHARDS
+* The number of independently locked shards; a power of two
+*/
+#define KEYCACHE_SHARDS 16
+
+/*! \def KEYCACHE_DEFAULT_CAPACITY
+* The number of entries used when keycache_create is called with a zero capacity
+*/
+#define KEYCACHE_DEFAULT_CAPACITY 4096
+
+/*! \struct keycache_state
+* The cache state, an opaque type created with keycache_create
+*/
+typedef struct keycache_state keycache_state;
+
+/*! \struct keycache_stats
+* The cache counters, summed over all shards
+*/
+typedef struct keycache_stats
+{
+	uint64_t hits;			/*!< lookups answered from the cache */
+	uint64_t misses;		/*!< lookups that ran the key schedule */
+	uint64_t evictions;		/*!< entries dropped to make room for a new key */
+	size_t entries;			/*!< the number of keys currently cached */
+} keycache_stats;
+
+/**
+* \brief Create a key cache. \n
+* The capacity is divided evenly over the shards, and rounded up to a multiple of KEYCACHE_SHARDS.
+*
+* \param capacity The maximum number of cached keys; zero selects KEYCACHE_DEFAULT_CAPACITY
+* \return Returns the cache, or NULL if the memory or the hashing secret could not be obtained
+*/
+keycache_state* keycache_create(size_t capacity);
+
+/**
+* \brief Zeroize every entry and release the cache
+*
+* \param cache The cache to destroy, can be NULL
+*/
+void keycache_destroy(keycache_state* cache);
+
+/**
+* \brief Get the expanded key schedules for a key. \n
+* On a hit the cached round keys are copied to the states; on a miss the key is expanded in both directions,
+* the schedules are copied to the states, and the key is added to the cache, evicting the least recently used key of its shard if it is full.
+* The states receive the same round keys as rsx_initialize with encryption set to true and false.
+*
+* \param cache The key cache
+* \param encstate The state receiving the encryption schedule, can be NULL
+* \param decstate The state receiving the decryption schedule, can be NULL; if both are set they must have the same rkeylen
+* \param keyparams The cipher key; used on a miss, and to derive the id when keyid is NULL
+* \param keyid The KEYCACHE_ID_SIZE byte key id, or NULL to derive the id from the key material
+* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID if neither state is set, the rkeylen is not a known cipher, or the two states disagree
+*/
+mqc_status keycache_get(keycache_state* cache, rsx_state* encstate, rsx_state* decstate, rsx_keyparams* keyparams, const uint8_t* keyid);
+
+/**
+* \brief Remove and zeroize a cached key, for example when a key is revoked or rotated
+*
+* \param cache The key cache
+* \param keyparams The cipher key; only used to derive the id when keyid is NULL
+* \param keyid The KEYCACHE_ID_SIZE byte key id, or NULL to derive the id from the key material
+* \param rkeylen The round key dimension of the cached cipher
+* \return Returns true if the key was cached
+*/
+bool keycache_remove(keycache_state* cache, rsx_keyparams* keyparams, const uint8_t* keyid, size_t rkeylen);
+
+/**
+* \brief Read the hit, miss and eviction counters
+*
+* \param cache The key cache
+* \param stats The counters, summed over all shards
+*/
+void keycache_statistics(keycache_state* cache, keycache_stats* stats);
+
+#endif
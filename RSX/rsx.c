@@ -1,6 +1,53 @@
 #include "rsx.h"
+#include "cpufeatures.h"
 #include <string.h>
 
+/* the number of blocks processed in parallel by the multi-block kernels */
+#define RSX_CTR_LANES 8
+
+/* the number of keys expanded and encrypted together by the key-agile CTR batch */
+#define RSX_KEYED_LANES 8
+
+/* the number of blocks prepared ahead of the multi-block cipher by the portable XTS, OCB, and XCTR kernels, and the GCM-SIV counter pass */
+#define RSX_BATCH_BLOCKS 32
+
+/* the number of GCM-SIV key derivation blocks for the largest key; two for the authentication key and one for each 8 bytes of the cipher key */
+#define RSX_GCMSIV_KDF_BLOCKS (2 + (RSX512_KEY_SIZE / 8))
+
+/* the x86 kernels (SSSE3, AES-NI, PCLMUL, VAES, VPCLMULQDQ) are always compiled, and selected at runtime when the processor supports them */
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#	define RSX_AESNI_SUPPORTED
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <immintrin.h>
+#	endif
+#	if defined(__GNUC__)
+#		define RSX_AESNI_TARGET __attribute__((target("aes,ssse3")))
+#		define RSX_VPAES_TARGET __attribute__((target("ssse3")))
+#		define RSX_PCLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+#		define RSX_AESCLMUL_TARGET __attribute__((target("aes,pclmul,ssse3")))
+#	else
+#		define RSX_AESNI_TARGET
+#		define RSX_VPAES_TARGET
+#		define RSX_PCLMUL_TARGET
+#		define RSX_AESCLMUL_TARGET
+#	endif
+	/* compilers with VAES intrinsics get the 512 bit kernels */
+#	if (defined(__GNUC__) && (__GNUC__ >= 8)) || defined(__clang__) || (defined(_MSC_VER) && (_MSC_VER >= 1920))
+#		define RSX_VAES_SUPPORTED
+		/* the number of blocks processed in parallel by the 512 bit kernels (4 blocks per register) */
+#		define RSX_VAES_LANES 16
+#		if defined(__GNUC__)
+#			define RSX_VAES_TARGET __attribute__((target("aes,ssse3,avx512f,avx512bw,vaes")))
+#			define RSX_VPCLMUL_TARGET __attribute__((target("aes,pclmul,ssse3,avx512f,avx512bw,vaes,vpclmulqdq")))
+#		else
+#			define RSX_VAES_TARGET
+#			define RSX_VPCLMUL_TARGET
+#		endif
+#	endif
+#endif
+
 /* Common */
 
 static void increment_be8(uint8_t* output)
@@ -11,6 +58,23 @@ static void increment_be8(uint8_t* output)
 	}
 }
 
+static void add_be128(uint8_t* output, uint64_t value)
+{
+	uint32_t carry;
+	int i;
+
+	/* adds a block offset to the 128 bit big endian counter, carrying through all 16 bytes */
+	carry = 0;
+
+	for (i = 15; i >= 0; --i)
+	{
+		carry += (uint32_t)output[i] + (uint32_t)(value & 0xFF);
+		output[i] = (uint8_t)carry;
+		carry >>= 8;
+		value >>= 8;
+	}
+}
+
 static uint32_t load_be32(const uint8_t* a, size_t offset)
 {
 	return
@@ -20,63 +84,34 @@ static uint32_t load_be32(const uint8_t* a, size_t offset)
 		((uint8_t)(a[offset + 3]));
 }
 
-#if defined(RSX_AESNI_ENABLED)
-
-static void decrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+static uint32_t load_le32(const uint8_t* a, size_t offset)
 {
-	const size_t RNDCNT = state->rkeylen - 2;
-	size_t keyctr = 0;
-
-	__m128i x = _mm_loadu_si128((const __m128i*)input);
-	x = _mm_xor_si128(x, state->roundkeys[keyctr]);
-
-	while (keyctr != RNDCNT)
-	{
-		++keyctr;
-		x = _mm_aesdec_si128(x, state->roundkeys[keyctr]);
-	}
-
-	++keyctr;
-	_mm_storeu_si128((__m128i*)output, _mm_aesdeclast_si128(x, state->roundkeys[keyctr]));
+	return
+		((uint32_t)(a[offset])) |
+		((uint32_t)(a[offset + 1]) << 8) |
+		((uint32_t)(a[offset + 2]) << 16) |
+		((uint32_t)(a[offset + 3]) << 24);
 }
 
-static void encrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+static uint64_t load_be64(const uint8_t* a, size_t offset)
 {
-	const size_t RNDCNT = state->rkeylen - 2;
-	size_t keyctr = 0;
-
-	__m128i x = _mm_loadu_si128((const __m128i*)input);
-	x = _mm_xor_si128(x, state->roundkeys[keyctr]);
-
-	while (keyctr != RNDCNT)
-	{
-		++keyctr;
-		x = _mm_aesenc_si128(x, state->roundkeys[keyctr]);
-	}
-
-	++keyctr;
-	_mm_storeu_si128((__m128i*)output, _mm_aesenclast_si128(x, state->roundkeys[keyctr]));
+	return
+		((uint64_t)load_be32(a, offset) << 32) |
+		(uint64_t)load_be32(a, offset + 4);
 }
 
-static void expand_rot(__m128i* Key, size_t Index, size_t Offset)
+static void be32_to_bytes(const uint32_t value, uint8_t* output, size_t offset)
 {
-	__m128i pkb = Key[Index - Offset];
-	Key[Index] = _mm_shuffle_epi32(Key[Index], 0xFF);
-	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
-	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
-	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
-	Key[Index] = _mm_xor_si128(pkb, Key[Index]);
+	output[offset] = (uint8_t)(value >> 24);
+	output[offset + 1] = (uint8_t)(value >> 16);
+	output[offset + 2] = (uint8_t)(value >> 8);
+	output[offset + 3] = (uint8_t)value;
 }
 
-static void expand_sub(__m128i* Key, size_t Index, size_t Offset)
+static void be64_to_bytes(const uint64_t value, uint8_t* output, size_t offset)
 {
-	// used with 256 bit keys
-	__m128i pkb = Key[Index - Offset];
-	Key[Index] = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(Key[Index - 1], 0x0), 0xAA);
-	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
-	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
-	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
-	Key[Index] = _mm_xor_si128(pkb, Key[Index]);
+	be32_to_bytes((uint32_t)(value >> 32), output, offset);
+	be32_to_bytes((uint32_t)value, output, offset + 4);
 }
 
 static void le32_to_bytes(const uint32_t value, uint8_t* output, size_t offset)
@@ -87,212 +122,445 @@ static void le32_to_bytes(const uint32_t value, uint8_t* output, size_t offset)
 	output[offset + 3] = (uint8_t)(value >> 24);
 }
 
-static void secure_expand(rsx_state* state, rsx_keyparams* keyparams)
+static uint64_t load_le64(const uint8_t* a, size_t offset)
 {
-	uint32_t tmpk;
+	return
+		(uint64_t)load_le32(a, offset) |
+		((uint64_t)load_le32(a, offset + 4) << 32);
+}
+
+static void le64_to_bytes(const uint64_t value, uint8_t* output, size_t offset)
+{
+	le32_to_bytes((uint32_t)value, output, offset);
+	le32_to_bytes((uint32_t)(value >> 32), output, offset + 4);
+}
+
+static void cbc_jobs(void (*ecb)(rsx_state*, uint8_t*, const uint8_t*, size_t), rsx_state* state, rsx_cbc_job* jobs, size_t count)
+{
+	uint8_t blocks[RSX_CTR_LANES * RSX_BLOCK_SIZE];
+	rsx_cbc_job* lanes[RSX_CTR_LANES];
+	size_t slots[RSX_CTR_LANES];
+	size_t pos[RSX_CTR_LANES];
+	size_t active;
+	size_t next;
 	size_t i;
 	size_t j;
 
-	if (state->rkeylen == RSX256_ROUNDKEY_DIMENSION)
+	next = 0;
+
+	for (i = 0; i < RSX_CTR_LANES; ++i)
 	{
-		uint8_t rk[(RSX256_ROUNDKEY_DIMENSION * ROUNDKEY_ELEMENT_SIZE)];
-		cshake256(rk, (RSX256_ROUNDKEY_DIMENSION * ROUNDKEY_ELEMENT_SIZE), keyparams->key, keyparams->keylen, NULL, 0, keyparams->distcode, keyparams->codelen);
+		lanes[i] = NULL;
+		pos[i] = 0;
+	}
 
-		/* swap to le (required for kats) */
-		for (size_t i = 0; i < (RSX256_ROUNDKEY_DIMENSION * ROUNDKEY_ELEMENT_SIZE); i += 4)
-		{
-			tmpk = load_be32(rk, i);
-			le32_to_bytes(tmpk, rk, i);
-		}
+	/* one block from each of up to eight streams runs through the multi-block cipher, the chaining value is kept in the iv;
+	   a lane whose stream has ended takes the next job, and the active lanes are packed so no cipher work is wasted */
+	while (true)
+	{
+		active = 0;
 
-		/* load the round-key array */
-		for (size_t i = 0, j = 0; i < RSX256_ROUNDKEY_DIMENSION; i++, j += 16)
+		for (i = 0; i < RSX_CTR_LANES; ++i)
 		{
-			state->roundkeys[i] = _mm_loadu_si128((__m128i*)(rk + (i * 16)));
+			if (lanes[i] != NULL && lanes[i]->length - pos[i] < RSX_BLOCK_SIZE)
+			{
+				lanes[i] = NULL;
+			}
+
+			while (lanes[i] == NULL && next < count)
+			{
+				if (jobs[next].length >= RSX_BLOCK_SIZE)
+				{
+					lanes[i] = &jobs[next];
+					pos[i] = 0;
+				}
+
+				++next;
+			}
+
+			if (lanes[i] != NULL)
+			{
+				for (j = 0; j < RSX_BLOCK_SIZE; ++j)
+				{
+					blocks[(active * RSX_BLOCK_SIZE) + j] = lanes[i]->input[pos[i] + j] ^ lanes[i]->iv[j];
+				}
+
+				slots[active] = i;
+				++active;
+			}
 		}
-	}
-	else
-	{
-		uint8_t rk[(RSX512_ROUNDKEY_DIMENSION * ROUNDKEY_ELEMENT_SIZE)];
-		cshake256(rk, (RSX512_ROUNDKEY_DIMENSION * ROUNDKEY_ELEMENT_SIZE), keyparams->key, keyparams->keylen, NULL, 0, keyparams->distcode, keyparams->codelen);
 
-		for (size_t i = 0; i < (RSX512_ROUNDKEY_DIMENSION * ROUNDKEY_ELEMENT_SIZE); i += 4)
+		if (active == 0)
 		{
-			tmpk = load_be32(rk, i);
-			le32_to_bytes(tmpk, rk, i);
+			break;
 		}
 
-		for (size_t i = 0, j = 0; i < RSX512_ROUNDKEY_DIMENSION; i++, j += 16)
+		ecb(state, blocks, blocks, active * RSX_BLOCK_SIZE);
+
+		for (j = 0; j < active; ++j)
 		{
-			state->roundkeys[i] = _mm_loadu_si128((__m128i*)(rk + (i * 16)));
+			i = slots[j];
+			memcpy(lanes[i]->output + pos[i], blocks + (j * RSX_BLOCK_SIZE), RSX_BLOCK_SIZE);
+			memcpy(lanes[i]->iv, blocks + (j * RSX_BLOCK_SIZE), RSX_BLOCK_SIZE);
+			pos[i] += RSX_BLOCK_SIZE;
 		}
 	}
+
+	memset(blocks, 0, sizeof(blocks));
 }
 
-static void standard_expand(rsx_state* state, rsx_keyparams* keyparams)
+static void ccm_blocks(void (*encrypt_block)(rsx_state*, uint8_t*, const uint8_t*), void (*ctr_transform)(rsx_state*, uint8_t*, uint8_t*, const uint8_t*, size_t), rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length, bool encryption)
 {
-	// key in 32 bit words
-	size_t kwords = keyparams->keylen / 4;
+	size_t blen;
+	size_t i;
+	size_t j;
 
-	if (kwords == 8)
-	{
-		state->roundkeys[0] = _mm_loadu_si128((__m128i*)keyparams->key);
-		state->roundkeys[1] = _mm_loadu_si128((__m128i*)(keyparams->key + 16));
-		state->roundkeys[2] = _mm_aeskeygenassist_si128(state->roundkeys[1], 0x01);
-		expand_rot(state->roundkeys, 2, 2);
-		expand_sub(state->roundkeys, 3, 2);
-		state->roundkeys[4] = _mm_aeskeygenassist_si128(state->roundkeys[3], 0x02);
-		expand_rot(state->roundkeys, 4, 2);
-		expand_sub(state->roundkeys, 5, 2);
-		state->roundkeys[6] = _mm_aeskeygenassist_si128(state->roundkeys[5], 0x04);
-		expand_rot(state->roundkeys, 6, 2);
-		expand_sub(state->roundkeys, 7, 2);
-		state->roundkeys[8] = _mm_aeskeygenassist_si128(state->roundkeys[7], 0x08);
-		expand_rot(state->roundkeys, 8, 2);
-		expand_sub(state->roundkeys, 9, 2);
-		state->roundkeys[10] = _mm_aeskeygenassist_si128(state->roundkeys[9], 0x10);
-		expand_rot(state->roundkeys, 10, 2);
-		expand_sub(state->roundkeys, 11, 2);
-		state->roundkeys[12] = _mm_aeskeygenassist_si128(state->roundkeys[11], 0x20);
-		expand_rot(state->roundkeys, 12, 2);
-		expand_sub(state->roundkeys, 13, 2);
-		state->roundkeys[14] = _mm_aeskeygenassist_si128(state->roundkeys[13], 0x40);
-		expand_rot(state->roundkeys, 14, 2);
-	}
-	else
+	/* the mac chain is serial, the keystream of each batch runs through the multi-block counter kernel;
+	   the mac reads the plain-text, before it is encrypted or after it is decrypted */
+	while (length >= RSX_BLOCK_SIZE)
 	{
-		state->roundkeys[0] = _mm_loadu_si128((__m128i*)keyparams->key);
-		state->roundkeys[1] = _mm_aeskeygenassist_si128(state->roundkeys[0], 0x01);
-		expand_rot(state->roundkeys, 1, 1);
-		state->roundkeys[2] = _mm_aeskeygenassist_si128(state->roundkeys[1], 0x02);
-		expand_rot(state->roundkeys, 2, 1);
-		state->roundkeys[3] = _mm_aeskeygenassist_si128(state->roundkeys[2], 0x04);
-		expand_rot(state->roundkeys, 3, 1);
-		state->roundkeys[4] = _mm_aeskeygenassist_si128(state->roundkeys[3], 0x08);
-		expand_rot(state->roundkeys, 4, 1);
-		state->roundkeys[5] = _mm_aeskeygenassist_si128(state->roundkeys[4], 0x10);
-		expand_rot(state->roundkeys, 5, 1);
-		state->roundkeys[6] = _mm_aeskeygenassist_si128(state->roundkeys[5], 0x20);
-		expand_rot(state->roundkeys, 6, 1);
-		state->roundkeys[7] = _mm_aeskeygenassist_si128(state->roundkeys[6], 0x40);
-		expand_rot(state->roundkeys, 7, 1);
-		state->roundkeys[8] = _mm_aeskeygenassist_si128(state->roundkeys[7], 0x80);
-		expand_rot(state->roundkeys, 8, 1);
-		state->roundkeys[9] = _mm_aeskeygenassist_si128(state->roundkeys[8], 0x1B);
-		expand_rot(state->roundkeys, 9, 1);
-		state->roundkeys[10] = _mm_aeskeygenassist_si128(state->roundkeys[9], 0x36);
-		expand_rot(state->roundkeys, 10, 1);
+		blen = length - (length % RSX_BLOCK_SIZE);
+		blen = (blen > RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE) ? RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE : blen;
+
+		if (encryption == false)
+		{
+			ctr_transform(state, output, ctr, input, blen);
+		}
+
+		for (i = 0; i < blen; i += RSX_BLOCK_SIZE)
+		{
+			for (j = 0; j < RSX_BLOCK_SIZE; ++j)
+			{
+				mac[j] ^= (encryption == true) ? input[i + j] : output[i + j];
+			}
+
+			encrypt_block(state, mac, mac);
+		}
+
+		if (encryption == true)
+		{
+			ctr_transform(state, output, ctr, input, blen);
+		}
+
+		input += blen;
+		output += blen;
+		length -= blen;
 	}
 }
 
-void rsx_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input)
+static void ctr_keyed(void (*ctr_transform)(rsx_state*, uint8_t*, uint8_t*, const uint8_t*, size_t), void (*encrypt_block)(rsx_state*, uint8_t*, const uint8_t*), rsx_state* states, const rsx_ctr_packet* packets, size_t count)
 {
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t blen;
 	size_t i;
-	uint8_t tmpv[RSX_BLOCK_SIZE];
-
-	memcpy(&tmpv[0], &input[0], RSX_BLOCK_SIZE);
-	decrypt_block(state, output, input);
+	size_t j;
 
-	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	/* each packet with its own key schedule, states[i] */
+	for (i = 0; i < count; ++i)
 	{
-		output[i] ^= iv[i];
+		memcpy(ctr, packets[i].nonce, RSX_BLOCK_SIZE);
+		blen = packets[i].length - (packets[i].length % RSX_BLOCK_SIZE);
+		ctr_transform(&states[i], packets[i].output, ctr, packets[i].input, blen);
+
+		if (packets[i].length != blen)
+		{
+			encrypt_block(&states[i], tmpb, ctr);
 
+			for (j = 0; j < packets[i].length - blen; ++j)
+			{
+				packets[i].output[blen + j] = packets[i].input[blen + j] ^ tmpb[j];
+			}
+		}
 	}
 
-	memcpy(&iv[0], &tmpv[0], RSX_BLOCK_SIZE);
+	memset(ctr, 0, sizeof(ctr));
+	memset(tmpb, 0, sizeof(tmpb));
 }
 
-void rsx_cbc_encrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input)
+static void ctr_packets(void (*ecb)(rsx_state*, uint8_t*, const uint8_t*, size_t), rsx_state* state, const rsx_ctr_packet* packets, size_t count)
 {
+	uint8_t blocks[RSX_CTR_LANES * RSX_BLOCK_SIZE];
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	const uint8_t* inputs[RSX_CTR_LANES];
+	uint8_t* outputs[RSX_CTR_LANES];
+	size_t lens[RSX_CTR_LANES];
+	size_t active;
+	size_t blen;
+	size_t next;
+	size_t pos;
 	size_t i;
+	size_t j;
 
-	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	next = 0;
+	pos = 0;
+
+	/* the counter blocks of consecutive packets share a batch, the end of a packet does not drain the multi-block cipher */
+	while (next != count)
 	{
-		iv[i] ^= input[i];
+		active = 0;
+
+		while (active != RSX_CTR_LANES && next != count)
+		{
+			if (pos >= packets[next].length)
+			{
+				++next;
+				pos = 0;
+			}
+			else
+			{
+				if (pos == 0)
+				{
+					memcpy(ctr, packets[next].nonce, RSX_BLOCK_SIZE);
+				}
+
+				while (active != RSX_CTR_LANES && pos < packets[next].length)
+				{
+					blen = packets[next].length - pos;
+					memcpy(blocks + (active * RSX_BLOCK_SIZE), ctr, RSX_BLOCK_SIZE);
+					increment_be8(ctr);
+					inputs[active] = packets[next].input + pos;
+					outputs[active] = packets[next].output + pos;
+					lens[active] = (blen > RSX_BLOCK_SIZE) ? RSX_BLOCK_SIZE : blen;
+					pos += RSX_BLOCK_SIZE;
+					++active;
+				}
+			}
+		}
+
+		if (active != 0)
+		{
+			ecb(state, blocks, blocks, active * RSX_BLOCK_SIZE);
+
+			for (i = 0; i < active; ++i)
+			{
+				for (j = 0; j < lens[i]; ++j)
+				{
+					outputs[i][j] = inputs[i][j] ^ blocks[(i * RSX_BLOCK_SIZE) + j];
+				}
+			}
+		}
 	}
 
-	encrypt_block(state, output, iv);
-	memcpy(&iv[0], &output[0], RSX_BLOCK_SIZE);
+	memset(blocks, 0, sizeof(blocks));
+	memset(ctr, 0, sizeof(ctr));
 }
 
-void rsx_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input)
+static void expand_x4(void (*standard_expand)(rsx_state*, rsx_keyparams*), rsx_state* states, rsx_keyparams* keyparams)
 {
 	size_t i;
 
-	encrypt_block(state, output, nonce);
-
-	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	for (i = 0; i < 4; ++i)
 	{
-		output[i] ^= input[i];
+		standard_expand(&states[i], &keyparams[i]);
 	}
-
-	increment_be8(nonce);
 }
 
-void rsx_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input)
+static void block_double(uint8_t* output, const uint8_t* input)
 {
-	decrypt_block(state, output, input);
+	uint64_t hi;
+	uint64_t lo;
+	uint64_t carry;
+
+	/* multiplies by x in GF(2^128), with the big endian convention of CMAC, OCB, and PMAC */
+	hi = load_be64(input, 0);
+	lo = load_be64(input, 8);
+	carry = hi >> 63;
+	hi = (hi << 1) | (lo >> 63);
+	lo = (lo << 1) ^ (0x87 & (0 - carry));
+	be64_to_bytes(hi, output, 0);
+	be64_to_bytes(lo, output, 8);
 }
 
-void rsx_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input)
+static void xts_double(uint8_t* tweak)
 {
-	encrypt_block(state, output, input);
+	uint64_t hi;
+	uint64_t lo;
+	uint64_t carry;
+
+	/* multiplies the tweak by x in GF(2^128), the little endian convention of IEEE 1619 */
+	lo = load_le64(tweak, 0);
+	hi = load_le64(tweak, 8);
+	carry = hi >> 63;
+	hi = (hi << 1) | (lo >> 63);
+	lo = (lo << 1) ^ (0x87 & (0 - carry));
+	le64_to_bytes(lo, tweak, 0);
+	le64_to_bytes(hi, tweak, 8);
 }
 
-mqc_status rsx_initialize(rsx_state* state, rsx_keyparams* keyparams, bool encryption)
+static void xts_blocks(void (*ecb)(rsx_state*, uint8_t*, const uint8_t*, size_t), rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
 {
-	mqc_status status;
-
-	status = MQC_STATUS_FAILURE;
+	uint8_t tweaks[RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE];
+	size_t blen;
+	size_t i;
 
-	if (state->rkeylen == RSX256_ROUNDKEY_DIMENSION)
-	{
-		secure_expand(state, keyparams);
-	}
-	else if (state->rkeylen == RSX512_ROUNDKEY_DIMENSION)
+	/* a batch of tweaks whitens the input, the batch runs through the multi-block cipher in place, and the tweaks are added again */
+	while (length >= RSX_BLOCK_SIZE)
 	{
-		secure_expand(state, keyparams);
+		blen = length - (length % RSX_BLOCK_SIZE);
+		blen = (blen > sizeof(tweaks)) ? sizeof(tweaks) : blen;
+
+		for (i = 0; i < blen; i += RSX_BLOCK_SIZE)
+		{
+			memcpy(tweaks + i, tweak, RSX_BLOCK_SIZE);
+			xts_double(tweak);
+		}
+
+		for (i = 0; i < blen; ++i)
+		{
+			output[i] = input[i] ^ tweaks[i];
+		}
+
+		ecb(state, output, output, blen);
+
+		for (i = 0; i < blen; ++i)
+		{
+			output[i] ^= tweaks[i];
+		}
+
+		input += blen;
+		output += blen;
+		length -= blen;
 	}
-	else if (state->rkeylen == AES256_ROUNDKEY_DIMENSION)
+}
+
+static size_t ocb_ntz(uint64_t index)
+{
+	/* the number of trailing zeros of a block index, which is public and never zero */
+#if defined(__GNUC__)
+	return (size_t)__builtin_ctzll(index);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long n;
+
+	_BitScanForward64(&n, index);
+
+	return (size_t)n;
+#else
+	size_t n;
+
+	n = 0;
+
+	while ((index & 1) == 0)
 	{
-		standard_expand(state, keyparams);
+		index >>= 1;
+		++n;
 	}
-	else if (state->rkeylen == AES128_ROUNDKEY_DIMENSION)
+
+	return n;
+#endif
+}
+
+static void ocb_blocks(void (*ecb)(rsx_state*, uint8_t*, const uint8_t*, size_t), rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index, bool encryption)
+{
+	uint8_t offsets[RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE];
+	const uint8_t* lval;
+	size_t blen;
+	size_t i;
+	size_t j;
+
+	/* a batch of offsets whitens the input, the batch runs through the multi-block cipher in place, and the offsets are added again */
+	while (length >= RSX_BLOCK_SIZE)
 	{
-		standard_expand(state, keyparams);
+		blen = length - (length % RSX_BLOCK_SIZE);
+		blen = (blen > sizeof(offsets)) ? sizeof(offsets) : blen;
+
+		for (i = 0; i < blen; i += RSX_BLOCK_SIZE)
+		{
+			++index;
+			lval = ltable[ocb_ntz(index)].bytes;
+
+			for (j = 0; j < RSX_BLOCK_SIZE; ++j)
+			{
+				offset[j] ^= lval[j];
+				offsets[i + j] = offset[j];
+			}
+		}
+
+		for (i = 0; i < blen; ++i)
+		{
+			if (encryption == true)
+			{
+				checksum[i % RSX_BLOCK_SIZE] ^= input[i];
+			}
+
+			output[i] = input[i] ^ offsets[i];
+		}
+
+		ecb(state, output, output, blen);
+
+		for (i = 0; i < blen; ++i)
+		{
+			output[i] ^= offsets[i];
+
+			if (encryption == false)
+			{
+				checksum[i % RSX_BLOCK_SIZE] ^= output[i];
+			}
+		}
+
+		input += blen;
+		output += blen;
+		length -= blen;
 	}
-	else
+}
+
+static void mac_blocks(void (*encrypt_block)(rsx_state*, uint8_t*, const uint8_t*), rsx_state* state, uint8_t* mac, const uint8_t* input, size_t length)
+{
+	size_t i;
+
+	while (length >= RSX_BLOCK_SIZE)
 	{
-		state->rkeylen = 0;
-		status = MQC_ERROR_INVALID;
+		for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+		{
+			mac[i] ^= input[i];
+		}
+
+		encrypt_block(state, mac, mac);
+		input += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
 	}
+}
 
-	// inverse cipher
-	if (encryption == false && state->rkeylen != 0)
+static void pmac_blocks(void (*ecb)(rsx_state*, uint8_t*, const uint8_t*, size_t), rsx_state* state, const rsx_roundkey* ltable, uint8_t* offset, uint8_t* sum, const uint8_t* input, size_t length, uint64_t index)
+{
+	uint8_t blocks[RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE];
+	const uint8_t* lval;
+	size_t blen;
+	size_t i;
+	size_t j;
+
+	/* a batch of offset blocks runs through the multi-block cipher, and the cipher outputs are summed */
+	while (length >= RSX_BLOCK_SIZE)
 	{
-		size_t i;
-		size_t j;
-		__m128i tmp;
+		blen = length - (length % RSX_BLOCK_SIZE);
+		blen = (blen > sizeof(blocks)) ? sizeof(blocks) : blen;
+
+		for (i = 0; i < blen; i += RSX_BLOCK_SIZE)
+		{
+			++index;
+			lval = ltable[ocb_ntz(index)].bytes;
+
+			for (j = 0; j < RSX_BLOCK_SIZE; ++j)
+			{
+				offset[j] ^= lval[j];
+				blocks[i + j] = input[i + j] ^ offset[j];
+			}
+		}
 
-		tmp = state->roundkeys[0];
-		state->roundkeys[0] = state->roundkeys[state->rkeylen - 1];
-		state->roundkeys[state->rkeylen - 1] = tmp;
+		ecb(state, blocks, blocks, blen);
 
-		for (i = 1, j = state->rkeylen - 2; i < j; ++i, --j)
+		for (i = 0; i < blen; ++i)
 		{
-			tmp = _mm_aesimc_si128(state->roundkeys[i]);
-			state->roundkeys[i] = _mm_aesimc_si128(state->roundkeys[j]);
-			state->roundkeys[j] = tmp;
+			sum[i % RSX_BLOCK_SIZE] ^= blocks[i];
 		}
 
-		state->roundkeys[i] = _mm_aesimc_si128(state->roundkeys[i]);
+		input += blen;
+		length -= blen;
 	}
 
-	return status;
+	memset(blocks, 0, sizeof(blocks));
 }
 
-#else
-
 /* Constant Tables */
 
 static const uint32_t rcon[30] =
@@ -646,110 +914,113 @@ static uint32_t sub_byte(uint32_t rot)
 	return result | ((uint32_t)(s_box[value]) << 24);
 }
 
-static void decrypt_block(uint8_t* output, const uint8_t* input, const uint32_t* roundkeys, size_t rlen)
+static void table_decrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
 {
-	const size_t RNDCNT = rlen - 4;
+	/* the round keys are read as big endian words */
+	const uint8_t* rk = state->roundkeys[0].bytes;
+	const size_t RNDCNT = (state->rkeylen * 4) - 4;
 
 	// round 0
-	uint32_t x0 = load_be32(input, 0) ^ roundkeys[0];
-	uint32_t x1 = load_be32(input, 4) ^ roundkeys[1];
-	uint32_t x2 = load_be32(input, 8) ^ roundkeys[2];
-	uint32_t x3 = load_be32(input, 12) ^ roundkeys[3];
+	uint32_t x0 = load_be32(input, 0) ^ load_be32(rk, 0);
+	uint32_t x1 = load_be32(input, 4) ^ load_be32(rk, 4);
+	uint32_t x2 = load_be32(input, 8) ^ load_be32(rk, 8);
+	uint32_t x3 = load_be32(input, 12) ^ load_be32(rk, 12);
 
 	// round 1
-	uint32_t y0 = it_0[(x0 >> 24)] ^ it_1[(uint8_t)(x3 >> 16)] ^ it_2[(uint8_t)(x2 >> 8)] ^ it_3[(uint8_t)x1] ^ roundkeys[4];
-	uint32_t y1 = it_0[(x1 >> 24)] ^ it_1[(uint8_t)(x0 >> 16)] ^ it_2[(uint8_t)(x3 >> 8)] ^ it_3[(uint8_t)x2] ^ roundkeys[5];
-	uint32_t y2 = it_0[(x2 >> 24)] ^ it_1[(uint8_t)(x1 >> 16)] ^ it_2[(uint8_t)(x0 >> 8)] ^ it_3[(uint8_t)x3] ^ roundkeys[6];
-	uint32_t y3 = it_0[(x3 >> 24)] ^ it_1[(uint8_t)(x2 >> 16)] ^ it_2[(uint8_t)(x1 >> 8)] ^ it_3[(uint8_t)x0] ^ roundkeys[7];
+	uint32_t y0 = it_0[(x0 >> 24)] ^ it_1[(uint8_t)(x3 >> 16)] ^ it_2[(uint8_t)(x2 >> 8)] ^ it_3[(uint8_t)x1] ^ load_be32(rk, 16);
+	uint32_t y1 = it_0[(x1 >> 24)] ^ it_1[(uint8_t)(x0 >> 16)] ^ it_2[(uint8_t)(x3 >> 8)] ^ it_3[(uint8_t)x2] ^ load_be32(rk, 20);
+	uint32_t y2 = it_0[(x2 >> 24)] ^ it_1[(uint8_t)(x1 >> 16)] ^ it_2[(uint8_t)(x0 >> 8)] ^ it_3[(uint8_t)x3] ^ load_be32(rk, 24);
+	uint32_t y3 = it_0[(x3 >> 24)] ^ it_1[(uint8_t)(x2 >> 16)] ^ it_2[(uint8_t)(x1 >> 8)] ^ it_3[(uint8_t)x0] ^ load_be32(rk, 28);
 
 	size_t keyCtr = 8;
 	// rounds loop
 	while (keyCtr != RNDCNT)
 	{
-		x0 = it_0[(y0 >> 24)] ^ it_1[(uint8_t)(y3 >> 16)] ^ it_2[(uint8_t)(y2 >> 8)] ^ it_3[(uint8_t)y1] ^ roundkeys[keyCtr];
-		x1 = it_0[(y1 >> 24)] ^ it_1[(uint8_t)(y0 >> 16)] ^ it_2[(uint8_t)(y3 >> 8)] ^ it_3[(uint8_t)y2] ^ roundkeys[keyCtr + 1];
-		x2 = it_0[(y2 >> 24)] ^ it_1[(uint8_t)(y1 >> 16)] ^ it_2[(uint8_t)(y0 >> 8)] ^ it_3[(uint8_t)y3] ^ roundkeys[keyCtr + 2];
-		x3 = it_0[(y3 >> 24)] ^ it_1[(uint8_t)(y2 >> 16)] ^ it_2[(uint8_t)(y1 >> 8)] ^ it_3[(uint8_t)y0] ^ roundkeys[keyCtr + 3];
+		x0 = it_0[(y0 >> 24)] ^ it_1[(uint8_t)(y3 >> 16)] ^ it_2[(uint8_t)(y2 >> 8)] ^ it_3[(uint8_t)y1] ^ load_be32(rk, keyCtr * 4);
+		x1 = it_0[(y1 >> 24)] ^ it_1[(uint8_t)(y0 >> 16)] ^ it_2[(uint8_t)(y3 >> 8)] ^ it_3[(uint8_t)y2] ^ load_be32(rk, (keyCtr + 1) * 4);
+		x2 = it_0[(y2 >> 24)] ^ it_1[(uint8_t)(y1 >> 16)] ^ it_2[(uint8_t)(y0 >> 8)] ^ it_3[(uint8_t)y3] ^ load_be32(rk, (keyCtr + 2) * 4);
+		x3 = it_0[(y3 >> 24)] ^ it_1[(uint8_t)(y2 >> 16)] ^ it_2[(uint8_t)(y1 >> 8)] ^ it_3[(uint8_t)y0] ^ load_be32(rk, (keyCtr + 3) * 4);
 
-		y0 = it_0[(x0 >> 24)] ^ it_1[(uint8_t)(x3 >> 16)] ^ it_2[(uint8_t)(x2 >> 8)] ^ it_3[(uint8_t)x1] ^ roundkeys[keyCtr + 4];
-		y1 = it_0[(x1 >> 24)] ^ it_1[(uint8_t)(x0 >> 16)] ^ it_2[(uint8_t)(x3 >> 8)] ^ it_3[(uint8_t)x2] ^ roundkeys[keyCtr + 5];
-		y2 = it_0[(x2 >> 24)] ^ it_1[(uint8_t)(x1 >> 16)] ^ it_2[(uint8_t)(x0 >> 8)] ^ it_3[(uint8_t)x3] ^ roundkeys[keyCtr + 6];
-		y3 = it_0[(x3 >> 24)] ^ it_1[(uint8_t)(x2 >> 16)] ^ it_2[(uint8_t)(x1 >> 8)] ^ it_3[(uint8_t)x0] ^ roundkeys[keyCtr + 7];
+		y0 = it_0[(x0 >> 24)] ^ it_1[(uint8_t)(x3 >> 16)] ^ it_2[(uint8_t)(x2 >> 8)] ^ it_3[(uint8_t)x1] ^ load_be32(rk, (keyCtr + 4) * 4);
+		y1 = it_0[(x1 >> 24)] ^ it_1[(uint8_t)(x0 >> 16)] ^ it_2[(uint8_t)(x3 >> 8)] ^ it_3[(uint8_t)x2] ^ load_be32(rk, (keyCtr + 5) * 4);
+		y2 = it_0[(x2 >> 24)] ^ it_1[(uint8_t)(x1 >> 16)] ^ it_2[(uint8_t)(x0 >> 8)] ^ it_3[(uint8_t)x3] ^ load_be32(rk, (keyCtr + 6) * 4);
+		y3 = it_0[(x3 >> 24)] ^ it_1[(uint8_t)(x2 >> 16)] ^ it_2[(uint8_t)(x1 >> 8)] ^ it_3[(uint8_t)x0] ^ load_be32(rk, (keyCtr + 7) * 4);
 		keyCtr += 8;
 	}
 
 	// final round
-	output[0] = (uint8_t)(is_box[(uint8_t)(y0 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[1] = (uint8_t)(is_box[(uint8_t)(y3 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[2] = (uint8_t)(is_box[(uint8_t)(y2 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[3] = (uint8_t)(is_box[(uint8_t)y1] ^ (uint8_t)roundkeys[keyCtr]);
+	output[0] = (uint8_t)(is_box[(uint8_t)(y0 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[1] = (uint8_t)(is_box[(uint8_t)(y3 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[2] = (uint8_t)(is_box[(uint8_t)(y2 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[3] = (uint8_t)(is_box[(uint8_t)y1] ^ rk[(keyCtr * 4) + 3]);
 	++keyCtr;
-	output[4] = (uint8_t)(is_box[(uint8_t)(y1 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[5] = (uint8_t)(is_box[(uint8_t)(y0 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[6] = (uint8_t)(is_box[(uint8_t)(y3 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[7] = (uint8_t)(is_box[(uint8_t)y2] ^ (uint8_t)roundkeys[keyCtr]);
+	output[4] = (uint8_t)(is_box[(uint8_t)(y1 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[5] = (uint8_t)(is_box[(uint8_t)(y0 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[6] = (uint8_t)(is_box[(uint8_t)(y3 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[7] = (uint8_t)(is_box[(uint8_t)y2] ^ rk[(keyCtr * 4) + 3]);
 	++keyCtr;
-	output[8] = (uint8_t)(is_box[(uint8_t)(y2 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[9] = (uint8_t)(is_box[(uint8_t)(y1 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[10] = (uint8_t)(is_box[(uint8_t)(y0 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[11] = (uint8_t)(is_box[(uint8_t)y3] ^ (uint8_t)(roundkeys[keyCtr]));
+	output[8] = (uint8_t)(is_box[(uint8_t)(y2 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[9] = (uint8_t)(is_box[(uint8_t)(y1 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[10] = (uint8_t)(is_box[(uint8_t)(y0 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[11] = (uint8_t)(is_box[(uint8_t)y3] ^ rk[(keyCtr * 4) + 3]);
 	++keyCtr;
-	output[12] = (uint8_t)(is_box[(uint8_t)(y3 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[13] = (uint8_t)(is_box[(uint8_t)(y2 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[14] = (uint8_t)(is_box[(uint8_t)(y1 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[15] = (uint8_t)(is_box[(uint8_t)y0] ^ (uint8_t)roundkeys[keyCtr]);
+	output[12] = (uint8_t)(is_box[(uint8_t)(y3 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[13] = (uint8_t)(is_box[(uint8_t)(y2 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[14] = (uint8_t)(is_box[(uint8_t)(y1 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[15] = (uint8_t)(is_box[(uint8_t)y0] ^ rk[(keyCtr * 4) + 3]);
 }
 
-static void encrypt_block(uint8_t* output, const uint8_t* input, const uint32_t* roundkeys, size_t rlen)
+static void table_encrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
 {
-	const size_t RNDCNT = rlen - 4;
+	const uint8_t* rk = state->roundkeys[0].bytes;
+	const size_t RNDCNT = (state->rkeylen * 4) - 4;
 
 	// round 0
-	uint32_t x0 = load_be32(input, 0) ^ roundkeys[0];
-	uint32_t x1 = load_be32(input, 4) ^ roundkeys[1];
-	uint32_t x2 = load_be32(input, 8) ^ roundkeys[2];
-	uint32_t x3 = load_be32(input, 12) ^ roundkeys[3];
+	uint32_t x0 = load_be32(input, 0) ^ load_be32(rk, 0);
+	uint32_t x1 = load_be32(input, 4) ^ load_be32(rk, 4);
+	uint32_t x2 = load_be32(input, 8) ^ load_be32(rk, 8);
+	uint32_t x3 = load_be32(input, 12) ^ load_be32(rk, 12);
 
 	// round 1
-	uint32_t y0 = t_0[(uint8_t)(x0 >> 24)] ^ t_1[(uint8_t)(x1 >> 16)] ^ t_2[(uint8_t)(x2 >> 8)] ^ t_3[(uint8_t)x3] ^ roundkeys[4];
-	uint32_t y1 = t_0[(uint8_t)(x1 >> 24)] ^ t_1[(uint8_t)(x2 >> 16)] ^ t_2[(uint8_t)(x3 >> 8)] ^ t_3[(uint8_t)x0] ^ roundkeys[5];
-	uint32_t y2 = t_0[(uint8_t)(x2 >> 24)] ^ t_1[(uint8_t)(x3 >> 16)] ^ t_2[(uint8_t)(x0 >> 8)] ^ t_3[(uint8_t)x1] ^ roundkeys[6];
-	uint32_t y3 = t_0[(uint8_t)(x3 >> 24)] ^ t_1[(uint8_t)(x0 >> 16)] ^ t_2[(uint8_t)(x1 >> 8)] ^ t_3[(uint8_t)x2] ^ roundkeys[7];
+	uint32_t y0 = t_0[(uint8_t)(x0 >> 24)] ^ t_1[(uint8_t)(x1 >> 16)] ^ t_2[(uint8_t)(x2 >> 8)] ^ t_3[(uint8_t)x3] ^ load_be32(rk, 16);
+	uint32_t y1 = t_0[(uint8_t)(x1 >> 24)] ^ t_1[(uint8_t)(x2 >> 16)] ^ t_2[(uint8_t)(x3 >> 8)] ^ t_3[(uint8_t)x0] ^ load_be32(rk, 20);
+	uint32_t y2 = t_0[(uint8_t)(x2 >> 24)] ^ t_1[(uint8_t)(x3 >> 16)] ^ t_2[(uint8_t)(x0 >> 8)] ^ t_3[(uint8_t)x1] ^ load_be32(rk, 24);
+	uint32_t y3 = t_0[(uint8_t)(x3 >> 24)] ^ t_1[(uint8_t)(x0 >> 16)] ^ t_2[(uint8_t)(x1 >> 8)] ^ t_3[(uint8_t)x2] ^ load_be32(rk, 28);
 
 	size_t keyCtr = 8;
 	while (keyCtr != RNDCNT)
 	{
-		x0 = t_0[(uint8_t)(y0 >> 24)] ^ t_1[(uint8_t)(y1 >> 16)] ^ t_2[(uint8_t)(y2 >> 8)] ^ t_3[(uint8_t)y3] ^ roundkeys[keyCtr];
-		x1 = t_0[(uint8_t)(y1 >> 24)] ^ t_1[(uint8_t)(y2 >> 16)] ^ t_2[(uint8_t)(y3 >> 8)] ^ t_3[(uint8_t)y0] ^ roundkeys[keyCtr + 1];
-		x2 = t_0[(uint8_t)(y2 >> 24)] ^ t_1[(uint8_t)(y3 >> 16)] ^ t_2[(uint8_t)(y0 >> 8)] ^ t_3[(uint8_t)y1] ^ roundkeys[keyCtr + 2];
-		x3 = t_0[(uint8_t)(y3 >> 24)] ^ t_1[(uint8_t)(y0 >> 16)] ^ t_2[(uint8_t)(y1 >> 8)] ^ t_3[(uint8_t)y2] ^ roundkeys[keyCtr + 3];
-		y0 = t_0[(uint8_t)(x0 >> 24)] ^ t_1[(uint8_t)(x1 >> 16)] ^ t_2[(uint8_t)(x2 >> 8)] ^ t_3[(uint8_t)x3] ^ roundkeys[keyCtr + 4];
-		y1 = t_0[(uint8_t)(x1 >> 24)] ^ t_1[(uint8_t)(x2 >> 16)] ^ t_2[(uint8_t)(x3 >> 8)] ^ t_3[(uint8_t)x0] ^ roundkeys[keyCtr + 5];
-		y2 = t_0[(uint8_t)(x2 >> 24)] ^ t_1[(uint8_t)(x3 >> 16)] ^ t_2[(uint8_t)(x0 >> 8)] ^ t_3[(uint8_t)x1] ^ roundkeys[keyCtr + 6];
-		y3 = t_0[(uint8_t)(x3 >> 24)] ^ t_1[(uint8_t)(x0 >> 16)] ^ t_2[(uint8_t)(x1 >> 8)] ^ t_3[(uint8_t)x2] ^ roundkeys[keyCtr + 7];
+		x0 = t_0[(uint8_t)(y0 >> 24)] ^ t_1[(uint8_t)(y1 >> 16)] ^ t_2[(uint8_t)(y2 >> 8)] ^ t_3[(uint8_t)y3] ^ load_be32(rk, keyCtr * 4);
+		x1 = t_0[(uint8_t)(y1 >> 24)] ^ t_1[(uint8_t)(y2 >> 16)] ^ t_2[(uint8_t)(y3 >> 8)] ^ t_3[(uint8_t)y0] ^ load_be32(rk, (keyCtr + 1) * 4);
+		x2 = t_0[(uint8_t)(y2 >> 24)] ^ t_1[(uint8_t)(y3 >> 16)] ^ t_2[(uint8_t)(y0 >> 8)] ^ t_3[(uint8_t)y1] ^ load_be32(rk, (keyCtr + 2) * 4);
+		x3 = t_0[(uint8_t)(y3 >> 24)] ^ t_1[(uint8_t)(y0 >> 16)] ^ t_2[(uint8_t)(y1 >> 8)] ^ t_3[(uint8_t)y2] ^ load_be32(rk, (keyCtr + 3) * 4);
+		y0 = t_0[(uint8_t)(x0 >> 24)] ^ t_1[(uint8_t)(x1 >> 16)] ^ t_2[(uint8_t)(x2 >> 8)] ^ t_3[(uint8_t)x3] ^ load_be32(rk, (keyCtr + 4) * 4);
+		y1 = t_0[(uint8_t)(x1 >> 24)] ^ t_1[(uint8_t)(x2 >> 16)] ^ t_2[(uint8_t)(x3 >> 8)] ^ t_3[(uint8_t)x0] ^ load_be32(rk, (keyCtr + 5) * 4);
+		y2 = t_0[(uint8_t)(x2 >> 24)] ^ t_1[(uint8_t)(x3 >> 16)] ^ t_2[(uint8_t)(x0 >> 8)] ^ t_3[(uint8_t)x1] ^ load_be32(rk, (keyCtr + 6) * 4);
+		y3 = t_0[(uint8_t)(x3 >> 24)] ^ t_1[(uint8_t)(x0 >> 16)] ^ t_2[(uint8_t)(x1 >> 8)] ^ t_3[(uint8_t)x2] ^ load_be32(rk, (keyCtr + 7) * 4);
 		keyCtr += 8;
 	}
 
 	// final round
-	output[0] = (uint8_t)(s_box[(uint8_t)(y0 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[1] = (uint8_t)(s_box[(uint8_t)(y1 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[2] = (uint8_t)(s_box[(uint8_t)(y2 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[3] = (uint8_t)(s_box[(uint8_t)(y3)] ^ (uint8_t)(roundkeys[keyCtr]));
+	output[0] = (uint8_t)(s_box[(uint8_t)(y0 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[1] = (uint8_t)(s_box[(uint8_t)(y1 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[2] = (uint8_t)(s_box[(uint8_t)(y2 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[3] = (uint8_t)(s_box[(uint8_t)(y3)] ^ rk[(keyCtr * 4) + 3]);
 	++keyCtr;
-	output[4] = (uint8_t)(s_box[(uint8_t)(y1 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[5] = (uint8_t)(s_box[(uint8_t)(y2 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[6] = (uint8_t)(s_box[(uint8_t)(y3 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[7] = (uint8_t)(s_box[(uint8_t)(y0)] ^ (uint8_t)(roundkeys[keyCtr]));
+	output[4] = (uint8_t)(s_box[(uint8_t)(y1 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[5] = (uint8_t)(s_box[(uint8_t)(y2 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[6] = (uint8_t)(s_box[(uint8_t)(y3 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[7] = (uint8_t)(s_box[(uint8_t)(y0)] ^ rk[(keyCtr * 4) + 3]);
 	++keyCtr;
-	output[8] = (uint8_t)(s_box[(uint8_t)(y2 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[9] = (uint8_t)(s_box[(uint8_t)(y3 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[10] = (uint8_t)(s_box[(uint8_t)(y0 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[11] = (uint8_t)(s_box[(uint8_t)(y1)] ^ (uint8_t)(roundkeys[keyCtr]));
+	output[8] = (uint8_t)(s_box[(uint8_t)(y2 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[9] = (uint8_t)(s_box[(uint8_t)(y3 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[10] = (uint8_t)(s_box[(uint8_t)(y0 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[11] = (uint8_t)(s_box[(uint8_t)(y1)] ^ rk[(keyCtr * 4) + 3]);
 	++keyCtr;
-	output[12] = (uint8_t)(s_box[(uint8_t)(y3 >> 24)] ^ (uint8_t)(roundkeys[keyCtr] >> 24));
-	output[13] = (uint8_t)(s_box[(uint8_t)(y0 >> 16)] ^ (uint8_t)(roundkeys[keyCtr] >> 16));
-	output[14] = (uint8_t)(s_box[(uint8_t)(y1 >> 8)] ^ (uint8_t)(roundkeys[keyCtr] >> 8));
-	output[15] = (uint8_t)(s_box[(uint8_t)(y2)] ^ (uint8_t)(roundkeys[keyCtr]));
+	output[12] = (uint8_t)(s_box[(uint8_t)(y3 >> 24)] ^ rk[(keyCtr * 4) + 0]);
+	output[13] = (uint8_t)(s_box[(uint8_t)(y0 >> 16)] ^ rk[(keyCtr * 4) + 1]);
+	output[14] = (uint8_t)(s_box[(uint8_t)(y1 >> 8)] ^ rk[(keyCtr * 4) + 2]);
+	output[15] = (uint8_t)(s_box[(uint8_t)(y2)] ^ rk[(keyCtr * 4) + 3]);
 }
 
 static void expand_rot(uint32_t* key, size_t keyindex, size_t keyoffset, size_t rconindex)
@@ -783,7 +1054,6 @@ static void expand_sub(uint32_t* key, size_t keyindex, size_t keyoffset)
 	key[keyindex] = key[subkey] ^ key[keyindex - 1];
 }
 
-#if defined(RSX_PREFETCH_TABLES)
 static void prefetch_tables(bool encryption)
 {
 	size_t i;
@@ -830,7 +1100,7 @@ static void prefetch_tables(bool encryption)
 		}
 		for (i = 0; i < 256; i++)
 		{
-			dummy += t_3[i];
+			dummy += it_3[i];
 		}
 		for (i = 0; i < 256; i++)
 		{
@@ -838,125 +1108,5889 @@ static void prefetch_tables(bool encryption)
 		}
 	}
 }
-#endif
-
-static void secure_expand(rsx_state* state, rsx_keyparams* keyparams)
-{
-	cshake256((uint8_t*)state->roundkeys, state->rkeylen * sizeof(uint32_t), keyparams->key, keyparams->keylen, NULL, 0, keyparams->distcode, keyparams->codelen);
-}
 
-static void standard_expand(rsx_state* state, rsx_keyparams* keyparams)
+static void table_standard_expand(rsx_state* state, rsx_keyparams* keyparams)
 {
+	uint32_t rk[AES256_ROUNDKEY_DIMENSION * 4];
+	size_t i;
 	// key in 32 bit words
 	size_t kwords = keyparams->keylen / 4;
 
 	if (kwords == 8)
 	{
-		state->roundkeys[0] = load_be32(keyparams->key, 0);
-		state->roundkeys[1] = load_be32(keyparams->key, 4);
-		state->roundkeys[2] = load_be32(keyparams->key, 8);
-		state->roundkeys[3] = load_be32(keyparams->key, 12);
-		state->roundkeys[4] = load_be32(keyparams->key, 16);
-		state->roundkeys[5] = load_be32(keyparams->key, 20);
-		state->roundkeys[6] = load_be32(keyparams->key, 24);
-		state->roundkeys[7] = load_be32(keyparams->key, 28);
+		rk[0] = load_be32(keyparams->key, 0);
+		rk[1] = load_be32(keyparams->key, 4);
+		rk[2] = load_be32(keyparams->key, 8);
+		rk[3] = load_be32(keyparams->key, 12);
+		rk[4] = load_be32(keyparams->key, 16);
+		rk[5] = load_be32(keyparams->key, 20);
+		rk[6] = load_be32(keyparams->key, 24);
+		rk[7] = load_be32(keyparams->key, 28);
 
 		// k256 R: 8,16,24,32,40,48,56 S: 12,20,28,36,44,52
-		expand_rot(state->roundkeys, 8, 8, 1);
-		expand_sub(state->roundkeys, 12, 8);
-		expand_rot(state->roundkeys, 16, 8, 2);
-		expand_sub(state->roundkeys, 20, 8);
-		expand_rot(state->roundkeys, 24, 8, 3);
-		expand_sub(state->roundkeys, 28, 8);
-		expand_rot(state->roundkeys, 32, 8, 4);
-		expand_sub(state->roundkeys, 36, 8);
-		expand_rot(state->roundkeys, 40, 8, 5);
-		expand_sub(state->roundkeys, 44, 8);
-		expand_rot(state->roundkeys, 48, 8, 6);
-		expand_sub(state->roundkeys, 52, 8);
-		expand_rot(state->roundkeys, 56, 8, 7);
+		expand_rot(rk, 8, 8, 1);
+		expand_sub(rk, 12, 8);
+		expand_rot(rk, 16, 8, 2);
+		expand_sub(rk, 20, 8);
+		expand_rot(rk, 24, 8, 3);
+		expand_sub(rk, 28, 8);
+		expand_rot(rk, 32, 8, 4);
+		expand_sub(rk, 36, 8);
+		expand_rot(rk, 40, 8, 5);
+		expand_sub(rk, 44, 8);
+		expand_rot(rk, 48, 8, 6);
+		expand_sub(rk, 52, 8);
+		expand_rot(rk, 56, 8, 7);
 	}
 	else
 	{
-		state->roundkeys[0] = load_be32(keyparams->key, 0);
-		state->roundkeys[1] = load_be32(keyparams->key, 4);
-		state->roundkeys[2] = load_be32(keyparams->key, 8);
-		state->roundkeys[3] = load_be32(keyparams->key, 12);
+		rk[0] = load_be32(keyparams->key, 0);
+		rk[1] = load_be32(keyparams->key, 4);
+		rk[2] = load_be32(keyparams->key, 8);
+		rk[3] = load_be32(keyparams->key, 12);
 
 		// k128 R: 4,8,12,16,20,24,28,32,36,40
-		expand_rot(state->roundkeys, 4, 4, 1);
-		expand_rot(state->roundkeys, 8, 4, 2);
-		expand_rot(state->roundkeys, 12, 4, 3);
-		expand_rot(state->roundkeys, 16, 4, 4);
-		expand_rot(state->roundkeys, 20, 4, 5);
-		expand_rot(state->roundkeys, 24, 4, 6);
-		expand_rot(state->roundkeys, 28, 4, 7);
-		expand_rot(state->roundkeys, 32, 4, 8);
-		expand_rot(state->roundkeys, 36, 4, 9);
-		expand_rot(state->roundkeys, 40, 4, 10);
+		expand_rot(rk, 4, 4, 1);
+		expand_rot(rk, 8, 4, 2);
+		expand_rot(rk, 12, 4, 3);
+		expand_rot(rk, 16, 4, 4);
+		expand_rot(rk, 20, 4, 5);
+		expand_rot(rk, 24, 4, 6);
+		expand_rot(rk, 28, 4, 7);
+		expand_rot(rk, 32, 4, 8);
+		expand_rot(rk, 36, 4, 9);
+		expand_rot(rk, 40, 4, 10);
+	}
+
+	for (i = 0; i < state->rkeylen * 4; ++i)
+	{
+		be32_to_bytes(rk[i], state->roundkeys[i / 4].bytes, (i % 4) * 4);
 	}
+
+	memset(rk, 0x00, sizeof(rk));
 }
 
-/* Public API */
+static void table_standard_expand_x4(rsx_state* states, rsx_keyparams* keyparams)
+{
+	expand_x4(table_standard_expand, states, keyparams);
+}
 
-void rsx_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input)
+static void table_inverse_expand(rsx_state* state)
 {
+	rsx_roundkey tmpk;
+	uint32_t w;
 	size_t i;
-	uint8_t tmpv[RSX_BLOCK_SIZE];
-
-	memcpy(&tmpv[0], &input[0], RSX_BLOCK_SIZE);
-	decrypt_block(output, input, state->roundkeys, state->rkeylen);
+	size_t j;
 
-	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	// reverse key
+	for (i = 0, j = state->rkeylen - 1; i < j; ++i, --j)
+	{
+		tmpk = state->roundkeys[i];
+		state->roundkeys[i] = state->roundkeys[j];
+		state->roundkeys[j] = tmpk;
+	}
+
+	// sbox inversion
+	for (i = 1; i < state->rkeylen - 1; ++i)
+	{
+		for (j = 0; j < RSX_BLOCK_SIZE; j += 4)
+		{
+			w = load_be32(state->roundkeys[i].bytes, j);
+			w = it_0[s_box[(w >> 24)]] ^
+				it_1[s_box[(uint8_t)(w >> 16)]] ^
+				it_2[s_box[(uint8_t)(w >> 8)]] ^
+				it_3[s_box[(uint8_t)w]];
+			be32_to_bytes(w, state->roundkeys[i].bytes, j);
+		}
+	}
+
+	memset(&tmpk, 0x00, sizeof(tmpk));
+}
+
+static void table_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length)
+{
+	uint8_t tmpv[RSX_BLOCK_SIZE];
+	size_t blocks;
+	size_t i;
+	size_t j;
+
+	blocks = length / RSX_BLOCK_SIZE;
+
+	if (blocks != 0)
+	{
+		/* walk the chain backwards; the previous cipher-text block is still intact
+		   when it is needed, so no per-block copy of the chaining value is required */
+		memcpy(&tmpv[0], &input[(blocks - 1) * RSX_BLOCK_SIZE], RSX_BLOCK_SIZE);
+
+		for (i = blocks - 1; i > 0; --i)
+		{
+			table_decrypt_block(state, output + (i * RSX_BLOCK_SIZE), input + (i * RSX_BLOCK_SIZE));
+
+			for (j = 0; j < RSX_BLOCK_SIZE; j++)
+			{
+				output[(i * RSX_BLOCK_SIZE) + j] ^= input[((i - 1) * RSX_BLOCK_SIZE) + j];
+			}
+		}
+
+		table_decrypt_block(state, output, input);
+
+		for (j = 0; j < RSX_BLOCK_SIZE; j++)
+		{
+			output[j] ^= iv[j];
+		}
+
+		memcpy(&iv[0], &tmpv[0], RSX_BLOCK_SIZE);
+	}
+}
+
+static void table_cbc_mac(rsx_state* state, uint8_t* mac, const uint8_t* input, size_t length)
+{
+	mac_blocks(table_encrypt_block, state, mac, input, length);
+}
+
+static void table_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t i;
+
+	/* the keystream goes through a temporary block, so the output can overwrite the input */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		table_encrypt_block(state, tmpb, nonce);
+
+		for (i = 0; i < RSX_BLOCK_SIZE; i++)
+		{
+			output[i] = tmpb[i] ^ input[i];
+		}
+
+		increment_be8(nonce);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+static void table_ccm_decrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	ccm_blocks(table_encrypt_block, table_ctr_transform, state, mac, output, ctr, input, length, false);
+}
+
+static void table_ccm_encrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	ccm_blocks(table_encrypt_block, table_ctr_transform, state, mac, output, ctr, input, length, true);
+}
+
+static void table_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		table_decrypt_block(state, output, input);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+static void table_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		table_encrypt_block(state, output, input);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+static void table_cbc_encrypt_jobs(rsx_state* state, rsx_cbc_job* jobs, size_t count)
+{
+	cbc_jobs(table_ecb_encrypt, state, jobs, count);
+}
+
+static void table_ctr_keyed(rsx_state* states, const rsx_ctr_packet* packets, size_t count)
+{
+	ctr_keyed(table_ctr_transform, table_encrypt_block, states, packets, count);
+}
+
+static void table_ctr_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count)
+{
+	ctr_packets(table_ecb_encrypt, state, packets, count);
+}
+
+static void table_ocb_decrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	ocb_blocks(table_ecb_decrypt, state, ltable, output, offset, checksum, input, length, index, false);
+}
+
+static void table_ocb_encrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	ocb_blocks(table_ecb_encrypt, state, ltable, output, offset, checksum, input, length, index, true);
+}
+
+static void table_pmac_sum(rsx_state* state, const rsx_roundkey* ltable, uint8_t* offset, uint8_t* sum, const uint8_t* input, size_t length, uint64_t index)
+{
+	pmac_blocks(table_ecb_encrypt, state, ltable, offset, sum, input, length, index);
+}
+
+static void table_xts_decrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	xts_blocks(table_ecb_decrypt, state, output, tweak, input, length);
+}
+
+static void table_xts_encrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	xts_blocks(table_ecb_encrypt, state, output, tweak, input, length);
+}
+
+/* Bitsliced Kernels */
+
+/* The state of four blocks is held in eight 64 bit words, one word per bit of each byte (ortho),
+   two sets of words are processed together, eight blocks per pass. There are no secret dependent
+   memory accesses or branches, the s-box is computed with the Boyar-Peralta circuit.
+   When SSE2 is part of the baseline instruction set, both sets share a 128 bit word (the first set
+   in the low lane), so each logic operation is applied to all eight blocks at once. */
+
+#define RSX_BITSLICE_SETS 2
+
+#if defined(RSX_AESNI_SUPPORTED) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#	define RSX_BITSLICE_SSE2
+	typedef __m128i rsx_bsword;
+	/* the number of words holding the round state */
+#	define RSX_BITSLICE_WORDS 8
+#	define RSX_BS_AND(a, b) _mm_and_si128((a), (b))
+#	define RSX_BS_OR(a, b) _mm_or_si128((a), (b))
+#	define RSX_BS_XOR(a, b) _mm_xor_si128((a), (b))
+#	define RSX_BS_NOT(a) _mm_xor_si128((a), _mm_set1_epi32(-1))
+#	define RSX_BS_SHL(a, n) _mm_slli_epi64((a), (n))
+#	define RSX_BS_SHR(a, n) _mm_srli_epi64((a), (n))
+#	define RSX_BS_ROTR32(a) _mm_shuffle_epi32((a), 0xB1)
+#	define RSX_BS_CONST(c) _mm_set1_epi64x((long long)(c))
+#else
+	typedef uint64_t rsx_bsword;
+#	define RSX_BITSLICE_WORDS (RSX_BITSLICE_SETS * 8)
+#	define RSX_BS_AND(a, b) ((a) & (b))
+#	define RSX_BS_OR(a, b) ((a) | (b))
+#	define RSX_BS_XOR(a, b) ((a) ^ (b))
+#	define RSX_BS_NOT(a) (~(a))
+#	define RSX_BS_SHL(a, n) ((a) << (n))
+#	define RSX_BS_SHR(a, n) ((a) >> (n))
+#	define RSX_BS_ROTR32(a) (((a) << 32) | ((a) >> 32))
+#	define RSX_BS_CONST(c) ((uint64_t)(c))
+#endif
+
+static void bitsliced_swap(uint64_t* x, uint64_t* y, uint64_t cl, uint64_t ch, size_t shift)
+{
+	uint64_t a = *x;
+	uint64_t b = *y;
+
+	*x = (a & cl) | ((b & cl) << shift);
+	*y = ((a & ch) >> shift) | (b & ch);
+}
+
+static void bitsliced_ortho(uint64_t* q)
+{
+	/* transpose the 8x8 bit matrices, moving between block bytes and bit planes */
+	bitsliced_swap(&q[0], &q[1], 0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1);
+	bitsliced_swap(&q[2], &q[3], 0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1);
+	bitsliced_swap(&q[4], &q[5], 0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1);
+	bitsliced_swap(&q[6], &q[7], 0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1);
+	bitsliced_swap(&q[0], &q[2], 0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2);
+	bitsliced_swap(&q[1], &q[3], 0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2);
+	bitsliced_swap(&q[4], &q[6], 0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2);
+	bitsliced_swap(&q[5], &q[7], 0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2);
+	bitsliced_swap(&q[0], &q[4], 0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4);
+	bitsliced_swap(&q[1], &q[5], 0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4);
+	bitsliced_swap(&q[2], &q[6], 0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4);
+	bitsliced_swap(&q[3], &q[7], 0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4);
+}
+
+static void bitsliced_interleave_in(uint64_t* q0, uint64_t* q1, const uint8_t* input)
+{
+	uint64_t x0;
+	uint64_t x1;
+	uint64_t x2;
+	uint64_t x3;
+
+	/* the block is read as four little endian words */
+	x0 = (uint64_t)load_le32(input, 0);
+	x1 = (uint64_t)load_le32(input, 4);
+	x2 = (uint64_t)load_le32(input, 8);
+	x3 = (uint64_t)load_le32(input, 12);
+
+	x0 |= (x0 << 16);
+	x1 |= (x1 << 16);
+	x2 |= (x2 << 16);
+	x3 |= (x3 << 16);
+	x0 &= 0x0000FFFF0000FFFFULL;
+	x1 &= 0x0000FFFF0000FFFFULL;
+	x2 &= 0x0000FFFF0000FFFFULL;
+	x3 &= 0x0000FFFF0000FFFFULL;
+	x0 |= (x0 << 8);
+	x1 |= (x1 << 8);
+	x2 |= (x2 << 8);
+	x3 |= (x3 << 8);
+	x0 &= 0x00FF00FF00FF00FFULL;
+	x1 &= 0x00FF00FF00FF00FFULL;
+	x2 &= 0x00FF00FF00FF00FFULL;
+	x3 &= 0x00FF00FF00FF00FFULL;
+	*q0 = x0 | (x2 << 8);
+	*q1 = x1 | (x3 << 8);
+}
+
+static void bitsliced_interleave_out(uint8_t* output, uint64_t q0, uint64_t q1)
+{
+	uint64_t x0;
+	uint64_t x1;
+	uint64_t x2;
+	uint64_t x3;
+
+	x0 = q0 & 0x00FF00FF00FF00FFULL;
+	x1 = q1 & 0x00FF00FF00FF00FFULL;
+	x2 = (q0 >> 8) & 0x00FF00FF00FF00FFULL;
+	x3 = (q1 >> 8) & 0x00FF00FF00FF00FFULL;
+	x0 |= (x0 >> 8);
+	x1 |= (x1 >> 8);
+	x2 |= (x2 >> 8);
+	x3 |= (x3 >> 8);
+	x0 &= 0x0000FFFF0000FFFFULL;
+	x1 &= 0x0000FFFF0000FFFFULL;
+	x2 &= 0x0000FFFF0000FFFFULL;
+	x3 &= 0x0000FFFF0000FFFFULL;
+	le32_to_bytes((uint32_t)x0 | (uint32_t)(x0 >> 16), output, 0);
+	le32_to_bytes((uint32_t)x1 | (uint32_t)(x1 >> 16), output, 4);
+	le32_to_bytes((uint32_t)x2 | (uint32_t)(x2 >> 16), output, 8);
+	le32_to_bytes((uint32_t)x3 | (uint32_t)(x3 >> 16), output, 12);
+}
+
+static void bitsliced_sbox(rsx_bsword* q)
+{
+	rsx_bsword x0, x1, x2, x3, x4, x5, x6, x7;
+	rsx_bsword y1, y2, y3, y4, y5, y6, y7, y8, y9;
+	rsx_bsword y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+	rsx_bsword y20, y21;
+	rsx_bsword z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+	rsx_bsword z10, z11, z12, z13, z14, z15, z16, z17;
+	rsx_bsword t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+	rsx_bsword t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+	rsx_bsword t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+	rsx_bsword t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+	rsx_bsword t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+	rsx_bsword t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+	rsx_bsword t60, t61, t62, t63, t64, t65, t66, t67;
+	rsx_bsword s0, s1, s2, s3, s4, s5, s6, s7;
+
+	x0 = q[7];
+	x1 = q[6];
+	x2 = q[5];
+	x3 = q[4];
+	x4 = q[3];
+	x5 = q[2];
+	x6 = q[1];
+	x7 = q[0];
+
+	/* top linear transformation */
+	y14 = RSX_BS_XOR(x3, x5);
+	y13 = RSX_BS_XOR(x0, x6);
+	y9 = RSX_BS_XOR(x0, x3);
+	y8 = RSX_BS_XOR(x0, x5);
+	t0 = RSX_BS_XOR(x1, x2);
+	y1 = RSX_BS_XOR(t0, x7);
+	y4 = RSX_BS_XOR(y1, x3);
+	y12 = RSX_BS_XOR(y13, y14);
+	y2 = RSX_BS_XOR(y1, x0);
+	y5 = RSX_BS_XOR(y1, x6);
+	y3 = RSX_BS_XOR(y5, y8);
+	t1 = RSX_BS_XOR(x4, y12);
+	y15 = RSX_BS_XOR(t1, x5);
+	y20 = RSX_BS_XOR(t1, x1);
+	y6 = RSX_BS_XOR(y15, x7);
+	y10 = RSX_BS_XOR(y15, t0);
+	y11 = RSX_BS_XOR(y20, y9);
+	y7 = RSX_BS_XOR(x7, y11);
+	y17 = RSX_BS_XOR(y10, y11);
+	y19 = RSX_BS_XOR(y10, y8);
+	y16 = RSX_BS_XOR(t0, y11);
+	y21 = RSX_BS_XOR(y13, y16);
+	y18 = RSX_BS_XOR(x0, y16);
+
+	/* non-linear section */
+	t2 = RSX_BS_AND(y12, y15);
+	t3 = RSX_BS_AND(y3, y6);
+	t4 = RSX_BS_XOR(t3, t2);
+	t5 = RSX_BS_AND(y4, x7);
+	t6 = RSX_BS_XOR(t5, t2);
+	t7 = RSX_BS_AND(y13, y16);
+	t8 = RSX_BS_AND(y5, y1);
+	t9 = RSX_BS_XOR(t8, t7);
+	t10 = RSX_BS_AND(y2, y7);
+	t11 = RSX_BS_XOR(t10, t7);
+	t12 = RSX_BS_AND(y9, y11);
+	t13 = RSX_BS_AND(y14, y17);
+	t14 = RSX_BS_XOR(t13, t12);
+	t15 = RSX_BS_AND(y8, y10);
+	t16 = RSX_BS_XOR(t15, t12);
+	t17 = RSX_BS_XOR(t4, t14);
+	t18 = RSX_BS_XOR(t6, t16);
+	t19 = RSX_BS_XOR(t9, t14);
+	t20 = RSX_BS_XOR(t11, t16);
+	t21 = RSX_BS_XOR(t17, y20);
+	t22 = RSX_BS_XOR(t18, y19);
+	t23 = RSX_BS_XOR(t19, y21);
+	t24 = RSX_BS_XOR(t20, y18);
+
+	t25 = RSX_BS_XOR(t21, t22);
+	t26 = RSX_BS_AND(t21, t23);
+	t27 = RSX_BS_XOR(t24, t26);
+	t28 = RSX_BS_AND(t25, t27);
+	t29 = RSX_BS_XOR(t28, t22);
+	t30 = RSX_BS_XOR(t23, t24);
+	t31 = RSX_BS_XOR(t22, t26);
+	t32 = RSX_BS_AND(t31, t30);
+	t33 = RSX_BS_XOR(t32, t24);
+	t34 = RSX_BS_XOR(t23, t33);
+	t35 = RSX_BS_XOR(t27, t33);
+	t36 = RSX_BS_AND(t24, t35);
+	t37 = RSX_BS_XOR(t36, t34);
+	t38 = RSX_BS_XOR(t27, t36);
+	t39 = RSX_BS_AND(t29, t38);
+	t40 = RSX_BS_XOR(t25, t39);
+
+	t41 = RSX_BS_XOR(t40, t37);
+	t42 = RSX_BS_XOR(t29, t33);
+	t43 = RSX_BS_XOR(t29, t40);
+	t44 = RSX_BS_XOR(t33, t37);
+	t45 = RSX_BS_XOR(t42, t41);
+	z0 = RSX_BS_AND(t44, y15);
+	z1 = RSX_BS_AND(t37, y6);
+	z2 = RSX_BS_AND(t33, x7);
+	z3 = RSX_BS_AND(t43, y16);
+	z4 = RSX_BS_AND(t40, y1);
+	z5 = RSX_BS_AND(t29, y7);
+	z6 = RSX_BS_AND(t42, y11);
+	z7 = RSX_BS_AND(t45, y17);
+	z8 = RSX_BS_AND(t41, y10);
+	z9 = RSX_BS_AND(t44, y12);
+	z10 = RSX_BS_AND(t37, y3);
+	z11 = RSX_BS_AND(t33, y4);
+	z12 = RSX_BS_AND(t43, y13);
+	z13 = RSX_BS_AND(t40, y5);
+	z14 = RSX_BS_AND(t29, y2);
+	z15 = RSX_BS_AND(t42, y9);
+	z16 = RSX_BS_AND(t45, y14);
+	z17 = RSX_BS_AND(t41, y8);
+
+	/* bottom linear transformation */
+	t46 = RSX_BS_XOR(z15, z16);
+	t47 = RSX_BS_XOR(z10, z11);
+	t48 = RSX_BS_XOR(z5, z13);
+	t49 = RSX_BS_XOR(z9, z10);
+	t50 = RSX_BS_XOR(z2, z12);
+	t51 = RSX_BS_XOR(z2, z5);
+	t52 = RSX_BS_XOR(z7, z8);
+	t53 = RSX_BS_XOR(z0, z3);
+	t54 = RSX_BS_XOR(z6, z7);
+	t55 = RSX_BS_XOR(z16, z17);
+	t56 = RSX_BS_XOR(z12, t48);
+	t57 = RSX_BS_XOR(t50, t53);
+	t58 = RSX_BS_XOR(z4, t46);
+	t59 = RSX_BS_XOR(z3, t54);
+	t60 = RSX_BS_XOR(t46, t57);
+	t61 = RSX_BS_XOR(z14, t57);
+	t62 = RSX_BS_XOR(t52, t58);
+	t63 = RSX_BS_XOR(t49, t58);
+	t64 = RSX_BS_XOR(z4, t59);
+	t65 = RSX_BS_XOR(t61, t62);
+	t66 = RSX_BS_XOR(z1, t63);
+	s0 = RSX_BS_XOR(t59, t63);
+	s6 = RSX_BS_NOT(RSX_BS_XOR(t56, t62));
+	s7 = RSX_BS_NOT(RSX_BS_XOR(t48, t60));
+	t67 = RSX_BS_XOR(t64, t65);
+	s3 = RSX_BS_XOR(t53, t66);
+	s4 = RSX_BS_XOR(t51, t66);
+	s5 = RSX_BS_XOR(t47, t65);
+	s1 = RSX_BS_NOT(RSX_BS_XOR(t64, s3));
+	s2 = RSX_BS_NOT(RSX_BS_XOR(t55, t67));
+
+	q[7] = s0;
+	q[6] = s1;
+	q[5] = s2;
+	q[4] = s3;
+	q[3] = s4;
+	q[2] = s5;
+	q[1] = s6;
+	q[0] = s7;
+}
+
+static void bitsliced_inv_affine(rsx_bsword* q)
+{
+	rsx_bsword q0 = RSX_BS_NOT(q[0]);
+	rsx_bsword q1 = RSX_BS_NOT(q[1]);
+	rsx_bsword q2 = q[2];
+	rsx_bsword q3 = q[3];
+	rsx_bsword q4 = q[4];
+	rsx_bsword q5 = RSX_BS_NOT(q[5]);
+	rsx_bsword q6 = RSX_BS_NOT(q[6]);
+	rsx_bsword q7 = q[7];
+
+	q[7] = RSX_BS_XOR(RSX_BS_XOR(q1, q4), q6);
+	q[6] = RSX_BS_XOR(RSX_BS_XOR(q0, q3), q5);
+	q[5] = RSX_BS_XOR(RSX_BS_XOR(q7, q2), q4);
+	q[4] = RSX_BS_XOR(RSX_BS_XOR(q6, q1), q3);
+	q[3] = RSX_BS_XOR(RSX_BS_XOR(q5, q0), q2);
+	q[2] = RSX_BS_XOR(RSX_BS_XOR(q4, q7), q1);
+	q[1] = RSX_BS_XOR(RSX_BS_XOR(q3, q6), q0);
+	q[0] = RSX_BS_XOR(RSX_BS_XOR(q2, q5), q7);
+}
+
+static void bitsliced_inv_sbox(rsx_bsword* q)
+{
+	/* the inverse s-box is the forward circuit wrapped in the inverse affine transform */
+	bitsliced_inv_affine(q);
+	bitsliced_sbox(q);
+	bitsliced_inv_affine(q);
+}
+
+static void bitsliced_shift_rows(rsx_bsword* q)
+{
+	rsx_bsword x;
+	rsx_bsword y;
+	size_t i;
+
+	for (i = 0; i < 8; ++i)
+	{
+		x = q[i];
+		y = RSX_BS_AND(x, RSX_BS_CONST(0x000000000000FFFFULL));
+		y = RSX_BS_OR(y, RSX_BS_SHR(RSX_BS_AND(x, RSX_BS_CONST(0x00000000FFF00000ULL)), 4));
+		y = RSX_BS_OR(y, RSX_BS_SHL(RSX_BS_AND(x, RSX_BS_CONST(0x00000000000F0000ULL)), 12));
+		y = RSX_BS_OR(y, RSX_BS_SHR(RSX_BS_AND(x, RSX_BS_CONST(0x0000FF0000000000ULL)), 8));
+		y = RSX_BS_OR(y, RSX_BS_SHL(RSX_BS_AND(x, RSX_BS_CONST(0x000000FF00000000ULL)), 8));
+		y = RSX_BS_OR(y, RSX_BS_SHR(RSX_BS_AND(x, RSX_BS_CONST(0xF000000000000000ULL)), 12));
+		q[i] = RSX_BS_OR(y, RSX_BS_SHL(RSX_BS_AND(x, RSX_BS_CONST(0x0FFF000000000000ULL)), 4));
+	}
+}
+
+static void bitsliced_inv_shift_rows(rsx_bsword* q)
+{
+	rsx_bsword x;
+	rsx_bsword y;
+	size_t i;
+
+	for (i = 0; i < 8; ++i)
+	{
+		x = q[i];
+		y = RSX_BS_AND(x, RSX_BS_CONST(0x000000000000FFFFULL));
+		y = RSX_BS_OR(y, RSX_BS_SHL(RSX_BS_AND(x, RSX_BS_CONST(0x000000000FFF0000ULL)), 4));
+		y = RSX_BS_OR(y, RSX_BS_SHR(RSX_BS_AND(x, RSX_BS_CONST(0x00000000F0000000ULL)), 12));
+		y = RSX_BS_OR(y, RSX_BS_SHL(RSX_BS_AND(x, RSX_BS_CONST(0x000000FF00000000ULL)), 8));
+		y = RSX_BS_OR(y, RSX_BS_SHR(RSX_BS_AND(x, RSX_BS_CONST(0x0000FF0000000000ULL)), 8));
+		y = RSX_BS_OR(y, RSX_BS_SHL(RSX_BS_AND(x, RSX_BS_CONST(0x000F000000000000ULL)), 12));
+		q[i] = RSX_BS_OR(y, RSX_BS_SHR(RSX_BS_AND(x, RSX_BS_CONST(0xFFF0000000000000ULL)), 4));
+	}
+}
+
+static rsx_bsword bitsliced_rotr16(rsx_bsword x)
+{
+	/* the next row of each column */
+	return RSX_BS_OR(RSX_BS_SHR(x, 16), RSX_BS_SHL(x, 48));
+}
+
+static void bitsliced_mix_columns(rsx_bsword* q)
+{
+	rsx_bsword r[8];
+	rsx_bsword t[8];
+	size_t i;
+
+	for (i = 0; i < 8; ++i)
+	{
+		r[i] = bitsliced_rotr16(q[i]);
+		t[i] = RSX_BS_XOR(q[i], r[i]);
+	}
+
+	/* t is the row sum of each pair, doubled by the shift into the next bit plane */
+	q[0] = RSX_BS_XOR(RSX_BS_XOR(t[7], r[0]), RSX_BS_ROTR32(t[0]));
+	q[1] = RSX_BS_XOR(RSX_BS_XOR(RSX_BS_XOR(t[0], t[7]), r[1]), RSX_BS_ROTR32(t[1]));
+	q[2] = RSX_BS_XOR(RSX_BS_XOR(t[1], r[2]), RSX_BS_ROTR32(t[2]));
+	q[3] = RSX_BS_XOR(RSX_BS_XOR(RSX_BS_XOR(t[2], t[7]), r[3]), RSX_BS_ROTR32(t[3]));
+	q[4] = RSX_BS_XOR(RSX_BS_XOR(RSX_BS_XOR(t[3], t[7]), r[4]), RSX_BS_ROTR32(t[4]));
+	q[5] = RSX_BS_XOR(RSX_BS_XOR(t[4], r[5]), RSX_BS_ROTR32(t[5]));
+	q[6] = RSX_BS_XOR(RSX_BS_XOR(t[5], r[6]), RSX_BS_ROTR32(t[6]));
+	q[7] = RSX_BS_XOR(RSX_BS_XOR(t[6], r[7]), RSX_BS_ROTR32(t[7]));
+}
+
+static void bitsliced_inv_mix_columns(rsx_bsword* q)
+{
+	rsx_bsword u[8];
+	rsx_bsword tmp;
+	size_t i;
+
+	/* InvMixColumns is MixColumns applied after y = 5x ^ 4x' (x' two rows on), computed as x ^ 4(x ^ x') */
+	for (i = 0; i < 8; ++i)
+	{
+		u[i] = RSX_BS_XOR(q[i], RSX_BS_ROTR32(q[i]));
+	}
+
+	for (i = 0; i < 2; ++i)
+	{
+		tmp = u[7];
+		u[7] = u[6];
+		u[6] = u[5];
+		u[5] = u[4];
+		u[4] = RSX_BS_XOR(u[3], tmp);
+		u[3] = RSX_BS_XOR(u[2], tmp);
+		u[2] = u[1];
+		u[1] = RSX_BS_XOR(u[0], tmp);
+		u[0] = tmp;
+	}
+
+	for (i = 0; i < 8; ++i)
+	{
+		q[i] = RSX_BS_XOR(q[i], u[i]);
+	}
+
+	bitsliced_mix_columns(q);
+}
+
+static void bitsliced_add_round_key(rsx_bsword* q, const rsx_bsword* sk)
+{
+	size_t i;
+
+	for (i = 0; i < 8; ++i)
+	{
+		q[i] = RSX_BS_XOR(q[i], sk[i]);
+	}
+}
+
+static void bitsliced_load_blocks(rsx_bsword* w, const uint8_t* input, size_t count)
+{
+	uint8_t tmpb[RSX_BITSLICE_SETS * 4 * RSX_BLOCK_SIZE] = { 0 };
+	uint64_t q[RSX_BITSLICE_SETS * 8];
+	size_t i;
+	size_t j;
+
+	/* a partial batch is zero padded, the padding lanes are discarded on output */
+	memcpy(tmpb, input, count * RSX_BLOCK_SIZE);
+
+	for (j = 0; j < RSX_BITSLICE_SETS; ++j)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			bitsliced_interleave_in(&q[(j * 8) + i], &q[(j * 8) + i + 4], tmpb + (((j * 4) + i) * RSX_BLOCK_SIZE));
+		}
+
+		bitsliced_ortho(q + (j * 8));
+	}
+
+#if defined(RSX_BITSLICE_SSE2)
+	for (i = 0; i < 8; ++i)
+	{
+		w[i] = _mm_set_epi64x((long long)q[i + 8], (long long)q[i]);
+	}
+#else
+	memcpy(w, q, sizeof(q));
+#endif
+}
+
+static void bitsliced_store_blocks(uint8_t* output, const rsx_bsword* w, size_t count)
+{
+	uint8_t tmpb[RSX_BITSLICE_SETS * 4 * RSX_BLOCK_SIZE];
+	uint64_t q[RSX_BITSLICE_SETS * 8];
+	size_t i;
+	size_t j;
+
+#if defined(RSX_BITSLICE_SSE2)
+	for (i = 0; i < 8; ++i)
+	{
+		_mm_storeu_si128((__m128i*)tmpb, w[i]);
+		q[i] = ((uint64_t)load_le32(tmpb, 4) << 32) | load_le32(tmpb, 0);
+		q[i + 8] = ((uint64_t)load_le32(tmpb, 12) << 32) | load_le32(tmpb, 8);
+	}
+#else
+	memcpy(q, w, sizeof(q));
+#endif
+
+	for (j = 0; j < RSX_BITSLICE_SETS; ++j)
+	{
+		bitsliced_ortho(q + (j * 8));
+
+		for (i = 0; i < 4; ++i)
+		{
+			bitsliced_interleave_out(tmpb + (((j * 4) + i) * RSX_BLOCK_SIZE), q[(j * 8) + i], q[(j * 8) + i + 4]);
+		}
+	}
+
+	memcpy(output, tmpb, count * RSX_BLOCK_SIZE);
+}
+
+static void bitsliced_load_key(rsx_state* state, rsx_bsword* sk)
+{
+	uint64_t q[8];
+	size_t i;
+	size_t j;
+
+	/* each round key is replicated across every block position */
+	for (i = 0; i < state->rkeylen; ++i)
+	{
+		bitsliced_interleave_in(&q[0], &q[4], state->roundkeys[i].bytes);
+
+		for (j = 1; j < 4; ++j)
+		{
+			q[j] = q[0];
+			q[j + 4] = q[4];
+		}
+
+		bitsliced_ortho(q);
+
+		for (j = 0; j < 8; ++j)
+		{
+			sk[(i * 8) + j] = RSX_BS_CONST(q[j]);
+		}
+	}
+
+	memset(q, 0x00, sizeof(q));
+}
+
+static void bitsliced_decrypt_blocks8(rsx_state* state, const rsx_bsword* sk, rsx_bsword* q)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr;
+	size_t j;
+
+	/* the equivalent inverse cipher, the decryption round keys are already mixed */
+	for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+	{
+		bitsliced_add_round_key(q + j, sk);
+	}
+
+	for (keyctr = 1; keyctr < RNDCNT; ++keyctr)
+	{
+		for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+		{
+			bitsliced_inv_shift_rows(q + j);
+			bitsliced_inv_sbox(q + j);
+			bitsliced_inv_mix_columns(q + j);
+			bitsliced_add_round_key(q + j, sk + (keyctr * 8));
+		}
+	}
+
+	for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+	{
+		bitsliced_inv_shift_rows(q + j);
+		bitsliced_inv_sbox(q + j);
+		bitsliced_add_round_key(q + j, sk + (keyctr * 8));
+	}
+}
+
+static void bitsliced_encrypt_blocks8(rsx_state* state, const rsx_bsword* sk, rsx_bsword* q)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr;
+	size_t j;
+
+	for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+	{
+		bitsliced_add_round_key(q + j, sk);
+	}
+
+	for (keyctr = 1; keyctr < RNDCNT; ++keyctr)
+	{
+		for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+		{
+			bitsliced_sbox(q + j);
+			bitsliced_shift_rows(q + j);
+			bitsliced_mix_columns(q + j);
+			bitsliced_add_round_key(q + j, sk + (keyctr * 8));
+		}
+	}
+
+	for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+	{
+		bitsliced_sbox(q + j);
+		bitsliced_shift_rows(q + j);
+		bitsliced_add_round_key(q + j, sk + (keyctr * 8));
+	}
+}
+
+static uint32_t bitsliced_sub_word(uint32_t x)
+{
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+	uint8_t tmpb[RSX_BLOCK_SIZE] = { 0 };
+
+	le32_to_bytes(x, tmpb, 0);
+	bitsliced_load_blocks(q, tmpb, 1);
+	bitsliced_sbox(q);
+	bitsliced_store_blocks(tmpb, q, 1);
+
+	return load_le32(tmpb, 0);
+}
+
+static void bitsliced_decrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	rsx_bsword sk[RSX512_ROUNDKEY_DIMENSION * 8];
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+
+	bitsliced_load_key(state, sk);
+	bitsliced_load_blocks(q, input, 1);
+	bitsliced_decrypt_blocks8(state, sk, q);
+	bitsliced_store_blocks(output, q, 1);
+}
+
+static void bitsliced_encrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	rsx_bsword sk[RSX512_ROUNDKEY_DIMENSION * 8];
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+
+	bitsliced_load_key(state, sk);
+	bitsliced_load_blocks(q, input, 1);
+	bitsliced_encrypt_blocks8(state, sk, q);
+	bitsliced_store_blocks(output, q, 1);
+}
+
+static void schedule_expand(rsx_state* state, rsx_keyparams* keyparams, uint32_t (*sub_word)(uint32_t))
+{
+	uint32_t rk[AES256_ROUNDKEY_DIMENSION * 4];
+	const size_t KWORDS = keyparams->keylen / 4;
+	uint32_t tmpk;
+	size_t i;
+
+	for (i = 0; i < KWORDS; ++i)
+	{
+		rk[i] = load_be32(keyparams->key, i * 4);
+	}
+
+	/* the rijndael key schedule, the constant-time kernels supply the s-box */
+	for (i = KWORDS; i < state->rkeylen * 4; ++i)
+	{
+		tmpk = rk[i - 1];
+
+		if (i % KWORDS == 0)
+		{
+			tmpk = sub_word((tmpk << 8) | (tmpk >> 24)) ^ rcon[i / KWORDS];
+		}
+		else if (KWORDS > 6 && i % KWORDS == 4)
+		{
+			tmpk = sub_word(tmpk);
+		}
+
+		rk[i] = rk[i - KWORDS] ^ tmpk;
+	}
+
+	for (i = 0; i < state->rkeylen * 4; ++i)
+	{
+		be32_to_bytes(rk[i], state->roundkeys[i / 4].bytes, (i % 4) * 4);
+	}
+
+	memset(rk, 0x00, sizeof(rk));
+}
+
+static void bitsliced_standard_expand(rsx_state* state, rsx_keyparams* keyparams)
+{
+	schedule_expand(state, keyparams, bitsliced_sub_word);
+}
+
+static void bitsliced_standard_expand_x4(rsx_state* states, rsx_keyparams* keyparams)
+{
+	expand_x4(bitsliced_standard_expand, states, keyparams);
+}
+
+static void bitsliced_inverse_expand(rsx_state* state)
+{
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+	rsx_roundkey tmpk;
+	size_t blocks;
+	size_t i;
+	size_t j;
+
+	// reverse key
+	for (i = 0, j = state->rkeylen - 1; i < j; ++i, --j)
+	{
+		tmpk = state->roundkeys[i];
+		state->roundkeys[i] = state->roundkeys[j];
+		state->roundkeys[j] = tmpk;
+	}
+
+	// inverse mix columns, applied to the inner round keys eight at a time
+	for (i = 1; i < state->rkeylen - 1; i += blocks)
+	{
+		blocks = state->rkeylen - 1 - i;
+		blocks = (blocks > RSX_CTR_LANES) ? RSX_CTR_LANES : blocks;
+		bitsliced_load_blocks(q, state->roundkeys[i].bytes, blocks);
+
+		for (j = 0; j < RSX_BITSLICE_WORDS; j += 8)
+		{
+			bitsliced_inv_mix_columns(q + j);
+		}
+
+		bitsliced_store_blocks(state->roundkeys[i].bytes, q, blocks);
+	}
+
+	memset(&tmpk, 0x00, sizeof(tmpk));
+	memset(q, 0x00, sizeof(q));
+}
+
+static void bitsliced_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length)
+{
+	rsx_bsword sk[RSX512_ROUNDKEY_DIMENSION * 8];
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+	uint8_t cipher[RSX_CTR_LANES * RSX_BLOCK_SIZE];
+	uint8_t prev[RSX_BLOCK_SIZE];
+	size_t blocks;
+	size_t i;
+
+	bitsliced_load_key(state, sk);
+	memcpy(prev, iv, RSX_BLOCK_SIZE);
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		blocks = length / RSX_BLOCK_SIZE;
+		blocks = (blocks > RSX_CTR_LANES) ? RSX_CTR_LANES : blocks;
+
+		/* the cipher-text is copied first, so the output can overwrite the input */
+		memcpy(cipher, input, blocks * RSX_BLOCK_SIZE);
+		bitsliced_load_blocks(q, cipher, blocks);
+		bitsliced_decrypt_blocks8(state, sk, q);
+		bitsliced_store_blocks(output, q, blocks);
+
+		for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+		{
+			output[i] ^= prev[i];
+		}
+
+		for (i = RSX_BLOCK_SIZE; i < blocks * RSX_BLOCK_SIZE; ++i)
+		{
+			output[i] ^= cipher[i - RSX_BLOCK_SIZE];
+		}
+
+		memcpy(prev, cipher + ((blocks - 1) * RSX_BLOCK_SIZE), RSX_BLOCK_SIZE);
+		input += blocks * RSX_BLOCK_SIZE;
+		output += blocks * RSX_BLOCK_SIZE;
+		length -= blocks * RSX_BLOCK_SIZE;
+	}
+
+	memcpy(iv, prev, RSX_BLOCK_SIZE);
+	memset(sk, 0x00, sizeof(sk));
+}
+
+static void bitsliced_cbc_mac(rsx_state* state, uint8_t* mac, const uint8_t* input, size_t length)
+{
+	mac_blocks(bitsliced_encrypt_block, state, mac, input, length);
+}
+
+static void bitsliced_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length)
+{
+	rsx_bsword sk[RSX512_ROUNDKEY_DIMENSION * 8];
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+	uint8_t ctrb[RSX_CTR_LANES * RSX_BLOCK_SIZE];
+	size_t blocks;
+	size_t i;
+
+	bitsliced_load_key(state, sk);
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		blocks = length / RSX_BLOCK_SIZE;
+		blocks = (blocks > RSX_CTR_LANES) ? RSX_CTR_LANES : blocks;
+
+		for (i = 0; i < blocks; ++i)
+		{
+			memcpy(ctrb + (i * RSX_BLOCK_SIZE), nonce, RSX_BLOCK_SIZE);
+			increment_be8(nonce);
+		}
+
+		bitsliced_load_blocks(q, ctrb, blocks);
+		bitsliced_encrypt_blocks8(state, sk, q);
+		bitsliced_store_blocks(ctrb, q, blocks);
+
+		for (i = 0; i < blocks * RSX_BLOCK_SIZE; ++i)
+		{
+			output[i] = ctrb[i] ^ input[i];
+		}
+
+		input += blocks * RSX_BLOCK_SIZE;
+		output += blocks * RSX_BLOCK_SIZE;
+		length -= blocks * RSX_BLOCK_SIZE;
+	}
+
+	memset(sk, 0x00, sizeof(sk));
+}
+
+static void bitsliced_ccm_decrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	ccm_blocks(bitsliced_encrypt_block, bitsliced_ctr_transform, state, mac, output, ctr, input, length, false);
+}
+
+static void bitsliced_ccm_encrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	ccm_blocks(bitsliced_encrypt_block, bitsliced_ctr_transform, state, mac, output, ctr, input, length, true);
+}
+
+static void bitsliced_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	rsx_bsword sk[RSX512_ROUNDKEY_DIMENSION * 8];
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+	size_t blocks;
+
+	bitsliced_load_key(state, sk);
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		blocks = length / RSX_BLOCK_SIZE;
+		blocks = (blocks > RSX_CTR_LANES) ? RSX_CTR_LANES : blocks;
+		bitsliced_load_blocks(q, input, blocks);
+		bitsliced_decrypt_blocks8(state, sk, q);
+		bitsliced_store_blocks(output, q, blocks);
+		input += blocks * RSX_BLOCK_SIZE;
+		output += blocks * RSX_BLOCK_SIZE;
+		length -= blocks * RSX_BLOCK_SIZE;
+	}
+
+	memset(sk, 0x00, sizeof(sk));
+}
+
+static void bitsliced_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	rsx_bsword sk[RSX512_ROUNDKEY_DIMENSION * 8];
+	rsx_bsword q[RSX_BITSLICE_WORDS];
+	size_t blocks;
+
+	bitsliced_load_key(state, sk);
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		blocks = length / RSX_BLOCK_SIZE;
+		blocks = (blocks > RSX_CTR_LANES) ? RSX_CTR_LANES : blocks;
+		bitsliced_load_blocks(q, input, blocks);
+		bitsliced_encrypt_blocks8(state, sk, q);
+		bitsliced_store_blocks(output, q, blocks);
+		input += blocks * RSX_BLOCK_SIZE;
+		output += blocks * RSX_BLOCK_SIZE;
+		length -= blocks * RSX_BLOCK_SIZE;
+	}
+
+	memset(sk, 0x00, sizeof(sk));
+}
+
+static void bitsliced_cbc_encrypt_jobs(rsx_state* state, rsx_cbc_job* jobs, size_t count)
+{
+	cbc_jobs(bitsliced_ecb_encrypt, state, jobs, count);
+}
+
+static void bitsliced_ctr_keyed(rsx_state* states, const rsx_ctr_packet* packets, size_t count)
+{
+	ctr_keyed(bitsliced_ctr_transform, bitsliced_encrypt_block, states, packets, count);
+}
+
+static void bitsliced_ctr_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count)
+{
+	ctr_packets(bitsliced_ecb_encrypt, state, packets, count);
+}
+
+static void bitsliced_ocb_decrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	ocb_blocks(bitsliced_ecb_decrypt, state, ltable, output, offset, checksum, input, length, index, false);
+}
+
+static void bitsliced_ocb_encrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	ocb_blocks(bitsliced_ecb_encrypt, state, ltable, output, offset, checksum, input, length, index, true);
+}
+
+static void bitsliced_pmac_sum(rsx_state* state, const rsx_roundkey* ltable, uint8_t* offset, uint8_t* sum, const uint8_t* input, size_t length, uint64_t index)
+{
+	pmac_blocks(bitsliced_ecb_encrypt, state, ltable, offset, sum, input, length, index);
+}
+
+static void bitsliced_xts_decrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	xts_blocks(bitsliced_ecb_decrypt, state, output, tweak, input, length);
+}
+
+static void bitsliced_xts_encrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	xts_blocks(bitsliced_ecb_encrypt, state, output, tweak, input, length);
+}
+
+/* Vector Permute Kernels */
+
+#if defined(RSX_AESNI_SUPPORTED)
+
+/* The s-box is computed with 4 bit table lookups in the pshufb instruction (M. Hamburg, Accelerating AES with
+   Vector Permute Instructions), the inversion is done in GF((2^4)^2) after a change of basis. The state of one
+   block is held in that basis between rounds; the round keys are moved into it as they are used, so the kernel
+   shares the round-key layout of the other kernels. There are no secret dependent memory accesses or branches. */
+
+static const uint8_t vpaes_inv[32] =
+{
+	0x80, 0x01, 0x08, 0x0D, 0x0F, 0x06, 0x05, 0x0E, 0x02, 0x0C, 0x0B, 0x0A, 0x09, 0x03, 0x07, 0x04,
+	0x80, 0x07, 0x0B, 0x0F, 0x06, 0x0A, 0x04, 0x01, 0x09, 0x08, 0x05, 0x02, 0x0C, 0x0E, 0x0D, 0x03
+};
+
+/* input transform, into the inversion basis */
+static const uint8_t vpaes_ipt[32] =
+{
+	0x00, 0x70, 0x2A, 0x5A, 0x98, 0xE8, 0xB2, 0xC2, 0x08, 0x78, 0x22, 0x52, 0x90, 0xE0, 0xBA, 0xCA,
+	0x00, 0x4D, 0x7C, 0x31, 0x7D, 0x30, 0x01, 0x4C, 0x81, 0xCC, 0xFD, 0xB0, 0xFC, 0xB1, 0x80, 0xCD
+};
+
+/* s-box output multiplied by 1 and 2, in the inversion basis */
+static const uint8_t vpaes_sb1[32] =
+{
+	0x00, 0x3E, 0x50, 0xCB, 0x8F, 0xE1, 0x9B, 0xB1, 0x44, 0xF5, 0x2A, 0x14, 0x6E, 0x7A, 0xDF, 0xA5,
+	0x00, 0x23, 0xE2, 0xFA, 0x15, 0xD4, 0x18, 0x36, 0xEF, 0xD9, 0x2E, 0x0D, 0xC1, 0xCC, 0xF7, 0x3B
+};
+
+static const uint8_t vpaes_sb2[32] =
+{
+	0x00, 0x24, 0x71, 0x0B, 0xC6, 0x93, 0x7A, 0xE2, 0xCD, 0x2F, 0x98, 0xBC, 0x55, 0xE9, 0xB7, 0x5E,
+	0x00, 0x29, 0xE1, 0x0A, 0x40, 0x88, 0xEB, 0x69, 0x4A, 0x23, 0x82, 0xAB, 0xC8, 0x63, 0xA1, 0xC2
+};
+
+/* s-box output in the standard basis, less the 0x63 constant */
+static const uint8_t vpaes_sbo[32] =
+{
+	0x00, 0xC7, 0xBD, 0x6F, 0x17, 0x6D, 0xD2, 0xD0, 0x78, 0xA8, 0x02, 0xC5, 0x7A, 0xBF, 0xAA, 0x15,
+	0x00, 0x6A, 0xBB, 0x5F, 0xA5, 0x74, 0xE4, 0xCF, 0xFA, 0x35, 0x2B, 0x41, 0xD1, 0x90, 0x1E, 0x8E
+};
+
+/* decryption input transform, through the inverse affine map into the inversion basis */
+static const uint8_t vpaes_dipt[32] =
+{
+	0x00, 0x5F, 0x54, 0x0B, 0x04, 0x5B, 0x50, 0x0F, 0x1A, 0x45, 0x4E, 0x11, 0x1E, 0x41, 0x4A, 0x15,
+	0x00, 0x65, 0x05, 0x60, 0xE6, 0x83, 0xE3, 0x86, 0x94, 0xF1, 0x91, 0xF4, 0x72, 0x17, 0x77, 0x12
+};
+
+/* inverse s-box output multiplied by the inverse mix columns coefficients, in the decryption basis */
+static const uint8_t vpaes_dsb9[32] =
+{
+	0x00, 0xD6, 0x86, 0x9A, 0x53, 0x03, 0x1C, 0x85, 0xC9, 0x4C, 0x99, 0x4F, 0x50, 0x1F, 0xD5, 0xCA,
+	0x00, 0x49, 0xD7, 0xEC, 0x89, 0x17, 0x3B, 0xC0, 0x65, 0xA5, 0xFB, 0xB2, 0x9E, 0x2C, 0x5E, 0x72
+};
+
+static const uint8_t vpaes_dsbd[32] =
+{
+	0x00, 0xA2, 0xB1, 0xE6, 0xDF, 0xCC, 0x57, 0x7D, 0x39, 0x44, 0x2A, 0x88, 0x13, 0x9B, 0x6E, 0xF5,
+	0x00, 0xCB, 0xC6, 0x24, 0xF7, 0xFA, 0xE2, 0x3C, 0xD3, 0xEF, 0xDE, 0x15, 0x0D, 0x18, 0x31, 0x29
+};
+
+static const uint8_t vpaes_dsbb[32] =
+{
+	0x00, 0x42, 0xB4, 0x96, 0x92, 0x64, 0x22, 0xD0, 0x04, 0xD4, 0xF2, 0xB0, 0xF6, 0x46, 0x26, 0x60,
+	0x00, 0x67, 0x59, 0xCD, 0xA6, 0x98, 0x94, 0xC1, 0x6B, 0xAA, 0x55, 0x32, 0x3E, 0x0C, 0xFF, 0xF3
+};
+
+static const uint8_t vpaes_dsbe[32] =
+{
+	0x00, 0xD0, 0xD4, 0x26, 0x96, 0x92, 0xF2, 0x46, 0xB0, 0xF6, 0xB4, 0x64, 0x04, 0x60, 0x42, 0x22,
+	0x00, 0xC1, 0xAA, 0xFF, 0xCD, 0xA6, 0x55, 0x0C, 0x32, 0x3E, 0x59, 0x98, 0x6B, 0xF3, 0x67, 0x94
+};
+
+/* inverse s-box output in the standard basis */
+static const uint8_t vpaes_dsbo[32] =
+{
+	0x00, 0x40, 0xF9, 0x7E, 0x53, 0xEA, 0x87, 0x13, 0x2D, 0x3E, 0x94, 0xD4, 0xB9, 0x6D, 0xAA, 0xC7,
+	0x00, 0x1D, 0x44, 0x93, 0x0F, 0x56, 0xD7, 0x12, 0x9C, 0x8E, 0xC5, 0xD8, 0x59, 0x81, 0x4B, 0xCA
+};
+
+/* byte permutations: the next and previous row of each column, and the shift rows transforms */
+static const uint8_t vpaes_perm[64] =
+{
+	0x01, 0x02, 0x03, 0x00, 0x05, 0x06, 0x07, 0x04, 0x09, 0x0A, 0x0B, 0x08, 0x0D, 0x0E, 0x0F, 0x0C,
+	0x03, 0x00, 0x01, 0x02, 0x07, 0x04, 0x05, 0x06, 0x0B, 0x08, 0x09, 0x0A, 0x0F, 0x0C, 0x0D, 0x0E,
+	0x00, 0x05, 0x0A, 0x0F, 0x04, 0x09, 0x0E, 0x03, 0x08, 0x0D, 0x02, 0x07, 0x0C, 0x01, 0x06, 0x0B,
+	0x00, 0x0D, 0x0A, 0x07, 0x04, 0x01, 0x0E, 0x0B, 0x08, 0x05, 0x02, 0x0F, 0x0C, 0x09, 0x06, 0x03
+};
+
+RSX_VPAES_TARGET
+static __m128i vpaes_load(const uint8_t* table, size_t index)
+{
+	return _mm_loadu_si128((const __m128i*)(table + (index * 16)));
+}
+
+RSX_VPAES_TARGET
+static __m128i vpaes_lookup(const uint8_t* table, __m128i lo, __m128i hi)
+{
+	return _mm_xor_si128(_mm_shuffle_epi8(vpaes_load(table, 0), lo), _mm_shuffle_epi8(vpaes_load(table, 1), hi));
+}
+
+RSX_VPAES_TARGET
+static __m128i vpaes_transform(const uint8_t* table, __m128i x)
+{
+	const __m128i MASK = _mm_set1_epi8(0x0F);
+
+	return vpaes_lookup(table, _mm_and_si128(x, MASK), _mm_and_si128(_mm_srli_epi32(x, 4), MASK));
+}
+
+RSX_VPAES_TARGET
+static void vpaes_invert(__m128i x, __m128i* io, __m128i* jo)
+{
+	const __m128i MASK = _mm_set1_epi8(0x0F);
+	const __m128i INV = vpaes_load(vpaes_inv, 0);
+	__m128i ak;
+	__m128i i;
+	__m128i j;
+	__m128i k;
+
+	/* the inversion in GF((2^4)^2); the 0x80 entries zero the lookups for a zero input */
+	i = _mm_and_si128(_mm_srli_epi32(x, 4), MASK);
+	k = _mm_and_si128(x, MASK);
+	ak = _mm_shuffle_epi8(vpaes_load(vpaes_inv, 1), k);
+	j = _mm_xor_si128(i, k);
+	*io = _mm_xor_si128(_mm_shuffle_epi8(INV, _mm_xor_si128(_mm_shuffle_epi8(INV, i), ak)), j);
+	*jo = _mm_xor_si128(_mm_shuffle_epi8(INV, _mm_xor_si128(_mm_shuffle_epi8(INV, j), ak)), i);
+}
+
+RSX_VPAES_TARGET
+static __m128i vpaes_round_key(rsx_state* state, const uint8_t* table, size_t index)
+{
+	/* the key is offset by the s-box constant, which the output tables leave out */
+	return vpaes_transform(table, _mm_xor_si128(_mm_load_si128((const __m128i*)state->roundkeys[index].bytes), _mm_set1_epi8(0x63)));
+}
+
+RSX_VPAES_TARGET
+static void vpaes_decrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	const __m128i ROW = vpaes_load(vpaes_perm, 0);
+	const __m128i ISR = vpaes_load(vpaes_perm, 3);
+	__m128i io;
+	__m128i jo;
+	__m128i x;
+	size_t keyctr;
+
+	/* the equivalent inverse cipher, the decryption round keys are already mixed */
+	x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)input), _mm_load_si128((const __m128i*)state->roundkeys[0].bytes));
+	x = vpaes_transform(vpaes_dipt, _mm_xor_si128(x, _mm_set1_epi8(0x63)));
+
+	for (keyctr = 1; keyctr < RNDCNT; ++keyctr)
+	{
+		vpaes_invert(_mm_shuffle_epi8(x, ISR), &io, &jo);
+		/* inverse mix columns: 14a + 11a' + 13a'' + 9a''' in horner form */
+		x = vpaes_lookup(vpaes_dsb9, io, jo);
+		x = _mm_xor_si128(_mm_shuffle_epi8(x, ROW), vpaes_lookup(vpaes_dsbd, io, jo));
+		x = _mm_xor_si128(_mm_shuffle_epi8(x, ROW), vpaes_lookup(vpaes_dsbb, io, jo));
+		x = _mm_xor_si128(_mm_shuffle_epi8(x, ROW), vpaes_lookup(vpaes_dsbe, io, jo));
+		x = _mm_xor_si128(x, vpaes_round_key(state, vpaes_dipt, keyctr));
+	}
+
+	vpaes_invert(_mm_shuffle_epi8(x, ISR), &io, &jo);
+	x = _mm_xor_si128(vpaes_lookup(vpaes_dsbo, io, jo), _mm_load_si128((const __m128i*)state->roundkeys[keyctr].bytes));
+	_mm_storeu_si128((__m128i*)output, x);
+}
+
+RSX_VPAES_TARGET
+static void vpaes_encrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	const __m128i ROW = vpaes_load(vpaes_perm, 0);
+	const __m128i BACK = vpaes_load(vpaes_perm, 1);
+	const __m128i SR = vpaes_load(vpaes_perm, 2);
+	__m128i a;
+	__m128i b;
+	__m128i io;
+	__m128i jo;
+	__m128i x;
+	size_t keyctr;
+
+	x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)input), _mm_load_si128((const __m128i*)state->roundkeys[0].bytes));
+	x = vpaes_transform(vpaes_ipt, x);
+
+	for (keyctr = 1; keyctr < RNDCNT; ++keyctr)
+	{
+		vpaes_invert(_mm_shuffle_epi8(x, SR), &io, &jo);
+		/* mix columns: 2a + 3a' + a'' + a''' */
+		a = vpaes_lookup(vpaes_sb1, io, jo);
+		b = _mm_xor_si128(vpaes_lookup(vpaes_sb2, io, jo), _mm_shuffle_epi8(a, ROW));
+		x = _mm_xor_si128(b, _mm_shuffle_epi8(b, ROW));
+		x = _mm_xor_si128(x, _mm_shuffle_epi8(a, BACK));
+		x = _mm_xor_si128(x, vpaes_round_key(state, vpaes_ipt, keyctr));
+	}
+
+	vpaes_invert(_mm_shuffle_epi8(x, SR), &io, &jo);
+	x = _mm_xor_si128(vpaes_lookup(vpaes_sbo, io, jo), _mm_load_si128((const __m128i*)state->roundkeys[keyctr].bytes));
+	_mm_storeu_si128((__m128i*)output, _mm_xor_si128(x, _mm_set1_epi8(0x63)));
+}
+
+RSX_VPAES_TARGET
+static __m128i vpaes_double(__m128i x)
+{
+	/* multiplication by 2 in the standard basis, a conditional reduction by 0x1B */
+	return _mm_xor_si128(_mm_add_epi8(x, x), _mm_and_si128(_mm_cmplt_epi8(x, _mm_setzero_si128()), _mm_set1_epi8(0x1B)));
+}
+
+RSX_VPAES_TARGET
+static __m128i vpaes_mix_columns(__m128i x)
+{
+	const __m128i ROW = vpaes_load(vpaes_perm, 0);
+	__m128i r;
+	__m128i y;
+
+	/* 2(a + a') + a' + a'' + a''' */
+	r = _mm_shuffle_epi8(x, ROW);
+	y = _mm_xor_si128(vpaes_double(_mm_xor_si128(x, r)), r);
+	r = _mm_shuffle_epi8(r, ROW);
+	y = _mm_xor_si128(y, r);
+	r = _mm_shuffle_epi8(r, ROW);
+
+	return _mm_xor_si128(y, r);
+}
+
+RSX_VPAES_TARGET
+static uint32_t vpaes_sub_word(uint32_t x)
+{
+	__m128i io;
+	__m128i jo;
+
+	vpaes_invert(vpaes_transform(vpaes_ipt, _mm_cvtsi32_si128((int)x)), &io, &jo);
+
+	return (uint32_t)_mm_cvtsi128_si32(_mm_xor_si128(vpaes_lookup(vpaes_sbo, io, jo), _mm_set1_epi8(0x63)));
+}
+
+static void vpaes_standard_expand(rsx_state* state, rsx_keyparams* keyparams)
+{
+	schedule_expand(state, keyparams, vpaes_sub_word);
+}
+
+static void vpaes_standard_expand_x4(rsx_state* states, rsx_keyparams* keyparams)
+{
+	expand_x4(vpaes_standard_expand, states, keyparams);
+}
+
+RSX_VPAES_TARGET
+static void vpaes_inverse_expand(rsx_state* state)
+{
+	const __m128i ROW = vpaes_load(vpaes_perm, 0);
+	rsx_roundkey tmpk;
+	__m128i x;
+	size_t i;
+	size_t j;
+
+	// reverse key
+	for (i = 0, j = state->rkeylen - 1; i < j; ++i, --j)
+	{
+		tmpk = state->roundkeys[i];
+		state->roundkeys[i] = state->roundkeys[j];
+		state->roundkeys[j] = tmpk;
+	}
+
+	// inverse mix columns, computed as mix columns applied to a + 4(a + a'')
+	for (i = 1; i < state->rkeylen - 1; ++i)
+	{
+		x = _mm_load_si128((const __m128i*)state->roundkeys[i].bytes);
+		x = _mm_xor_si128(x, vpaes_double(vpaes_double(_mm_xor_si128(x, _mm_shuffle_epi8(_mm_shuffle_epi8(x, ROW), ROW)))));
+		_mm_store_si128((__m128i*)state->roundkeys[i].bytes, vpaes_mix_columns(x));
+	}
+
+	memset(&tmpk, 0x00, sizeof(tmpk));
+}
+
+static void vpaes_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length)
+{
+	uint8_t tmpv[RSX_BLOCK_SIZE];
+	size_t blocks;
+	size_t i;
+	size_t j;
+
+	blocks = length / RSX_BLOCK_SIZE;
+
+	if (blocks != 0)
+	{
+		/* walk the chain backwards, as in the table kernel, so the output can overwrite the input */
+		memcpy(&tmpv[0], &input[(blocks - 1) * RSX_BLOCK_SIZE], RSX_BLOCK_SIZE);
+
+		for (i = blocks - 1; i > 0; --i)
+		{
+			vpaes_decrypt_block(state, output + (i * RSX_BLOCK_SIZE), input + (i * RSX_BLOCK_SIZE));
+
+			for (j = 0; j < RSX_BLOCK_SIZE; j++)
+			{
+				output[(i * RSX_BLOCK_SIZE) + j] ^= input[((i - 1) * RSX_BLOCK_SIZE) + j];
+			}
+		}
+
+		vpaes_decrypt_block(state, output, input);
+
+		for (j = 0; j < RSX_BLOCK_SIZE; j++)
+		{
+			output[j] ^= iv[j];
+		}
+
+		memcpy(&iv[0], &tmpv[0], RSX_BLOCK_SIZE);
+	}
+}
+
+static void vpaes_cbc_mac(rsx_state* state, uint8_t* mac, const uint8_t* input, size_t length)
+{
+	mac_blocks(vpaes_encrypt_block, state, mac, input, length);
+}
+
+static void vpaes_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t i;
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		vpaes_encrypt_block(state, tmpb, nonce);
+
+		for (i = 0; i < RSX_BLOCK_SIZE; i++)
+		{
+			output[i] = tmpb[i] ^ input[i];
+		}
+
+		increment_be8(nonce);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+static void vpaes_ccm_decrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	ccm_blocks(vpaes_encrypt_block, vpaes_ctr_transform, state, mac, output, ctr, input, length, false);
+}
+
+static void vpaes_ccm_encrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	ccm_blocks(vpaes_encrypt_block, vpaes_ctr_transform, state, mac, output, ctr, input, length, true);
+}
+
+static void vpaes_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		vpaes_decrypt_block(state, output, input);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+static void vpaes_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		vpaes_encrypt_block(state, output, input);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+static void vpaes_cbc_encrypt_jobs(rsx_state* state, rsx_cbc_job* jobs, size_t count)
+{
+	cbc_jobs(vpaes_ecb_encrypt, state, jobs, count);
+}
+
+static void vpaes_ctr_keyed(rsx_state* states, const rsx_ctr_packet* packets, size_t count)
+{
+	ctr_keyed(vpaes_ctr_transform, vpaes_encrypt_block, states, packets, count);
+}
+
+static void vpaes_ctr_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count)
+{
+	ctr_packets(vpaes_ecb_encrypt, state, packets, count);
+}
+
+static void vpaes_ocb_decrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	ocb_blocks(vpaes_ecb_decrypt, state, ltable, output, offset, checksum, input, length, index, false);
+}
+
+static void vpaes_ocb_encrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	ocb_blocks(vpaes_ecb_encrypt, state, ltable, output, offset, checksum, input, length, index, true);
+}
+
+static void vpaes_pmac_sum(rsx_state* state, const rsx_roundkey* ltable, uint8_t* offset, uint8_t* sum, const uint8_t* input, size_t length, uint64_t index)
+{
+	pmac_blocks(vpaes_ecb_encrypt, state, ltable, offset, sum, input, length, index);
+}
+
+static void vpaes_xts_decrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	xts_blocks(vpaes_ecb_decrypt, state, output, tweak, input, length);
+}
+
+static void vpaes_xts_encrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	xts_blocks(vpaes_ecb_encrypt, state, output, tweak, input, length);
+}
+
+#endif
+
+#if defined(RSX_AESNI_SUPPORTED)
+
+RSX_AESNI_TARGET
+static __m128i aesni_load_key(rsx_state* state, size_t index)
+{
+	return _mm_load_si128((const __m128i*)state->roundkeys[index].bytes);
+}
+
+RSX_AESNI_TARGET
+static void aesni_decrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	const size_t RNDCNT = state->rkeylen - 2;
+	size_t keyctr = 0;
+
+	__m128i x = _mm_loadu_si128((const __m128i*)input);
+	x = _mm_xor_si128(x, aesni_load_key(state, keyctr));
+
+	while (keyctr != RNDCNT)
+	{
+		++keyctr;
+		x = _mm_aesdec_si128(x, aesni_load_key(state, keyctr));
+	}
+
+	++keyctr;
+	_mm_storeu_si128((__m128i*)output, _mm_aesdeclast_si128(x, aesni_load_key(state, keyctr)));
+}
+
+RSX_AESNI_TARGET
+static void aesni_encrypt_block(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	const size_t RNDCNT = state->rkeylen - 2;
+	size_t keyctr = 0;
+
+	__m128i x = _mm_loadu_si128((const __m128i*)input);
+	x = _mm_xor_si128(x, aesni_load_key(state, keyctr));
+
+	while (keyctr != RNDCNT)
+	{
+		++keyctr;
+		x = _mm_aesenc_si128(x, aesni_load_key(state, keyctr));
+	}
+
+	++keyctr;
+	_mm_storeu_si128((__m128i*)output, _mm_aesenclast_si128(x, aesni_load_key(state, keyctr)));
+}
+
+RSX_AESNI_TARGET
+static void aesni_decrypt_blocks8(rsx_state* state, __m128i* blocks)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr = 0;
+	__m128i k = aesni_load_key(state, keyctr);
+	__m128i x0 = _mm_xor_si128(blocks[0], k);
+	__m128i x1 = _mm_xor_si128(blocks[1], k);
+	__m128i x2 = _mm_xor_si128(blocks[2], k);
+	__m128i x3 = _mm_xor_si128(blocks[3], k);
+	__m128i x4 = _mm_xor_si128(blocks[4], k);
+	__m128i x5 = _mm_xor_si128(blocks[5], k);
+	__m128i x6 = _mm_xor_si128(blocks[6], k);
+	__m128i x7 = _mm_xor_si128(blocks[7], k);
+
+	while (++keyctr != RNDCNT)
+	{
+		k = aesni_load_key(state, keyctr);
+		x0 = _mm_aesdec_si128(x0, k);
+		x1 = _mm_aesdec_si128(x1, k);
+		x2 = _mm_aesdec_si128(x2, k);
+		x3 = _mm_aesdec_si128(x3, k);
+		x4 = _mm_aesdec_si128(x4, k);
+		x5 = _mm_aesdec_si128(x5, k);
+		x6 = _mm_aesdec_si128(x6, k);
+		x7 = _mm_aesdec_si128(x7, k);
+	}
+
+	k = aesni_load_key(state, keyctr);
+	blocks[0] = _mm_aesdeclast_si128(x0, k);
+	blocks[1] = _mm_aesdeclast_si128(x1, k);
+	blocks[2] = _mm_aesdeclast_si128(x2, k);
+	blocks[3] = _mm_aesdeclast_si128(x3, k);
+	blocks[4] = _mm_aesdeclast_si128(x4, k);
+	blocks[5] = _mm_aesdeclast_si128(x5, k);
+	blocks[6] = _mm_aesdeclast_si128(x6, k);
+	blocks[7] = _mm_aesdeclast_si128(x7, k);
+}
+
+RSX_AESNI_TARGET
+static void aesni_encrypt_blocks8(rsx_state* state, __m128i* blocks)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr = 0;
+	__m128i k = aesni_load_key(state, keyctr);
+	__m128i x0 = _mm_xor_si128(blocks[0], k);
+	__m128i x1 = _mm_xor_si128(blocks[1], k);
+	__m128i x2 = _mm_xor_si128(blocks[2], k);
+	__m128i x3 = _mm_xor_si128(blocks[3], k);
+	__m128i x4 = _mm_xor_si128(blocks[4], k);
+	__m128i x5 = _mm_xor_si128(blocks[5], k);
+	__m128i x6 = _mm_xor_si128(blocks[6], k);
+	__m128i x7 = _mm_xor_si128(blocks[7], k);
+
+	/* eight independent blocks keep the aes unit pipeline full */
+	while (++keyctr != RNDCNT)
+	{
+		k = aesni_load_key(state, keyctr);
+		x0 = _mm_aesenc_si128(x0, k);
+		x1 = _mm_aesenc_si128(x1, k);
+		x2 = _mm_aesenc_si128(x2, k);
+		x3 = _mm_aesenc_si128(x3, k);
+		x4 = _mm_aesenc_si128(x4, k);
+		x5 = _mm_aesenc_si128(x5, k);
+		x6 = _mm_aesenc_si128(x6, k);
+		x7 = _mm_aesenc_si128(x7, k);
+	}
+
+	k = aesni_load_key(state, keyctr);
+	blocks[0] = _mm_aesenclast_si128(x0, k);
+	blocks[1] = _mm_aesenclast_si128(x1, k);
+	blocks[2] = _mm_aesenclast_si128(x2, k);
+	blocks[3] = _mm_aesenclast_si128(x3, k);
+	blocks[4] = _mm_aesenclast_si128(x4, k);
+	blocks[5] = _mm_aesenclast_si128(x5, k);
+	blocks[6] = _mm_aesenclast_si128(x6, k);
+	blocks[7] = _mm_aesenclast_si128(x7, k);
+}
+
+RSX_AESNI_TARGET
+static void aesni_encrypt_blocks8_keyed(rsx_state* const* states, __m128i* blocks)
+{
+	const size_t RNDCNT = states[0]->rkeylen - 1;
+	const rsx_roundkey* rk0 = states[0]->roundkeys;
+	const rsx_roundkey* rk1 = states[1]->roundkeys;
+	const rsx_roundkey* rk2 = states[2]->roundkeys;
+	const rsx_roundkey* rk3 = states[3]->roundkeys;
+	const rsx_roundkey* rk4 = states[4]->roundkeys;
+	const rsx_roundkey* rk5 = states[5]->roundkeys;
+	const rsx_roundkey* rk6 = states[6]->roundkeys;
+	const rsx_roundkey* rk7 = states[7]->roundkeys;
+	size_t keyctr = 0;
+	__m128i x0 = _mm_xor_si128(blocks[0], _mm_load_si128((const __m128i*)rk0[0].bytes));
+	__m128i x1 = _mm_xor_si128(blocks[1], _mm_load_si128((const __m128i*)rk1[0].bytes));
+	__m128i x2 = _mm_xor_si128(blocks[2], _mm_load_si128((const __m128i*)rk2[0].bytes));
+	__m128i x3 = _mm_xor_si128(blocks[3], _mm_load_si128((const __m128i*)rk3[0].bytes));
+	__m128i x4 = _mm_xor_si128(blocks[4], _mm_load_si128((const __m128i*)rk4[0].bytes));
+	__m128i x5 = _mm_xor_si128(blocks[5], _mm_load_si128((const __m128i*)rk5[0].bytes));
+	__m128i x6 = _mm_xor_si128(blocks[6], _mm_load_si128((const __m128i*)rk6[0].bytes));
+	__m128i x7 = _mm_xor_si128(blocks[7], _mm_load_si128((const __m128i*)rk7[0].bytes));
+
+	/* each lane has its own key schedule of the same length; the round keys are loaded per lane, the rounds still overlap */
+	while (++keyctr != RNDCNT)
+	{
+		x0 = _mm_aesenc_si128(x0, _mm_load_si128((const __m128i*)rk0[keyctr].bytes));
+		x1 = _mm_aesenc_si128(x1, _mm_load_si128((const __m128i*)rk1[keyctr].bytes));
+		x2 = _mm_aesenc_si128(x2, _mm_load_si128((const __m128i*)rk2[keyctr].bytes));
+		x3 = _mm_aesenc_si128(x3, _mm_load_si128((const __m128i*)rk3[keyctr].bytes));
+		x4 = _mm_aesenc_si128(x4, _mm_load_si128((const __m128i*)rk4[keyctr].bytes));
+		x5 = _mm_aesenc_si128(x5, _mm_load_si128((const __m128i*)rk5[keyctr].bytes));
+		x6 = _mm_aesenc_si128(x6, _mm_load_si128((const __m128i*)rk6[keyctr].bytes));
+		x7 = _mm_aesenc_si128(x7, _mm_load_si128((const __m128i*)rk7[keyctr].bytes));
+	}
+
+	blocks[0] = _mm_aesenclast_si128(x0, _mm_load_si128((const __m128i*)rk0[keyctr].bytes));
+	blocks[1] = _mm_aesenclast_si128(x1, _mm_load_si128((const __m128i*)rk1[keyctr].bytes));
+	blocks[2] = _mm_aesenclast_si128(x2, _mm_load_si128((const __m128i*)rk2[keyctr].bytes));
+	blocks[3] = _mm_aesenclast_si128(x3, _mm_load_si128((const __m128i*)rk3[keyctr].bytes));
+	blocks[4] = _mm_aesenclast_si128(x4, _mm_load_si128((const __m128i*)rk4[keyctr].bytes));
+	blocks[5] = _mm_aesenclast_si128(x5, _mm_load_si128((const __m128i*)rk5[keyctr].bytes));
+	blocks[6] = _mm_aesenclast_si128(x6, _mm_load_si128((const __m128i*)rk6[keyctr].bytes));
+	blocks[7] = _mm_aesenclast_si128(x7, _mm_load_si128((const __m128i*)rk7[keyctr].bytes));
+}
+
+RSX_AESNI_TARGET
+static void aesni_expand_rot(__m128i* Key, size_t Index, size_t Offset)
+{
+	__m128i pkb = Key[Index - Offset];
+	Key[Index] = _mm_shuffle_epi32(Key[Index], 0xFF);
+	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
+	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
+	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
+	Key[Index] = _mm_xor_si128(pkb, Key[Index]);
+}
+
+RSX_AESNI_TARGET
+static void aesni_expand_sub(__m128i* Key, size_t Index, size_t Offset)
+{
+	// used with 256 bit keys
+	__m128i pkb = Key[Index - Offset];
+	Key[Index] = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(Key[Index - 1], 0x0), 0xAA);
+	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
+	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
+	pkb = _mm_xor_si128(pkb, _mm_slli_si128(pkb, 0x4));
+	Key[Index] = _mm_xor_si128(pkb, Key[Index]);
+}
+
+RSX_AESNI_TARGET
+static void aesni_standard_expand(rsx_state* state, rsx_keyparams* keyparams)
+{
+	__m128i rk[AES256_ROUNDKEY_DIMENSION];
+	size_t i;
+	// key in 32 bit words
+	size_t kwords = keyparams->keylen / 4;
+
+	if (kwords == 8)
+	{
+		rk[0] = _mm_loadu_si128((__m128i*)keyparams->key);
+		rk[1] = _mm_loadu_si128((__m128i*)(keyparams->key + 16));
+		rk[2] = _mm_aeskeygenassist_si128(rk[1], 0x01);
+		aesni_expand_rot(rk, 2, 2);
+		aesni_expand_sub(rk, 3, 2);
+		rk[4] = _mm_aeskeygenassist_si128(rk[3], 0x02);
+		aesni_expand_rot(rk, 4, 2);
+		aesni_expand_sub(rk, 5, 2);
+		rk[6] = _mm_aeskeygenassist_si128(rk[5], 0x04);
+		aesni_expand_rot(rk, 6, 2);
+		aesni_expand_sub(rk, 7, 2);
+		rk[8] = _mm_aeskeygenassist_si128(rk[7], 0x08);
+		aesni_expand_rot(rk, 8, 2);
+		aesni_expand_sub(rk, 9, 2);
+		rk[10] = _mm_aeskeygenassist_si128(rk[9], 0x10);
+		aesni_expand_rot(rk, 10, 2);
+		aesni_expand_sub(rk, 11, 2);
+		rk[12] = _mm_aeskeygenassist_si128(rk[11], 0x20);
+		aesni_expand_rot(rk, 12, 2);
+		aesni_expand_sub(rk, 13, 2);
+		rk[14] = _mm_aeskeygenassist_si128(rk[13], 0x40);
+		aesni_expand_rot(rk, 14, 2);
+	}
+	else
+	{
+		rk[0] = _mm_loadu_si128((__m128i*)keyparams->key);
+		rk[1] = _mm_aeskeygenassist_si128(rk[0], 0x01);
+		aesni_expand_rot(rk, 1, 1);
+		rk[2] = _mm_aeskeygenassist_si128(rk[1], 0x02);
+		aesni_expand_rot(rk, 2, 1);
+		rk[3] = _mm_aeskeygenassist_si128(rk[2], 0x04);
+		aesni_expand_rot(rk, 3, 1);
+		rk[4] = _mm_aeskeygenassist_si128(rk[3], 0x08);
+		aesni_expand_rot(rk, 4, 1);
+		rk[5] = _mm_aeskeygenassist_si128(rk[4], 0x10);
+		aesni_expand_rot(rk, 5, 1);
+		rk[6] = _mm_aeskeygenassist_si128(rk[5], 0x20);
+		aesni_expand_rot(rk, 6, 1);
+		rk[7] = _mm_aeskeygenassist_si128(rk[6], 0x40);
+		aesni_expand_rot(rk, 7, 1);
+		rk[8] = _mm_aeskeygenassist_si128(rk[7], 0x80);
+		aesni_expand_rot(rk, 8, 1);
+		rk[9] = _mm_aeskeygenassist_si128(rk[8], 0x1B);
+		aesni_expand_rot(rk, 9, 1);
+		rk[10] = _mm_aeskeygenassist_si128(rk[9], 0x36);
+		aesni_expand_rot(rk, 10, 1);
+	}
+
+	for (i = 0; i < state->rkeylen; ++i)
+	{
+		_mm_store_si128((__m128i*)state->roundkeys[i].bytes, rk[i]);
+	}
+
+	memset(rk, 0x00, sizeof(rk));
+}
+
+RSX_AESNI_TARGET
+static __m128i aesni_expand_spread(__m128i key)
+{
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 0x4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 0x4));
+
+	return _mm_xor_si128(key, _mm_slli_si128(key, 0x4));
+}
+
+RSX_AESNI_TARGET
+static void aesni_standard_expand_x4(rsx_state* states, rsx_keyparams* keyparams)
+{
+	const uint32_t RCON[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36 };
+	const __m128i ROTWORD = _mm_setr_epi8(13, 14, 15, 12, 13, 14, 15, 12, 13, 14, 15, 12, 13, 14, 15, 12);
+	const __m128i SUBWORD = _mm_setr_epi8(12, 13, 14, 15, 12, 13, 14, 15, 12, 13, 14, 15, 12, 13, 14, 15);
+	__m128i rk[4][AES256_ROUNDKEY_DIMENSION];
+	__m128i rcon;
+	size_t i;
+	size_t j;
+
+	/* aeskeygenassist is microcoded with a low throughput on recent processors, so interleaving it gains little;
+	   the last word is broadcast to every column instead, where ShiftRows has no effect, and aesenclast applies SubWord
+	   and adds the round constant. aesenclast is pipelined, and the four independent key chains fill the pipeline */
+	if (keyparams[0].keylen == 32)
+	{
+		for (j = 0; j < 4; ++j)
+		{
+			rk[j][0] = _mm_loadu_si128((const __m128i*)keyparams[j].key);
+			rk[j][1] = _mm_loadu_si128((const __m128i*)(keyparams[j].key + 16));
+		}
+
+		for (i = 2; i < AES256_ROUNDKEY_DIMENSION; i += 2)
+		{
+			rcon = _mm_set1_epi32((int)RCON[(i / 2) - 1]);
+
+			for (j = 0; j < 4; ++j)
+			{
+				rk[j][i] = _mm_aesenclast_si128(_mm_shuffle_epi8(rk[j][i - 1], ROTWORD), rcon);
+				rk[j][i] = _mm_xor_si128(aesni_expand_spread(rk[j][i - 2]), rk[j][i]);
+			}
+
+			if (i + 1 < AES256_ROUNDKEY_DIMENSION)
+			{
+				for (j = 0; j < 4; ++j)
+				{
+					rk[j][i + 1] = _mm_aesenclast_si128(_mm_shuffle_epi8(rk[j][i], SUBWORD), _mm_setzero_si128());
+					rk[j][i + 1] = _mm_xor_si128(aesni_expand_spread(rk[j][i - 1]), rk[j][i + 1]);
+				}
+			}
+		}
+	}
+	else
+	{
+		for (j = 0; j < 4; ++j)
+		{
+			rk[j][0] = _mm_loadu_si128((const __m128i*)keyparams[j].key);
+		}
+
+		for (i = 1; i < AES128_ROUNDKEY_DIMENSION; ++i)
+		{
+			rcon = _mm_set1_epi32((int)RCON[i - 1]);
+
+			for (j = 0; j < 4; ++j)
+			{
+				rk[j][i] = _mm_aesenclast_si128(_mm_shuffle_epi8(rk[j][i - 1], ROTWORD), rcon);
+				rk[j][i] = _mm_xor_si128(aesni_expand_spread(rk[j][i - 1]), rk[j][i]);
+			}
+		}
+	}
+
+	for (j = 0; j < 4; ++j)
+	{
+		for (i = 0; i < states[j].rkeylen; ++i)
+		{
+			_mm_store_si128((__m128i*)states[j].roundkeys[i].bytes, rk[j][i]);
+		}
+	}
+
+	memset(rk, 0x00, sizeof(rk));
+}
+
+RSX_AESNI_TARGET
+static void aesni_inverse_expand(rsx_state* state)
+{
+	__m128i tmp;
+	size_t i;
+	size_t j;
+
+	tmp = aesni_load_key(state, 0);
+	_mm_store_si128((__m128i*)state->roundkeys[0].bytes, aesni_load_key(state, state->rkeylen - 1));
+	_mm_store_si128((__m128i*)state->roundkeys[state->rkeylen - 1].bytes, tmp);
+
+	for (i = 1, j = state->rkeylen - 2; i < j; ++i, --j)
+	{
+		tmp = _mm_aesimc_si128(aesni_load_key(state, i));
+		_mm_store_si128((__m128i*)state->roundkeys[i].bytes, _mm_aesimc_si128(aesni_load_key(state, j)));
+		_mm_store_si128((__m128i*)state->roundkeys[j].bytes, tmp);
+	}
+
+	_mm_store_si128((__m128i*)state->roundkeys[i].bytes, _mm_aesimc_si128(aesni_load_key(state, i)));
+}
+
+RSX_AESNI_TARGET
+static void aesni_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	__m128i cipher[RSX_CTR_LANES];
+	__m128i prev;
+	size_t i;
+
+	prev = _mm_loadu_si128((const __m128i*)iv);
+
+	while (length >= RSX_CTR_LANES * RSX_BLOCK_SIZE)
+	{
+		/* the cipher-text is held in registers, so the output can overwrite the input */
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			cipher[i] = _mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE)));
+			blocks[i] = cipher[i];
+		}
+
+		aesni_decrypt_blocks8(state, blocks);
+
+		_mm_storeu_si128((__m128i*)output, _mm_xor_si128(blocks[0], prev));
+
+		for (i = 1; i < RSX_CTR_LANES; ++i)
+		{
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), _mm_xor_si128(blocks[i], cipher[i - 1]));
+		}
+
+		prev = cipher[RSX_CTR_LANES - 1];
+		input += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		output += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		length -= RSX_CTR_LANES * RSX_BLOCK_SIZE;
+	}
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		cipher[0] = _mm_loadu_si128((const __m128i*)input);
+		aesni_decrypt_block(state, output, input);
+		_mm_storeu_si128((__m128i*)output, _mm_xor_si128(_mm_loadu_si128((const __m128i*)output), prev));
+		prev = cipher[0];
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)iv, prev);
+}
+
+RSX_AESNI_TARGET
+static void aesni_cbc_encrypt_jobs(rsx_state* state, rsx_cbc_job* jobs, size_t count)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	__m128i chain[RSX_CTR_LANES];
+	rsx_cbc_job* lanes[RSX_CTR_LANES];
+	size_t pos[RSX_CTR_LANES];
+	size_t active;
+	size_t next;
+	size_t i;
+
+	next = 0;
+
+	for (i = 0; i < RSX_CTR_LANES; ++i)
+	{
+		lanes[i] = NULL;
+		pos[i] = 0;
+		chain[i] = _mm_setzero_si128();
+	}
+
+	/* one block from each of up to eight streams per pass of the cipher, so the passes are throughput bound instead of latency bound;
+	   the chaining values stay in registers, and a lane whose stream has ended stores its iv and takes the next job */
+	while (true)
+	{
+		active = 0;
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			if (lanes[i] != NULL && lanes[i]->length - pos[i] < RSX_BLOCK_SIZE)
+			{
+				_mm_storeu_si128((__m128i*)lanes[i]->iv, chain[i]);
+				lanes[i] = NULL;
+			}
+
+			while (lanes[i] == NULL && next < count)
+			{
+				if (jobs[next].length >= RSX_BLOCK_SIZE)
+				{
+					lanes[i] = &jobs[next];
+					pos[i] = 0;
+					chain[i] = _mm_loadu_si128((const __m128i*)jobs[next].iv);
+				}
+
+				++next;
+			}
+
+			if (lanes[i] != NULL)
+			{
+				blocks[i] = _mm_xor_si128(chain[i], _mm_loadu_si128((const __m128i*)(lanes[i]->input + pos[i])));
+				++active;
+			}
+			else
+			{
+				blocks[i] = _mm_setzero_si128();
+			}
+		}
+
+		if (active == 0)
+		{
+			break;
+		}
+
+		aesni_encrypt_blocks8(state, blocks);
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			if (lanes[i] != NULL)
+			{
+				chain[i] = blocks[i];
+				_mm_storeu_si128((__m128i*)(lanes[i]->output + pos[i]), blocks[i]);
+				pos[i] += RSX_BLOCK_SIZE;
+			}
+		}
+	}
+}
+
+RSX_AESNI_TARGET
+static void aesni_cbc_mac(rsx_state* state, uint8_t* mac, const uint8_t* input, size_t length)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr;
+	__m128i m;
+
+	m = _mm_loadu_si128((const __m128i*)mac);
+
+	/* the chaining value stays in a register; the round keys are loaded off the critical path */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		keyctr = 0;
+		m = _mm_xor_si128(m, _mm_loadu_si128((const __m128i*)input));
+		m = _mm_xor_si128(m, aesni_load_key(state, keyctr));
+
+		while (++keyctr != RNDCNT)
+		{
+			m = _mm_aesenc_si128(m, aesni_load_key(state, keyctr));
+		}
+
+		m = _mm_aesenclast_si128(m, aesni_load_key(state, keyctr));
+		input += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)mac, m);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ccm_transform(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length, bool encryption)
+{
+	const __m128i BSWAP = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i ONE = _mm_set_epi32(0, 0, 0, 1);
+	const size_t RNDCNT = state->rkeylen - 1;
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t keyctr;
+	__m128i ks;
+	__m128i c;
+	__m128i k;
+	__m128i m;
+	__m128i p;
+	__m128i x;
+
+	/* the ccm counter field is at most 8 bytes and can not wrap within a message, so the counter is a 64 bit add */
+	c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ctr), BSWAP);
+	m = _mm_loadu_si128((const __m128i*)mac);
+	ks = _mm_setzero_si128();
+
+	if (encryption == false && length >= RSX_BLOCK_SIZE)
+	{
+		/* decryption authenticates the plain-text, so the keystream runs one block ahead of the mac */
+		aesni_encrypt_block(state, tmpb, ctr);
+		ks = _mm_loadu_si128((const __m128i*)tmpb);
+	}
+
+	/* cbc-mac is serial; each mac round is paired with a round of an independent counter block,
+	   which runs in the latency of the mac chain instead of in a second pass over the message */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		p = _mm_loadu_si128((const __m128i*)input);
+
+		if (encryption == false)
+		{
+			p = _mm_xor_si128(p, ks);
+			_mm_storeu_si128((__m128i*)output, p);
+			c = _mm_add_epi64(c, ONE);
+		}
+
+		keyctr = 0;
+		k = aesni_load_key(state, keyctr);
+		m = _mm_xor_si128(_mm_xor_si128(m, p), k);
+		x = _mm_xor_si128(_mm_shuffle_epi8(c, BSWAP), k);
+
+		while (++keyctr != RNDCNT)
+		{
+			k = aesni_load_key(state, keyctr);
+			m = _mm_aesenc_si128(m, k);
+			x = _mm_aesenc_si128(x, k);
+		}
+
+		k = aesni_load_key(state, keyctr);
+		m = _mm_aesenclast_si128(m, k);
+		x = _mm_aesenclast_si128(x, k);
+
+		if (encryption == true)
+		{
+			_mm_storeu_si128((__m128i*)output, _mm_xor_si128(p, x));
+			c = _mm_add_epi64(c, ONE);
+		}
+		else
+		{
+			ks = x;
+		}
+
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)mac, m);
+	_mm_storeu_si128((__m128i*)ctr, _mm_shuffle_epi8(c, BSWAP));
+}
+
+RSX_AESNI_TARGET
+static void aesni_ccm_decrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	aesni_ccm_transform(state, mac, output, ctr, input, length, false);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ccm_encrypt(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	aesni_ccm_transform(state, mac, output, ctr, input, length, true);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ctr_lanes(rsx_state* state, rsx_state* states, const rsx_ctr_packet* packets, size_t count)
+{
+	const __m128i BSWAP = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i ONE = _mm_set_epi32(0, 0, 0, 1);
+	__m128i blocks[RSX_CTR_LANES];
+	const uint8_t* inputs[RSX_CTR_LANES];
+	uint8_t* outputs[RSX_CTR_LANES];
+	rsx_state* keys[RSX_CTR_LANES];
+	size_t lens[RSX_CTR_LANES];
+	uint8_t ctrb[RSX_BLOCK_SIZE];
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	__m128i ctr;
+	size_t active;
+	size_t blen;
+	size_t nblk;
+	size_t next;
+	size_t pos;
+	size_t i;
+	size_t j;
+	bool carry;
+
+	ctr = _mm_setzero_si128();
+	carry = false;
+	next = 0;
+	pos = 0;
+
+	/* the counter blocks of consecutive packets fill the eight lanes, so short packets do not each start and drain the pipeline;
+	   the counter is kept byte reversed in a register, and the last block of each packet can be partial.
+	   with a state array, packet i is encrypted with states[i], and a batch can mix keys */
+	while (next != count)
+	{
+		active = 0;
+
+		while (active != RSX_CTR_LANES && next != count)
+		{
+			if (pos >= packets[next].length)
+			{
+				++next;
+				pos = 0;
+			}
+			else
+			{
+				nblk = ((packets[next].length - pos) + (RSX_BLOCK_SIZE - 1)) / RSX_BLOCK_SIZE;
+				nblk = (nblk > RSX_CTR_LANES - active) ? RSX_CTR_LANES - active : nblk;
+
+				if (pos == 0)
+				{
+					/* a packet that carries into the upper 64 bits of its counter is counted bytewise */
+					carry = (load_be64(packets[next].nonce, 8) > UINT64_MAX - ((packets[next].length / RSX_BLOCK_SIZE) + 1));
+					memcpy(ctrb, packets[next].nonce, RSX_BLOCK_SIZE);
+					ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ctrb), BSWAP);
+				}
+
+				if (carry == true)
+				{
+					for (i = 0; i < nblk; ++i)
+					{
+						blocks[active + i] = _mm_loadu_si128((const __m128i*)ctrb);
+						increment_be8(ctrb);
+					}
+				}
+				else
+				{
+					for (i = 0; i < nblk; ++i)
+					{
+						blocks[active + i] = _mm_shuffle_epi8(ctr, BSWAP);
+						ctr = _mm_add_epi64(ctr, ONE);
+					}
+				}
+
+				for (i = 0; i < nblk; ++i)
+				{
+					blen = packets[next].length - pos;
+					inputs[active + i] = packets[next].input + pos;
+					outputs[active + i] = packets[next].output + pos;
+					keys[active + i] = (states != NULL) ? &states[next] : state;
+					lens[active + i] = (blen > RSX_BLOCK_SIZE) ? RSX_BLOCK_SIZE : blen;
+					pos += RSX_BLOCK_SIZE;
+				}
+
+				active += nblk;
+			}
+		}
+
+		if (active != 0)
+		{
+			for (i = active; i < RSX_CTR_LANES; ++i)
+			{
+				blocks[i] = _mm_setzero_si128();
+				keys[i] = keys[0];
+			}
+
+			if (states == NULL)
+			{
+				aesni_encrypt_blocks8(state, blocks);
+			}
+			else
+			{
+				aesni_encrypt_blocks8_keyed(keys, blocks);
+			}
+
+			for (i = 0; i < active; ++i)
+			{
+				if (lens[i] == RSX_BLOCK_SIZE)
+				{
+					_mm_storeu_si128((__m128i*)outputs[i], _mm_xor_si128(blocks[i], _mm_loadu_si128((const __m128i*)inputs[i])));
+				}
+				else
+				{
+					_mm_storeu_si128((__m128i*)tmpb, blocks[i]);
+
+					for (j = 0; j < lens[i]; ++j)
+					{
+						outputs[i][j] = inputs[i][j] ^ tmpb[j];
+					}
+				}
+			}
+		}
+	}
+
+	memset(ctrb, 0, sizeof(ctrb));
+	memset(tmpb, 0, sizeof(tmpb));
+}
+
+RSX_AESNI_TARGET
+static void aesni_ctr_keyed(rsx_state* states, const rsx_ctr_packet* packets, size_t count)
+{
+	aesni_ctr_lanes(NULL, states, packets, count);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ctr_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count)
+{
+	aesni_ctr_lanes(state, NULL, packets, count);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length)
+{
+	const __m128i BSWAP = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	__m128i blocks[RSX_CTR_LANES];
+	__m128i ctr;
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t i;
+
+	while (length >= RSX_CTR_LANES * RSX_BLOCK_SIZE)
+	{
+		if (load_be64(nonce, 8) <= UINT64_MAX - RSX_CTR_LANES)
+		{
+			/* no carry into the upper 64 bits in this batch; derive the counters with vector adds */
+			ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)nonce), BSWAP);
+			blocks[0] = _mm_shuffle_epi8(ctr, BSWAP);
+			blocks[1] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 1)), BSWAP);
+			blocks[2] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 2)), BSWAP);
+			blocks[3] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 3)), BSWAP);
+			blocks[4] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 4)), BSWAP);
+			blocks[5] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 5)), BSWAP);
+			blocks[6] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 6)), BSWAP);
+			blocks[7] = _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 7)), BSWAP);
+			_mm_storeu_si128((__m128i*)nonce, _mm_shuffle_epi8(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, RSX_CTR_LANES)), BSWAP));
+		}
+		else
+		{
+			for (i = 0; i < RSX_CTR_LANES; ++i)
+			{
+				blocks[i] = _mm_loadu_si128((const __m128i*)nonce);
+				increment_be8(nonce);
+			}
+		}
+
+		aesni_encrypt_blocks8(state, blocks);
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			_mm_storeu_si128((__m128i*)output, _mm_xor_si128(blocks[i], _mm_loadu_si128((const __m128i*)input)));
+			input += RSX_BLOCK_SIZE;
+			output += RSX_BLOCK_SIZE;
+		}
+
+		length -= RSX_CTR_LANES * RSX_BLOCK_SIZE;
+	}
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		aesni_encrypt_block(state, tmpb, nonce);
+		_mm_storeu_si128((__m128i*)output, _mm_xor_si128(_mm_loadu_si128((const __m128i*)tmpb), _mm_loadu_si128((const __m128i*)input)));
+		increment_be8(nonce);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+RSX_AESNI_TARGET
+static void aesni_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	size_t i;
+
+	while (length >= RSX_CTR_LANES * RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			blocks[i] = _mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE)));
+		}
+
+		aesni_decrypt_blocks8(state, blocks);
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), blocks[i]);
+		}
+
+		input += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		output += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		length -= RSX_CTR_LANES * RSX_BLOCK_SIZE;
+	}
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		aesni_decrypt_block(state, output, input);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+RSX_AESNI_TARGET
+static void aesni_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	size_t i;
+
+	while (length >= RSX_CTR_LANES * RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			blocks[i] = _mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE)));
+		}
+
+		aesni_encrypt_blocks8(state, blocks);
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), blocks[i]);
+		}
+
+		input += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		output += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		length -= RSX_CTR_LANES * RSX_BLOCK_SIZE;
+	}
+
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		aesni_encrypt_block(state, output, input);
+		input += RSX_BLOCK_SIZE;
+		output += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+}
+
+RSX_AESNI_TARGET
+static void aesni_ocb_transform(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index, bool encryption)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	__m128i offsets[RSX_CTR_LANES];
+	__m128i off;
+	__m128i sum;
+	__m128i x;
+	size_t nblocks;
+	size_t i;
+
+	off = _mm_loadu_si128((const __m128i*)offset);
+	sum = _mm_loadu_si128((const __m128i*)checksum);
+
+	/* the offsets and the checksum stay in registers; a short batch fills the unused cipher lanes with zeros */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		nblocks = length / RSX_BLOCK_SIZE;
+		nblocks = (nblocks > RSX_CTR_LANES) ? RSX_CTR_LANES : nblocks;
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			if (i < nblocks)
+			{
+				++index;
+				off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index)].bytes));
+				offsets[i] = off;
+				x = _mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE)));
+				sum = (encryption == true) ? _mm_xor_si128(sum, x) : sum;
+				blocks[i] = _mm_xor_si128(x, off);
+			}
+			else
+			{
+				blocks[i] = _mm_setzero_si128();
+			}
+		}
+
+		if (encryption == true)
+		{
+			aesni_encrypt_blocks8(state, blocks);
+		}
+		else
+		{
+			aesni_decrypt_blocks8(state, blocks);
+		}
+
+		for (i = 0; i < nblocks; ++i)
+		{
+			x = _mm_xor_si128(blocks[i], offsets[i]);
+			sum = (encryption == false) ? _mm_xor_si128(sum, x) : sum;
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), x);
+		}
+
+		input += nblocks * RSX_BLOCK_SIZE;
+		output += nblocks * RSX_BLOCK_SIZE;
+		length -= nblocks * RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)offset, off);
+	_mm_storeu_si128((__m128i*)checksum, sum);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ocb_decrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	aesni_ocb_transform(state, ltable, output, offset, checksum, input, length, index, false);
+}
+
+RSX_AESNI_TARGET
+static void aesni_ocb_encrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	aesni_ocb_transform(state, ltable, output, offset, checksum, input, length, index, true);
+}
+
+RSX_AESNI_TARGET
+static void aesni_pmac_sum(rsx_state* state, const rsx_roundkey* ltable, uint8_t* offset, uint8_t* sum, const uint8_t* input, size_t length, uint64_t index)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	__m128i off;
+	__m128i acc;
+	size_t i;
+
+	off = _mm_loadu_si128((const __m128i*)offset);
+	acc = _mm_loadu_si128((const __m128i*)sum);
+
+	/* eight offset blocks per pass of the cipher */
+	while (length >= RSX_CTR_LANES * RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			++index;
+			off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index)].bytes));
+			blocks[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE))), off);
+		}
+
+		aesni_encrypt_blocks8(state, blocks);
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			acc = _mm_xor_si128(acc, blocks[i]);
+		}
+
+		input += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		length -= RSX_CTR_LANES * RSX_BLOCK_SIZE;
+	}
+
+	/* the blocks of a short message are independent, so they overlap without filling the unused lanes */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		++index;
+		off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index)].bytes));
+		_mm_storeu_si128((__m128i*)tmpb, _mm_xor_si128(_mm_loadu_si128((const __m128i*)input), off));
+		aesni_encrypt_block(state, tmpb, tmpb);
+		acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i*)tmpb));
+		input += RSX_BLOCK_SIZE;
+		length -= RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)offset, off);
+	_mm_storeu_si128((__m128i*)sum, acc);
+}
+
+RSX_AESNI_TARGET
+static __m128i aesni_xts_double(__m128i tweak)
+{
+	__m128i carry;
+
+	/* each 32 bit lane is doubled, the bit shifted out of a lane is carried into the next, and the top bit folds back as 0x87 */
+	carry = _mm_srai_epi32(tweak, 31);
+	carry = _mm_and_si128(carry, _mm_set_epi32(0x87, 1, 1, 1));
+	carry = _mm_shuffle_epi32(carry, 0x93);
+
+	return _mm_xor_si128(_mm_add_epi32(tweak, tweak), carry);
+}
+
+RSX_AESNI_TARGET
+static void aesni_xts_transform(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length, bool encryption)
+{
+	__m128i blocks[RSX_CTR_LANES];
+	__m128i tweaks[RSX_CTR_LANES];
+	__m128i tw;
+	size_t nblocks;
+	size_t i;
+
+	tw = _mm_loadu_si128((const __m128i*)tweak);
+
+	/* eight tweaks are derived in registers and whiten both sides of the 8-way cipher; a short batch fills the unused lanes with zeros */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		nblocks = length / RSX_BLOCK_SIZE;
+		nblocks = (nblocks > RSX_CTR_LANES) ? RSX_CTR_LANES : nblocks;
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			if (i < nblocks)
+			{
+				tweaks[i] = tw;
+				blocks[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE))), tw);
+				tw = aesni_xts_double(tw);
+			}
+			else
+			{
+				blocks[i] = _mm_setzero_si128();
+			}
+		}
+
+		if (encryption == true)
+		{
+			aesni_encrypt_blocks8(state, blocks);
+		}
+		else
+		{
+			aesni_decrypt_blocks8(state, blocks);
+		}
+
+		for (i = 0; i < nblocks; ++i)
+		{
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), _mm_xor_si128(blocks[i], tweaks[i]));
+		}
+
+		input += nblocks * RSX_BLOCK_SIZE;
+		output += nblocks * RSX_BLOCK_SIZE;
+		length -= nblocks * RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)tweak, tw);
+}
+
+RSX_AESNI_TARGET
+static void aesni_xts_decrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	aesni_xts_transform(state, output, tweak, input, length, false);
+}
+
+RSX_AESNI_TARGET
+static void aesni_xts_encrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	aesni_xts_transform(state, output, tweak, input, length, true);
+}
+
+#if defined(RSX_VAES_SUPPORTED)
+
+RSX_VAES_TARGET
+static void vaes_decrypt_blocks16(rsx_state* state, __m512i* blocks)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr = 0;
+	__m512i k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+	__m512i x0 = _mm512_xor_si512(blocks[0], k);
+	__m512i x1 = _mm512_xor_si512(blocks[1], k);
+	__m512i x2 = _mm512_xor_si512(blocks[2], k);
+	__m512i x3 = _mm512_xor_si512(blocks[3], k);
+
+	while (++keyctr != RNDCNT)
+	{
+		k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+		x0 = _mm512_aesdec_epi128(x0, k);
+		x1 = _mm512_aesdec_epi128(x1, k);
+		x2 = _mm512_aesdec_epi128(x2, k);
+		x3 = _mm512_aesdec_epi128(x3, k);
+	}
+
+	k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+	blocks[0] = _mm512_aesdeclast_epi128(x0, k);
+	blocks[1] = _mm512_aesdeclast_epi128(x1, k);
+	blocks[2] = _mm512_aesdeclast_epi128(x2, k);
+	blocks[3] = _mm512_aesdeclast_epi128(x3, k);
+}
+
+RSX_VAES_TARGET
+static void vaes_encrypt_blocks16(rsx_state* state, __m512i* blocks)
+{
+	const size_t RNDCNT = state->rkeylen - 1;
+	size_t keyctr = 0;
+	__m512i k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+	__m512i x0 = _mm512_xor_si512(blocks[0], k);
+	__m512i x1 = _mm512_xor_si512(blocks[1], k);
+	__m512i x2 = _mm512_xor_si512(blocks[2], k);
+	__m512i x3 = _mm512_xor_si512(blocks[3], k);
+
+	/* four registers of four blocks each; sixteen independent blocks in flight */
+	while (++keyctr != RNDCNT)
+	{
+		k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+		x0 = _mm512_aesenc_epi128(x0, k);
+		x1 = _mm512_aesenc_epi128(x1, k);
+		x2 = _mm512_aesenc_epi128(x2, k);
+		x3 = _mm512_aesenc_epi128(x3, k);
+	}
+
+	k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+	blocks[0] = _mm512_aesenclast_epi128(x0, k);
+	blocks[1] = _mm512_aesenclast_epi128(x1, k);
+	blocks[2] = _mm512_aesenclast_epi128(x2, k);
+	blocks[3] = _mm512_aesenclast_epi128(x3, k);
+}
+
+RSX_VAES_TARGET
+static void vaes_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length)
+{
+	__m512i blocks[4];
+	__m512i cipher[4];
+	__m512i prev;
+	size_t plen;
+	size_t i;
+
+	/* the chaining value is kept in the top lane of prev */
+	prev = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)iv));
+	plen = 0;
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			cipher[i] = _mm512_loadu_si512((const void*)(input + plen + (i * 64)));
+			blocks[i] = cipher[i];
+		}
+
+		vaes_decrypt_blocks16(state, blocks);
+
+		/* shift the cipher-text up one lane, the previous register supplies the lowest lane */
+		_mm512_storeu_si512((void*)(output + plen), _mm512_xor_si512(blocks[0], _mm512_alignr_epi64(cipher[0], prev, 6)));
+		_mm512_storeu_si512((void*)(output + plen + 64), _mm512_xor_si512(blocks[1], _mm512_alignr_epi64(cipher[1], cipher[0], 6)));
+		_mm512_storeu_si512((void*)(output + plen + 128), _mm512_xor_si512(blocks[2], _mm512_alignr_epi64(cipher[2], cipher[1], 6)));
+		_mm512_storeu_si512((void*)(output + plen + 192), _mm512_xor_si512(blocks[3], _mm512_alignr_epi64(cipher[3], cipher[2], 6)));
+
+		prev = cipher[3];
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)iv, _mm512_extracti32x4_epi32(prev, 3));
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	aesni_cbc_decrypt(state, output + plen, iv, input + plen, length - plen);
+}
+
+RSX_VAES_TARGET
+static void vaes_ctr_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count)
+{
+	const __m128i BSWAP = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m128i ONE = _mm_set_epi32(0, 0, 0, 1);
+	__m128i blocks[RSX_VAES_LANES];
+	const uint8_t* inputs[RSX_VAES_LANES];
+	uint8_t* outputs[RSX_VAES_LANES];
+	size_t lens[RSX_VAES_LANES];
+	uint8_t ctrb[RSX_BLOCK_SIZE];
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	__m512i wide[4];
+	__m128i ctr;
+	size_t active;
+	size_t blen;
+	size_t nblk;
+	size_t next;
+	size_t pos;
+	size_t i;
+	size_t j;
+	bool carry;
+
+	ctr = _mm_setzero_si128();
+	carry = false;
+	next = 0;
+	pos = 0;
+
+	/* as the AES-NI kernel, with sixteen lanes; the blocks are gathered in 128 bit lanes and loaded four to a register */
+	while (next != count)
+	{
+		active = 0;
+
+		while (active != RSX_VAES_LANES && next != count)
+		{
+			if (pos >= packets[next].length)
+			{
+				++next;
+				pos = 0;
+			}
+			else
+			{
+				nblk = ((packets[next].length - pos) + (RSX_BLOCK_SIZE - 1)) / RSX_BLOCK_SIZE;
+				nblk = (nblk > RSX_VAES_LANES - active) ? RSX_VAES_LANES - active : nblk;
+
+				if (pos == 0)
+				{
+					/* a packet that carries into the upper 64 bits of its counter is counted bytewise */
+					carry = (load_be64(packets[next].nonce, 8) > UINT64_MAX - ((packets[next].length / RSX_BLOCK_SIZE) + 1));
+					memcpy(ctrb, packets[next].nonce, RSX_BLOCK_SIZE);
+					ctr = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ctrb), BSWAP);
+				}
+
+				if (carry == true)
+				{
+					for (i = 0; i < nblk; ++i)
+					{
+						blocks[active + i] = _mm_loadu_si128((const __m128i*)ctrb);
+						increment_be8(ctrb);
+					}
+				}
+				else
+				{
+					for (i = 0; i < nblk; ++i)
+					{
+						blocks[active + i] = _mm_shuffle_epi8(ctr, BSWAP);
+						ctr = _mm_add_epi64(ctr, ONE);
+					}
+				}
+
+				for (i = 0; i < nblk; ++i)
+				{
+					blen = packets[next].length - pos;
+					inputs[active + i] = packets[next].input + pos;
+					outputs[active + i] = packets[next].output + pos;
+					lens[active + i] = (blen > RSX_BLOCK_SIZE) ? RSX_BLOCK_SIZE : blen;
+					pos += RSX_BLOCK_SIZE;
+				}
+
+				active += nblk;
+			}
+		}
+
+		if (active != 0)
+		{
+			for (i = active; i < RSX_VAES_LANES; ++i)
+			{
+				blocks[i] = _mm_setzero_si128();
+			}
+
+			for (i = 0; i < 4; ++i)
+			{
+				wide[i] = _mm512_loadu_si512((const void*)&blocks[i * 4]);
+			}
+
+			vaes_encrypt_blocks16(state, wide);
+
+			for (i = 0; i < 4; ++i)
+			{
+				_mm512_storeu_si512((void*)&blocks[i * 4], wide[i]);
+			}
+
+			for (i = 0; i < active; ++i)
+			{
+				if (lens[i] == RSX_BLOCK_SIZE)
+				{
+					_mm_storeu_si128((__m128i*)outputs[i], _mm_xor_si128(blocks[i], _mm_loadu_si128((const __m128i*)inputs[i])));
+				}
+				else
+				{
+					_mm_storeu_si128((__m128i*)tmpb, blocks[i]);
+
+					for (j = 0; j < lens[i]; ++j)
+					{
+						outputs[i][j] = inputs[i][j] ^ tmpb[j];
+					}
+				}
+			}
+		}
+	}
+
+	memset(ctrb, 0, sizeof(ctrb));
+	memset(tmpb, 0, sizeof(tmpb));
+	_mm256_zeroupper();
+}
+
+RSX_VAES_TARGET
+static void vaes_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length)
+{
+	const __m128i BSWAP = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const __m512i WSWAP = _mm512_broadcast_i32x4(BSWAP);
+	const __m512i LINC = _mm512_set_epi64(0, 3, 0, 2, 0, 1, 0, 0);
+	const __m512i LSTEP = _mm512_set_epi64(0, 4, 0, 4, 0, 4, 0, 4);
+	uint8_t ctrb[RSX_VAES_LANES * RSX_BLOCK_SIZE];
+	__m512i blocks[4];
+	__m512i ctr;
+	size_t plen;
+	size_t i;
+
+	plen = 0;
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		if (load_be64(nonce, 8) <= UINT64_MAX - RSX_VAES_LANES)
+		{
+			/* no carry into the upper 64 bits in this batch; derive the counters with vector adds */
+			ctr = _mm512_broadcast_i32x4(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)nonce), BSWAP));
+			ctr = _mm512_add_epi64(ctr, LINC);
+
+			for (i = 0; i < 4; ++i)
+			{
+				blocks[i] = _mm512_shuffle_epi8(ctr, WSWAP);
+				ctr = _mm512_add_epi64(ctr, LSTEP);
+			}
+
+			_mm_storeu_si128((__m128i*)nonce, _mm_shuffle_epi8(_mm512_castsi512_si128(ctr), BSWAP));
+		}
+		else
+		{
+			for (i = 0; i < RSX_VAES_LANES; ++i)
+			{
+				memcpy(ctrb + (i * RSX_BLOCK_SIZE), nonce, RSX_BLOCK_SIZE);
+				increment_be8(nonce);
+			}
+
+			for (i = 0; i < 4; ++i)
+			{
+				blocks[i] = _mm512_loadu_si512((const void*)(ctrb + (i * 64)));
+			}
+		}
+
+		vaes_encrypt_blocks16(state, blocks);
+
+		for (i = 0; i < 4; ++i)
+		{
+			_mm512_storeu_si512((void*)(output + plen + (i * 64)), _mm512_xor_si512(blocks[i], _mm512_loadu_si512((const void*)(input + plen + (i * 64)))));
+		}
+
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+	}
+
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	aesni_ctr_transform(state, output + plen, nonce, input + plen, length - plen);
+}
+
+RSX_VAES_TARGET
+static void vaes_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	__m512i blocks[4];
+	size_t plen;
+	size_t i;
+
+	plen = 0;
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			blocks[i] = _mm512_loadu_si512((const void*)(input + plen + (i * 64)));
+		}
+
+		vaes_decrypt_blocks16(state, blocks);
+
+		for (i = 0; i < 4; ++i)
+		{
+			_mm512_storeu_si512((void*)(output + plen + (i * 64)), blocks[i]);
+		}
+
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+	}
+
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	aesni_ecb_decrypt(state, output + plen, input + plen, length - plen);
+}
+
+RSX_VAES_TARGET
+static void vaes_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	__m512i blocks[4];
+	size_t plen;
+	size_t i;
+
+	plen = 0;
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < 4; ++i)
+		{
+			blocks[i] = _mm512_loadu_si512((const void*)(input + plen + (i * 64)));
+		}
+
+		vaes_encrypt_blocks16(state, blocks);
+
+		for (i = 0; i < 4; ++i)
+		{
+			_mm512_storeu_si512((void*)(output + plen + (i * 64)), blocks[i]);
+		}
+
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+	}
+
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	aesni_ecb_encrypt(state, output + plen, input + plen, length - plen);
+}
+
+RSX_VAES_TARGET
+static void vaes_ocb_transform(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index, bool encryption)
+{
+	__m512i blocks[4];
+	__m512i offsets[4];
+	__m512i sums;
+	__m512i x;
+	__m128i off;
+	__m128i sum;
+	size_t plen;
+	size_t i;
+
+	plen = 0;
+	off = _mm_loadu_si128((const __m128i*)offset);
+	sums = _mm512_setzero_si512();
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		/* the offsets are a serial chain; each one is inserted into its lane as it is derived */
+		for (i = 0; i < 4; ++i)
+		{
+			off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index + 1)].bytes));
+			offsets[i] = _mm512_castsi128_si512(off);
+			off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index + 2)].bytes));
+			offsets[i] = _mm512_inserti32x4(offsets[i], off, 1);
+			off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index + 3)].bytes));
+			offsets[i] = _mm512_inserti32x4(offsets[i], off, 2);
+			off = _mm_xor_si128(off, _mm_load_si128((const __m128i*)ltable[ocb_ntz(index + 4)].bytes));
+			offsets[i] = _mm512_inserti32x4(offsets[i], off, 3);
+			index += 4;
+			x = _mm512_loadu_si512((const void*)(input + plen + (i * 64)));
+			sums = (encryption == true) ? _mm512_xor_si512(sums, x) : sums;
+			blocks[i] = _mm512_xor_si512(x, offsets[i]);
+		}
+
+		if (encryption == true)
+		{
+			vaes_encrypt_blocks16(state, blocks);
+		}
+		else
+		{
+			vaes_decrypt_blocks16(state, blocks);
+		}
+
+		for (i = 0; i < 4; ++i)
+		{
+			x = _mm512_xor_si512(blocks[i], offsets[i]);
+			sums = (encryption == false) ? _mm512_xor_si512(sums, x) : sums;
+			_mm512_storeu_si512((void*)(output + plen + (i * 64)), x);
+		}
+
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+	}
+
+	/* the four checksum lanes fold into the 128 bit checksum */
+	sum = _mm_xor_si128(_mm512_castsi512_si128(sums), _mm512_extracti32x4_epi32(sums, 1));
+	sum = _mm_xor_si128(sum, _mm512_extracti32x4_epi32(sums, 2));
+	sum = _mm_xor_si128(sum, _mm512_extracti32x4_epi32(sums, 3));
+	_mm_storeu_si128((__m128i*)checksum, _mm_xor_si128(sum, _mm_loadu_si128((const __m128i*)checksum)));
+	_mm_storeu_si128((__m128i*)offset, off);
+
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	aesni_ocb_transform(state, ltable, output + plen, offset, checksum, input + plen, length - plen, index, encryption);
+}
+
+RSX_VAES_TARGET
+static void vaes_ocb_decrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	vaes_ocb_transform(state, ltable, output, offset, checksum, input, length, index, false);
+}
+
+RSX_VAES_TARGET
+static void vaes_ocb_encrypt(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index)
+{
+	vaes_ocb_transform(state, ltable, output, offset, checksum, input, length, index, true);
+}
+
+RSX_VAES_TARGET
+static void vaes_xts_transform(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length, bool encryption)
+{
+	__m512i blocks[4];
+	__m512i tweaks[4];
+	__m128i tw;
+	size_t plen;
+	size_t i;
+
+	plen = 0;
+	tw = _mm_loadu_si128((const __m128i*)tweak);
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		/* the sixteen tweaks are assembled in registers, storing them and reloading as wide vectors would stall store forwarding */
+		for (i = 0; i < 4; ++i)
+		{
+			tweaks[i] = _mm512_castsi128_si512(tw);
+			tw = aesni_xts_double(tw);
+			tweaks[i] = _mm512_inserti32x4(tweaks[i], tw, 1);
+			tw = aesni_xts_double(tw);
+			tweaks[i] = _mm512_inserti32x4(tweaks[i], tw, 2);
+			tw = aesni_xts_double(tw);
+			tweaks[i] = _mm512_inserti32x4(tweaks[i], tw, 3);
+			tw = aesni_xts_double(tw);
+			blocks[i] = _mm512_xor_si512(_mm512_loadu_si512((const void*)(input + plen + (i * 64))), tweaks[i]);
+		}
+
+		if (encryption == true)
+		{
+			vaes_encrypt_blocks16(state, blocks);
+		}
+		else
+		{
+			vaes_decrypt_blocks16(state, blocks);
+		}
+
+		for (i = 0; i < 4; ++i)
+		{
+			_mm512_storeu_si512((void*)(output + plen + (i * 64)), _mm512_xor_si512(blocks[i], tweaks[i]));
+		}
+
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+	}
+
+	_mm_storeu_si128((__m128i*)tweak, tw);
+
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	aesni_xts_transform(state, output + plen, tweak, input + plen, length - plen, encryption);
+}
+
+RSX_VAES_TARGET
+static void vaes_xts_decrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	vaes_xts_transform(state, output, tweak, input, length, false);
+}
+
+RSX_VAES_TARGET
+static void vaes_xts_encrypt(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	vaes_xts_transform(state, output, tweak, input, length, true);
+}
+
+#endif
+
+#endif
+
+/* GHASH */
+
+/* The GCM hash multiplies in GF(2^128) with the reflected bit order of SP800-38D. The portable multiply is constant-time;
+   each 64 bit carry-less product is computed with integer multiplies on operands spread to every fourth bit, so that
+   carries cannot reach the bits that are kept (T. Pornin, BearSSL ghash_ctmul64). The high half of a product is the
+   bit reversed product of the bit reversed operands. The POLYVAL hash of GCM-SIV runs on the same multiply, with the
+   blocks read in little endian order. */
+
+static uint64_t gf_bmul64(uint64_t x, uint64_t y)
+{
+	uint64_t x0;
+	uint64_t x1;
+	uint64_t x2;
+	uint64_t x3;
+	uint64_t y0;
+	uint64_t y1;
+	uint64_t y2;
+	uint64_t y3;
+	uint64_t z0;
+	uint64_t z1;
+	uint64_t z2;
+	uint64_t z3;
+
+	x0 = x & 0x1111111111111111ULL;
+	x1 = x & 0x2222222222222222ULL;
+	x2 = x & 0x4444444444444444ULL;
+	x3 = x & 0x8888888888888888ULL;
+	y0 = y & 0x1111111111111111ULL;
+	y1 = y & 0x2222222222222222ULL;
+	y2 = y & 0x4444444444444444ULL;
+	y3 = y & 0x8888888888888888ULL;
+
+	z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+	z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+	z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+	z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+
+	z0 &= 0x1111111111111111ULL;
+	z1 &= 0x2222222222222222ULL;
+	z2 &= 0x4444444444444444ULL;
+	z3 &= 0x8888888888888888ULL;
+
+	return z0 | z1 | z2 | z3;
+}
+
+static uint64_t gf_rev64(uint64_t x)
+{
+	x = ((x & 0x5555555555555555ULL) << 1) | ((x >> 1) & 0x5555555555555555ULL);
+	x = ((x & 0x3333333333333333ULL) << 2) | ((x >> 2) & 0x3333333333333333ULL);
+	x = ((x & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+	x = ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+	x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+
+	return (x << 32) | (x >> 32);
+}
+
+static void gf_multiply(uint64_t* y1, uint64_t* y0, uint64_t h1, uint64_t h0)
+{
+	uint64_t v0;
+	uint64_t v1;
+	uint64_t v2;
+	uint64_t v3;
+	uint64_t z0;
+	uint64_t z1;
+	uint64_t z2;
+	uint64_t z0h;
+	uint64_t z1h;
+	uint64_t z2h;
+
+	/* karatsuba over the 64 bit halves, on the operands and their bit reversals */
+	z0 = gf_bmul64(*y0, h0);
+	z1 = gf_bmul64(*y1, h1);
+	z2 = gf_bmul64(*y0 ^ *y1, h0 ^ h1);
+	z0h = gf_bmul64(gf_rev64(*y0), gf_rev64(h0));
+	z1h = gf_bmul64(gf_rev64(*y1), gf_rev64(h1));
+	z2h = gf_bmul64(gf_rev64(*y0 ^ *y1), gf_rev64(h0 ^ h1));
+	z2 ^= z0 ^ z1;
+	z2h ^= z0h ^ z1h;
+	z0h = gf_rev64(z0h) >> 1;
+	z1h = gf_rev64(z1h) >> 1;
+	z2h = gf_rev64(z2h) >> 1;
+
+	v0 = z0;
+	v1 = z0h ^ z2;
+	v2 = z1 ^ z2h;
+	v3 = z1h;
+
+	/* the reflected product is one bit short, shift it into place and reduce by x^128 + x^7 + x^2 + x + 1 */
+	v3 = (v3 << 1) | (v2 >> 63);
+	v2 = (v2 << 1) | (v1 >> 63);
+	v1 = (v1 << 1) | (v0 >> 63);
+	v0 = (v0 << 1);
+
+	v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+	v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+	v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+	v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+	*y0 = v2;
+	*y1 = v3;
+}
+
+static void hash_portable(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks, bool polyval)
+{
+	uint64_t h0;
+	uint64_t h1;
+	uint64_t y0;
+	uint64_t y1;
+	size_t i;
+
+	/* the portable path multiplies by H once per block, only the first power is used;
+	   POLYVAL blocks are the byte reversed GHASH blocks */
+	h1 = load_be64(hpowers[0].bytes, 0);
+	h0 = load_be64(hpowers[0].bytes, 8);
+	y1 = (polyval == true) ? load_le64(hash, 8) : load_be64(hash, 0);
+	y0 = (polyval == true) ? load_le64(hash, 0) : load_be64(hash, 8);
+
+	for (i = 0; i < nblocks; ++i)
+	{
+		y1 ^= (polyval == true) ? load_le64(input, (i * RSX_BLOCK_SIZE) + 8) : load_be64(input, i * RSX_BLOCK_SIZE);
+		y0 ^= (polyval == true) ? load_le64(input, i * RSX_BLOCK_SIZE) : load_be64(input, (i * RSX_BLOCK_SIZE) + 8);
+		gf_multiply(&y1, &y0, h1, h0);
+	}
+
+	if (polyval == true)
+	{
+		le64_to_bytes(y1, hash, 8);
+		le64_to_bytes(y0, hash, 0);
+	}
+	else
+	{
+		be64_to_bytes(y1, hash, 0);
+		be64_to_bytes(y0, hash, 8);
+	}
+}
+
+static void ghash_portable(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	hash_portable(hpowers, hash, input, nblocks, false);
+}
+
+static void polyval_portable(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	hash_portable(hpowers, hash, input, nblocks, true);
+}
+
+static void ghash_powers(rsx_roundkey* hpowers, const uint8_t* hkey)
+{
+	uint64_t h0;
+	uint64_t h1;
+	uint64_t y0;
+	uint64_t y1;
+	size_t i;
+
+	h1 = load_be64(hkey, 0);
+	h0 = load_be64(hkey, 8);
+	y1 = h1;
+	y0 = h0;
+	memcpy(hpowers[0].bytes, hkey, RSX_BLOCK_SIZE);
+
+	for (i = 1; i < RSX_GCM_HPOWERS; ++i)
+	{
+		gf_multiply(&y1, &y0, h1, h0);
+		be64_to_bytes(y1, hpowers[i].bytes, 0);
+		be64_to_bytes(y0, hpowers[i].bytes, 8);
+	}
+}
+
+#if defined(RSX_AESNI_SUPPORTED)
+
+/* Carry-less multiply GHASH (S. Gueron, M. Kounavis, Intel Carry-Less Multiplication Instruction and its Usage for
+   Computing the GCM Mode). Blocks are byte reversed into registers, eight products by H^8..H^1 are summed unreduced,
+   and the sum is shifted and reduced once per eight blocks. */
+
+RSX_PCLMUL_TARGET static __m128i clmul_reduce(__m128i lo, __m128i hi)
+{
+	__m128i t0;
+	__m128i t1;
+	__m128i t2;
+
+	/* shift the 256 bit product left by one */
+	t0 = _mm_srli_epi32(lo, 31);
+	t1 = _mm_srli_epi32(hi, 31);
+	lo = _mm_slli_epi32(lo, 1);
+	hi = _mm_slli_epi32(hi, 1);
+	t2 = _mm_srli_si128(t0, 12);
+	t1 = _mm_slli_si128(t1, 4);
+	t0 = _mm_slli_si128(t0, 4);
+	lo = _mm_or_si128(lo, t0);
+	hi = _mm_or_si128(hi, t1);
+	hi = _mm_or_si128(hi, t2);
+
+	/* reduce modulo x^128 + x^7 + x^2 + x + 1 */
+	t0 = _mm_slli_epi32(lo, 31);
+	t1 = _mm_slli_epi32(lo, 30);
+	t2 = _mm_slli_epi32(lo, 25);
+	t0 = _mm_xor_si128(t0, t1);
+	t0 = _mm_xor_si128(t0, t2);
+	t1 = _mm_srli_si128(t0, 4);
+	t0 = _mm_slli_si128(t0, 12);
+	lo = _mm_xor_si128(lo, t0);
+
+	t2 = _mm_srli_epi32(lo, 1);
+	t0 = _mm_srli_epi32(lo, 2);
+	t2 = _mm_xor_si128(t2, t0);
+	t0 = _mm_srli_epi32(lo, 7);
+	t2 = _mm_xor_si128(t2, t0);
+	t2 = _mm_xor_si128(t2, t1);
+	lo = _mm_xor_si128(lo, t2);
+
+	return _mm_xor_si128(hi, lo);
+}
+
+RSX_PCLMUL_TARGET static void clmul_accumulate(__m128i x, __m128i h, __m128i hk, __m128i* lo, __m128i* mid, __m128i* hi)
+{
+	/* karatsuba; hk holds the xor of the halves of h in both lanes */
+	*lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(x, h, 0x00));
+	*hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(x, h, 0x11));
+	x = _mm_xor_si128(x, _mm_shuffle_epi32(x, 0x4E));
+	*mid = _mm_xor_si128(*mid, _mm_clmulepi64_si128(x, hk, 0x00));
+}
+
+RSX_PCLMUL_TARGET static __m128i clmul_combine(__m128i lo, __m128i mid, __m128i hi)
+{
+	mid = _mm_xor_si128(mid, _mm_xor_si128(lo, hi));
+	lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+	hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+	return clmul_reduce(lo, hi);
+}
+
+RSX_PCLMUL_TARGET static void clmul_hash(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks, __m128i order)
+{
+	const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	__m128i h[RSX_GCM_HPOWERS];
+	__m128i hk[RSX_GCM_HPOWERS];
+	__m128i lo;
+	__m128i mid;
+	__m128i hi;
+	__m128i x;
+	__m128i y;
+	size_t i;
+
+	for (i = 0; i < RSX_GCM_HPOWERS; ++i)
+	{
+		h[i] = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)hpowers[i].bytes), bswap);
+		hk[i] = _mm_xor_si128(h[i], _mm_shuffle_epi32(h[i], 0x4E));
+	}
+
+	y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)hash), order);
+
+	while (nblocks >= RSX_GCM_HPOWERS)
+	{
+		lo = _mm_setzero_si128();
+		mid = _mm_setzero_si128();
+		hi = _mm_setzero_si128();
+
+		/* (y + x0)H^8 + x1H^7 + .. + x7H */
+		for (i = 0; i < RSX_GCM_HPOWERS; ++i)
+		{
+			x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE))), order);
+
+			if (i == 0)
+			{
+				x = _mm_xor_si128(x, y);
+			}
+
+			clmul_accumulate(x, h[RSX_GCM_HPOWERS - 1 - i], hk[RSX_GCM_HPOWERS - 1 - i], &lo, &mid, &hi);
+		}
+
+		y = clmul_combine(lo, mid, hi);
+		input += RSX_GCM_HPOWERS * RSX_BLOCK_SIZE;
+		nblocks -= RSX_GCM_HPOWERS;
+	}
+
+	while (nblocks != 0)
+	{
+		lo = _mm_setzero_si128();
+		mid = _mm_setzero_si128();
+		hi = _mm_setzero_si128();
+		x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)input), order);
+		clmul_accumulate(_mm_xor_si128(x, y), h[0], hk[0], &lo, &mid, &hi);
+		y = clmul_combine(lo, mid, hi);
+		input += RSX_BLOCK_SIZE;
+		--nblocks;
+	}
+
+	_mm_storeu_si128((__m128i*)hash, _mm_shuffle_epi8(y, order));
+}
+
+RSX_PCLMUL_TARGET static void ghash_clmul(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	/* GHASH blocks are big endian */
+	clmul_hash(hpowers, hash, input, nblocks, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+RSX_PCLMUL_TARGET static void polyval_clmul(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	/* POLYVAL blocks are the byte reversed GHASH blocks, and load without a shuffle */
+	clmul_hash(hpowers, hash, input, nblocks, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+RSX_PCLMUL_TARGET static void clmul_powers(rsx_roundkey* hpowers, const uint8_t* hkey)
+{
+	const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	__m128i h;
+	__m128i hk;
+	__m128i lo;
+	__m128i mid;
+	__m128i hi;
+	__m128i y;
+	size_t i;
+
+	h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)hkey), bswap);
+	hk = _mm_xor_si128(h, _mm_shuffle_epi32(h, 0x4E));
+	y = h;
+	_mm_store_si128((__m128i*)hpowers[0].bytes, _mm_shuffle_epi8(y, bswap));
+
+	for (i = 1; i < RSX_GCM_HPOWERS; ++i)
+	{
+		lo = _mm_setzero_si128();
+		mid = _mm_setzero_si128();
+		hi = _mm_setzero_si128();
+		clmul_accumulate(y, h, hk, &lo, &mid, &hi);
+		y = clmul_combine(lo, mid, hi);
+		_mm_store_si128((__m128i*)hpowers[i].bytes, _mm_shuffle_epi8(y, bswap));
+	}
+}
+
+static void aesni_ghash(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	/* carry-less multiply shipped with AES-NI, but a hypervisor can hide it */
+	if (cpu_features_get()->pclmul == true)
+	{
+		ghash_clmul(hpowers, hash, input, nblocks);
+	}
+	else
+	{
+		ghash_portable(hpowers, hash, input, nblocks);
+	}
+}
+
+static void aesni_ghash_powers(rsx_roundkey* hpowers, const uint8_t* hkey)
+{
+	if (cpu_features_get()->pclmul == true)
+	{
+		clmul_powers(hpowers, hkey);
+	}
+	else
+	{
+		ghash_powers(hpowers, hkey);
+	}
+}
+
+static void aesni_polyval(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	if (cpu_features_get()->pclmul == true)
+	{
+		polyval_clmul(hpowers, hash, input, nblocks);
+	}
+	else
+	{
+		polyval_portable(hpowers, hash, input, nblocks);
+	}
+}
+
+#if defined(RSX_VAES_SUPPORTED)
+
+/* The VPCLMULQDQ hash multiplies four blocks per instruction; sixteen blocks are summed unreduced against H^16..H^1,
+   and the reduction runs on all four lanes before they are added. */
+
+RSX_VPCLMUL_TARGET
+static void vpclmul_accumulate(__m512i x, __m512i h, __m512i hk, __m512i* lo, __m512i* mid, __m512i* hi)
+{
+	/* four karatsuba products, one in each 128 bit lane */
+	*lo = _mm512_xor_si512(*lo, _mm512_clmulepi64_epi128(x, h, 0x00));
+	*hi = _mm512_xor_si512(*hi, _mm512_clmulepi64_epi128(x, h, 0x11));
+	x = _mm512_xor_si512(x, _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)0x4E));
+	*mid = _mm512_xor_si512(*mid, _mm512_clmulepi64_epi128(x, hk, 0x00));
+}
+
+RSX_VPCLMUL_TARGET
+static __m512i vpclmul_combine(__m512i lo, __m512i mid, __m512i hi)
+{
+	__m512i t0;
+	__m512i t1;
+	__m512i t2;
+
+	/* clmul_combine in each 128 bit lane; the SSE version would stall every instruction on the dirty upper state */
+	mid = _mm512_xor_si512(mid, _mm512_xor_si512(lo, hi));
+	lo = _mm512_xor_si512(lo, _mm512_bslli_epi128(mid, 8));
+	hi = _mm512_xor_si512(hi, _mm512_bsrli_epi128(mid, 8));
+
+	t0 = _mm512_srli_epi32(lo, 31);
+	t1 = _mm512_srli_epi32(hi, 31);
+	lo = _mm512_slli_epi32(lo, 1);
+	hi = _mm512_slli_epi32(hi, 1);
+	t2 = _mm512_bsrli_epi128(t0, 12);
+	t1 = _mm512_bslli_epi128(t1, 4);
+	t0 = _mm512_bslli_epi128(t0, 4);
+	lo = _mm512_or_si512(lo, t0);
+	hi = _mm512_or_si512(hi, t1);
+	hi = _mm512_or_si512(hi, t2);
+
+	t0 = _mm512_slli_epi32(lo, 31);
+	t1 = _mm512_slli_epi32(lo, 30);
+	t2 = _mm512_slli_epi32(lo, 25);
+	t0 = _mm512_xor_si512(t0, t1);
+	t0 = _mm512_xor_si512(t0, t2);
+	t1 = _mm512_bsrli_epi128(t0, 4);
+	t0 = _mm512_bslli_epi128(t0, 12);
+	lo = _mm512_xor_si512(lo, t0);
+
+	t2 = _mm512_srli_epi32(lo, 1);
+	t0 = _mm512_srli_epi32(lo, 2);
+	t2 = _mm512_xor_si512(t2, t0);
+	t0 = _mm512_srli_epi32(lo, 7);
+	t2 = _mm512_xor_si512(t2, t0);
+	t2 = _mm512_xor_si512(t2, t1);
+	lo = _mm512_xor_si512(lo, t2);
+
+	return _mm512_xor_si512(hi, lo);
+}
+
+RSX_VPCLMUL_TARGET
+static __m128i vpclmul_fold(__m512i x)
+{
+	__m256i t;
+
+	/* the reduction is linear, so the four lane sums reduce to one by xor */
+	t = _mm256_xor_si256(_mm512_castsi512_si256(x), _mm512_extracti64x4_epi64(x, 1));
+
+	return _mm_xor_si128(_mm256_castsi256_si128(t), _mm256_extracti128_si256(t, 1));
+}
+
+RSX_VPCLMUL_TARGET
+static __m512i vpclmul_multiply(__m512i x, __m512i h)
+{
+	__m512i lo;
+	__m512i mid;
+	__m512i hi;
+
+	lo = _mm512_setzero_si512();
+	mid = _mm512_setzero_si512();
+	hi = _mm512_setzero_si512();
+	vpclmul_accumulate(x, h, _mm512_xor_si512(h, _mm512_shuffle_epi32(h, (_MM_PERM_ENUM)0x4E)), &lo, &mid, &hi);
+
+	return vpclmul_combine(lo, mid, hi);
+}
+
+RSX_VPCLMUL_TARGET
+static void vpclmul_powers(const rsx_roundkey* hpowers, __m512i* hz, __m512i* hkz)
+{
+	const __m512i BSWAP = _mm512_broadcast_i32x4(_mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+	__m512i h8;
+	size_t i;
+
+	/* H^9..H^16 are the stored powers times H^8, so a batch of sixteen blocks is reduced once; the lanes are
+	   reversed so that register j of a batch is multiplied by H^(16 - 4j)..H^(13 - 4j), from the low lane up */
+	hz[3] = _mm512_shuffle_epi8(_mm512_loadu_si512((const void*)hpowers[0].bytes), BSWAP);
+	hz[2] = _mm512_shuffle_epi8(_mm512_loadu_si512((const void*)hpowers[4].bytes), BSWAP);
+	h8 = _mm512_shuffle_i64x2(hz[2], hz[2], 0xFF);
+	hz[1] = vpclmul_multiply(hz[3], h8);
+	hz[0] = vpclmul_multiply(hz[2], h8);
+
+	for (i = 0; i < 4; ++i)
+	{
+		hz[i] = _mm512_shuffle_i64x2(hz[i], hz[i], 0x1B);
+		hkz[i] = _mm512_xor_si512(hz[i], _mm512_shuffle_epi32(hz[i], (_MM_PERM_ENUM)0x4E));
+	}
+}
+
+RSX_VPCLMUL_TARGET
+static void vpclmul_hash(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks, __m128i order)
+{
+	const __m512i ORDER = _mm512_broadcast_i32x4(order);
+	uint8_t tail[RSX_VAES_LANES * RSX_BLOCK_SIZE];
+	const uint8_t* src;
+	__m512i hz[4];
+	__m512i hkz[4];
+	__m512i lo;
+	__m512i mid;
+	__m512i hi;
+	__m512i x;
+	__m128i y;
+	size_t pos;
+	size_t i;
+
+	y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)hash), order);
+
+	if (nblocks >= RSX_GCM_HPOWERS)
+	{
+		vpclmul_powers(hpowers, hz, hkz);
+
+		/* sixteen blocks in four registers, one reduction: (y + x0)H^16 + x1H^15 + .. + x15H; a short last batch
+		   is placed at the end of a zeroed batch, leading zero blocks leave the sum unchanged */
+		while (nblocks != 0)
+		{
+			src = input;
+
+			if (nblocks < RSX_VAES_LANES)
+			{
+				pos = (RSX_VAES_LANES - nblocks) * RSX_BLOCK_SIZE;
+				memset(tail, 0, pos);
+				memcpy(tail + pos, input, nblocks * RSX_BLOCK_SIZE);
+				_mm_storeu_si128((__m128i*)(tail + pos), _mm_xor_si128(_mm_loadu_si128((const __m128i*)(tail + pos)), _mm_shuffle_epi8(y, order)));
+				y = _mm_setzero_si128();
+				src = tail;
+				nblocks = RSX_VAES_LANES;
+			}
+
+			lo = _mm512_setzero_si512();
+			mid = _mm512_setzero_si512();
+			hi = _mm512_setzero_si512();
+
+			for (i = 0; i < 4; ++i)
+			{
+				x = _mm512_shuffle_epi8(_mm512_loadu_si512((const void*)(src + (i * 64))), ORDER);
+
+				if (i == 0)
+				{
+					x = _mm512_xor_si512(x, _mm512_inserti32x4(_mm512_setzero_si512(), y, 0));
+				}
+
+				vpclmul_accumulate(x, hz[i], hkz[i], &lo, &mid, &hi);
+			}
+
+			y = vpclmul_fold(vpclmul_combine(lo, mid, hi));
+			input += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+			nblocks -= RSX_VAES_LANES;
+		}
+
+		_mm_storeu_si128((__m128i*)hash, _mm_shuffle_epi8(y, order));
+		_mm256_zeroupper();
+		memset(tail, 0, sizeof(tail));
+	}
+	else
+	{
+		clmul_hash(hpowers, hash, input, nblocks, order);
+	}
+}
+
+static void vaes_ghash(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	if (cpu_features_get()->vpclmul == true)
+	{
+		vpclmul_hash(hpowers, hash, input, nblocks, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+	}
+	else
+	{
+		aesni_ghash(hpowers, hash, input, nblocks);
+	}
+}
+
+static void vaes_polyval(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks)
+{
+	if (cpu_features_get()->vpclmul == true)
+	{
+		vpclmul_hash(hpowers, hash, input, nblocks, _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	}
+	else
+	{
+		aesni_polyval(hpowers, hash, input, nblocks);
+	}
+}
+
+#endif
+
+#endif
+
+/* XCTR */
+
+/* The XCTR keystream of HCTR2 (P. Crowley, N. Huckleberry, E. Biggers, Length-preserving encryption with HCTR2) encrypts
+   the iv xor the little endian block index. HCTR2 hashes the XCTR output with POLYVAL, so the kernels produce and hash
+   the output in the same pass; the carry-less multiply kernels hash the previous batch between the cipher rounds of
+   the next, and the two instruction streams run on separate execution ports. */
+
+static void xctr_blocks(void (*ecb)(rsx_state*, uint8_t*, const uint8_t*, size_t), void (*polyval)(const rsx_roundkey*, uint8_t*, const uint8_t*, size_t), rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	uint8_t ks[RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE];
+	size_t blen;
+	size_t i;
+
+	/* a batch of counter blocks runs through the multi-block cipher, and the output is hashed while it is in the L1 cache */
+	while (length >= RSX_BLOCK_SIZE)
+	{
+		blen = length - (length % RSX_BLOCK_SIZE);
+		blen = (blen > sizeof(ks)) ? sizeof(ks) : blen;
+
+		for (i = 0; i < blen; i += RSX_BLOCK_SIZE)
+		{
+			memcpy(ks + i, iv, RSX_BLOCK_SIZE);
+			le64_to_bytes(load_le64(iv, 0) ^ index, ks, i);
+			++index;
+		}
+
+		ecb(state, ks, ks, blen);
+
+		for (i = 0; i < blen; ++i)
+		{
+			output[i] = input[i] ^ ks[i];
+		}
+
+		polyval(hpowers, hash, output, blen / RSX_BLOCK_SIZE);
+		input += blen;
+		output += blen;
+		length -= blen;
+	}
+
+	memset(ks, 0, sizeof(ks));
+}
+
+static void table_xctr_polyval(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	xctr_blocks(table_ecb_encrypt, polyval_portable, state, hpowers, hash, output, iv, input, length, index);
+}
+
+static void bitsliced_xctr_polyval(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	xctr_blocks(bitsliced_ecb_encrypt, polyval_portable, state, hpowers, hash, output, iv, input, length, index);
+}
+
+#if defined(RSX_AESNI_SUPPORTED)
+
+static void vpaes_xctr_polyval(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	xctr_blocks(vpaes_ecb_encrypt, polyval_portable, state, hpowers, hash, output, iv, input, length, index);
+}
+
+RSX_AESCLMUL_TARGET
+static void xctr_polyval_clmul(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	const __m128i bswap = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const size_t RNDCNT = state->rkeylen - 1;
+	__m128i blocks[RSX_CTR_LANES];
+	__m128i prev[RSX_CTR_LANES];
+	__m128i h[RSX_GCM_HPOWERS];
+	__m128i hk[RSX_GCM_HPOWERS];
+	__m128i ivb;
+	__m128i k;
+	__m128i lo;
+	__m128i mid;
+	__m128i hi;
+	__m128i x0;
+	__m128i x1;
+	__m128i x2;
+	__m128i x3;
+	__m128i x4;
+	__m128i x5;
+	__m128i x6;
+	__m128i x7;
+	__m128i y;
+	size_t keyctr;
+	size_t nblocks;
+	size_t i;
+	bool pending;
+
+	for (i = 0; i < RSX_GCM_HPOWERS; ++i)
+	{
+		h[i] = _mm_shuffle_epi8(_mm_load_si128((const __m128i*)hpowers[i].bytes), bswap);
+		hk[i] = _mm_xor_si128(h[i], _mm_shuffle_epi32(h[i], 0x4E));
+	}
+
+	ivb = _mm_loadu_si128((const __m128i*)iv);
+	y = _mm_loadu_si128((const __m128i*)hash);
+	pending = false;
+
+	while (length >= RSX_CTR_LANES * RSX_BLOCK_SIZE)
+	{
+		k = _mm_xor_si128(ivb, aesni_load_key(state, 0));
+		x0 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)index));
+		x1 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 1)));
+		x2 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 2)));
+		x3 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 3)));
+		x4 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 4)));
+		x5 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 5)));
+		x6 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 6)));
+		x7 = _mm_xor_si128(k, _mm_set_epi64x(0, (int64_t)(index + 7)));
+		lo = _mm_setzero_si128();
+		mid = _mm_setzero_si128();
+		hi = _mm_setzero_si128();
+
+		/* every cipher has at least nine middle rounds; the first eight each carry one block of the previous batch through the hash */
+		for (keyctr = 1; keyctr != RNDCNT; ++keyctr)
+		{
+			k = aesni_load_key(state, keyctr);
+			x0 = _mm_aesenc_si128(x0, k);
+			x1 = _mm_aesenc_si128(x1, k);
+			x2 = _mm_aesenc_si128(x2, k);
+			x3 = _mm_aesenc_si128(x3, k);
+			x4 = _mm_aesenc_si128(x4, k);
+			x5 = _mm_aesenc_si128(x5, k);
+			x6 = _mm_aesenc_si128(x6, k);
+			x7 = _mm_aesenc_si128(x7, k);
+
+			if (pending == true && keyctr <= RSX_CTR_LANES)
+			{
+				clmul_accumulate(prev[keyctr - 1], h[RSX_CTR_LANES - keyctr], hk[RSX_CTR_LANES - keyctr], &lo, &mid, &hi);
+			}
+		}
+
+		k = aesni_load_key(state, keyctr);
+		prev[0] = _mm_xor_si128(_mm_aesenclast_si128(x0, k), _mm_loadu_si128((const __m128i*)input));
+		prev[1] = _mm_xor_si128(_mm_aesenclast_si128(x1, k), _mm_loadu_si128((const __m128i*)(input + 16)));
+		prev[2] = _mm_xor_si128(_mm_aesenclast_si128(x2, k), _mm_loadu_si128((const __m128i*)(input + 32)));
+		prev[3] = _mm_xor_si128(_mm_aesenclast_si128(x3, k), _mm_loadu_si128((const __m128i*)(input + 48)));
+		prev[4] = _mm_xor_si128(_mm_aesenclast_si128(x4, k), _mm_loadu_si128((const __m128i*)(input + 64)));
+		prev[5] = _mm_xor_si128(_mm_aesenclast_si128(x5, k), _mm_loadu_si128((const __m128i*)(input + 80)));
+		prev[6] = _mm_xor_si128(_mm_aesenclast_si128(x6, k), _mm_loadu_si128((const __m128i*)(input + 96)));
+		prev[7] = _mm_xor_si128(_mm_aesenclast_si128(x7, k), _mm_loadu_si128((const __m128i*)(input + 112)));
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), prev[i]);
+		}
+
+		/* the running hash is folded into the first block of the batch: (y + x0)H^8 + x1H^7 + .. + x7H */
+		if (pending == true)
+		{
+			y = clmul_combine(lo, mid, hi);
+		}
+
+		prev[0] = _mm_xor_si128(prev[0], y);
+		pending = true;
+		input += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		output += RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		length -= RSX_CTR_LANES * RSX_BLOCK_SIZE;
+		index += RSX_CTR_LANES;
+	}
+
+	if (pending == true)
+	{
+		lo = _mm_setzero_si128();
+		mid = _mm_setzero_si128();
+		hi = _mm_setzero_si128();
+
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			clmul_accumulate(prev[i], h[RSX_GCM_HPOWERS - 1 - i], hk[RSX_GCM_HPOWERS - 1 - i], &lo, &mid, &hi);
+		}
+
+		y = clmul_combine(lo, mid, hi);
+	}
+
+	_mm_storeu_si128((__m128i*)hash, y);
+
+	/* the last few blocks encrypt a short batch, and are hashed one at a time */
+	nblocks = length / RSX_BLOCK_SIZE;
+
+	if (nblocks != 0)
+	{
+		for (i = 0; i < RSX_CTR_LANES; ++i)
+		{
+			blocks[i] = _mm_xor_si128(ivb, _mm_set_epi64x(0, (int64_t)(index + i)));
+		}
+
+		aesni_encrypt_blocks8(state, blocks);
+
+		for (i = 0; i < nblocks; ++i)
+		{
+			_mm_storeu_si128((__m128i*)(output + (i * RSX_BLOCK_SIZE)), _mm_xor_si128(blocks[i], _mm_loadu_si128((const __m128i*)(input + (i * RSX_BLOCK_SIZE)))));
+		}
+
+		polyval_clmul(hpowers, hash, output, nblocks);
+	}
+}
+
+static void aesni_xctr_polyval(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	if (cpu_features_get()->pclmul == true)
+	{
+		xctr_polyval_clmul(state, hpowers, hash, output, iv, input, length, index);
+	}
+	else
+	{
+		xctr_blocks(aesni_ecb_encrypt, polyval_portable, state, hpowers, hash, output, iv, input, length, index);
+	}
+}
+
+#if defined(RSX_VAES_SUPPORTED)
+
+RSX_VPCLMUL_TARGET
+static void xctr_polyval_vpclmul(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	const __m512i LSTEP = _mm512_set_epi64(0, 4, 0, 4, 0, 4, 0, 4);
+	const size_t RNDCNT = state->rkeylen - 1;
+	__m512i hz[4];
+	__m512i hkz[4];
+	__m512i prev[4];
+	__m512i ivb;
+	__m512i ctr;
+	__m512i k;
+	__m512i lo;
+	__m512i mid;
+	__m512i hi;
+	__m512i x0;
+	__m512i x1;
+	__m512i x2;
+	__m512i x3;
+	__m128i y;
+	size_t keyctr;
+	size_t plen;
+	size_t i;
+	bool pending;
+
+	vpclmul_powers(hpowers, hz, hkz);
+	ivb = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)iv));
+	ctr = _mm512_set_epi64(0, (int64_t)(index + 3), 0, (int64_t)(index + 2), 0, (int64_t)(index + 1), 0, (int64_t)index);
+	y = _mm_loadu_si128((const __m128i*)hash);
+	pending = false;
+	plen = 0;
+
+	while (length - plen >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		k = _mm512_xor_si512(ivb, _mm512_broadcast_i32x4(aesni_load_key(state, 0)));
+		x0 = _mm512_xor_si512(k, ctr);
+		ctr = _mm512_add_epi64(ctr, LSTEP);
+		x1 = _mm512_xor_si512(k, ctr);
+		ctr = _mm512_add_epi64(ctr, LSTEP);
+		x2 = _mm512_xor_si512(k, ctr);
+		ctr = _mm512_add_epi64(ctr, LSTEP);
+		x3 = _mm512_xor_si512(k, ctr);
+		ctr = _mm512_add_epi64(ctr, LSTEP);
+		lo = _mm512_setzero_si512();
+		mid = _mm512_setzero_si512();
+		hi = _mm512_setzero_si512();
+
+		/* the first four rounds each carry one register of the previous batch through the hash */
+		for (keyctr = 1; keyctr != RNDCNT; ++keyctr)
+		{
+			k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+			x0 = _mm512_aesenc_epi128(x0, k);
+			x1 = _mm512_aesenc_epi128(x1, k);
+			x2 = _mm512_aesenc_epi128(x2, k);
+			x3 = _mm512_aesenc_epi128(x3, k);
+
+			if (pending == true && keyctr <= 4)
+			{
+				vpclmul_accumulate(prev[keyctr - 1], hz[keyctr - 1], hkz[keyctr - 1], &lo, &mid, &hi);
+			}
+		}
+
+		k = _mm512_broadcast_i32x4(aesni_load_key(state, keyctr));
+		prev[0] = _mm512_xor_si512(_mm512_aesenclast_epi128(x0, k), _mm512_loadu_si512((const void*)(input + plen)));
+		prev[1] = _mm512_xor_si512(_mm512_aesenclast_epi128(x1, k), _mm512_loadu_si512((const void*)(input + plen + 64)));
+		prev[2] = _mm512_xor_si512(_mm512_aesenclast_epi128(x2, k), _mm512_loadu_si512((const void*)(input + plen + 128)));
+		prev[3] = _mm512_xor_si512(_mm512_aesenclast_epi128(x3, k), _mm512_loadu_si512((const void*)(input + plen + 192)));
+
+		for (i = 0; i < 4; ++i)
+		{
+			_mm512_storeu_si512((void*)(output + plen + (i * 64)), prev[i]);
+		}
+
+		/* the running hash is folded into the first block of the batch */
+		if (pending == true)
+		{
+			y = vpclmul_fold(vpclmul_combine(lo, mid, hi));
+		}
+
+		prev[0] = _mm512_xor_si512(prev[0], _mm512_inserti32x4(_mm512_setzero_si512(), y, 0));
+		pending = true;
+		plen += RSX_VAES_LANES * RSX_BLOCK_SIZE;
+		index += RSX_VAES_LANES;
+	}
+
+	if (pending == true)
+	{
+		lo = _mm512_setzero_si512();
+		mid = _mm512_setzero_si512();
+		hi = _mm512_setzero_si512();
+
+		for (i = 0; i < 4; ++i)
+		{
+			vpclmul_accumulate(prev[i], hz[i], hkz[i], &lo, &mid, &hi);
+		}
+
+		y = vpclmul_fold(vpclmul_combine(lo, mid, hi));
+	}
+
+	_mm_storeu_si128((__m128i*)hash, y);
+
+	/* the tail runs SSE code, which stalls while the upper register state is dirty */
+	_mm256_zeroupper();
+	xctr_polyval_clmul(state, hpowers, hash, output + plen, iv, input + plen, length - plen, index);
+}
+
+static void vaes_xctr_polyval(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index)
+{
+	/* the wide kernel extends the key powers on every call, which a short message does not repay */
+	if (cpu_features_get()->vpclmul == true && length >= RSX_VAES_LANES * RSX_BLOCK_SIZE)
+	{
+		xctr_polyval_vpclmul(state, hpowers, hash, output, iv, input, length, index);
+	}
+	else
+	{
+		aesni_xctr_polyval(state, hpowers, hash, output, iv, input, length, index);
+	}
+}
+
+#endif
+
+#endif
+
+/* Kernel Dispatch */
+
+typedef struct rsx_kernels
+{
+	rsx_backend backend;
+	void (*decrypt_block)(rsx_state* state, uint8_t* output, const uint8_t* input);
+	void (*encrypt_block)(rsx_state* state, uint8_t* output, const uint8_t* input);
+	void (*cbc_decrypt)(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length);
+	void (*cbc_encrypt_jobs)(rsx_state* state, rsx_cbc_job* jobs, size_t count);
+	void (*cbc_mac)(rsx_state* state, uint8_t* mac, const uint8_t* input, size_t length);
+	void (*ccm_decrypt)(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length);
+	void (*ccm_encrypt)(rsx_state* state, uint8_t* mac, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length);
+	void (*ctr_keyed)(rsx_state* states, const rsx_ctr_packet* packets, size_t count);
+	void (*ctr_packets)(rsx_state* state, const rsx_ctr_packet* packets, size_t count);
+	void (*ctr_transform)(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length);
+	void (*ecb_decrypt)(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length);
+	void (*ecb_encrypt)(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length);
+	void (*ocb_decrypt)(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index);
+	void (*ocb_encrypt)(rsx_state* state, const rsx_roundkey* ltable, uint8_t* output, uint8_t* offset, uint8_t* checksum, const uint8_t* input, size_t length, uint64_t index);
+	void (*pmac_sum)(rsx_state* state, const rsx_roundkey* ltable, uint8_t* offset, uint8_t* sum, const uint8_t* input, size_t length, uint64_t index);
+	void (*xctr_polyval)(rsx_state* state, const rsx_roundkey* hpowers, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length, uint64_t index);
+	void (*xts_decrypt)(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length);
+	void (*xts_encrypt)(rsx_state* state, uint8_t* output, uint8_t* tweak, const uint8_t* input, size_t length);
+	void (*standard_expand)(rsx_state* state, rsx_keyparams* keyparams);
+	void (*standard_expand_x4)(rsx_state* states, rsx_keyparams* keyparams);
+	void (*inverse_expand)(rsx_state* state);
+	void (*ghash)(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks);
+	void (*ghash_powers)(rsx_roundkey* hpowers, const uint8_t* hkey);
+	void (*polyval)(const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t nblocks);
+} rsx_kernels;
+
+static const rsx_kernels table_kernels =
+{
+	RSX_BACKEND_TABLE,
+	table_decrypt_block,
+	table_encrypt_block,
+	table_cbc_decrypt,
+	table_cbc_encrypt_jobs,
+	table_cbc_mac,
+	table_ccm_decrypt,
+	table_ccm_encrypt,
+	table_ctr_keyed,
+	table_ctr_packets,
+	table_ctr_transform,
+	table_ecb_decrypt,
+	table_ecb_encrypt,
+	table_ocb_decrypt,
+	table_ocb_encrypt,
+	table_pmac_sum,
+	table_xctr_polyval,
+	table_xts_decrypt,
+	table_xts_encrypt,
+	table_standard_expand,
+	table_standard_expand_x4,
+	table_inverse_expand,
+	ghash_portable,
+	ghash_powers,
+	polyval_portable
+};
+
+static const rsx_kernels bitsliced_kernels =
+{
+	RSX_BACKEND_BITSLICED,
+	bitsliced_decrypt_block,
+	bitsliced_encrypt_block,
+	bitsliced_cbc_decrypt,
+	bitsliced_cbc_encrypt_jobs,
+	bitsliced_cbc_mac,
+	bitsliced_ccm_decrypt,
+	bitsliced_ccm_encrypt,
+	bitsliced_ctr_keyed,
+	bitsliced_ctr_packets,
+	bitsliced_ctr_transform,
+	bitsliced_ecb_decrypt,
+	bitsliced_ecb_encrypt,
+	bitsliced_ocb_decrypt,
+	bitsliced_ocb_encrypt,
+	bitsliced_pmac_sum,
+	bitsliced_xctr_polyval,
+	bitsliced_xts_decrypt,
+	bitsliced_xts_encrypt,
+	bitsliced_standard_expand,
+	bitsliced_standard_expand_x4,
+	bitsliced_inverse_expand,
+	ghash_portable,
+	ghash_powers,
+	polyval_portable
+};
+
+#if defined(RSX_AESNI_SUPPORTED)
+static const rsx_kernels vpaes_kernels =
+{
+	RSX_BACKEND_VPAES,
+	vpaes_decrypt_block,
+	vpaes_encrypt_block,
+	vpaes_cbc_decrypt,
+	vpaes_cbc_encrypt_jobs,
+	vpaes_cbc_mac,
+	vpaes_ccm_decrypt,
+	vpaes_ccm_encrypt,
+	vpaes_ctr_keyed,
+	vpaes_ctr_packets,
+	vpaes_ctr_transform,
+	vpaes_ecb_decrypt,
+	vpaes_ecb_encrypt,
+	vpaes_ocb_decrypt,
+	vpaes_ocb_encrypt,
+	vpaes_pmac_sum,
+	vpaes_xctr_polyval,
+	vpaes_xts_decrypt,
+	vpaes_xts_encrypt,
+	vpaes_standard_expand,
+	vpaes_standard_expand_x4,
+	vpaes_inverse_expand,
+	ghash_portable,
+	ghash_powers,
+	polyval_portable
+};
+
+static const rsx_kernels aesni_kernels =
+{
+	RSX_BACKEND_AESNI,
+	aesni_decrypt_block,
+	aesni_encrypt_block,
+	aesni_cbc_decrypt,
+	aesni_cbc_encrypt_jobs,
+	aesni_cbc_mac,
+	aesni_ccm_decrypt,
+	aesni_ccm_encrypt,
+	aesni_ctr_keyed,
+	aesni_ctr_packets,
+	aesni_ctr_transform,
+	aesni_ecb_decrypt,
+	aesni_ecb_encrypt,
+	aesni_ocb_decrypt,
+	aesni_ocb_encrypt,
+	aesni_pmac_sum,
+	aesni_xctr_polyval,
+	aesni_xts_decrypt,
+	aesni_xts_encrypt,
+	aesni_standard_expand,
+	aesni_standard_expand_x4,
+	aesni_inverse_expand,
+	aesni_ghash,
+	aesni_ghash_powers,
+	aesni_polyval
+};
+#endif
+
+#if defined(RSX_VAES_SUPPORTED)
+/* single blocks, the serial cbc-mac chains, short pmac messages, and the key schedule have nothing to gain from the wide registers */
+static const rsx_kernels vaes_kernels =
+{
+	RSX_BACKEND_VAES,
+	aesni_decrypt_block,
+	aesni_encrypt_block,
+	vaes_cbc_decrypt,
+	aesni_cbc_encrypt_jobs,
+	aesni_cbc_mac,
+	aesni_ccm_decrypt,
+	aesni_ccm_encrypt,
+	aesni_ctr_keyed,
+	vaes_ctr_packets,
+	vaes_ctr_transform,
+	vaes_ecb_decrypt,
+	vaes_ecb_encrypt,
+	vaes_ocb_decrypt,
+	vaes_ocb_encrypt,
+	aesni_pmac_sum,
+	vaes_xctr_polyval,
+	vaes_xts_decrypt,
+	vaes_xts_encrypt,
+	aesni_standard_expand,
+	aesni_standard_expand_x4,
+	aesni_inverse_expand,
+	vaes_ghash,
+	aesni_ghash_powers,
+	vaes_polyval
+};
+#endif
+
+static const rsx_kernels* volatile rsx_active_kernels = NULL;
+
+static const rsx_kernels* kernels_select(rsx_backend backend)
+{
+#if defined(RSX_AESNI_SUPPORTED)
+	const cpu_features* cpuf = cpu_features_get();
+#endif
+	const rsx_kernels* kern;
+
+	kern = NULL;
+
+	switch (backend)
+	{
+		case RSX_BACKEND_TABLE:
+		{
+			kern = &table_kernels;
+			break;
+		}
+		case RSX_BACKEND_BITSLICED:
+		{
+			kern = &bitsliced_kernels;
+			break;
+		}
+#if defined(RSX_AESNI_SUPPORTED)
+		case RSX_BACKEND_VPAES:
+		{
+			if (cpuf->ssse3 == true)
+			{
+				kern = &vpaes_kernels;
+			}
+			break;
+		}
+		case RSX_BACKEND_AESNI:
+		{
+			if (cpuf->aesni == true && cpuf->ssse3 == true)
+			{
+				kern = &aesni_kernels;
+			}
+			break;
+		}
+#endif
+#if defined(RSX_VAES_SUPPORTED)
+		case RSX_BACKEND_VAES:
+		{
+			if (cpuf->aesni == true && cpuf->ssse3 == true && cpuf->vaes == true && cpuf->avx512f == true && cpuf->avx512bw == true)
+			{
+				kern = &vaes_kernels;
+			}
+			break;
+		}
+#endif
+		case RSX_BACKEND_AUTO:
+		{
+			/* the fastest supported kernel set */
+			kern = kernels_select(RSX_BACKEND_VAES);
+
+			if (kern == NULL)
+			{
+				kern = kernels_select(RSX_BACKEND_AESNI);
+			}
+
+			if (kern == NULL)
+			{
+				kern = kernels_select(RSX_BACKEND_VPAES);
+			}
+
+			if (kern == NULL)
+			{
+				/* constant-time in preference to the lookup tables */
+				kern = &bitsliced_kernels;
+			}
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	return kern;
+}
+
+static const rsx_kernels* kernels_get()
+{
+	/* the probe is idempotent, so a race on first use selects the same kernels */
+	if (rsx_active_kernels == NULL)
+	{
+		rsx_active_kernels = kernels_select(RSX_BACKEND_AUTO);
+	}
+
+	return rsx_active_kernels;
+}
+
+static void secure_expand(rsx_state* state, rsx_keyparams* keyparams)
+{
+	uint8_t* rk = state->roundkeys[0].bytes;
+	uint32_t tmpk;
+	size_t i;
+
+	cshake256(rk, state->rkeylen * RSX_BLOCK_SIZE, keyparams->key, keyparams->keylen, NULL, 0, keyparams->distcode, keyparams->codelen);
+
+	/* the shake output is read as little endian words, and stored in rijndael (big endian) word order */
+	for (i = 0; i < state->rkeylen * RSX_BLOCK_SIZE; i += 4)
+	{
+		tmpk = load_be32(rk, i);
+		le32_to_bytes(tmpk, rk, i);
+	}
+}
+
+static void secure_expand_x4(rsx_state* states, rsx_keyparams* keyparams)
+{
+	const uint8_t* seeds[4];
+	uint8_t* outputs[4];
+	uint8_t* rk;
+	uint32_t tmpk;
+	size_t i;
+	size_t j;
+
+	/* four schedules of the same size, from keys of the same length and one distribution code */
+	for (j = 0; j < 4; ++j)
+	{
+		seeds[j] = keyparams[j].key;
+		outputs[j] = states[j].roundkeys[0].bytes;
+	}
+
+	cshake256_x4(outputs, states[0].rkeylen * RSX_BLOCK_SIZE, seeds, keyparams[0].keylen, NULL, 0, keyparams[0].distcode, keyparams[0].codelen);
+
+	for (j = 0; j < 4; ++j)
+	{
+		rk = states[j].roundkeys[0].bytes;
+
+		for (i = 0; i < states[j].rkeylen * RSX_BLOCK_SIZE; i += 4)
+		{
+			tmpk = load_be32(rk, i);
+			le32_to_bytes(tmpk, rk, i);
+		}
+	}
+}
+
+/* Public API */
+
+rsx_backend rsx_backend_get()
+{
+	return kernels_get()->backend;
+}
+
+bool rsx_backend_set(rsx_backend backend)
+{
+	const rsx_kernels* kern;
+	bool res;
+
+	kern = kernels_select(backend);
+	res = false;
+
+	if (kern != NULL)
+	{
+		rsx_active_kernels = kern;
+		res = true;
+	}
+
+	return res;
+}
+
+void rsx_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input)
+{
+	size_t i;
+	uint8_t tmpv[RSX_BLOCK_SIZE];
+
+	memcpy(&tmpv[0], &input[0], RSX_BLOCK_SIZE);
+	kernels_get()->decrypt_block(state, output, input);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; i++)
 	{
 		output[i] ^= iv[i];
 
 	}
 
-	memcpy(&iv[0], &tmpv[0], RSX_BLOCK_SIZE);
+	memcpy(&iv[0], &tmpv[0], RSX_BLOCK_SIZE);
+}
+
+void rsx_cbc_decrypt_blocks(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length)
+{
+	kernels_get()->cbc_decrypt(state, output, iv, input, length);
+}
+
+void rsx_cbc_encrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input)
+{
+	size_t i;
+
+	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	{
+		iv[i] ^= input[i];
+	}
+
+	kernels_get()->encrypt_block(state, output, iv);
+	memcpy(&iv[0], &output[0], RSX_BLOCK_SIZE);
+}
+
+void rsx_cbc_encrypt_jobs(rsx_state* state, rsx_cbc_job* jobs, size_t count)
+{
+	kernels_get()->cbc_encrypt_jobs(state, jobs, count);
+}
+
+static bool ccm_parameters_valid(size_t noncelen, size_t taglen, size_t length)
+{
+	bool res;
+
+	/* SP800-38C: an even tag length, and a message length that fits the 15 - noncelen byte length field */
+	res = (noncelen >= RSX_CCM_MINNONCE_SIZE && noncelen <= RSX_CCM_MAXNONCE_SIZE &&
+		taglen >= RSX_CCM_MINTAG_SIZE && taglen <= RSX_CCM_TAG_SIZE && (taglen & 1) == 0);
+
+	if (res == true && noncelen > 7)
+	{
+		res = (((uint64_t)length >> (8 * (15 - noncelen))) == 0);
+	}
+
+	return res;
+}
+
+static void ccm_format(uint8_t* output, uint8_t flags, const uint8_t* nonce, size_t noncelen, uint64_t value)
+{
+	size_t i;
+
+	/* the flags byte, the nonce, and a big endian value in the remaining bytes */
+	output[0] = flags;
+	memcpy(output + 1, nonce, noncelen);
+
+	for (i = RSX_BLOCK_SIZE - 1; i > noncelen; --i)
+	{
+		output[i] = (uint8_t)value;
+		value >>= 8;
+	}
+}
+
+static void ccm_prepare(const rsx_kernels* kern, rsx_state* state, uint8_t* mac, uint8_t* ctr, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t hlen;
+	size_t clen;
+	size_t pos;
+	size_t i;
+
+	/* the first block carries the flags, the nonce, and the message length */
+	ccm_format(mac, (uint8_t)(((aadlen != 0) ? 0x40 : 0x00) | (((taglen - 2) / 2) << 3) | (14 - noncelen)), nonce, noncelen, (uint64_t)length);
+	kern->encrypt_block(state, mac, mac);
+
+	if (aadlen != 0)
+	{
+		/* the encoded length of the additional data, followed by the data, zero padded to the block size */
+		memset(tmpb, 0, RSX_BLOCK_SIZE);
+
+		if (aadlen < 0xFF00)
+		{
+			tmpb[0] = (uint8_t)(aadlen >> 8);
+			tmpb[1] = (uint8_t)aadlen;
+			hlen = 2;
+		}
+		else if ((uint64_t)aadlen <= 0xFFFFFFFFULL)
+		{
+			tmpb[0] = 0xFF;
+			tmpb[1] = 0xFE;
+			be32_to_bytes((uint32_t)aadlen, tmpb, 2);
+			hlen = 6;
+		}
+		else
+		{
+			tmpb[0] = 0xFF;
+			tmpb[1] = 0xFF;
+			be64_to_bytes((uint64_t)aadlen, tmpb, 2);
+			hlen = 10;
+		}
+
+		pos = 0;
+
+		while (pos < aadlen)
+		{
+			clen = (aadlen - pos < RSX_BLOCK_SIZE - hlen) ? aadlen - pos : RSX_BLOCK_SIZE - hlen;
+			memcpy(tmpb + hlen, aad + pos, clen);
+
+			for (i = 0; i < hlen + clen; ++i)
+			{
+				mac[i] ^= tmpb[i];
+			}
+
+			kern->encrypt_block(state, mac, mac);
+			pos += clen;
+			hlen = 0;
+		}
+	}
+
+	/* counter zero encrypts the tag, the message starts at one */
+	ccm_format(ctr, (uint8_t)(14 - noncelen), nonce, noncelen, 1);
+}
+
+static void ccm_transform(const rsx_kernels* kern, rsx_state* state, uint8_t* mac, uint8_t* ctr, uint8_t* output, const uint8_t* input, size_t length, bool encryption)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t plen;
+	size_t i;
+
+	plen = length - (length % RSX_BLOCK_SIZE);
+
+	if (plen != 0)
+	{
+		if (encryption == true)
+		{
+			kern->ccm_encrypt(state, mac, output, ctr, input, plen);
+		}
+		else
+		{
+			kern->ccm_decrypt(state, mac, output, ctr, input, plen);
+		}
+	}
+
+	if (plen != length)
+	{
+		/* the partial last block is authenticated zero padded */
+		kern->encrypt_block(state, tmpb, ctr);
+
+		for (i = 0; plen + i < length; ++i)
+		{
+			mac[i] ^= (encryption == true) ? input[plen + i] : (uint8_t)(input[plen + i] ^ tmpb[i]);
+			output[plen + i] = input[plen + i] ^ tmpb[i];
+		}
+
+		kern->encrypt_block(state, mac, mac);
+	}
+}
+
+static void ccm_finalize(const rsx_kernels* kern, rsx_state* state, uint8_t* tag, const uint8_t* mac, const uint8_t* nonce, size_t noncelen)
+{
+	size_t i;
+
+	ccm_format(tag, (uint8_t)(14 - noncelen), nonce, noncelen, 0);
+	kern->encrypt_block(state, tag, tag);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		tag[i] ^= mac[i];
+	}
+}
+
+mqc_status rsx_ccm_decrypt(rsx_state* state, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t mac[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t i;
+	uint8_t diff;
+
+	status = MQC_ERROR_INVALID;
+
+	if (ccm_parameters_valid(noncelen, taglen, length) == true)
+	{
+		ccm_prepare(kern, state, mac, ctr, taglen, nonce, noncelen, aad, aadlen, length);
+		ccm_transform(kern, state, mac, ctr, output, input, length, false);
+		ccm_finalize(kern, state, tmpt, mac, nonce, noncelen);
+		diff = 0;
+
+		/* constant-time tag comparison */
+		for (i = 0; i < taglen; i++)
+		{
+			diff |= (uint8_t)(tmpt[i] ^ tag[i]);
+		}
+
+		if (diff == 0)
+		{
+			status = MQC_STATUS_SUCCESS;
+		}
+		else
+		{
+			memset(output, 0, length);
+			status = MQC_STATUS_AUTHFAIL;
+		}
+
+		memset(mac, 0, RSX_BLOCK_SIZE);
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+	}
+
+	return status;
+}
+
+mqc_status rsx_ccm_encrypt(rsx_state* state, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t mac[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (ccm_parameters_valid(noncelen, taglen, length) == true)
+	{
+		ccm_prepare(kern, state, mac, ctr, taglen, nonce, noncelen, aad, aadlen, length);
+		ccm_transform(kern, state, mac, ctr, output, input, length, true);
+		ccm_finalize(kern, state, tmpt, mac, nonce, noncelen);
+		memcpy(tag, tmpt, taglen);
+		memset(mac, 0, RSX_BLOCK_SIZE);
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+static bool cmac_parameters_valid(size_t taglen)
+{
+	return (taglen >= RSX_CMAC_MINTAG_SIZE && taglen <= RSX_CMAC_TAG_SIZE);
+}
+
+static bool mac_tags_equal(const uint8_t* tag, const uint8_t* expected, size_t taglen)
+{
+	size_t i;
+	uint8_t diff;
+
+	diff = 0;
+
+	/* constant-time tag comparison */
+	for (i = 0; i < taglen; i++)
+	{
+		diff |= (uint8_t)(tag[i] ^ expected[i]);
+	}
+
+	return (diff == 0);
+}
+
+static void cmac_compute(const rsx_kernels* kern, const rsx_cmac_ctx* ctx, uint8_t* tag, const uint8_t* message, size_t length)
+{
+	uint8_t last[RSX_BLOCK_SIZE];
+	size_t plen;
+	size_t i;
+
+	/* every block but the last is chained by the kernel; the last block takes K1 if it is complete, otherwise it is padded and takes K2 */
+	plen = (length == 0) ? 0 : ((length - 1) / RSX_BLOCK_SIZE) * RSX_BLOCK_SIZE;
+
+	if (length - plen == RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+		{
+			last[i] = message[plen + i] ^ ctx->k1.bytes[i];
+		}
+	}
+	else
+	{
+		memset(last, 0, RSX_BLOCK_SIZE);
+
+		/* the message can be NULL when it is empty */
+		if (length != plen)
+		{
+			memcpy(last, message + plen, length - plen);
+		}
+
+		last[length - plen] = 0x80;
+
+		for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+		{
+			last[i] ^= ctx->k2.bytes[i];
+		}
+	}
+
+	memset(tag, 0, RSX_BLOCK_SIZE);
+	kern->cbc_mac(ctx->state, tag, message, plen);
+	kern->cbc_mac(ctx->state, tag, last, RSX_BLOCK_SIZE);
+	memset(last, 0, RSX_BLOCK_SIZE);
+}
+
+void rsx_cmac_initialize(rsx_cmac_ctx* ctx, rsx_state* state)
+{
+	ctx->state = state;
+
+	/* K1 = 2 E(0), and K2 = 2 K1 */
+	memset(ctx->k1.bytes, 0, RSX_BLOCK_SIZE);
+	kernels_get()->encrypt_block(state, ctx->k1.bytes, ctx->k1.bytes);
+	block_double(ctx->k1.bytes, ctx->k1.bytes);
+	block_double(ctx->k2.bytes, ctx->k1.bytes);
+}
+
+mqc_status rsx_cmac_compute(const rsx_cmac_ctx* ctx, uint8_t* tag, size_t taglen, const uint8_t* message, size_t length)
+{
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (cmac_parameters_valid(taglen) == true)
+	{
+		cmac_compute(kernels_get(), ctx, tmpt, message, length);
+		memcpy(tag, tmpt, taglen);
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+mqc_status rsx_cmac_verify(const rsx_cmac_ctx* ctx, const uint8_t* tag, size_t taglen, const uint8_t* message, size_t length)
+{
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (cmac_parameters_valid(taglen) == true)
+	{
+		cmac_compute(kernels_get(), ctx, tmpt, message, length);
+		status = (mac_tags_equal(tmpt, tag, taglen) == true) ? MQC_STATUS_SUCCESS : MQC_STATUS_AUTHFAIL;
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+	}
+
+	return status;
+}
+
+void rsx_cmac_dispose(rsx_cmac_ctx* ctx)
+{
+	memset(ctx->k1.bytes, 0, RSX_BLOCK_SIZE);
+	memset(ctx->k2.bytes, 0, RSX_BLOCK_SIZE);
+	ctx->state = NULL;
+}
+
+void rsx_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input)
+{
+	size_t i;
+
+	kernels_get()->encrypt_block(state, output, nonce);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	{
+		output[i] ^= input[i];
+	}
+
+	increment_be8(nonce);
+}
+
+void rsx_ctr_transform_blocks(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t plen;
+	size_t i;
+
+	plen = length - (length % RSX_BLOCK_SIZE);
+	kern->ctr_transform(state, output, nonce, input, plen);
+
+	if (length != plen)
+	{
+		kern->encrypt_block(state, tmpb, nonce);
+
+		for (i = 0; i < length - plen; i++)
+		{
+			output[plen + i] = tmpb[i] ^ input[plen + i];
+		}
+
+		increment_be8(nonce);
+	}
+}
+
+mqc_status rsx_ctr_transform_keyed(const rsx_keyed_packet* packets, size_t count, size_t rkeylen, const uint8_t* distcode, size_t codelen)
+{
+	const rsx_kernels* kern = kernels_get();
+	rsx_roundkey rkeys[RSX_KEYED_LANES][RSX512_ROUNDKEY_DIMENSION];
+	rsx_keyparams kps[RSX_KEYED_LANES];
+	rsx_state states[RSX_KEYED_LANES];
+	rsx_ctr_packet batch[RSX_KEYED_LANES];
+	mqc_status status;
+	size_t keylen;
+	size_t pos;
+	size_t len;
+	size_t i;
+	bool secure;
+
+	status = MQC_STATUS_SUCCESS;
+	secure = (rkeylen == RSX256_ROUNDKEY_DIMENSION || rkeylen == RSX512_ROUNDKEY_DIMENSION);
+
+	if (rkeylen == AES128_ROUNDKEY_DIMENSION)
+	{
+		keylen = AES128_KEY_SIZE;
+	}
+	else if (rkeylen == AES256_ROUNDKEY_DIMENSION)
+	{
+		keylen = AES256_KEY_SIZE;
+	}
+	else if (rkeylen == RSX256_ROUNDKEY_DIMENSION)
+	{
+		keylen = RSX256_KEY_SIZE;
+	}
+	else if (rkeylen == RSX512_ROUNDKEY_DIMENSION)
+	{
+		keylen = RSX512_KEY_SIZE;
+	}
+	else
+	{
+		keylen = 0;
+		status = MQC_ERROR_INVALID;
+	}
+
+	if (status == MQC_STATUS_SUCCESS)
+	{
+		if (kern->backend == RSX_BACKEND_TABLE)
+		{
+			prefetch_tables(true);
+		}
+
+		/* a group of packets is keyed together, four schedules per expansion call, then encrypted in one pass with a key per lane */
+		for (pos = 0; pos < count; pos += len)
+		{
+			len = (count - pos > RSX_KEYED_LANES) ? RSX_KEYED_LANES : count - pos;
+
+			for (i = 0; i < len; ++i)
+			{
+				states[i].roundkeys = rkeys[i];
+				states[i].rkeylen = rkeylen;
+				kps[i].key = (uint8_t*)packets[pos + i].key;
+				kps[i].keylen = keylen;
+				kps[i].distcode = (uint8_t*)distcode;
+				kps[i].codelen = codelen;
+				batch[i].output = packets[pos + i].output;
+				batch[i].nonce = packets[pos + i].nonce;
+				batch[i].input = packets[pos + i].input;
+				batch[i].length = packets[pos + i].length;
+			}
+
+			for (i = 0; i + 4 <= len; i += 4)
+			{
+				if (secure == true)
+				{
+					secure_expand_x4(&states[i], &kps[i]);
+				}
+				else
+				{
+					kern->standard_expand_x4(&states[i], &kps[i]);
+				}
+			}
+
+			for (; i < len; ++i)
+			{
+				if (secure == true)
+				{
+					secure_expand(&states[i], &kps[i]);
+				}
+				else
+				{
+					kern->standard_expand(&states[i], &kps[i]);
+				}
+			}
+
+			kern->ctr_keyed(states, batch, len);
+		}
+
+		memset(rkeys, 0, sizeof(rkeys));
+	}
+
+	return status;
+}
+
+void rsx_ctr_transform_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count)
+{
+	kernels_get()->ctr_packets(state, packets, count);
+}
+
+typedef struct rsx_ctr_segments
+{
+	const rsx_kernels* kern;
+	rsx_state* state;
+	uint8_t* output;
+	const uint8_t* nonce;
+	const uint8_t* input;
+	size_t length;
+	size_t seglen;
+} rsx_ctr_segments;
+
+static void ctr_segment_task(void* context, size_t index)
+{
+	const rsx_ctr_segments* segs = (const rsx_ctr_segments*)context;
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t blen;
+	size_t len;
+	size_t pos;
+	size_t i;
+
+	/* the segment counter is the nonce plus the segment block offset, no thread depends on another */
+	pos = index * segs->seglen;
+	len = segs->length - pos;
+
+	if (len > segs->seglen)
+	{
+		len = segs->seglen;
+	}
+
+	memcpy(ctr, segs->nonce, RSX_BLOCK_SIZE);
+	add_be128(ctr, (uint64_t)(pos / RSX_BLOCK_SIZE));
+
+	blen = len - (len % RSX_BLOCK_SIZE);
+	segs->kern->ctr_transform(segs->state, segs->output + pos, ctr, segs->input + pos, blen);
+
+	/* only the last segment can end in a partial block */
+	if (len != blen)
+	{
+		segs->kern->encrypt_block(segs->state, tmpb, ctr);
+
+		for (i = 0; i < len - blen; i++)
+		{
+			segs->output[pos + blen + i] = tmpb[i] ^ segs->input[pos + blen + i];
+		}
+	}
+}
+
+void rsx_ctr_transform_parallel(threadpool_state* pool, rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length, size_t minchunk)
+{
+	rsx_ctr_segments segs;
+	size_t nseg;
+
+	if (minchunk < RSX_BLOCK_SIZE)
+	{
+		minchunk = (minchunk == 0) ? RSX_PARALLEL_MINCHUNK : RSX_BLOCK_SIZE;
+	}
+
+	nseg = (pool != NULL) ? threadpool_threads(pool) : 1;
+
+	if (nseg > length / minchunk)
+	{
+		nseg = length / minchunk;
+	}
+
+	if (nseg < 2)
+	{
+		rsx_ctr_transform_blocks(state, output, nonce, input, length);
+	}
+	else
+	{
+		/* equal segments rounded up to whole blocks, the last segment is shorter */
+		segs.seglen = (length + nseg - 1) / nseg;
+		segs.seglen += (RSX_BLOCK_SIZE - (segs.seglen % RSX_BLOCK_SIZE)) % RSX_BLOCK_SIZE;
+		segs.kern = kernels_get();
+		segs.state = state;
+		segs.output = output;
+		segs.nonce = nonce;
+		segs.input = input;
+		segs.length = length;
+
+		nseg = (length + segs.seglen - 1) / segs.seglen;
+		threadpool_dispatch(pool, ctr_segment_task, &segs, nseg);
+		add_be128(nonce, (uint64_t)((length + RSX_BLOCK_SIZE - 1) / RSX_BLOCK_SIZE));
+	}
+}
+
+void rsx_ctr_initialize(rsx_ctr_ctx* ctx, rsx_state* state, const uint8_t* nonce)
+{
+	ctx->state = state;
+	memcpy(ctx->nonce, nonce, RSX_BLOCK_SIZE);
+	memset(ctx->keystream, 0, RSX_BLOCK_SIZE);
+	ctx->position = RSX_BLOCK_SIZE;
+}
+
+void rsx_ctr_update(rsx_ctr_ctx* ctx, uint8_t* output, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	size_t blen;
+	size_t pos;
+	size_t i;
+
+	pos = 0;
+
+	/* keystream left over from the previous update */
+	while (pos != length && ctx->position != RSX_BLOCK_SIZE)
+	{
+		output[pos] = input[pos] ^ ctx->keystream[ctx->position];
+		++ctx->position;
+		++pos;
+	}
+
+	blen = (length - pos) - ((length - pos) % RSX_BLOCK_SIZE);
+
+	if (blen != 0)
+	{
+		kern->ctr_transform(ctx->state, output + pos, ctx->nonce, input + pos, blen);
+		pos += blen;
+	}
+
+	/* a partial block; its unused keystream is kept for the next update */
+	if (pos != length)
+	{
+		kern->encrypt_block(ctx->state, ctx->keystream, ctx->nonce);
+		increment_be8(ctx->nonce);
+
+		for (i = 0; pos + i < length; i++)
+		{
+			output[pos + i] = input[pos + i] ^ ctx->keystream[i];
+		}
+
+		ctx->position = i;
+	}
+}
+
+void rsx_ctr_dispose(rsx_ctr_ctx* ctx)
+{
+	memset(ctx->nonce, 0, RSX_BLOCK_SIZE);
+	memset(ctx->keystream, 0, RSX_BLOCK_SIZE);
+	ctx->position = RSX_BLOCK_SIZE;
+	ctx->state = NULL;
+}
+
+static const uint8_t rsx_ctrkmac_custom[15] = { 'R', 'S', 'X', '-', 'C', 'T', 'R', '-', 'K', 'M', 'A', 'C', '2', '5', '6' };
+
+static void ctrkmac_absorb_header(uint64_t* kstate, const uint8_t* nonce, const uint8_t* aad, size_t aadlen)
+{
+	uint8_t buf[CSHAKE256_RATE];
+	size_t apos;
+	size_t clen;
+	size_t pos;
+
+	/* the nonce and the additional data are zero padded to a whole block,
+	   so the cipher-text starts on a block boundary and is absorbed straight from the caller's buffer */
+	memcpy(buf, nonce, RSX_BLOCK_SIZE);
+	pos = RSX_BLOCK_SIZE;
+	apos = 0;
+
+	while (true)
+	{
+		clen = (aadlen - apos < CSHAKE256_RATE - pos) ? aadlen - apos : CSHAKE256_RATE - pos;
+
+		if (clen != 0)
+		{
+			memcpy(buf + pos, aad + apos, clen);
+		}
+
+		pos += clen;
+		apos += clen;
+
+		if (apos == aadlen)
+		{
+			break;
+		}
+
+		kmac256_blockupdate(kstate, buf, 1);
+		pos = 0;
+	}
+
+	memset(buf + pos, 0, CSHAKE256_RATE - pos);
+	kmac256_blockupdate(kstate, buf, 1);
+}
+
+static void ctrkmac_finalize(uint64_t* kstate, uint8_t* tag, size_t taglen, const uint8_t* tail, size_t taillen, size_t aadlen, size_t length)
+{
+	uint8_t buf[CSHAKE256_RATE + 16];
+	size_t i;
+
+	/* the partial last block of cipher-text, then the additional data and message lengths */
+	memcpy(buf, tail, taillen);
+
+	for (i = 0; i < 8; ++i)
+	{
+		buf[taillen + i] = (uint8_t)((uint64_t)aadlen >> (8 * i));
+		buf[taillen + 8 + i] = (uint8_t)((uint64_t)length >> (8 * i));
+	}
+
+	if (taillen + 16 >= CSHAKE256_RATE)
+	{
+		kmac256_blockupdate(kstate, buf, 1);
+		kmac256_finalize(kstate, tag, taglen, buf + CSHAKE256_RATE, taillen + 16 - CSHAKE256_RATE);
+	}
+	else
+	{
+		kmac256_finalize(kstate, tag, taglen, buf, taillen + 16);
+	}
+}
+
+mqc_status rsx_ctrkmac_initialize(rsx_ctrkmac_ctx* ctx, rsx_state* state, const uint8_t* mackey, size_t mackeylen)
+{
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (mackeylen != 0 && mackeylen <= RSX_CTRKMAC_MAXKEY_SIZE)
+	{
+		/* the keyed mac state is computed once, and copied for each message */
+		ctx->state = state;
+		kmac256_initialize(ctx->kstate, mackey, mackeylen, rsx_ctrkmac_custom, sizeof(rsx_ctrkmac_custom));
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+mqc_status rsx_ctrkmac_encrypt(const rsx_ctrkmac_ctx* ctx, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	uint64_t kstate[SHA3_STATESIZE];
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t clen;
+	size_t pos;
+
+	status = MQC_ERROR_INVALID;
+
+	if (taglen >= RSX_CTRKMAC_MINTAG_SIZE && taglen <= RSX_CTRKMAC_MAXTAG_SIZE)
+	{
+		memcpy(kstate, ctx->kstate, sizeof(kstate));
+		memcpy(ctr, nonce, RSX_BLOCK_SIZE);
+		ctrkmac_absorb_header(kstate, nonce, aad, aadlen);
+
+		/* one pass: each stride is absorbed by the mac while it is still in the L1 cache */
+		for (pos = 0; pos < length; pos += clen)
+		{
+			clen = (length - pos < RSX_CTRKMAC_STRIDE) ? length - pos : RSX_CTRKMAC_STRIDE;
+			rsx_ctr_transform_blocks(ctx->state, output + pos, ctr, input + pos, clen);
+			kmac256_blockupdate(kstate, output + pos, clen / CSHAKE256_RATE);
+		}
+
+		clen = length % CSHAKE256_RATE;
+		ctrkmac_finalize(kstate, tag, taglen, output + (length - clen), clen, aadlen, length);
+		memset(kstate, 0, sizeof(kstate));
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+mqc_status rsx_ctrkmac_decrypt(const rsx_ctrkmac_ctx* ctx, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	uint64_t kstate[SHA3_STATESIZE];
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_CTRKMAC_MAXTAG_SIZE];
+	uint8_t tail[CSHAKE256_RATE];
+	mqc_status status;
+	size_t clen;
+	size_t pos;
+	size_t i;
+	uint8_t diff;
+
+	status = MQC_ERROR_INVALID;
+
+	if (taglen >= RSX_CTRKMAC_MINTAG_SIZE && taglen <= RSX_CTRKMAC_MAXTAG_SIZE)
+	{
+		memcpy(kstate, ctx->kstate, sizeof(kstate));
+		memcpy(ctr, nonce, RSX_BLOCK_SIZE);
+		ctrkmac_absorb_header(kstate, nonce, aad, aadlen);
+
+		/* the cipher-text stride is absorbed before it is decrypted, so the output can overwrite the input */
+		for (pos = 0; pos < length; pos += clen)
+		{
+			clen = (length - pos < RSX_CTRKMAC_STRIDE) ? length - pos : RSX_CTRKMAC_STRIDE;
+			kmac256_blockupdate(kstate, input + pos, clen / CSHAKE256_RATE);
+
+			if (pos + clen == length)
+			{
+				memcpy(tail, input + (length - (length % CSHAKE256_RATE)), length % CSHAKE256_RATE);
+			}
+
+			rsx_ctr_transform_blocks(ctx->state, output + pos, ctr, input + pos, clen);
+		}
+
+		ctrkmac_finalize(kstate, tmpt, taglen, tail, length % CSHAKE256_RATE, aadlen, length);
+		memset(kstate, 0, sizeof(kstate));
+		diff = 0;
+
+		/* constant-time tag comparison */
+		for (i = 0; i < taglen; i++)
+		{
+			diff |= (uint8_t)(tmpt[i] ^ tag[i]);
+		}
+
+		memset(tmpt, 0, sizeof(tmpt));
+
+		if (diff == 0)
+		{
+			status = MQC_STATUS_SUCCESS;
+		}
+		else
+		{
+			/* roll back: the keystream is applied again, which returns the output to the cipher-text */
+			memcpy(ctr, nonce, RSX_BLOCK_SIZE);
+			rsx_ctr_transform_blocks(ctx->state, output, ctr, output, length);
+			status = MQC_STATUS_AUTHFAIL;
+		}
+	}
+
+	return status;
+}
+
+void rsx_ctrkmac_dispose(rsx_ctrkmac_ctx* ctx)
+{
+	memset(ctx->kstate, 0, sizeof(ctx->kstate));
+	ctx->state = NULL;
+}
+
+static bool dualkey_parameters_valid(const rsx_state* state, const rsx_state* invstate)
+{
+	return ((state->rkeylen == AES128_ROUNDKEY_DIMENSION || state->rkeylen == AES256_ROUNDKEY_DIMENSION ||
+		state->rkeylen == RSX256_ROUNDKEY_DIMENSION || state->rkeylen == RSX512_ROUNDKEY_DIMENSION) &&
+		invstate->rkeylen == state->rkeylen);
+}
+
+mqc_status rsx_dualkey_initialize(rsx_dualkey_ctx* ctx, rsx_state* state, rsx_state* invstate, rsx_keyparams* keyparams, bool lazy)
+{
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+	ctx->state = state;
+	ctx->invstate = invstate;
+	ctx->inverse = false;
+
+	if (dualkey_parameters_valid(state, invstate) == true)
+	{
+		/* the key is expanded once, the decryption schedule is derived from the encryption schedule */
+		rsx_initialize(state, keyparams, true);
+
+		if (lazy == false)
+		{
+			rsx_inverse_schedule(invstate, state);
+			ctx->inverse = true;
+		}
+
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+rsx_state* rsx_dualkey_decryption(rsx_dualkey_ctx* ctx)
+{
+	if (ctx->inverse == false)
+	{
+		rsx_inverse_schedule(ctx->invstate, ctx->state);
+		ctx->inverse = true;
+	}
+
+	return ctx->invstate;
+}
+
+void rsx_dualkey_dispose(rsx_dualkey_ctx* ctx)
+{
+	memset(ctx->state->roundkeys, 0, ctx->state->rkeylen * sizeof(rsx_roundkey));
+	memset(ctx->invstate->roundkeys, 0, ctx->invstate->rkeylen * sizeof(rsx_roundkey));
+	ctx->state = NULL;
+	ctx->invstate = NULL;
+	ctx->inverse = false;
+}
+
+void rsx_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	kernels_get()->decrypt_block(state, output, input);
+}
+
+void rsx_ecb_decrypt_blocks(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	kernels_get()->ecb_decrypt(state, output, input, length);
+}
+
+void rsx_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input)
+{
+	kernels_get()->encrypt_block(state, output, input);
+}
+
+void rsx_ecb_encrypt_blocks(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length)
+{
+	kernels_get()->ecb_encrypt(state, output, input, length);
+}
+
+static void gcm_increment32(uint8_t* ctr)
+{
+	be32_to_bytes(load_be32(ctr, 12) + 1, ctr, 12);
+}
+
+static void gcm_ctr_transform(const rsx_kernels* kern, rsx_state* state, uint8_t* output, uint8_t* ctr, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	uint8_t upper[12];
+	uint64_t room;
+	size_t nblk;
+	size_t cnt;
+	size_t pos;
+	size_t i;
+
+	pos = 0;
+	nblk = length / RSX_BLOCK_SIZE;
+
+	/* gcm counts in the low 32 bits only; a run is split where that counter wraps,
+	   and the upper 96 bits are restored after the 128 bit kernel increment */
+	while (nblk != 0)
+	{
+		room = 0x100000000ULL - (uint64_t)load_be32(ctr, 12);
+		cnt = ((uint64_t)nblk < room) ? nblk : (size_t)room;
+		memcpy(upper, ctr, sizeof(upper));
+		kern->ctr_transform(state, output + pos, ctr, input + pos, cnt * RSX_BLOCK_SIZE);
+		memcpy(ctr, upper, sizeof(upper));
+		pos += cnt * RSX_BLOCK_SIZE;
+		nblk -= cnt;
+	}
+
+	if (pos != length)
+	{
+		kern->encrypt_block(state, tmpb, ctr);
+
+		for (i = 0; pos + i < length; i++)
+		{
+			output[pos + i] = tmpb[i] ^ input[pos + i];
+		}
+
+		gcm_increment32(ctr);
+	}
+}
+
+static void gcm_hash_padded(const rsx_kernels* kern, const rsx_gcm_ctx* ctx, uint8_t* hash, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t plen;
+
+	plen = length - (length % RSX_BLOCK_SIZE);
+
+	if (plen != 0)
+	{
+		kern->ghash(ctx->hpowers, hash, input, plen / RSX_BLOCK_SIZE);
+	}
+
+	if (plen != length)
+	{
+		memset(tmpb, 0, RSX_BLOCK_SIZE);
+		memcpy(tmpb, input + plen, length - plen);
+		kern->ghash(ctx->hpowers, hash, tmpb, 1);
+	}
+}
+
+static bool gcm_parameters_valid(size_t noncelen, size_t taglen, size_t length)
+{
+	/* SP800-38D limits the plain-text to 2^39 - 256 bits */
+	return (noncelen != 0 && taglen >= RSX_GCM_MINTAG_SIZE && taglen <= RSX_GCM_TAG_SIZE && (uint64_t)length <= 0xFFFFFFFE0ULL);
+}
+
+static void gcm_prepare(const rsx_kernels* kern, const rsx_gcm_ctx* ctx, uint8_t* j0, uint8_t* ctr, uint8_t* hash, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen)
+{
+	uint8_t lenb[RSX_BLOCK_SIZE];
+
+	/* the pre-counter block: a 96 bit nonce is used directly, any other length is hashed */
+	if (noncelen == RSX_GCM_NONCE_SIZE)
+	{
+		memcpy(j0, nonce, RSX_GCM_NONCE_SIZE);
+		be32_to_bytes(1, j0, 12);
+	}
+	else
+	{
+		memset(j0, 0, RSX_BLOCK_SIZE);
+		gcm_hash_padded(kern, ctx, j0, nonce, noncelen);
+		memset(lenb, 0, RSX_BLOCK_SIZE);
+		be64_to_bytes((uint64_t)noncelen * 8, lenb, 8);
+		kern->ghash(ctx->hpowers, j0, lenb, 1);
+	}
+
+	memcpy(ctr, j0, RSX_BLOCK_SIZE);
+	gcm_increment32(ctr);
+	memset(hash, 0, RSX_BLOCK_SIZE);
+	gcm_hash_padded(kern, ctx, hash, aad, aadlen);
+}
+
+static void gcm_finalize(const rsx_kernels* kern, const rsx_gcm_ctx* ctx, uint8_t* tag, const uint8_t* j0, uint8_t* hash, size_t aadlen, size_t length)
+{
+	uint8_t lenb[RSX_BLOCK_SIZE];
+	size_t i;
+
+	be64_to_bytes((uint64_t)aadlen * 8, lenb, 0);
+	be64_to_bytes((uint64_t)length * 8, lenb, 8);
+	kern->ghash(ctx->hpowers, hash, lenb, 1);
+	kern->encrypt_block(ctx->state, tag, j0);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	{
+		tag[i] ^= hash[i];
+	}
+}
+
+void rsx_gcm_initialize(rsx_gcm_ctx* ctx, rsx_state* state)
+{
+	uint8_t hkey[RSX_BLOCK_SIZE];
+
+	ctx->state = state;
+	memset(hkey, 0, RSX_BLOCK_SIZE);
+	kernels_get()->encrypt_block(state, hkey, hkey);
+	kernels_get()->ghash_powers(ctx->hpowers, hkey);
+	memset(hkey, 0, RSX_BLOCK_SIZE);
+}
+
+mqc_status rsx_gcm_encrypt(const rsx_gcm_ctx* ctx, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t hash[RSX_BLOCK_SIZE];
+	uint8_t j0[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t clen;
+	size_t pos;
+
+	status = MQC_ERROR_INVALID;
+
+	if (gcm_parameters_valid(noncelen, taglen, length) == true)
+	{
+		gcm_prepare(kern, ctx, j0, ctr, hash, nonce, noncelen, aad, aadlen);
+
+		/* one pass: each stride is hashed while it is still in the L1 cache */
+		for (pos = 0; pos < length; pos += clen)
+		{
+			clen = (length - pos < RSX_GCM_STRIDE) ? length - pos : RSX_GCM_STRIDE;
+			gcm_ctr_transform(kern, ctx->state, output + pos, ctr, input + pos, clen);
+			gcm_hash_padded(kern, ctx, hash, output + pos, clen);
+		}
+
+		gcm_finalize(kern, ctx, tmpt, j0, hash, aadlen, length);
+		memcpy(tag, tmpt, taglen);
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+mqc_status rsx_gcm_decrypt(const rsx_gcm_ctx* ctx, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint8_t hash[RSX_BLOCK_SIZE];
+	uint8_t j0[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t clen;
+	size_t pos;
+	size_t i;
+	uint8_t diff;
+
+	status = MQC_ERROR_INVALID;
+
+	if (gcm_parameters_valid(noncelen, taglen, length) == true)
+	{
+		gcm_prepare(kern, ctx, j0, ctr, hash, nonce, noncelen, aad, aadlen);
+
+		/* the cipher-text stride is hashed before it is decrypted, so the output can overwrite the input */
+		for (pos = 0; pos < length; pos += clen)
+		{
+			clen = (length - pos < RSX_GCM_STRIDE) ? length - pos : RSX_GCM_STRIDE;
+			gcm_hash_padded(kern, ctx, hash, input + pos, clen);
+			gcm_ctr_transform(kern, ctx->state, output + pos, ctr, input + pos, clen);
+		}
+
+		gcm_finalize(kern, ctx, tmpt, j0, hash, aadlen, length);
+		diff = 0;
+
+		/* constant-time tag comparison */
+		for (i = 0; i < taglen; i++)
+		{
+			diff |= (uint8_t)(tmpt[i] ^ tag[i]);
+		}
+
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+
+		if (diff == 0)
+		{
+			status = MQC_STATUS_SUCCESS;
+		}
+		else
+		{
+			memset(output, 0, length);
+			status = MQC_STATUS_AUTHFAIL;
+		}
+	}
+
+	return status;
+}
+
+void rsx_gcm_dispose(rsx_gcm_ctx* ctx)
+{
+	memset(ctx->hpowers, 0, sizeof(ctx->hpowers));
+	ctx->state = NULL;
+}
+
+static size_t gcmsiv_key_size(size_t rkeylen)
+{
+	size_t klen;
+
+	klen = 0;
+
+	if (rkeylen == AES128_ROUNDKEY_DIMENSION)
+	{
+		klen = AES128_KEY_SIZE;
+	}
+	else if (rkeylen == AES256_ROUNDKEY_DIMENSION)
+	{
+		klen = AES256_KEY_SIZE;
+	}
+	else if (rkeylen == RSX256_ROUNDKEY_DIMENSION)
+	{
+		klen = RSX256_KEY_SIZE;
+	}
+	else if (rkeylen == RSX512_ROUNDKEY_DIMENSION)
+	{
+		klen = RSX512_KEY_SIZE;
+	}
+
+	return klen;
+}
+
+static bool gcmsiv_parameters_valid(size_t aadlen, size_t length)
+{
+	/* RFC 8452 limits the plain-text and the additional data to 2^36 bytes */
+	return ((uint64_t)aadlen <= 0x1000000000ULL && (uint64_t)length <= 0x1000000000ULL);
+}
+
+static void gcmsiv_derive_keys(const rsx_kernels* kern, rsx_state* state, uint8_t* keys, const rsx_gcmsiv_record* records, size_t count, size_t nkblocks)
+{
+	uint8_t blocks[RSX_GCMSIV_BATCH * RSX_GCMSIV_KDF_BLOCKS * RSX_BLOCK_SIZE];
+	size_t i;
+
+	/* the key blocks of every record in the batch, le32(index) || nonce, go through the multi-block cipher together */
+	for (i = 0; i < count * nkblocks; ++i)
+	{
+		le32_to_bytes((uint32_t)(i % nkblocks), blocks, i * RSX_BLOCK_SIZE);
+		memcpy(blocks + (i * RSX_BLOCK_SIZE) + 4, records[i / nkblocks].nonce, RSX_GCMSIV_NONCE_SIZE);
+	}
+
+	kern->ecb_encrypt(state, blocks, blocks, count * nkblocks * RSX_BLOCK_SIZE);
+
+	/* the first half of each encrypted block is kept */
+	for (i = 0; i < count * nkblocks; ++i)
+	{
+		memcpy(keys + (i * 8), blocks + (i * RSX_BLOCK_SIZE), 8);
+	}
+
+	memset(blocks, 0, sizeof(blocks));
+}
+
+static void polyval_powers(const rsx_kernels* kern, rsx_roundkey* hpowers, const uint8_t* polykey)
+{
+	uint8_t hkey[RSX_BLOCK_SIZE];
+	size_t i;
+	uint8_t carry;
+
+	/* POLYVAL(H, X) is the byte reversed GHASH of the byte reversed blocks, keyed with mulX_GHASH(ByteReverse(H)) (RFC 8452, Appendix A);
+	   the GHASH key powers are reused, and the POLYVAL kernels load the blocks without the byte reversal */
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		hkey[i] = polykey[RSX_BLOCK_SIZE - 1 - i];
+	}
+
+	carry = hkey[RSX_BLOCK_SIZE - 1] & 0x01;
+
+	for (i = RSX_BLOCK_SIZE - 1; i > 0; --i)
+	{
+		hkey[i] = (uint8_t)((hkey[i] >> 1) | (hkey[i - 1] << 7));
+	}
+
+	hkey[0] = (uint8_t)((hkey[0] >> 1) ^ (0xE1 & (0 - carry)));
+	kern->ghash_powers(hpowers, hkey);
+	memset(hkey, 0, sizeof(hkey));
+}
+
+static void gcmsiv_hash_padded(const rsx_kernels* kern, const rsx_roundkey* hpowers, uint8_t* hash, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t plen;
+
+	plen = length - (length % RSX_BLOCK_SIZE);
+
+	if (plen != 0)
+	{
+		kern->polyval(hpowers, hash, input, plen / RSX_BLOCK_SIZE);
+	}
+
+	if (plen != length)
+	{
+		memset(tmpb, 0, RSX_BLOCK_SIZE);
+		memcpy(tmpb, input + plen, length - plen);
+		kern->polyval(hpowers, hash, tmpb, 1);
+	}
+}
+
+static void gcmsiv_tag(const rsx_kernels* kern, rsx_state* mstate, uint8_t* tag, const uint8_t* authkey, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* message, size_t length)
+{
+	rsx_roundkey hpowers[RSX_GCM_HPOWERS];
+	uint8_t lenb[RSX_BLOCK_SIZE];
+	size_t i;
+
+	polyval_powers(kern, hpowers, authkey);
+	memset(tag, 0, RSX_BLOCK_SIZE);
+	gcmsiv_hash_padded(kern, hpowers, tag, aad, aadlen);
+	gcmsiv_hash_padded(kern, hpowers, tag, message, length);
+	le64_to_bytes((uint64_t)aadlen * 8, lenb, 0);
+	le64_to_bytes((uint64_t)length * 8, lenb, 8);
+	kern->polyval(hpowers, tag, lenb, 1);
+
+	for (i = 0; i < RSX_GCMSIV_NONCE_SIZE; ++i)
+	{
+		tag[i] ^= nonce[i];
+	}
+
+	tag[RSX_BLOCK_SIZE - 1] &= 0x7F;
+	kern->encrypt_block(mstate, tag, tag);
+
+	memset(hpowers, 0, sizeof(hpowers));
+}
+
+static void gcmsiv_ctr_transform(const rsx_kernels* kern, rsx_state* mstate, uint8_t* output, const uint8_t* tag, const uint8_t* input, size_t length)
+{
+	uint8_t ks[RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE];
+	uint8_t ctr[RSX_BLOCK_SIZE];
+	uint32_t cnt;
+	size_t blen;
+	size_t nblocks;
+	size_t i;
+
+	/* the counter is the tag with the top bit set, and its first 32 bits count little endian; the counter blocks of a batch
+	   are written ahead and encrypted by the multi-block kernel */
+	memcpy(ctr, tag, RSX_BLOCK_SIZE);
+	ctr[RSX_BLOCK_SIZE - 1] |= 0x80;
+	cnt = load_le32(ctr, 0);
+
+	while (length != 0)
+	{
+		blen = (length > sizeof(ks)) ? sizeof(ks) : length;
+		nblocks = (blen + RSX_BLOCK_SIZE - 1) / RSX_BLOCK_SIZE;
+
+		for (i = 0; i < nblocks; ++i)
+		{
+			memcpy(ks + (i * RSX_BLOCK_SIZE), ctr, RSX_BLOCK_SIZE);
+			le32_to_bytes(cnt, ks, i * RSX_BLOCK_SIZE);
+			++cnt;
+		}
+
+		kern->ecb_encrypt(mstate, ks, ks, nblocks * RSX_BLOCK_SIZE);
+
+		for (i = 0; i < blen; ++i)
+		{
+			output[i] = input[i] ^ ks[i];
+		}
+
+		input += blen;
+		output += blen;
+		length -= blen;
+	}
+
+	memset(ks, 0, sizeof(ks));
+}
+
+static void gcmsiv_batch(rsx_state* state, rsx_gcmsiv_record* records, size_t count, bool encryption)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t keys[RSX_GCMSIV_BATCH * RSX_GCMSIV_KDF_BLOCKS * 8];
+	rsx_roundkey rkeys[RSX512_ROUNDKEY_DIMENSION];
+	rsx_state mstate = { rkeys, state->rkeylen };
+	rsx_keyparams kp = { NULL, gcmsiv_key_size(state->rkeylen), NULL, 0 };
+	uint8_t tmpt[RSX_GCMSIV_TAG_SIZE];
+	rsx_gcmsiv_record* rec;
+	size_t nkblocks;
+	size_t ncount;
+	size_t i;
+	size_t j;
+	uint8_t diff;
+
+	nkblocks = 2 + (kp.keylen / 8);
+
+	while (count != 0)
+	{
+		ncount = (count > RSX_GCMSIV_BATCH) ? RSX_GCMSIV_BATCH : count;
+		gcmsiv_derive_keys(kern, state, keys, records, ncount, nkblocks);
+
+		for (i = 0; i < ncount; ++i)
+		{
+			rec = &records[i];
+
+			/* the message key, then the tag over the plain-text, then the counter pass from the tag */
+			kp.key = keys + (i * nkblocks * 8) + RSX_BLOCK_SIZE;
+			mstate.rkeylen = state->rkeylen;
+			rsx_initialize(&mstate, &kp, true);
+
+			if (encryption == true)
+			{
+				gcmsiv_tag(kern, &mstate, rec->tag, keys + (i * nkblocks * 8), rec->nonce, rec->aad, rec->aadlen, rec->input, rec->length);
+				gcmsiv_ctr_transform(kern, &mstate, rec->output, rec->tag, rec->input, rec->length);
+				rec->status = MQC_STATUS_SUCCESS;
+			}
+			else
+			{
+				gcmsiv_ctr_transform(kern, &mstate, rec->output, rec->tag, rec->input, rec->length);
+				gcmsiv_tag(kern, &mstate, tmpt, keys + (i * nkblocks * 8), rec->nonce, rec->aad, rec->aadlen, rec->output, rec->length);
+				diff = 0;
+
+				/* constant-time tag comparison */
+				for (j = 0; j < RSX_GCMSIV_TAG_SIZE; j++)
+				{
+					diff |= (uint8_t)(tmpt[j] ^ rec->tag[j]);
+				}
+
+				if (diff == 0)
+				{
+					rec->status = MQC_STATUS_SUCCESS;
+				}
+				else
+				{
+					memset(rec->output, 0, rec->length);
+					rec->status = MQC_STATUS_AUTHFAIL;
+				}
+			}
+		}
+
+		records += ncount;
+		count -= ncount;
+	}
+
+	memset(keys, 0, sizeof(keys));
+	memset(rkeys, 0, sizeof(rkeys));
+	memset(tmpt, 0, sizeof(tmpt));
+}
+
+static mqc_status gcmsiv_process(rsx_state* state, rsx_gcmsiv_record* records, size_t count, bool encryption)
+{
+	mqc_status status;
+	size_t i;
+
+	status = MQC_STATUS_SUCCESS;
+
+	if (gcmsiv_key_size(state->rkeylen) == 0)
+	{
+		status = MQC_ERROR_INVALID;
+	}
+
+	for (i = 0; i < count && status == MQC_STATUS_SUCCESS; ++i)
+	{
+		if (gcmsiv_parameters_valid(records[i].aadlen, records[i].length) == false)
+		{
+			status = MQC_ERROR_INVALID;
+		}
+	}
+
+	if (status == MQC_STATUS_SUCCESS)
+	{
+		gcmsiv_batch(state, records, count, encryption);
+
+		for (i = 0; i < count && status == MQC_STATUS_SUCCESS; ++i)
+		{
+			status = records[i].status;
+		}
+	}
+
+	return status;
+}
+
+mqc_status rsx_gcmsiv_decrypt(rsx_state* state, uint8_t* output, const uint8_t* tag, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	rsx_gcmsiv_record rec = { output, (uint8_t*)tag, nonce, aad, aadlen, input, length, MQC_STATUS_FAILURE };
+
+	return gcmsiv_process(state, &rec, 1, false);
+}
+
+mqc_status rsx_gcmsiv_decrypt_batch(rsx_state* state, rsx_gcmsiv_record* records, size_t count)
+{
+	return gcmsiv_process(state, records, count, false);
+}
+
+mqc_status rsx_gcmsiv_encrypt(rsx_state* state, uint8_t* output, uint8_t* tag, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	rsx_gcmsiv_record rec = { output, tag, nonce, aad, aadlen, input, length, MQC_STATUS_FAILURE };
+
+	return gcmsiv_process(state, &rec, 1, true);
+}
+
+mqc_status rsx_gcmsiv_encrypt_batch(rsx_state* state, rsx_gcmsiv_record* records, size_t count)
+{
+	return gcmsiv_process(state, records, count, true);
+}
+
+static void hctr2_hash_tweak(const rsx_kernels* kern, const rsx_hctr2_ctx* ctx, uint8_t* hash, const uint8_t* tweak, size_t tweaklen, size_t length)
+{
+	uint8_t lenb[RSX_BLOCK_SIZE];
+
+	/* the first block encodes the tweak length in bits, and whether the message is padded: 2|T| + 2 or 2|T| + 3;
+	   the tweak is zero padded, and its hash is shared by both hashes of a message */
+	memset(lenb, 0, RSX_BLOCK_SIZE);
+	le64_to_bytes(((uint64_t)tweaklen * 16) + ((length % RSX_BLOCK_SIZE == 0) ? 2 : 3), lenb, 0);
+	memset(hash, 0, RSX_BLOCK_SIZE);
+	kern->polyval(ctx->hpowers, hash, lenb, 1);
+	gcmsiv_hash_padded(kern, ctx->hpowers, hash, tweak, tweaklen);
+}
+
+static void hctr2_hash_padded(const rsx_kernels* kern, const rsx_hctr2_ctx* ctx, uint8_t* hash, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t plen;
+
+	plen = length - (length % RSX_BLOCK_SIZE);
+
+	if (plen != 0)
+	{
+		kern->polyval(ctx->hpowers, hash, input, plen / RSX_BLOCK_SIZE);
+	}
+
+	/* a partial block is padded with a one byte, then zeros */
+	if (plen != length)
+	{
+		memset(tmpb, 0, RSX_BLOCK_SIZE);
+		memcpy(tmpb, input + plen, length - plen);
+		tmpb[length - plen] = 0x01;
+		kern->polyval(ctx->hpowers, hash, tmpb, 1);
+	}
+}
+
+static void hctr2_xctr_polyval(const rsx_kernels* kern, const rsx_hctr2_ctx* ctx, uint8_t* hash, uint8_t* output, const uint8_t* iv, const uint8_t* input, size_t length)
+{
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	size_t plen;
+	size_t i;
+
+	/* the block index starts at one */
+	plen = length - (length % RSX_BLOCK_SIZE);
+	kern->xctr_polyval(ctx->state, ctx->hpowers, hash, output, iv, input, plen, 1);
+
+	if (plen != length)
+	{
+		memcpy(tmpb, iv, RSX_BLOCK_SIZE);
+		le64_to_bytes(load_le64(iv, 0) ^ ((uint64_t)(plen / RSX_BLOCK_SIZE) + 1), tmpb, 0);
+		kern->encrypt_block(ctx->state, tmpb, tmpb);
+
+		for (i = 0; plen + i < length; ++i)
+		{
+			output[plen + i] = input[plen + i] ^ tmpb[i];
+		}
+
+		hctr2_hash_padded(kern, ctx, hash, output + plen, length - plen);
+	}
+}
+
+static void hctr2_transform(const rsx_hctr2_ctx* ctx, uint8_t* output, const uint8_t* tweak, size_t tweaklen, const uint8_t* input, size_t length, bool encryption)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t hash[RSX_BLOCK_SIZE];
+	uint8_t thash[RSX_BLOCK_SIZE];
+	uint8_t iv[RSX_BLOCK_SIZE];
+	uint8_t mm[RSX_BLOCK_SIZE];
+	uint8_t uu[RSX_BLOCK_SIZE];
+	size_t i;
+
+	/* both directions have the same shape: the first block is whitened with the hash of the rest of the input,
+	   and enciphered; the rest is transformed by XCTR from the two, and the first block is whitened again with the hash of the output */
+	hctr2_hash_tweak(kern, ctx, thash, tweak, tweaklen, length - RSX_BLOCK_SIZE);
+	memcpy(hash, thash, RSX_BLOCK_SIZE);
+	hctr2_hash_padded(kern, ctx, hash, input + RSX_BLOCK_SIZE, length - RSX_BLOCK_SIZE);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		mm[i] = input[i] ^ hash[i];
+	}
+
+	if (encryption == true)
+	{
+		kern->encrypt_block(ctx->state, uu, mm);
+	}
+	else
+	{
+		kern->decrypt_block(ctx->invstate, uu, mm);
+	}
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		iv[i] = mm[i] ^ uu[i] ^ ctx->l.bytes[i];
+	}
+
+	/* one pass: the XCTR output is hashed as it is written */
+	memcpy(hash, thash, RSX_BLOCK_SIZE);
+	hctr2_xctr_polyval(kern, ctx, hash, output + RSX_BLOCK_SIZE, iv, input + RSX_BLOCK_SIZE, length - RSX_BLOCK_SIZE);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		output[i] = uu[i] ^ hash[i];
+	}
+
+	memset(iv, 0, sizeof(iv));
+	memset(mm, 0, sizeof(mm));
+	memset(uu, 0, sizeof(uu));
 }
 
-void rsx_cbc_encrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input)
+void rsx_hctr2_initialize(rsx_hctr2_ctx* ctx, rsx_state* state, rsx_state* invstate)
 {
-	size_t i;
-
-	for (i = 0; i < RSX_BLOCK_SIZE; i++)
-	{
-		iv[i] ^= input[i];
-	}
+	const rsx_kernels* kern = kernels_get();
+	uint8_t hkey[RSX_BLOCK_SIZE];
 
-	encrypt_block(output, iv, state->roundkeys, state->rkeylen);
-	memcpy(&iv[0], &output[0], RSX_BLOCK_SIZE);
+	/* the hash key is the encrypted zero block, and L the encrypted block of the little endian integer 1 */
+	ctx->state = state;
+	ctx->invstate = invstate;
+	memset(hkey, 0, RSX_BLOCK_SIZE);
+	kern->encrypt_block(state, hkey, hkey);
+	polyval_powers(kern, ctx->hpowers, hkey);
+	memset(ctx->l.bytes, 0, RSX_BLOCK_SIZE);
+	ctx->l.bytes[0] = 0x01;
+	kern->encrypt_block(state, ctx->l.bytes, ctx->l.bytes);
+	memset(hkey, 0, RSX_BLOCK_SIZE);
 }
 
-void rsx_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input)
+mqc_status rsx_hctr2_encrypt(const rsx_hctr2_ctx* ctx, uint8_t* output, const uint8_t* tweak, size_t tweaklen, const uint8_t* input, size_t length)
 {
-	size_t i;
+	mqc_status status;
 
-	encrypt_block(output, nonce, state->roundkeys, state->rkeylen);
+	status = MQC_ERROR_INVALID;
 
-	for (i = 0; i < RSX_BLOCK_SIZE; i++)
+	if (length >= RSX_BLOCK_SIZE)
 	{
-		output[i] ^= input[i];
+		hctr2_transform(ctx, output, tweak, tweaklen, input, length, true);
+		status = MQC_STATUS_SUCCESS;
 	}
 
-	increment_be8(nonce);
+	return status;
 }
 
-void rsx_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input)
+mqc_status rsx_hctr2_decrypt(const rsx_hctr2_ctx* ctx, uint8_t* output, const uint8_t* tweak, size_t tweaklen, const uint8_t* input, size_t length)
 {
-	decrypt_block(output, input, state->roundkeys, state->rkeylen);
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (ctx->invstate != NULL && length >= RSX_BLOCK_SIZE)
+	{
+		hctr2_transform(ctx, output, tweak, tweaklen, input, length, false);
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
 }
 
-void rsx_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input)
+void rsx_hctr2_dispose(rsx_hctr2_ctx* ctx)
 {
-	encrypt_block(output, input, state->roundkeys, state->rkeylen);
+	memset(ctx->hpowers, 0, sizeof(ctx->hpowers));
+	memset(ctx->l.bytes, 0, RSX_BLOCK_SIZE);
+	ctx->state = NULL;
+	ctx->invstate = NULL;
 }
 
 mqc_status rsx_initialize(rsx_state* state, rsx_keyparams* keyparams, bool encryption)
 {
+	const rsx_kernels* kern = kernels_get();
 	mqc_status status;
-	
+
 	status = MQC_STATUS_FAILURE;
 
 	if (state->rkeylen == RSX256_ROUNDKEY_DIMENSION)
@@ -969,11 +7003,11 @@ mqc_status rsx_initialize(rsx_state* state, rsx_keyparams* keyparams, bool encry
 	}
 	else if (state->rkeylen == AES256_ROUNDKEY_DIMENSION)
 	{
-		standard_expand(state, keyparams);
+		kern->standard_expand(state, keyparams);
 	}
 	else if (state->rkeylen == AES128_ROUNDKEY_DIMENSION)
 	{
-		standard_expand(state, keyparams);
+		kern->standard_expand(state, keyparams);
 	}
 	else
 	{
@@ -984,37 +7018,517 @@ mqc_status rsx_initialize(rsx_state* state, rsx_keyparams* keyparams, bool encry
 	// inverse cipher
 	if (encryption == false && state->rkeylen != 0)
 	{
-		uint32_t tmpk;
-		size_t i;
-		size_t j;
-		size_t k;
+		kern->inverse_expand(state);
+	}
+
+	if (kern->backend == RSX_BACKEND_TABLE)
+	{
+		prefetch_tables(encryption);
+	}
+
+	return status;
+}
+
+void rsx_inverse_schedule(rsx_state* invstate, const rsx_state* state)
+{
+	const rsx_kernels* kern = kernels_get();
+
+	/* the same transform rsx_initialize applies for decryption, without running the key schedule again */
+	invstate->rkeylen = state->rkeylen;
+	memcpy(invstate->roundkeys, state->roundkeys, state->rkeylen * sizeof(rsx_roundkey));
+	kern->inverse_expand(invstate);
+
+	if (kern->backend == RSX_BACKEND_TABLE)
+	{
+		prefetch_tables(false);
+	}
+}
+
+static bool ocb_parameters_valid(size_t noncelen, size_t taglen)
+{
+	return (noncelen != 0 && noncelen <= RSX_OCB_MAXNONCE_SIZE && taglen >= RSX_OCB_MINTAG_SIZE && taglen <= RSX_OCB_TAG_SIZE);
+}
+
+static void ocb_initial_offset(const rsx_kernels* kern, const rsx_ocb_ctx* ctx, uint8_t* offset, const uint8_t* nonce, size_t noncelen, size_t taglen)
+{
+	uint8_t ktop[RSX_BLOCK_SIZE];
+	uint8_t nblk[RSX_BLOCK_SIZE];
+	uint8_t stretch[RSX_BLOCK_SIZE + 8];
+	size_t bottom;
+	size_t bshift;
+	size_t i;
+
+	/* the formatted nonce; the tag length in the first 7 bits, then a one bit before the nonce */
+	memset(nblk, 0, RSX_BLOCK_SIZE);
+	nblk[0] = (uint8_t)(((taglen * 8) % 128) << 1);
+	nblk[RSX_BLOCK_SIZE - 1 - noncelen] |= 0x01;
+	memcpy(nblk + RSX_BLOCK_SIZE - noncelen, nonce, noncelen);
+
+	/* the low 6 bits select a bit offset into the stretched encryption of the other 122 bits */
+	bottom = nblk[RSX_BLOCK_SIZE - 1] & 0x3F;
+	nblk[RSX_BLOCK_SIZE - 1] &= 0xC0;
+	kern->encrypt_block(ctx->state, ktop, nblk);
+	memcpy(stretch, ktop, RSX_BLOCK_SIZE);
+
+	for (i = 0; i < 8; ++i)
+	{
+		stretch[RSX_BLOCK_SIZE + i] = ktop[i] ^ ktop[i + 1];
+	}
+
+	bshift = bottom % 8;
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		offset[i] = (uint8_t)(stretch[(bottom / 8) + i] << bshift);
+
+		if (bshift != 0)
+		{
+			offset[i] |= (uint8_t)(stretch[(bottom / 8) + i + 1] >> (8 - bshift));
+		}
+	}
+}
+
+static void ocb_hash(const rsx_kernels* kern, const rsx_ocb_ctx* ctx, uint8_t* sum, const uint8_t* aad, size_t aadlen)
+{
+	uint8_t blocks[RSX_BATCH_BLOCKS * RSX_BLOCK_SIZE];
+	uint8_t offset[RSX_BLOCK_SIZE];
+	const uint8_t* lval;
+	uint64_t index;
+	size_t blen;
+	size_t i;
+	size_t j;
+
+	memset(sum, 0, RSX_BLOCK_SIZE);
+	memset(offset, 0, RSX_BLOCK_SIZE);
+	index = 0;
+
+	/* the associated data blocks are whitened with their offsets, and their encryptions are summed */
+	while (aadlen >= RSX_BLOCK_SIZE)
+	{
+		blen = aadlen - (aadlen % RSX_BLOCK_SIZE);
+		blen = (blen > sizeof(blocks)) ? sizeof(blocks) : blen;
 
-		// reverse key
-		for (i = 0, k = state->rkeylen - 4; i < k; i += 4, k -= 4)
+		for (i = 0; i < blen; i += RSX_BLOCK_SIZE)
 		{
-			for (j = 0; j < 4; j++)
+			++index;
+			lval = ctx->ltable[ocb_ntz(index)].bytes;
+
+			for (j = 0; j < RSX_BLOCK_SIZE; ++j)
 			{
-				tmpk = state->roundkeys[i + j];
-				state->roundkeys[i + j] = state->roundkeys[k + j];
-				state->roundkeys[k + j] = tmpk;
+				offset[j] ^= lval[j];
+				blocks[i + j] = aad[i + j] ^ offset[j];
 			}
 		}
 
-		// sbox inversion
-		for (i = 4; i < state->rkeylen - 4; i++)
+		kern->ecb_encrypt(ctx->state, blocks, blocks, blen);
+
+		for (i = 0; i < blen; ++i)
 		{
-			state->roundkeys[i] = it_0[s_box[(state->roundkeys[i] >> 24)]] ^
-				it_1[s_box[(uint8_t)(state->roundkeys[i] >> 16)]] ^
-				it_2[s_box[(uint8_t)(state->roundkeys[i] >> 8)]] ^
-				it_3[s_box[(uint8_t)(state->roundkeys[i])]];
+			sum[i % RSX_BLOCK_SIZE] ^= blocks[i];
 		}
+
+		aad += blen;
+		aadlen -= blen;
 	}
 
-#ifdef RSX_PREFETCH_TABLES
-	prefetch_tables(encryption);
-#endif
+	if (aadlen != 0)
+	{
+		memset(blocks, 0, RSX_BLOCK_SIZE);
+		memcpy(blocks, aad, aadlen);
+		blocks[aadlen] = 0x80;
+
+		for (j = 0; j < RSX_BLOCK_SIZE; ++j)
+		{
+			blocks[j] ^= offset[j] ^ ctx->lstar.bytes[j];
+		}
+
+		kern->encrypt_block(ctx->state, blocks, blocks);
+
+		for (j = 0; j < RSX_BLOCK_SIZE; ++j)
+		{
+			sum[j] ^= blocks[j];
+		}
+	}
+}
+
+static void ocb_finalize(const rsx_kernels* kern, const rsx_ocb_ctx* ctx, uint8_t* tag, uint8_t* checksum, const uint8_t* offset, const uint8_t* aad, size_t aadlen)
+{
+	uint8_t sum[RSX_BLOCK_SIZE];
+	size_t i;
+
+	/* tag = E(checksum ^ offset ^ L$) ^ HASH(A) */
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		checksum[i] ^= offset[i] ^ ctx->ldollar.bytes[i];
+	}
+
+	kern->encrypt_block(ctx->state, tag, checksum);
+	ocb_hash(kern, ctx, sum, aad, aadlen);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		tag[i] ^= sum[i];
+	}
+}
+
+void rsx_ocb_initialize(rsx_ocb_ctx* ctx, rsx_state* state, rsx_state* invstate)
+{
+	size_t i;
+
+	ctx->state = state;
+	ctx->invstate = invstate;
+
+	/* L* = E(0), L$ = 2 L*, and L_i = 2^(i + 1) L$ */
+	memset(ctx->lstar.bytes, 0, RSX_BLOCK_SIZE);
+	kernels_get()->encrypt_block(state, ctx->lstar.bytes, ctx->lstar.bytes);
+	block_double(ctx->ldollar.bytes, ctx->lstar.bytes);
+	block_double(ctx->ltable[0].bytes, ctx->ldollar.bytes);
+
+	for (i = 1; i < RSX_OCB_LTABLE; ++i)
+	{
+		block_double(ctx->ltable[i].bytes, ctx->ltable[i - 1].bytes);
+	}
+}
+
+mqc_status rsx_ocb_encrypt(const rsx_ocb_ctx* ctx, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t checksum[RSX_BLOCK_SIZE];
+	uint8_t offset[RSX_BLOCK_SIZE];
+	uint8_t pad[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t blen;
+	size_t rlen;
+	size_t i;
+	uint8_t b;
+
+	status = MQC_ERROR_INVALID;
+
+	if (ocb_parameters_valid(noncelen, taglen) == true)
+	{
+		ocb_initial_offset(kern, ctx, offset, nonce, noncelen, taglen);
+		memset(checksum, 0, RSX_BLOCK_SIZE);
+		rlen = length % RSX_BLOCK_SIZE;
+		blen = length - rlen;
+		kern->ocb_encrypt(ctx->state, ctx->ltable, output, offset, checksum, input, blen, 0);
+
+		if (rlen != 0)
+		{
+			/* the partial block is encrypted with a pad, and enters the checksum with 10* padding */
+			for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+			{
+				offset[i] ^= ctx->lstar.bytes[i];
+			}
+
+			kern->encrypt_block(ctx->state, pad, offset);
+
+			for (i = 0; i < rlen; ++i)
+			{
+				b = input[blen + i];
+				checksum[i] ^= b;
+				output[blen + i] = b ^ pad[i];
+			}
+
+			checksum[rlen] ^= 0x80;
+		}
+
+		ocb_finalize(kern, ctx, tmpt, checksum, offset, aad, aadlen);
+		memcpy(tag, tmpt, taglen);
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+mqc_status rsx_ocb_decrypt(const rsx_ocb_ctx* ctx, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t checksum[RSX_BLOCK_SIZE];
+	uint8_t offset[RSX_BLOCK_SIZE];
+	uint8_t pad[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t blen;
+	size_t rlen;
+	size_t i;
+	uint8_t diff;
+	uint8_t b;
+
+	status = MQC_ERROR_INVALID;
+
+	if (ctx->invstate != NULL && ocb_parameters_valid(noncelen, taglen) == true)
+	{
+		ocb_initial_offset(kern, ctx, offset, nonce, noncelen, taglen);
+		memset(checksum, 0, RSX_BLOCK_SIZE);
+		rlen = length % RSX_BLOCK_SIZE;
+		blen = length - rlen;
+		kern->ocb_decrypt(ctx->invstate, ctx->ltable, output, offset, checksum, input, blen, 0);
+
+		if (rlen != 0)
+		{
+			for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+			{
+				offset[i] ^= ctx->lstar.bytes[i];
+			}
+
+			kern->encrypt_block(ctx->state, pad, offset);
+
+			for (i = 0; i < rlen; ++i)
+			{
+				b = input[blen + i] ^ pad[i];
+				checksum[i] ^= b;
+				output[blen + i] = b;
+			}
+
+			checksum[rlen] ^= 0x80;
+		}
+
+		ocb_finalize(kern, ctx, tmpt, checksum, offset, aad, aadlen);
+		diff = 0;
+
+		/* constant-time tag comparison */
+		for (i = 0; i < taglen; i++)
+		{
+			diff |= (uint8_t)(tmpt[i] ^ tag[i]);
+		}
+
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+
+		if (diff == 0)
+		{
+			status = MQC_STATUS_SUCCESS;
+		}
+		else
+		{
+			memset(output, 0, length);
+			status = MQC_STATUS_AUTHFAIL;
+		}
+	}
+
+	return status;
+}
+
+void rsx_ocb_dispose(rsx_ocb_ctx* ctx)
+{
+	memset(ctx->lstar.bytes, 0, RSX_BLOCK_SIZE);
+	memset(ctx->ldollar.bytes, 0, RSX_BLOCK_SIZE);
+	memset(ctx->ltable, 0, sizeof(ctx->ltable));
+	ctx->state = NULL;
+	ctx->invstate = NULL;
+}
+
+static bool pmac_parameters_valid(size_t taglen)
+{
+	return (taglen >= RSX_PMAC_MINTAG_SIZE && taglen <= RSX_PMAC_TAG_SIZE);
+}
+
+static void pmac_halve(uint8_t* output, const uint8_t* input)
+{
+	uint64_t hi;
+	uint64_t lo;
+	uint64_t carry;
+
+	/* multiplies by x^-1 in GF(2^128); the inverse of block_double */
+	hi = load_be64(input, 0);
+	lo = load_be64(input, 8);
+	carry = lo & 1;
+	lo = (lo >> 1) | (hi << 63);
+	hi = (hi >> 1) ^ (0x8000000000000000ULL & (0 - carry));
+	lo ^= 0x43 & (0 - carry);
+	be64_to_bytes(hi, output, 0);
+	be64_to_bytes(lo, output, 8);
+}
+
+static void pmac_compute(const rsx_kernels* kern, const rsx_pmac_ctx* ctx, uint8_t* tag, const uint8_t* message, size_t length)
+{
+	uint8_t offset[RSX_BLOCK_SIZE];
+	uint8_t last[RSX_BLOCK_SIZE];
+	size_t plen;
+	size_t i;
+
+	/* PMAC1: every block but the last is whitened with the offset of its index and enciphered in parallel,
+	   the last block is added to the sum directly, with L(-1) if it is complete, otherwise padded */
+	plen = (length == 0) ? 0 : ((length - 1) / RSX_BLOCK_SIZE) * RSX_BLOCK_SIZE;
+
+	if (length - plen == RSX_BLOCK_SIZE)
+	{
+		for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+		{
+			last[i] = message[plen + i] ^ ctx->linv.bytes[i];
+		}
+	}
+	else
+	{
+		memset(last, 0, RSX_BLOCK_SIZE);
+
+		/* the message can be NULL when it is empty */
+		if (length != plen)
+		{
+			memcpy(last, message + plen, length - plen);
+		}
+
+		last[length - plen] = 0x80;
+	}
+
+	memset(offset, 0, RSX_BLOCK_SIZE);
+	memset(tag, 0, RSX_BLOCK_SIZE);
+	kern->pmac_sum(ctx->state, ctx->ltable, offset, tag, message, plen, 0);
+
+	for (i = 0; i < RSX_BLOCK_SIZE; ++i)
+	{
+		tag[i] ^= last[i];
+	}
+
+	kern->encrypt_block(ctx->state, tag, tag);
+	memset(offset, 0, RSX_BLOCK_SIZE);
+	memset(last, 0, RSX_BLOCK_SIZE);
+}
+
+void rsx_pmac_initialize(rsx_pmac_ctx* ctx, rsx_state* state)
+{
+	size_t i;
+
+	ctx->state = state;
+
+	/* L(0) = E(0), L(i) = 2^i L(0), and L(-1) = L(0) / 2 */
+	memset(ctx->ltable[0].bytes, 0, RSX_BLOCK_SIZE);
+	kernels_get()->encrypt_block(state, ctx->ltable[0].bytes, ctx->ltable[0].bytes);
+	pmac_halve(ctx->linv.bytes, ctx->ltable[0].bytes);
+
+	for (i = 1; i < RSX_PMAC_LTABLE; ++i)
+	{
+		block_double(ctx->ltable[i].bytes, ctx->ltable[i - 1].bytes);
+	}
+}
+
+mqc_status rsx_pmac_compute(const rsx_pmac_ctx* ctx, uint8_t* tag, size_t taglen, const uint8_t* message, size_t length)
+{
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (pmac_parameters_valid(taglen) == true)
+	{
+		pmac_compute(kernels_get(), ctx, tmpt, message, length);
+		memcpy(tag, tmpt, taglen);
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
+
+mqc_status rsx_pmac_verify(const rsx_pmac_ctx* ctx, const uint8_t* tag, size_t taglen, const uint8_t* message, size_t length)
+{
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	mqc_status status;
+
+	status = MQC_ERROR_INVALID;
+
+	if (pmac_parameters_valid(taglen) == true)
+	{
+		pmac_compute(kernels_get(), ctx, tmpt, message, length);
+		status = (mac_tags_equal(tmpt, tag, taglen) == true) ? MQC_STATUS_SUCCESS : MQC_STATUS_AUTHFAIL;
+		memset(tmpt, 0, RSX_BLOCK_SIZE);
+	}
+
+	return status;
+}
+
+void rsx_pmac_dispose(rsx_pmac_ctx* ctx)
+{
+	memset(ctx->linv.bytes, 0, RSX_BLOCK_SIZE);
+	memset(ctx->ltable, 0, sizeof(ctx->ltable));
+	ctx->state = NULL;
+}
+
+mqc_status rsx_xts_decrypt(rsx_state* state, rsx_state* tweakstate, uint8_t* output, const uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	uint8_t tmpt[RSX_BLOCK_SIZE];
+	uint8_t tw[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t blen;
+	size_t rlen;
+	size_t i;
+	uint8_t b;
+
+	status = MQC_ERROR_INVALID;
+
+	if (length >= RSX_BLOCK_SIZE)
+	{
+		kern->encrypt_block(tweakstate, tw, tweak);
+		rlen = length % RSX_BLOCK_SIZE;
+		blen = length - rlen;
+
+		if (rlen == 0)
+		{
+			kern->xts_decrypt(state, output, tw, input, blen);
+		}
+		else
+		{
+			/* the last full block was encrypted with the final tweak, and the partial block with the one before it */
+			kern->xts_decrypt(state, output, tw, input, blen - RSX_BLOCK_SIZE);
+			memcpy(tmpt, tw, RSX_BLOCK_SIZE);
+			xts_double(tmpt);
+			kern->xts_decrypt(state, tmpb, tmpt, input + blen - RSX_BLOCK_SIZE, RSX_BLOCK_SIZE);
+
+			for (i = 0; i < rlen; ++i)
+			{
+				b = input[blen + i];
+				output[blen + i] = tmpb[i];
+				tmpb[i] = b;
+			}
+
+			kern->xts_decrypt(state, output + blen - RSX_BLOCK_SIZE, tw, tmpb, RSX_BLOCK_SIZE);
+		}
+
+		status = MQC_STATUS_SUCCESS;
+	}
 
 	return status;
 }
 
-#endif
\ No newline at end of file
+mqc_status rsx_xts_encrypt(rsx_state* state, rsx_state* tweakstate, uint8_t* output, const uint8_t* tweak, const uint8_t* input, size_t length)
+{
+	const rsx_kernels* kern = kernels_get();
+	uint8_t tmpb[RSX_BLOCK_SIZE];
+	uint8_t tw[RSX_BLOCK_SIZE];
+	mqc_status status;
+	size_t blen;
+	size_t rlen;
+	size_t i;
+	uint8_t b;
+
+	status = MQC_ERROR_INVALID;
+
+	if (length >= RSX_BLOCK_SIZE)
+	{
+		kern->encrypt_block(tweakstate, tw, tweak);
+		rlen = length % RSX_BLOCK_SIZE;
+		blen = length - rlen;
+		kern->xts_encrypt(state, output, tw, input, blen);
+
+		if (rlen != 0)
+		{
+			/* cipher-text stealing; the head of the last full block becomes the partial block, its tail pads the partial plain-text */
+			memcpy(tmpb, output + blen - RSX_BLOCK_SIZE, RSX_BLOCK_SIZE);
+
+			for (i = 0; i < rlen; ++i)
+			{
+				b = input[blen + i];
+				output[blen + i] = tmpb[i];
+				tmpb[i] = b;
+			}
+
+			kern->xts_encrypt(state, output + blen - RSX_BLOCK_SIZE, tw, tmpb, RSX_BLOCK_SIZE);
+		}
+
+		status = MQC_STATUS_SUCCESS;
+	}
+
+	return status;
+}
@@ -38,8 +38,22 @@
 * The base cipher, Rijndael, and the extended form of the cipher, can operate using one of the three provided cipher modes of operation: \n
 * Electronic Code Book mode (ECB), which can be used for testing or creating more complex algorithms,  \n
 * a segmented integer counter (CTR), and the Cipher Block Chaining mode (CBC). \n
-* This implementation has both a C reference, and an implementation that uses the AES-NI instructions. \n
-* The AES-NI implementation can be enabled by adding the RSX_AESNI_ENABLED constant to your preprocessor definitions. \n
+* The CCM mode (SP800-38C) runs its CBC-MAC and counter keystream in one pass, for peers that require it. \n
+* CMAC (SP800-38B) and PMAC1 authenticate messages with subkeys cached in a context; PMAC runs eight blocks in parallel. \n
+* Multi-buffer CBC encryption interleaves up to eight independent streams, each with its own IV, through the cipher. \n
+* Batches of short packets, each with its own counter, share the passes of the multi-block CTR cipher. \n
+* Small objects with their own keys are keyed and encrypted in groups, with the key schedules expanded four at a time. \n
+* Expanded key schedules can be held in a bounded, sharded cache (keycache.h) for callers that re-derive the same keys. \n
+* A two direction key context expands a key once, and derives the decryption schedule from the encryption schedule. \n
+* The Galois/Counter Mode (GCM) authenticated encryption runs over every key size, with a carry-less multiply GHASH when the AES-NI kernels are active. \n
+* The CTR-KMAC mode encrypts in CTR mode and authenticates the cipher-text with KMAC-256 in the same pass. \n
+* GCM-SIV (RFC 8452) is nonce misuse resistant, and derives a message key from each nonce. \n
+* The OCB3 mode (RFC 7253) authenticates with one cipher call per block, and runs in parallel in both directions. \n
+* The XTS mode (IEEE 1619) encrypts storage sectors with a second tweak key, for every key size. \n
+* HCTR2 is a length preserving wide-block mode for sectors, built from XCTR and POLYVAL, which hides equal blocks within a sector. \n
+* This implementation has a C reference (lookup table) kernel, a constant-time bitsliced kernel, an SSSE3 vector permute kernel, a kernel that uses the AES-NI instructions, \n
+* and on processors that support VAES and AVX-512, 512 bit kernels for the multi-block ECB, CTR, and CBC decryption functions. \n
+* The fastest kernel supported by the processor is selected at runtime, without AES-NI this is the vector permute kernel (SSSE3) or the bitsliced kernel; all kernels share the same round-key layout. \n
 * The AES128 and AES256 implementations along with the CBC, CTR, and CBC modes are tested using vectors from SP800-38a. \n
 * SP800-38a: <a href="http://nvlpubs.nist.gov/nistpubs/Legacy/SP/nistspecialpublication800-38a.pdf">Block Cipher Modes of Operations</a> \n
 * See the documentation and the aes_kat.h tests for usage examples.
@@ -65,11 +79,7 @@
 * uint8_t output[16];
 *
 * // initialize the roundkey array for the state
-* #if defined(RSX_AESNI_ENABLED)
-*	__m128i rkeys[RSX256_ROUNDKEY_DIMENSION];
-* #else
-*	uint32_t rkeys[RSX256_ROUNDKEY_DIMENSION];
-* #endif
+* rsx_roundkey rkeys[RSX256_ROUNDKEY_DIMENSION];
 *
 * rsx_state state = { rkeys, RSX256_ROUNDKEY_DIMENSION };
 *
@@ -81,17 +91,23 @@
 * \endcode
 *
 * \remarks For usage examples, see rsx_kat.h. \n
-* To enable AES-NI, add RSX_AESNI_ENABLED to the preprocessor definitions.
+* The cipher kernel (table, bitsliced, vector permute, AES-NI, or VAES) is selected at runtime, rsx_backend_set can be used to force a kernel.
 */
 
 #ifndef RSX_H
 #define RSX_H
 
-//#define RSX_AESNI_ENABLED /* just for testing, use preprocessor */
-
 #include "sha3.h"
-#if defined(RSX_AESNI_ENABLED)
-#	include <wmmintrin.h>
+#include "threadpool.h"
+
+/*!
+\def RSX_ALIGN
+* Aligns a type or variable to the x byte boundary
+*/
+#if defined(_MSC_VER)
+#	define RSX_ALIGN(x) __declspec(align(x))
+#else
+#	define RSX_ALIGN(x) __attribute__((aligned(x)))
 #endif
 
 /*! \enum cipher_mode
@@ -104,6 +120,19 @@ typedef enum
 	ECB = 3,	/*!< electronic codeBook mode */
 } cipher_mode;
 
+/*! \enum rsx_backend
+* The cipher kernel implementations, selected at runtime
+*/
+typedef enum
+{
+	RSX_BACKEND_AUTO = 0,	/*!< the fastest kernel supported by the processor */
+	RSX_BACKEND_TABLE = 1,	/*!< the portable lookup table kernel */
+	RSX_BACKEND_AESNI = 2,	/*!< the AES-NI kernel, eight blocks in parallel */
+	RSX_BACKEND_VAES = 3,	/*!< the VAES and AVX-512 kernel, sixteen blocks in parallel */
+	RSX_BACKEND_BITSLICED = 4,	/*!< the constant-time bitsliced kernel, eight blocks in parallel */
+	RSX_BACKEND_VPAES = 5,	/*!< the constant-time SSSE3 vector permute kernel */
+} rsx_backend;
+
 typedef struct rsx_keyparams
 {
 	uint8_t* key;
@@ -112,13 +141,17 @@ typedef struct rsx_keyparams
 	size_t codelen;
 } rsx_keyparams;
 
+/*! \struct rsx_roundkey
+* One round key in rijndael byte order; the layout is shared by every kernel
+*/
+typedef struct RSX_ALIGN(16) rsx_roundkey
+{
+	uint8_t bytes[16];
+} rsx_roundkey;
+
 typedef struct rsx_state
 {
-#if defined(RSX_AESNI_ENABLED)
-	__m128i* roundkeys;
-#else
-	uint32_t* roundkeys;
-#endif
+	rsx_roundkey* roundkeys;
 	size_t rkeylen;
 } rsx_state;
 
@@ -180,12 +213,7 @@ typedef struct rsx_state
 \def ROUNDKEY_ELEMENT_SIZE
 * The size in bytes of the round key array elements
 */
-#if defined(RSX_AESNI_ENABLED)
-#	define ROUNDKEY_ELEMENT_SIZE 16
-#else
-#	define ROUNDKEY_ELEMENT_SIZE 4
-#	define RSX_PREFETCH_TABLES
-#endif
+#define ROUNDKEY_ELEMENT_SIZE 16
 
 /*!
 \def AES128_ROUNDKEY_DIMENSION
@@ -211,8 +239,324 @@ typedef struct rsx_state
 */
 #define RSX512_ROUNDKEY_DIMENSION ((RSX512_ROUND_COUNT + 1) * (RSX_BLOCK_SIZE / ROUNDKEY_ELEMENT_SIZE))
 
+/*!
+\def RSX_PARALLEL_MINCHUNK
+* The default minimum number of bytes given to each thread by the parallel CTR transform
+*/
+#define RSX_PARALLEL_MINCHUNK (64 * 1024)
+
+/*!
+\def RSX_GCM_HPOWERS
+* The number of powers of the GHASH key held by a GCM context; the carry-less multiply path hashes this many blocks per reduction
+*/
+#define RSX_GCM_HPOWERS 8
+
+/*!
+\def RSX_GCM_NONCE_SIZE
+* The recommended GCM nonce size in bytes; other lengths are accepted and hashed into the initial counter
+*/
+#define RSX_GCM_NONCE_SIZE 12
+
+/*!
+\def RSX_GCM_TAG_SIZE
+* The size in bytes of a full length GCM authentication tag
+*/
+#define RSX_GCM_TAG_SIZE 16
+
+/*!
+\def RSX_GCM_MINTAG_SIZE
+* The smallest truncated GCM tag length in bytes accepted by the GCM functions
+*/
+#define RSX_GCM_MINTAG_SIZE 4
+
+/*!
+\def RSX_GCM_STRIDE
+* The number of bytes encrypted and hashed together by the GCM loop; small enough to stay in the L1 cache between the two
+*/
+#define RSX_GCM_STRIDE (32 * RSX_BLOCK_SIZE)
+
+/*!
+\def RSX_CTRKMAC_MAXKEY_SIZE
+* The largest KMAC key in bytes accepted by the CTR-KMAC mode
+*/
+#define RSX_CTRKMAC_MAXKEY_SIZE 64
+
+/*!
+\def RSX_CTRKMAC_TAG_SIZE
+* The recommended CTR-KMAC tag size in bytes
+*/
+#define RSX_CTRKMAC_TAG_SIZE 32
+
+/*!
+\def RSX_CTRKMAC_MINTAG_SIZE
+* The smallest CTR-KMAC tag size in bytes
+*/
+#define RSX_CTRKMAC_MINTAG_SIZE 16
+
+/*!
+\def RSX_CTRKMAC_MAXTAG_SIZE
+* The largest CTR-KMAC tag size in bytes
+*/
+#define RSX_CTRKMAC_MAXTAG_SIZE 64
+
+/*!
+\def RSX_CTRKMAC_STRIDE
+* The number of bytes encrypted and absorbed together by the CTR-KMAC loop; a whole number of cipher blocks and KMAC-256 blocks
+*/
+#define RSX_CTRKMAC_STRIDE (8 * CSHAKE256_RATE)
+
+/*!
+\def RSX_GCMSIV_NONCE_SIZE
+* The GCM-SIV nonce size in bytes
+*/
+#define RSX_GCMSIV_NONCE_SIZE 12
+
+/*!
+\def RSX_GCMSIV_TAG_SIZE
+* The GCM-SIV authentication tag size in bytes
+*/
+#define RSX_GCMSIV_TAG_SIZE 16
+
+/*!
+\def RSX_GCMSIV_BATCH
+* The number of records whose per-nonce keys are derived in one pass of the multi-block cipher by the batch functions
+*/
+#define RSX_GCMSIV_BATCH 8
+
+/*!
+\def RSX_OCB_LTABLE
+* The number of cached OCB L values; one for each possible number of trailing zeros in a 64 bit block index
+*/
+#define RSX_OCB_LTABLE 64
+
+/*!
+\def RSX_OCB_NONCE_SIZE
+* The recommended OCB nonce size in bytes
+*/
+#define RSX_OCB_NONCE_SIZE 12
+
+/*!
+\def RSX_OCB_MAXNONCE_SIZE
+* The maximum OCB nonce size in bytes
+*/
+#define RSX_OCB_MAXNONCE_SIZE 15
+
+/*!
+\def RSX_OCB_TAG_SIZE
+* The full OCB authentication tag size in bytes
+*/
+#define RSX_OCB_TAG_SIZE 16
+
+/*!
+\def RSX_OCB_MINTAG_SIZE
+* The minimum truncated OCB authentication tag size in bytes
+*/
+#define RSX_OCB_MINTAG_SIZE 8
+
+/*!
+\def RSX_CCM_MINNONCE_SIZE
+* The minimum CCM nonce size in bytes; the length field takes the remaining 15 - noncelen bytes of the counter block
+*/
+#define RSX_CCM_MINNONCE_SIZE 7
+
+/*!
+\def RSX_CCM_MAXNONCE_SIZE
+* The maximum CCM nonce size in bytes
+*/
+#define RSX_CCM_MAXNONCE_SIZE 13
+
+/*!
+\def RSX_CCM_TAG_SIZE
+* The full CCM authentication tag size in bytes
+*/
+#define RSX_CCM_TAG_SIZE 16
+
+/*!
+\def RSX_CCM_MINTAG_SIZE
+* The minimum truncated CCM authentication tag size in bytes; the tag length must be even
+*/
+#define RSX_CCM_MINTAG_SIZE 4
+
+/*!
+\def RSX_CMAC_TAG_SIZE
+* The full CMAC tag size in bytes
+*/
+#define RSX_CMAC_TAG_SIZE 16
+
+/*!
+\def RSX_CMAC_MINTAG_SIZE
+* The minimum truncated CMAC tag size in bytes
+*/
+#define RSX_CMAC_MINTAG_SIZE 8
+
+/*!
+\def RSX_PMAC_LTABLE
+* The number of cached PMAC L values; one for each possible number of trailing zeros in a 64 bit block index
+*/
+#define RSX_PMAC_LTABLE 64
+
+/*!
+\def RSX_PMAC_TAG_SIZE
+* The full PMAC tag size in bytes
+*/
+#define RSX_PMAC_TAG_SIZE 16
+
+/*!
+\def RSX_PMAC_MINTAG_SIZE
+* The minimum truncated PMAC tag size in bytes
+*/
+#define RSX_PMAC_MINTAG_SIZE 8
+
+/*! \struct rsx_cbc_job
+* One independent CBC stream of a multi-buffer encryption
+*/
+typedef struct rsx_cbc_job
+{
+	uint8_t* output;		/*!< the output cipher-text, length bytes */
+	uint8_t* iv;			/*!< the 16 byte initialization vector, receives the last cipher-text block */
+	const uint8_t* input;	/*!< the input plain-text */
+	size_t length;			/*!< the stream length in bytes, a multiple of the block size */
+} rsx_cbc_job;
+
+/*! \struct rsx_cmac_ctx
+* A CMAC context; the cipher state, and the two subkeys derived once per key
+*/
+typedef struct rsx_cmac_ctx
+{
+	rsx_state* state;
+	rsx_roundkey k1;
+	rsx_roundkey k2;
+} rsx_cmac_ctx;
+
+/*! \struct rsx_ctr_ctx
+* A streaming CTR context; keeps the counter and the unused part of the last keystream block between updates
+*/
+typedef struct rsx_ctr_ctx
+{
+	rsx_state* state;
+	uint8_t nonce[RSX_BLOCK_SIZE];
+	uint8_t keystream[RSX_BLOCK_SIZE];
+	size_t position;
+} rsx_ctr_ctx;
+
+/*! \struct rsx_ctr_packet
+* One packet of a batch CTR transform, with its own counter
+*/
+typedef struct rsx_ctr_packet
+{
+	uint8_t* output;		/*!< the output bytes, length bytes */
+	const uint8_t* nonce;	/*!< the 16 byte initial counter of the packet, it is not modified */
+	const uint8_t* input;	/*!< the input bytes */
+	size_t length;			/*!< the packet length in bytes */
+} rsx_ctr_packet;
+
+/*! \struct rsx_ctrkmac_ctx
+* A CTR-KMAC context; the cipher state and the KMAC-256 state after the mac key is absorbed
+*/
+typedef struct rsx_ctrkmac_ctx
+{
+	rsx_state* state;
+	uint64_t kstate[SHA3_STATESIZE];
+} rsx_ctrkmac_ctx;
+
+/*! \struct rsx_dualkey_ctx
+* A two direction key context; the encryption state, and the decryption state derived from it once, on first use when lazy
+*/
+typedef struct rsx_dualkey_ctx
+{
+	rsx_state* state;
+	rsx_state* invstate;
+	bool inverse;
+} rsx_dualkey_ctx;
+
+/*! \struct rsx_gcm_ctx
+* A GCM context; the cipher state and the powers of the hash key H, computed once per key
+*/
+typedef struct rsx_gcm_ctx
+{
+	rsx_state* state;
+	rsx_roundkey hpowers[RSX_GCM_HPOWERS];
+} rsx_gcm_ctx;
+
+/*! \struct rsx_gcmsiv_record
+* One GCM-SIV message of a batch; the status receives the result of the record
+*/
+typedef struct rsx_gcmsiv_record
+{
+	uint8_t* output;		/*!< the output cipher-text or plain-text, length bytes */
+	uint8_t* tag;			/*!< receives the tag when encrypting, holds the tag to verify when decrypting */
+	const uint8_t* nonce;	/*!< the RSX_GCMSIV_NONCE_SIZE byte nonce */
+	const uint8_t* aad;		/*!< the additional authenticated data, can be NULL if aadlen is zero */
+	size_t aadlen;			/*!< the length of the additional data in bytes */
+	const uint8_t* input;	/*!< the input plain-text or cipher-text */
+	size_t length;			/*!< the message length in bytes */
+	mqc_status status;		/*!< the result for this record */
+} rsx_gcmsiv_record;
+
+/*! \struct rsx_hctr2_ctx
+* An HCTR2 context; the forward and inverse cipher states, the POLYVAL key powers, and the L value derived once per key
+*/
+typedef struct rsx_hctr2_ctx
+{
+	rsx_state* state;
+	rsx_state* invstate;
+	rsx_roundkey hpowers[RSX_GCM_HPOWERS];
+	rsx_roundkey l;
+} rsx_hctr2_ctx;
+
+/*! \struct rsx_keyed_packet
+* One packet of a key-agile CTR batch, with its own key and counter
+*/
+typedef struct rsx_keyed_packet
+{
+	uint8_t* output;		/*!< the output bytes, length bytes */
+	const uint8_t* key;		/*!< the packet key, the key size of the cipher */
+	const uint8_t* nonce;	/*!< the 16 byte initial counter of the packet, it is not modified */
+	const uint8_t* input;	/*!< the input bytes */
+	size_t length;			/*!< the packet length in bytes */
+} rsx_keyed_packet;
+
+/*! \struct rsx_ocb_ctx
+* An OCB context; the forward and inverse cipher states, and the L values derived once per key
+*/
+typedef struct rsx_ocb_ctx
+{
+	rsx_state* state;
+	rsx_state* invstate;
+	rsx_roundkey lstar;
+	rsx_roundkey ldollar;
+	rsx_roundkey ltable[RSX_OCB_LTABLE];
+} rsx_ocb_ctx;
+
+/*! \struct rsx_pmac_ctx
+* A PMAC context; the cipher state, and the L values derived once per key
+*/
+typedef struct rsx_pmac_ctx
+{
+	rsx_state* state;
+	rsx_roundkey linv;
+	rsx_roundkey ltable[RSX_PMAC_LTABLE];
+} rsx_pmac_ctx;
+
 /* Public API */
 
+	/**
+	* \brief Get the cipher kernel used by the cipher functions. \n
+	* The first call selects the fastest kernel supported by the processor.
+	*
+	* \return Returns the active kernel
+	*/
+	rsx_backend rsx_backend_get();
+
+	/**
+	* \brief Set the cipher kernel used by the cipher functions. \n
+	* Initialized states remain valid, all kernels use the same round-key layout.
+	*
+	* \param backend The kernel to use, or RSX_BACKEND_AUTO for the fastest supported kernel
+	* \return Returns false if the kernel is not supported by this processor or compiler
+	*/
+	bool rsx_backend_set(rsx_backend backend);
+
 	/**
 	* \brief Decrypt one (16 byte) block of cipher-text using Cipher Block Chaining (CBC) mode.
 	*
@@ -224,6 +568,20 @@ typedef struct rsx_state
 	*/
 	void rsx_cbc_decrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input);
 
+	/**
+	* \brief Decrypt an array of cipher-text blocks using Cipher Block Chaining (CBC) mode. \n
+	* With AES-NI the blocks are decrypted eight at a time. The output may overwrite the input (in place).
+	*
+	* \warning The length must be a multiple of the 16 byte block size.
+	*
+	* \param state The initialized cipher state; initialized for decryption
+	* \param output The output byte array; receives the decrypted plain-text, must be at least length bytes
+	* \param iv The initialization vector; must be 16 bytes in length, receives the last cipher-text block
+	* \param input The input cipher-text byte array
+	* \param length The number of bytes to decrypt
+	*/
+	void rsx_cbc_decrypt_blocks(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input, size_t length);
+
 	/**
 	* \brief Encrypt one (16 byte) block of plain-text using Cipher Block Chaining (CBC) mode.
 	*
@@ -235,6 +593,96 @@ typedef struct rsx_state
 	*/
 	void rsx_cbc_encrypt(rsx_state* state, uint8_t* output, uint8_t* iv, const uint8_t* input);
 
+	/**
+	* \brief Encrypt a set of independent streams (files or sectors) using Cipher Block Chaining (CBC) mode. \n
+	* One CBC stream is bound by the latency of the cipher; here one block from each of up to eight streams is encrypted in every pass,
+	* and a lane whose stream ends is refilled with the next job. Streams of similar length keep the lanes full.
+	*
+	* \warning Each job length must be a multiple of the 16 byte block size, a partial last block is not encrypted.
+	*
+	* \param state The initialized cipher state; initialized for encryption
+	* \param jobs The streams; each iv receives the last cipher-text block of its stream
+	* \param count The number of jobs
+	*/
+	void rsx_cbc_encrypt_jobs(rsx_state* state, rsx_cbc_job* jobs, size_t count);
+
+	/**
+	* \brief Decrypt and verify a message with the CCM mode of SP800-38C (RFC 3610). \n
+	* The plain-text is authenticated as it is decrypted; the output can be the input array, and is erased if the tag does not match.
+	*
+	* \param state The cipher state; initialized for encryption, with any of the AES and RSX key sizes
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tag The authentication tag to verify
+	* \param taglen The tag length in bytes; an even number from RSX_CCM_MINTAG_SIZE to RSX_CCM_TAG_SIZE
+	* \param nonce The nonce used to encrypt the message
+	* \param noncelen The nonce length in bytes; from RSX_CCM_MINNONCE_SIZE to RSX_CCM_MAXNONCE_SIZE
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input cipher-text
+	* \param length The number of bytes to decrypt
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for invalid parameters
+	*/
+	mqc_status rsx_ccm_decrypt(rsx_state* state, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Encrypt and authenticate a message with the CCM mode of SP800-38C (RFC 3610). \n
+	* The serial CBC-MAC and the counter keystream share one pass; with AES-NI each mac block is paired with a keystream block in the same round loop.
+	*
+	* \param state The cipher state; initialized for encryption, with any of the AES and RSX key sizes
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tag The output authentication tag; receives taglen bytes
+	* \param taglen The tag length in bytes; an even number from RSX_CCM_MINTAG_SIZE to RSX_CCM_TAG_SIZE
+	* \param nonce The nonce; must be unique for each message encrypted with the key
+	* \param noncelen The nonce length in bytes; from RSX_CCM_MINNONCE_SIZE to RSX_CCM_MAXNONCE_SIZE
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input plain-text
+	* \param length The number of bytes to encrypt; must fit the 15 - noncelen byte length field
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for invalid parameters
+	*/
+	mqc_status rsx_ccm_encrypt(rsx_state* state, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Initialize a CMAC context; derives the K1 and K2 subkeys. \n
+	* The state must remain valid until the context is disposed.
+	*
+	* \param ctx The CMAC context
+	* \param state The cipher state; initialized for encryption, with any of the AES and RSX key sizes
+	*/
+	void rsx_cmac_initialize(rsx_cmac_ctx* ctx, rsx_state* state);
+
+	/**
+	* \brief Compute the CMAC (SP800-38B, RFC 4493) of a message. \n
+	* The chaining value stays in a register across the message, with no call or copy per block.
+	*
+	* \param ctx The initialized CMAC context
+	* \param tag The output tag; receives taglen bytes
+	* \param taglen The tag length in bytes; from RSX_CMAC_MINTAG_SIZE to RSX_CMAC_TAG_SIZE
+	* \param message The message, can be NULL if length is zero
+	* \param length The message length in bytes
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an invalid tag length
+	*/
+	mqc_status rsx_cmac_compute(const rsx_cmac_ctx* ctx, uint8_t* tag, size_t taglen, const uint8_t* message, size_t length);
+
+	/**
+	* \brief Verify the CMAC of a message, in constant time
+	*
+	* \param ctx The initialized CMAC context
+	* \param tag The tag to verify
+	* \param taglen The tag length in bytes; from RSX_CMAC_MINTAG_SIZE to RSX_CMAC_TAG_SIZE
+	* \param message The message, can be NULL if length is zero
+	* \param length The message length in bytes
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for an invalid tag length
+	*/
+	mqc_status rsx_cmac_verify(const rsx_cmac_ctx* ctx, const uint8_t* tag, size_t taglen, const uint8_t* message, size_t length);
+
+	/**
+	* \brief Erase the subkeys of a CMAC context
+	*
+	* \param ctx The CMAC context
+	*/
+	void rsx_cmac_dispose(rsx_cmac_ctx* ctx);
+
 	/**
 	* \brief Encrypt/Decrypt one (16 byte) block of plain-text using a segmented integer counter (CTR) mode.
 	*
@@ -246,6 +694,173 @@ typedef struct rsx_state
 	*/
 	void rsx_ctr_transform(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input);
 
+	/**
+	* \brief Encrypt/Decrypt an array of bytes using a segmented integer counter (CTR) mode. \n
+	* Full blocks are processed eight at a time, a trailing partial block consumes one counter.
+	*
+	* \param state The initialized cipher state
+	* \param output The output byte array; receives the transformed bytes, must be at least length bytes
+	* \param nonce The initialization vector; must be 16 bytes in length, the counter is updated internally
+	* \param input The input byte array
+	* \param length The number of bytes to transform
+	*/
+	void rsx_ctr_transform_blocks(rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Encrypt/Decrypt a batch of small objects in counter (CTR) mode, each object with its own key and counter. \n
+	* The key schedules are expanded four at a time; AES-NI runs the aeskeygenassist chains of four keys in step, and the RSX schedules
+	* are squeezed from four cSHAKE instances in lock step. Each group of eight objects is then encrypted in one pass with a key per lane.
+	* Each object gives the same output as rsx_initialize followed by rsx_ctr_transform_blocks with a copy of its nonce.
+	*
+	* \param packets The objects; the output of an object can be its input
+	* \param count The number of objects
+	* \param rkeylen The cipher; one of the AES128, AES256, RSX256, or RSX512 round-key dimensions, the keys are the key size of that cipher
+	* \param distcode The RSX distribution code shared by every key; can be NULL, not used by AES
+	* \param codelen The length of the distribution code
+	*
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an unknown round-key dimension
+	*/
+	mqc_status rsx_ctr_transform_keyed(const rsx_keyed_packet* packets, size_t count, size_t rkeylen, const uint8_t* distcode, size_t codelen);
+
+	/**
+	* \brief Encrypt/Decrypt a batch of short packets in counter (CTR) mode, each packet with its own counter. \n
+	* The counter blocks of consecutive packets share each pass of the multi-block cipher, so the pipeline is not started and drained for every packet.
+	* Each packet gives the same output as rsx_ctr_transform_blocks with a copy of its nonce.
+	*
+	* \param state The initialized cipher state; initialized for encryption
+	* \param packets The packets; the output of a packet can be its input
+	* \param count The number of packets
+	*/
+	void rsx_ctr_transform_packets(rsx_state* state, const rsx_ctr_packet* packets, size_t count);
+
+	/**
+	* \brief Encrypt/Decrypt an array of bytes in counter (CTR) mode, on the threads of a worker pool. \n
+	* The input is split into one segment per thread, each segment starts at the nonce plus its 128 bit block offset. \n
+	* The output and the final counter are identical to rsx_ctr_transform_blocks.
+	*
+	* \param pool The worker pool; if NULL, or the input is smaller than two chunks, the transform runs on the calling thread
+	* \param state The initialized cipher state; read concurrently by the workers
+	* \param output The output byte array; receives the transformed bytes, must be at least length bytes
+	* \param nonce The initialization vector; must be 16 bytes in length, the counter is updated internally
+	* \param input The input byte array
+	* \param length The number of bytes to transform
+	* \param minchunk The minimum number of bytes given to each thread; zero selects RSX_PARALLEL_MINCHUNK
+	*/
+	void rsx_ctr_transform_parallel(threadpool_state* pool, rsx_state* state, uint8_t* output, uint8_t* nonce, const uint8_t* input, size_t length, size_t minchunk);
+
+	/**
+	* \brief Initialize a streaming CTR context. \n
+	* The context references the cipher state, which must remain valid until the context is disposed.
+	*
+	* \param ctx The CTR context
+	* \param state The initialized cipher state; initialized for encryption
+	* \param nonce The initial counter; must be 16 bytes in length, it is copied to the context
+	*/
+	void rsx_ctr_initialize(rsx_ctr_ctx* ctx, rsx_state* state, const uint8_t* nonce);
+
+	/**
+	* \brief Encrypt/Decrypt an array of bytes of any length in counter (CTR) mode. \n
+	* Unused keystream from the previous update is consumed first, the aligned middle is processed by the multi-block kernel,
+	* and the keystream of a trailing partial block is kept for the next update.
+	* A message split over several updates gives the same output as a single call to rsx_ctr_transform_blocks.
+	*
+	* \param ctx The initialized CTR context
+	* \param output The output byte array; receives the transformed bytes, must be at least length bytes
+	* \param input The input byte array
+	* \param length The number of bytes to transform
+	*/
+	void rsx_ctr_update(rsx_ctr_ctx* ctx, uint8_t* output, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Erase the counter and buffered keystream of a CTR context
+	*
+	* \param ctx The CTR context
+	*/
+	void rsx_ctr_dispose(rsx_ctr_ctx* ctx);
+
+	/**
+	* \brief Initialize a CTR-KMAC encrypt-then-mac context. \n
+	* The mac key should be independent of the cipher key. The context references the cipher state, which must remain valid until the context is disposed.
+	*
+	* \param ctx The CTR-KMAC context
+	* \param state The initialized cipher state; initialized for encryption
+	* \param mackey The KMAC-256 key
+	* \param mackeylen The length of the mac key in bytes; 1 to RSX_CTRKMAC_MAXKEY_SIZE
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an invalid key length
+	*/
+	mqc_status rsx_ctrkmac_initialize(rsx_ctrkmac_ctx* ctx, rsx_state* state, const uint8_t* mackey, size_t mackeylen);
+
+	/**
+	* \brief Encrypt a message in CTR mode, and authenticate the nonce, additional data, and cipher-text with KMAC-256. \n
+	* The keystream and the mac run in one loop over cache sized strides, the message is read once.
+	*
+	* \param ctx The initialized CTR-KMAC context
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tag The output authentication tag; receives taglen bytes
+	* \param taglen The tag length in bytes; RSX_CTRKMAC_MINTAG_SIZE to RSX_CTRKMAC_MAXTAG_SIZE
+	* \param nonce The initial counter; must be 16 bytes in length, and never repeated under the same key
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input plain-text
+	* \param length The number of bytes to encrypt
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an invalid tag length
+	*/
+	mqc_status rsx_ctrkmac_encrypt(const rsx_ctrkmac_ctx* ctx, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Verify and decrypt a CTR-KMAC message in a single pass. \n
+	* The output can be the input array. If the tag does not match, the decryption is rolled back and the output holds the cipher-text.
+	*
+	* \param ctx The initialized CTR-KMAC context
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tag The authentication tag to verify
+	* \param taglen The tag length in bytes; RSX_CTRKMAC_MINTAG_SIZE to RSX_CTRKMAC_MAXTAG_SIZE
+	* \param nonce The initial counter used to encrypt the message
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input cipher-text
+	* \param length The number of bytes to decrypt
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for an invalid tag length
+	*/
+	mqc_status rsx_ctrkmac_decrypt(const rsx_ctrkmac_ctx* ctx, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Erase the mac state of a CTR-KMAC context
+	*
+	* \param ctx The CTR-KMAC context
+	*/
+	void rsx_ctrkmac_dispose(rsx_ctrkmac_ctx* ctx);
+
+	/**
+	* \brief Initialize a two direction key context, for endpoints that both encrypt and decrypt under one key. \n
+	* The key is expanded once into the encryption state; the decryption state is derived from it with rsx_inverse_schedule,
+	* immediately, or on the first call to rsx_dualkey_decryption when lazy is true. The states must remain valid until the context is disposed.
+	*
+	* \param ctx The key context
+	* \param state The state receiving the encryption schedule; its rkeylen selects the cipher
+	* \param invstate The state receiving the decryption schedule; must have the same rkeylen
+	* \param keyparams The cipher key
+	* \param lazy Defer the decryption schedule until it is first requested
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an unknown or mismatched rkeylen
+	*/
+	mqc_status rsx_dualkey_initialize(rsx_dualkey_ctx* ctx, rsx_state* state, rsx_state* invstate, rsx_keyparams* keyparams, bool lazy);
+
+	/**
+	* \brief Get the decryption state of a key context, deriving the schedule on the first call. \n
+	* The first call writes the context, so it must not run concurrently with other calls on the same context.
+	*
+	* \param ctx The initialized key context
+	* \return Returns the state initialized for decryption
+	*/
+	rsx_state* rsx_dualkey_decryption(rsx_dualkey_ctx* ctx);
+
+	/**
+	* \brief Erase both key schedules of a key context
+	*
+	* \param ctx The key context
+	*/
+	void rsx_dualkey_dispose(rsx_dualkey_ctx* ctx);
+
 	/**
 	* \brief Decrypt one (16 byte) block of cipher-text using Electronic CodeBook Mode (ECB) mode. \n
 	* ECB is not a secure mode, and should be used only for testing, or building more complex primitives.
@@ -257,6 +872,19 @@ typedef struct rsx_state
 	*/
 	void rsx_ecb_decrypt(rsx_state* state, uint8_t* output, const uint8_t* input);
 
+	/**
+	* \brief Decrypt an array of cipher-text blocks using Electronic CodeBook Mode (ECB) mode. \n
+	* ECB is not a secure mode, and should be used only for testing, or building more complex primitives.
+	*
+	* \warning The length must be a multiple of the 16 byte block size.
+	*
+	* \param state The initialized cipher state; initialized for decryption
+	* \param output The output byte array; receives the decrypted plain-text, must be at least length bytes
+	* \param input The input cipher-text byte array
+	* \param length The number of bytes to decrypt
+	*/
+	void rsx_ecb_decrypt_blocks(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length);
+
 	/**
 	* \brief Encrypt one (16 byte) block of cipher-text using Electronic CodeBook Mode (ECB) mode. \n
 	* ECB is not a secure mode, and should be used only for testing, or building more complex primitives.
@@ -269,6 +897,171 @@ typedef struct rsx_state
 	*/
 	void rsx_ecb_encrypt(rsx_state* state, uint8_t* output, const uint8_t* input);
 
+	/**
+	* \brief Encrypt an array of plain-text blocks using Electronic CodeBook Mode (ECB) mode. \n
+	* ECB is not a secure mode, and should be used only for testing, or building more complex primitives.
+	*
+	* \warning The length must be a multiple of the 16 byte block size.
+	*
+	* \param state The initialized cipher state; initialized for encryption
+	* \param output The output byte array; receives the encrypted cipher-text, must be at least length bytes
+	* \param input The input plain-text byte array
+	* \param length The number of bytes to encrypt
+	*/
+	void rsx_ecb_encrypt_blocks(rsx_state* state, uint8_t* output, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Initialize a GCM context; computes the hash key H and its powers. \n
+	* The cipher state can use any of the AES and RSX key sizes, the context references it and it must remain valid until the context is disposed.
+	*
+	* \param ctx The GCM context
+	* \param state The initialized cipher state; initialized for encryption, GCM uses the forward cipher in both directions
+	*/
+	void rsx_gcm_initialize(rsx_gcm_ctx* ctx, rsx_state* state);
+
+	/**
+	* \brief Encrypt and authenticate a message with Galois/Counter Mode (GCM). \n
+	* The counter and the GHASH run in the same loop over the message, which is read once.
+	*
+	* \param ctx The initialized GCM context
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tag The output authentication tag; receives taglen bytes
+	* \param taglen The tag length in bytes; RSX_GCM_MINTAG_SIZE to RSX_GCM_TAG_SIZE
+	* \param nonce The nonce; must never be repeated under the same key, RSX_GCM_NONCE_SIZE bytes is recommended
+	* \param noncelen The length of the nonce in bytes; must not be zero
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input plain-text
+	* \param length The number of bytes to encrypt
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an invalid nonce, tag, or message length
+	*/
+	mqc_status rsx_gcm_encrypt(const rsx_gcm_ctx* ctx, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Decrypt and verify a message with Galois/Counter Mode (GCM). \n
+	* The output can be the input array; if the tag does not match, the output is erased.
+	*
+	* \param ctx The initialized GCM context
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tag The authentication tag to verify
+	* \param taglen The tag length in bytes; RSX_GCM_MINTAG_SIZE to RSX_GCM_TAG_SIZE
+	* \param nonce The nonce used to encrypt the message
+	* \param noncelen The length of the nonce in bytes
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input cipher-text
+	* \param length The number of bytes to decrypt
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for invalid parameters
+	*/
+	mqc_status rsx_gcm_decrypt(const rsx_gcm_ctx* ctx, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Erase the hash key powers of a GCM context
+	*
+	* \param ctx The GCM context
+	*/
+	void rsx_gcm_dispose(rsx_gcm_ctx* ctx);
+
+	/**
+	* \brief Decrypt and verify a message with GCM-SIV (RFC 8452). \n
+	* The message keys are derived from the nonce with the cipher state; the output can be the input array, and is erased if the tag does not match.
+	*
+	* \param state The key generating cipher state; initialized for encryption, with any of the AES and RSX key sizes
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tag The RSX_GCMSIV_TAG_SIZE byte authentication tag to verify
+	* \param nonce The RSX_GCMSIV_NONCE_SIZE byte nonce used to encrypt the message
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input cipher-text
+	* \param length The number of bytes to decrypt
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for invalid parameters
+	*/
+	mqc_status rsx_gcmsiv_decrypt(rsx_state* state, uint8_t* output, const uint8_t* tag, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Decrypt and verify a batch of GCM-SIV records under one key. \n
+	* The per-nonce keys of up to RSX_GCMSIV_BATCH records are derived together, which removes most of the setup cost of short records.
+	*
+	* \param state The key generating cipher state; initialized for encryption
+	* \param records The records; each record status receives its result
+	* \param count The number of records
+	* \return Returns MQC_STATUS_SUCCESS if every record was verified, otherwise the first failed record status
+	*/
+	mqc_status rsx_gcmsiv_decrypt_batch(rsx_state* state, rsx_gcmsiv_record* records, size_t count);
+
+	/**
+	* \brief Encrypt and authenticate a message with GCM-SIV (RFC 8452). \n
+	* A repeated nonce reveals only whether the same message was encrypted; the message and the additional data are read twice, once by POLYVAL and once by the CTR pass.
+	*
+	* \param state The key generating cipher state; initialized for encryption, with any of the AES and RSX key sizes
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tag The output authentication tag; receives RSX_GCMSIV_TAG_SIZE bytes
+	* \param nonce The RSX_GCMSIV_NONCE_SIZE byte nonce
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input plain-text
+	* \param length The number of bytes to encrypt
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an unsupported state or a message longer than 2^36 bytes
+	*/
+	mqc_status rsx_gcmsiv_encrypt(rsx_state* state, uint8_t* output, uint8_t* tag, const uint8_t* nonce, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Encrypt and authenticate a batch of GCM-SIV records under one key. \n
+	* The per-nonce keys of up to RSX_GCMSIV_BATCH records are derived together, which removes most of the setup cost of short records.
+	*
+	* \param state The key generating cipher state; initialized for encryption
+	* \param records The records; each record status receives its result
+	* \param count The number of records
+	* \return Returns MQC_STATUS_SUCCESS if every record was encrypted, otherwise the first failed record status
+	*/
+	mqc_status rsx_gcmsiv_encrypt_batch(rsx_state* state, rsx_gcmsiv_record* records, size_t count);
+
+	/**
+	* \brief Initialize an HCTR2 context; computes the POLYVAL key powers and the L value. \n
+	* The states must use the same key, and must remain valid until the context is disposed.
+	*
+	* \param ctx The HCTR2 context
+	* \param state The cipher state initialized for encryption; used by both directions
+	* \param invstate The cipher state initialized for decryption, can be NULL if the context is only used to encrypt
+	*/
+	void rsx_hctr2_initialize(rsx_hctr2_ctx* ctx, rsx_state* state, rsx_state* invstate);
+
+	/**
+	* \brief Encrypt a data unit (sector) with the HCTR2 wide-block mode. \n
+	* Every output byte depends on every input byte and the tweak, the length is preserved, and there is no tag;
+	* the XCTR keystream and the POLYVAL hash of its output are computed in the same pass. The output can be the input array.
+	*
+	* \param ctx The initialized HCTR2 context
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tweak The tweak, for example the sector number; can be NULL if tweaklen is zero
+	* \param tweaklen The length of the tweak in bytes; 32 bytes or less keeps the tweak to two hash blocks
+	* \param input The input plain-text
+	* \param length The length of the data unit in bytes; at least one block
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID if the length is less than the block size
+	*/
+	mqc_status rsx_hctr2_encrypt(const rsx_hctr2_ctx* ctx, uint8_t* output, const uint8_t* tweak, size_t tweaklen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Decrypt a data unit (sector) with the HCTR2 wide-block mode. \n
+	* The output can be the input array.
+	*
+	* \param ctx The initialized HCTR2 context; the inverse cipher state must be set
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tweak The tweak used to encrypt the data unit
+	* \param tweaklen The length of the tweak in bytes
+	* \param input The input cipher-text
+	* \param length The length of the data unit in bytes; at least one block
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID if the length is less than the block size or the inverse state is missing
+	*/
+	mqc_status rsx_hctr2_decrypt(const rsx_hctr2_ctx* ctx, uint8_t* output, const uint8_t* tweak, size_t tweaklen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Erase the hash key powers and the L value of an HCTR2 context
+	*
+	* \param ctx The HCTR2 context
+	*/
+	void rsx_hctr2_dispose(rsx_hctr2_ctx* ctx);
+
 	/**
 	* \brief Initialize the round key array (key schedule) to the rkey array. \n
 	* AES128 and AES256 use the traditional rijndael key schedule, RSX256 and RSX512 use the SHAKE256 kdf.
@@ -280,4 +1073,136 @@ typedef struct rsx_state
 	*/
 	mqc_status rsx_initialize(rsx_state* state, rsx_keyparams* keyparams, bool encryption);
 
+	/**
+	* \brief Derive the decryption schedule from an encryption schedule, without running the key schedule again. \n
+	* The result is the same as rsx_initialize with encryption set to false; the round keys are reversed, and the inner keys
+	* passed through InvMixColumns (aesimc on the AES-NI kernels).
+	*
+	* \param invstate The output state; its round key array must hold state->rkeylen keys, and can not be the input array
+	* \param state The state initialized for encryption
+	*/
+	void rsx_inverse_schedule(rsx_state* invstate, const rsx_state* state);
+
+	/**
+	* \brief Initialize an OCB context; computes the L values used to derive the block offsets. \n
+	* The states must use the same key, and must remain valid until the context is disposed.
+	*
+	* \param ctx The OCB context
+	* \param state The cipher state initialized for encryption; used by both directions
+	* \param invstate The cipher state initialized for decryption, can be NULL if the context is only used to encrypt
+	*/
+	void rsx_ocb_initialize(rsx_ocb_ctx* ctx, rsx_state* state, rsx_state* invstate);
+
+	/**
+	* \brief Encrypt and authenticate a message with the OCB3 mode of RFC 7253. \n
+	* Each block takes one cipher call; the offsets and the checksum are computed alongside the multi-block cipher kernel.
+	*
+	* \param ctx The initialized OCB context
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tag The output authentication tag; receives taglen bytes
+	* \param taglen The tag length in bytes; RSX_OCB_MINTAG_SIZE to RSX_OCB_TAG_SIZE
+	* \param nonce The nonce; must never be repeated under the same key
+	* \param noncelen The length of the nonce in bytes; 1 to RSX_OCB_MAXNONCE_SIZE, RSX_OCB_NONCE_SIZE is recommended
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input plain-text
+	* \param length The number of bytes to encrypt
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an invalid nonce or tag length
+	*/
+	mqc_status rsx_ocb_encrypt(const rsx_ocb_ctx* ctx, uint8_t* output, uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Decrypt and verify a message with the OCB3 mode of RFC 7253. \n
+	* The output can be the input array; if the tag does not match, the output is erased.
+	*
+	* \param ctx The initialized OCB context; the inverse cipher state must be set
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tag The authentication tag to verify
+	* \param taglen The tag length in bytes; RSX_OCB_MINTAG_SIZE to RSX_OCB_TAG_SIZE
+	* \param nonce The nonce used to encrypt the message
+	* \param noncelen The length of the nonce in bytes
+	* \param aad The additional authenticated data, can be NULL if aadlen is zero
+	* \param aadlen The length of the additional data in bytes
+	* \param input The input cipher-text
+	* \param length The number of bytes to decrypt
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for invalid parameters or a missing inverse state
+	*/
+	mqc_status rsx_ocb_decrypt(const rsx_ocb_ctx* ctx, uint8_t* output, const uint8_t* tag, size_t taglen, const uint8_t* nonce, size_t noncelen, const uint8_t* aad, size_t aadlen, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Erase the L values of an OCB context
+	*
+	* \param ctx The OCB context
+	*/
+	void rsx_ocb_dispose(rsx_ocb_ctx* ctx);
+
+	/**
+	* \brief Initialize a PMAC context; computes the L values. \n
+	* The state must remain valid until the context is disposed.
+	*
+	* \param ctx The PMAC context
+	* \param state The cipher state; initialized for encryption, with any of the AES and RSX key sizes
+	*/
+	void rsx_pmac_initialize(rsx_pmac_ctx* ctx, rsx_state* state);
+
+	/**
+	* \brief Compute the PMAC1 tag of a message. \n
+	* The blocks are independent, with AES-NI they are enciphered eight at a time.
+	*
+	* \param ctx The initialized PMAC context
+	* \param tag The output tag; receives taglen bytes
+	* \param taglen The tag length in bytes; from RSX_PMAC_MINTAG_SIZE to RSX_PMAC_TAG_SIZE
+	* \param message The message, can be NULL if length is zero
+	* \param length The message length in bytes
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID for an invalid tag length
+	*/
+	mqc_status rsx_pmac_compute(const rsx_pmac_ctx* ctx, uint8_t* tag, size_t taglen, const uint8_t* message, size_t length);
+
+	/**
+	* \brief Verify the PMAC1 tag of a message, in constant time
+	*
+	* \param ctx The initialized PMAC context
+	* \param tag The tag to verify
+	* \param taglen The tag length in bytes; from RSX_PMAC_MINTAG_SIZE to RSX_PMAC_TAG_SIZE
+	* \param message The message, can be NULL if length is zero
+	* \param length The message length in bytes
+	* \return Returns MQC_STATUS_SUCCESS, MQC_STATUS_AUTHFAIL if the tag does not match, or MQC_ERROR_INVALID for an invalid tag length
+	*/
+	mqc_status rsx_pmac_verify(const rsx_pmac_ctx* ctx, const uint8_t* tag, size_t taglen, const uint8_t* message, size_t length);
+
+	/**
+	* \brief Erase the L values of a PMAC context
+	*
+	* \param ctx The PMAC context
+	*/
+	void rsx_pmac_dispose(rsx_pmac_ctx* ctx);
+
+	/**
+	* \brief Decrypt a data unit (sector) with the XTS mode of IEEE 1619. \n
+	* A length that is not a multiple of the block size is decrypted with cipher-text stealing; the output can be the input array.
+	*
+	* \param state The data key cipher state; initialized for decryption
+	* \param tweakstate The tweak key cipher state; initialized for encryption, with a key independent of the data key
+	* \param output The output byte array; receives the plain-text, must be at least length bytes
+	* \param tweak The 16 byte tweak; in IEEE 1619 the data unit (sector) number as a 128 bit little endian integer
+	* \param input The input cipher-text
+	* \param length The length of the data unit in bytes; at least one block
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID if the length is less than the block size
+	*/
+	mqc_status rsx_xts_decrypt(rsx_state* state, rsx_state* tweakstate, uint8_t* output, const uint8_t* tweak, const uint8_t* input, size_t length);
+
+	/**
+	* \brief Encrypt a data unit (sector) with the XTS mode of IEEE 1619. \n
+	* The tweaks of consecutive blocks are derived and applied in batches, alongside the multi-block cipher kernel.
+	*
+	* \param state The data key cipher state; initialized for encryption
+	* \param tweakstate The tweak key cipher state; initialized for encryption, with a key independent of the data key
+	* \param output The output byte array; receives the cipher-text, must be at least length bytes
+	* \param tweak The 16 byte tweak; in IEEE 1619 the data unit (sector) number as a 128 bit little endian integer
+	* \param input The input plain-text
+	* \param length The length of the data unit in bytes; at least one block
+	* \return Returns MQC_STATUS_SUCCESS, or MQC_ERROR_INVALID if the length is less than the block size
+	*/
+	mqc_status rsx_xts_encrypt(rsx_state* state, rsx_state* tweakstate, uint8_t* output, const uint8_t* tweak, const uint8_t* input, size_t length);
+
 #endif
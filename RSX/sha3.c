@@ -13,9 +13,49 @@
 *********************************************************************************************/
 
 #include "sha3.h"
+#include "cpufeatures.h"
+#include <string.h>
+
+/* the number of rounds of the Keccak-f[1600] permutation */
+#define KECCAK_ROUND_COUNT 24
+
+/* the four lane permutation is always compiled on x86, and selected at runtime when the processor supports AVX2 */
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#	define SHA3_AVX2_SUPPORTED
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <immintrin.h>
+#	endif
+#	if defined(__GNUC__)
+#		define SHA3_AVX2_TARGET __attribute__((target("avx2")))
+#	else
+#		define SHA3_AVX2_TARGET
+#	endif
+	/* the BMI1 and BMI2 scalar permutation uses the 64 bit andn and rorx instructions */
+#	if defined(_M_X64) || defined(__x86_64__)
+#		define SHA3_BMI2_SUPPORTED
+#		if defined(__GNUC__)
+#			define SHA3_BMI2_TARGET __attribute__((target("bmi,bmi2")))
+#		else
+#			define SHA3_BMI2_TARGET
+#		endif
+#	endif
+	/* compilers with AVX-512 intrinsics get the single state permutation on 512 bit registers */
+#	if (defined(__GNUC__) && (__GNUC__ >= 8)) || defined(__clang__) || (defined(_MSC_VER) && (_MSC_VER >= 1920))
+#		define SHA3_AVX512_SUPPORTED
+#		if defined(__GNUC__)
+#			define SHA3_AVX512_TARGET __attribute__((target("avx512f")))
+#		else
+#			define SHA3_AVX512_TARGET
+#		endif
+#	endif
+#endif
 
 /* Internal */
 
+static volatile sha3_backend sha3_active_backend = SHA3_BACKEND_AUTO;
+
 static void clear8(uint8_t* a, size_t count)
 {
 	size_t i;
@@ -111,12 +151,164 @@ static void store64(uint8_t* a, uint64_t x)
 	}
 }
 
-static void keccak_absorb(uint64_t* state, size_t rate, const uint8_t* input, size_t inplen, uint8_t domain)
+#if defined(SHA3_AVX2_SUPPORTED)
+
+static const uint64_t keccak_round_constants[KECCAK_ROUND_COUNT] =
 {
-	uint8_t msg[200];
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+	0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+	0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+	0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+	0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+	0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+#endif
+
+#if defined(SHA3_AVX512_SUPPORTED)
+
+/* the state is held as five planes, lane x of register y is word (5 * y) + x; lanes 5 to 7 are not used */
+SHA3_AVX512_TARGET
+static void keccak_rounds_avx512(__m512i* planes)
+{
+	const __m512i XM1 = _mm512_setr_epi64(4, 0, 1, 2, 3, 5, 6, 7);
+	const __m512i XP1 = _mm512_setr_epi64(1, 2, 3, 4, 0, 5, 6, 7);
+	const __m512i XP2 = _mm512_setr_epi64(2, 3, 4, 0, 1, 5, 6, 7);
+	const __m512i RHO0 = _mm512_setr_epi64(0, 1, 62, 28, 27, 0, 0, 0);
+	const __m512i RHO1 = _mm512_setr_epi64(36, 44, 6, 55, 20, 0, 0, 0);
+	const __m512i RHO2 = _mm512_setr_epi64(3, 10, 43, 25, 39, 0, 0, 0);
+	const __m512i RHO3 = _mm512_setr_epi64(41, 45, 15, 21, 8, 0, 0, 0);
+	const __m512i RHO4 = _mm512_setr_epi64(18, 2, 61, 56, 14, 0, 0, 0);
+	/* pi moves lane (x + 3y) mod 5 of plane x to lane x of plane y; the first stage pairs planes 0,1 and 2,3 for y = 0..3, and for y = 4 */
+	const __m512i PI01 = _mm512_setr_epi64(0, 9, 3, 12, 1, 10, 4, 8);
+	const __m512i PI01H = _mm512_setr_epi64(2, 11, 0, 0, 0, 0, 0, 0);
+	const __m512i PI23 = _mm512_setr_epi64(2, 11, 0, 9, 3, 12, 1, 10);
+	const __m512i PI23H = _mm512_setr_epi64(4, 8, 0, 0, 0, 0, 0, 0);
+	const __m512i PIY0 = _mm512_setr_epi64(0, 1, 8, 9, 0, 0, 0, 0);
+	const __m512i PIY1 = _mm512_setr_epi64(2, 3, 10, 11, 0, 0, 0, 0);
+	const __m512i PIY2 = _mm512_setr_epi64(4, 5, 12, 13, 0, 0, 0, 0);
+	const __m512i PIY3 = _mm512_setr_epi64(6, 7, 14, 15, 0, 0, 0, 0);
+	__m512i a0;
+	__m512i a1;
+	__m512i a2;
+	__m512i a3;
+	__m512i a4;
+	__m512i c;
+	__m512i d0;
+	__m512i d1;
+	__m512i t0;
+	__m512i t1;
+	__m512i t2;
+	__m512i t3;
 	size_t i;
 
-	while (inplen >= rate)
+	a0 = planes[0];
+	a1 = planes[1];
+	a2 = planes[2];
+	a3 = planes[3];
+	a4 = planes[4];
+
+	for (i = 0; i < KECCAK_ROUND_COUNT; ++i)
+	{
+		/* theta; the column parity of x - 1, and of x + 1 rotated by one, are added to every plane */
+		c = _mm512_ternarylogic_epi64(a0, a1, a2, 0x96);
+		c = _mm512_ternarylogic_epi64(c, a3, a4, 0x96);
+		d0 = _mm512_permutexvar_epi64(XM1, c);
+		d1 = _mm512_rol_epi64(_mm512_permutexvar_epi64(XP1, c), 1);
+		a0 = _mm512_ternarylogic_epi64(a0, d0, d1, 0x96);
+		a1 = _mm512_ternarylogic_epi64(a1, d0, d1, 0x96);
+		a2 = _mm512_ternarylogic_epi64(a2, d0, d1, 0x96);
+		a3 = _mm512_ternarylogic_epi64(a3, d0, d1, 0x96);
+		a4 = _mm512_ternarylogic_epi64(a4, d0, d1, 0x96);
+
+		/* rho */
+		a0 = _mm512_rolv_epi64(a0, RHO0);
+		a1 = _mm512_rolv_epi64(a1, RHO1);
+		a2 = _mm512_rolv_epi64(a2, RHO2);
+		a3 = _mm512_rolv_epi64(a3, RHO3);
+		a4 = _mm512_rolv_epi64(a4, RHO4);
+
+		/* pi, as a transpose of the planes; lane 4 of each output comes from plane 4 */
+		t0 = _mm512_permutex2var_epi64(a0, PI01, a1);
+		t1 = _mm512_permutex2var_epi64(a0, PI01H, a1);
+		t2 = _mm512_permutex2var_epi64(a2, PI23, a3);
+		t3 = _mm512_permutex2var_epi64(a2, PI23H, a3);
+		a0 = _mm512_mask_permutexvar_epi64(_mm512_permutex2var_epi64(t0, PIY0, t2), 0x10, _mm512_set1_epi64(4), a4);
+		a1 = _mm512_mask_permutexvar_epi64(_mm512_permutex2var_epi64(t0, PIY1, t2), 0x10, _mm512_set1_epi64(2), a4);
+		a2 = _mm512_mask_permutexvar_epi64(_mm512_permutex2var_epi64(t0, PIY2, t2), 0x10, _mm512_set1_epi64(0), a4);
+		a3 = _mm512_mask_permutexvar_epi64(_mm512_permutex2var_epi64(t0, PIY3, t2), 0x10, _mm512_set1_epi64(3), a4);
+		a4 = _mm512_mask_permutexvar_epi64(_mm512_permutex2var_epi64(t1, PIY0, t3), 0x10, _mm512_set1_epi64(1), a4);
+
+		/* chi; a ^ (~b & c) in one ternary logic instruction */
+		a0 = _mm512_ternarylogic_epi64(a0, _mm512_permutexvar_epi64(XP1, a0), _mm512_permutexvar_epi64(XP2, a0), 0xD2);
+		a1 = _mm512_ternarylogic_epi64(a1, _mm512_permutexvar_epi64(XP1, a1), _mm512_permutexvar_epi64(XP2, a1), 0xD2);
+		a2 = _mm512_ternarylogic_epi64(a2, _mm512_permutexvar_epi64(XP1, a2), _mm512_permutexvar_epi64(XP2, a2), 0xD2);
+		a3 = _mm512_ternarylogic_epi64(a3, _mm512_permutexvar_epi64(XP1, a3), _mm512_permutexvar_epi64(XP2, a3), 0xD2);
+		a4 = _mm512_ternarylogic_epi64(a4, _mm512_permutexvar_epi64(XP1, a4), _mm512_permutexvar_epi64(XP2, a4), 0xD2);
+
+		/* iota */
+		a0 = _mm512_mask_xor_epi64(a0, 0x01, a0, _mm512_set1_epi64((long long)keccak_round_constants[i]));
+	}
+
+	planes[0] = a0;
+	planes[1] = a1;
+	planes[2] = a2;
+	planes[3] = a3;
+	planes[4] = a4;
+}
+
+SHA3_AVX512_TARGET
+static void keccak_absorb_blocks_avx512(uint64_t* state, size_t rate, const uint8_t* input, size_t nblocks)
+{
+	__m512i planes[5];
+	__mmask8 masks[5];
+	size_t words;
+	size_t i;
+
+	/* the rate words of a block fill the planes in order; the state stays in registers until the last block */
+	words = rate / 8;
+
+	for (i = 0; i < 5; ++i)
+	{
+		planes[i] = _mm512_maskz_loadu_epi64(0x1F, state + (5 * i));
+		masks[i] = (__mmask8)((words >= (5 * i) + 5) ? 0x1F : ((words > 5 * i) ? ((1U << (words - (5 * i))) - 1) : 0));
+	}
+
+	while (nblocks > 0)
+	{
+		for (i = 0; i < 5; ++i)
+		{
+			planes[i] = _mm512_xor_si512(planes[i], _mm512_maskz_loadu_epi64(masks[i], input + (40 * i)));
+		}
+
+		keccak_rounds_avx512(planes);
+		input += rate;
+		--nblocks;
+	}
+
+	for (i = 0; i < 5; ++i)
+	{
+		_mm512_mask_storeu_epi64(state + (5 * i), 0x1F, planes[i]);
+	}
+}
+
+#endif
+
+static void keccak_absorb_blocks(uint64_t* state, size_t rate, const uint8_t* input, size_t nblocks)
+{
+#if defined(SHA3_AVX512_SUPPORTED)
+	const sha3_backend backend = sha3_active_backend;
+#endif
+	size_t i;
+
+#if defined(SHA3_AVX512_SUPPORTED)
+	if (backend == SHA3_BACKEND_AVX512 || (backend == SHA3_BACKEND_AUTO && cpu_features_get()->avx512f == true))
+	{
+		keccak_absorb_blocks_avx512(state, rate, input, nblocks);
+		nblocks = 0;
+	}
+#endif
+
+	while (nblocks > 0)
 	{
 		for (i = 0; i < rate / 8; ++i)
 		{
@@ -124,29 +316,78 @@ static void keccak_absorb(uint64_t* state, size_t rate, const uint8_t* input, si
 		}
 
 		keccak_permute(state);
-
-		inplen -= rate;
 		input += rate;
+		--nblocks;
 	}
+}
+
+static void keccak_absorb_tail(uint64_t* state, size_t rate, const uint8_t* input, size_t inplen, uint8_t domain)
+{
+	size_t i;
 
-	for (i = 0; i < inplen; ++i)
+	/* the final partial block and its padding are added to the state lanes directly, without a padded copy of the block */
+	for (i = 0; i < inplen / 8; ++i)
 	{
-		msg[i] = input[i];
+		state[i] ^= load64(input + (8 * i));
 	}
 
-	msg[inplen] = domain;
+	for (i = (inplen / 8) * 8; i < inplen; ++i)
+	{
+		state[i / 8] ^= (uint64_t)input[i] << (8 * (i % 8));
+	}
+
+	state[inplen / 8] ^= (uint64_t)domain << (8 * (inplen % 8));
+	state[(rate - 1) / 8] ^= (uint64_t)128 << (8 * ((rate - 1) % 8));
+}
 
-	for (i = inplen + 1; i < rate; ++i)
+static void keccak_absorb(uint64_t* state, size_t rate, const uint8_t* input, size_t inplen, uint8_t domain)
+{
+	if (inplen >= rate)
 	{
-		msg[i] = 0;
+		keccak_absorb_blocks(state, rate, input, inplen / rate);
+		input += (inplen / rate) * rate;
+		inplen -= (inplen / rate) * rate;
 	}
 
-	msg[rate - 1] |= 128;
+	keccak_absorb_tail(state, rate, input, inplen, domain);
+}
+
+static void keccak_buffered_update(uint64_t* state, size_t rate, uint8_t* buffer, size_t* position, const uint8_t* input, size_t inplen)
+{
+	size_t rmd;
+
+	/* complete a block started by an earlier update */
+	if (*position != 0)
+	{
+		rmd = rate - *position;
+
+		if (rmd > inplen)
+		{
+			rmd = inplen;
+		}
+
+		memcpy(buffer + *position, input, rmd);
+		*position += rmd;
+		input += rmd;
+		inplen -= rmd;
+
+		if (*position == rate)
+		{
+			keccak_absorb_blocks(state, rate, buffer, 1);
+			*position = 0;
+		}
+	}
 
-	for (i = 0; i < rate / 8; ++i)
+	/* whole blocks are absorbed from the caller's memory */
+	if (inplen >= rate)
 	{
-		state[i] ^= load64(msg + (8 * i));
+		keccak_absorb_blocks(state, rate, input, inplen / rate);
+		input += (inplen / rate) * rate;
+		inplen -= (inplen / rate) * rate;
 	}
+
+	memcpy(buffer + *position, input, inplen);
+	*position += inplen;
 }
 
 static void keccak_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks, size_t rate)
@@ -167,9 +408,128 @@ static void keccak_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblock
 	}
 }
 
+static void keccak_absorb_x4(uint64_t* state, size_t rate, const uint8_t** inputs, size_t inplen, uint8_t domain)
+{
+	uint8_t msg[200];
+	size_t pos;
+	size_t i;
+	size_t j;
+
+	/* four inputs of the same length, absorbed in lock step into the interleaved states */
+	pos = 0;
+
+	while (inplen - pos >= rate)
+	{
+		for (j = 0; j < 4; ++j)
+		{
+			for (i = 0; i < rate / 8; ++i)
+			{
+				state[(i * 4) + j] ^= load64(inputs[j] + pos + (8 * i));
+			}
+		}
+
+		keccak_permute_x4(state);
+		pos += rate;
+	}
+
+	for (j = 0; j < 4; ++j)
+	{
+		for (i = 0; i < inplen - pos; ++i)
+		{
+			msg[i] = inputs[j][pos + i];
+		}
+
+		msg[inplen - pos] = domain;
+
+		for (i = (inplen - pos) + 1; i < rate; ++i)
+		{
+			msg[i] = 0;
+		}
+
+		msg[rate - 1] |= 128;
+
+		for (i = 0; i < rate / 8; ++i)
+		{
+			state[(i * 4) + j] ^= load64(msg + (8 * i));
+		}
+	}
+
+	clear8(msg, sizeof(msg));
+}
+
+static void keccak_squeeze_x4(uint64_t* state, uint8_t** outputs, size_t outputlen, size_t rate)
+{
+	uint8_t tmp[200];
+	size_t pos;
+	size_t i;
+	size_t j;
+
+	pos = 0;
+
+	while (outputlen - pos >= rate)
+	{
+		keccak_permute_x4(state);
+
+		for (j = 0; j < 4; ++j)
+		{
+			for (i = 0; i < rate / 8; ++i)
+			{
+				store64(outputs[j] + pos + (8 * i), state[(i * 4) + j]);
+			}
+		}
+
+		pos += rate;
+	}
+
+	if (outputlen != pos)
+	{
+		keccak_permute_x4(state);
+
+		for (j = 0; j < 4; ++j)
+		{
+			for (i = 0; i < rate / 8; ++i)
+			{
+				store64(tmp + (8 * i), state[(i * 4) + j]);
+			}
+
+			for (i = 0; i < outputlen - pos; ++i)
+			{
+				outputs[j][pos + i] = tmp[i];
+			}
+		}
+
+		clear8(tmp, sizeof(tmp));
+	}
+}
+
+static void keccak_squeezeblocks_x4(uint64_t* state, uint8_t** outputs, size_t nblocks, size_t rate)
+{
+	size_t pos;
+	size_t i;
+	size_t j;
+
+	pos = 0;
+
+	while (nblocks > 0)
+	{
+		keccak_permute_x4(state);
+
+		for (j = 0; j < 4; ++j)
+		{
+			for (i = 0; i < rate / 8; ++i)
+			{
+				store64(outputs[j] + pos + (8 * i), state[(i * 4) + j]);
+			}
+		}
+
+		pos += rate;
+		--nblocks;
+	}
+}
+
 /* SHA3 */
 
-void keccak_permute(uint64_t* state)
+static void keccak_permute_serial(uint64_t* state)
 {
 	uint64_t Aba;
 	uint64_t Abe;
@@ -2374,6 +2734,510 @@ void keccak_permute(uint64_t* state)
 	state[24] = Asu;
 }
 
+#if defined(SHA3_BMI2_SUPPORTED)
+
+/* msvc has a rorx intrinsic, gcc and clang emit rorx for the rotate idiom when bmi2 is enabled */
+#if defined(_MSC_VER)
+#	define KECCAK_RORX(x, n) _rorx_u64((x), (n))
+#else
+#	define KECCAK_RORX(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#endif
+
+SHA3_BMI2_TARGET
+static void keccak_permute_bmi2(uint64_t* state)
+{
+	uint64_t Aba;
+	uint64_t Abe;
+	uint64_t Abi;
+	uint64_t Abo;
+	uint64_t Abu;
+	uint64_t Aga;
+	uint64_t Age;
+	uint64_t Agi;
+	uint64_t Ago;
+	uint64_t Agu;
+	uint64_t Aka;
+	uint64_t Ake;
+	uint64_t Aki;
+	uint64_t Ako;
+	uint64_t Aku;
+	uint64_t Ama;
+	uint64_t Ame;
+	uint64_t Ami;
+	uint64_t Amo;
+	uint64_t Amu;
+	uint64_t Asa;
+	uint64_t Ase;
+	uint64_t Asi;
+	uint64_t Aso;
+	uint64_t Asu;
+	uint64_t Eba;
+	uint64_t Ebe;
+	uint64_t Ebi;
+	uint64_t Ebo;
+	uint64_t Ebu;
+	uint64_t Ega;
+	uint64_t Ege;
+	uint64_t Egi;
+	uint64_t Ego;
+	uint64_t Egu;
+	uint64_t Eka;
+	uint64_t Eke;
+	uint64_t Eki;
+	uint64_t Eko;
+	uint64_t Eku;
+	uint64_t Ema;
+	uint64_t Eme;
+	uint64_t Emi;
+	uint64_t Emo;
+	uint64_t Emu;
+	uint64_t Esa;
+	uint64_t Ese;
+	uint64_t Esi;
+	uint64_t Eso;
+	uint64_t Esu;
+	uint64_t Ba;
+	uint64_t Be;
+	uint64_t Bi;
+	uint64_t Bo;
+	uint64_t Bu;
+	uint64_t Ca;
+	uint64_t Ce;
+	uint64_t Ci;
+	uint64_t Co;
+	uint64_t Cu;
+	uint64_t Da;
+	uint64_t De;
+	uint64_t Di;
+	uint64_t Do;
+	uint64_t Du;
+	size_t i;
+
+	Aba = state[0];
+	Abe = state[1];
+	Abi = state[2];
+	Abo = state[3];
+	Abu = state[4];
+	Aga = state[5];
+	Age = state[6];
+	Agi = state[7];
+	Ago = state[8];
+	Agu = state[9];
+	Aka = state[10];
+	Ake = state[11];
+	Aki = state[12];
+	Ako = state[13];
+	Aku = state[14];
+	Ama = state[15];
+	Ame = state[16];
+	Ami = state[17];
+	Amo = state[18];
+	Amu = state[19];
+	Asa = state[20];
+	Ase = state[21];
+	Asi = state[22];
+	Aso = state[23];
+	Asu = state[24];
+
+	/* two rounds per iteration, from A to E and back, so the loop body stays small */
+	for (i = 0; i < KECCAK_ROUND_COUNT; i += 2)
+	{
+		Ca = Aba ^ Aga ^ Aka ^ Ama ^ Asa;
+		Ce = Abe ^ Age ^ Ake ^ Ame ^ Ase;
+		Ci = Abi ^ Agi ^ Aki ^ Ami ^ Asi;
+		Co = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
+		Cu = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
+		Da = Cu ^ KECCAK_RORX(Ce, 63);
+		De = Ca ^ KECCAK_RORX(Ci, 63);
+		Di = Ce ^ KECCAK_RORX(Co, 63);
+		Do = Ci ^ KECCAK_RORX(Cu, 63);
+		Du = Co ^ KECCAK_RORX(Ca, 63);
+
+		Ba = Aba ^ Da;
+		Be = KECCAK_RORX(Age ^ De, 20);
+		Bi = KECCAK_RORX(Aki ^ Di, 21);
+		Bo = KECCAK_RORX(Amo ^ Do, 43);
+		Bu = KECCAK_RORX(Asu ^ Du, 50);
+		Eba = Ba ^ _andn_u64(Be, Bi) ^ keccak_round_constants[i];
+		Ebe = Be ^ _andn_u64(Bi, Bo);
+		Ebi = Bi ^ _andn_u64(Bo, Bu);
+		Ebo = Bo ^ _andn_u64(Bu, Ba);
+		Ebu = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Abo ^ Do, 36);
+		Be = KECCAK_RORX(Agu ^ Du, 44);
+		Bi = KECCAK_RORX(Aka ^ Da, 61);
+		Bo = KECCAK_RORX(Ame ^ De, 19);
+		Bu = KECCAK_RORX(Asi ^ Di, 3);
+		Ega = Ba ^ _andn_u64(Be, Bi);
+		Ege = Be ^ _andn_u64(Bi, Bo);
+		Egi = Bi ^ _andn_u64(Bo, Bu);
+		Ego = Bo ^ _andn_u64(Bu, Ba);
+		Egu = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Abe ^ De, 63);
+		Be = KECCAK_RORX(Agi ^ Di, 58);
+		Bi = KECCAK_RORX(Ako ^ Do, 39);
+		Bo = KECCAK_RORX(Amu ^ Du, 56);
+		Bu = KECCAK_RORX(Asa ^ Da, 46);
+		Eka = Ba ^ _andn_u64(Be, Bi);
+		Eke = Be ^ _andn_u64(Bi, Bo);
+		Eki = Bi ^ _andn_u64(Bo, Bu);
+		Eko = Bo ^ _andn_u64(Bu, Ba);
+		Eku = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Abu ^ Du, 37);
+		Be = KECCAK_RORX(Aga ^ Da, 28);
+		Bi = KECCAK_RORX(Ake ^ De, 54);
+		Bo = KECCAK_RORX(Ami ^ Di, 49);
+		Bu = KECCAK_RORX(Aso ^ Do, 8);
+		Ema = Ba ^ _andn_u64(Be, Bi);
+		Eme = Be ^ _andn_u64(Bi, Bo);
+		Emi = Bi ^ _andn_u64(Bo, Bu);
+		Emo = Bo ^ _andn_u64(Bu, Ba);
+		Emu = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Abi ^ Di, 2);
+		Be = KECCAK_RORX(Ago ^ Do, 9);
+		Bi = KECCAK_RORX(Aku ^ Du, 25);
+		Bo = KECCAK_RORX(Ama ^ Da, 23);
+		Bu = KECCAK_RORX(Ase ^ De, 62);
+		Esa = Ba ^ _andn_u64(Be, Bi);
+		Ese = Be ^ _andn_u64(Bi, Bo);
+		Esi = Bi ^ _andn_u64(Bo, Bu);
+		Eso = Bo ^ _andn_u64(Bu, Ba);
+		Esu = Bu ^ _andn_u64(Ba, Be);
+
+		Ca = Eba ^ Ega ^ Eka ^ Ema ^ Esa;
+		Ce = Ebe ^ Ege ^ Eke ^ Eme ^ Ese;
+		Ci = Ebi ^ Egi ^ Eki ^ Emi ^ Esi;
+		Co = Ebo ^ Ego ^ Eko ^ Emo ^ Eso;
+		Cu = Ebu ^ Egu ^ Eku ^ Emu ^ Esu;
+		Da = Cu ^ KECCAK_RORX(Ce, 63);
+		De = Ca ^ KECCAK_RORX(Ci, 63);
+		Di = Ce ^ KECCAK_RORX(Co, 63);
+		Do = Ci ^ KECCAK_RORX(Cu, 63);
+		Du = Co ^ KECCAK_RORX(Ca, 63);
+
+		Ba = Eba ^ Da;
+		Be = KECCAK_RORX(Ege ^ De, 20);
+		Bi = KECCAK_RORX(Eki ^ Di, 21);
+		Bo = KECCAK_RORX(Emo ^ Do, 43);
+		Bu = KECCAK_RORX(Esu ^ Du, 50);
+		Aba = Ba ^ _andn_u64(Be, Bi) ^ keccak_round_constants[i + 1];
+		Abe = Be ^ _andn_u64(Bi, Bo);
+		Abi = Bi ^ _andn_u64(Bo, Bu);
+		Abo = Bo ^ _andn_u64(Bu, Ba);
+		Abu = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Ebo ^ Do, 36);
+		Be = KECCAK_RORX(Egu ^ Du, 44);
+		Bi = KECCAK_RORX(Eka ^ Da, 61);
+		Bo = KECCAK_RORX(Eme ^ De, 19);
+		Bu = KECCAK_RORX(Esi ^ Di, 3);
+		Aga = Ba ^ _andn_u64(Be, Bi);
+		Age = Be ^ _andn_u64(Bi, Bo);
+		Agi = Bi ^ _andn_u64(Bo, Bu);
+		Ago = Bo ^ _andn_u64(Bu, Ba);
+		Agu = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Ebe ^ De, 63);
+		Be = KECCAK_RORX(Egi ^ Di, 58);
+		Bi = KECCAK_RORX(Eko ^ Do, 39);
+		Bo = KECCAK_RORX(Emu ^ Du, 56);
+		Bu = KECCAK_RORX(Esa ^ Da, 46);
+		Aka = Ba ^ _andn_u64(Be, Bi);
+		Ake = Be ^ _andn_u64(Bi, Bo);
+		Aki = Bi ^ _andn_u64(Bo, Bu);
+		Ako = Bo ^ _andn_u64(Bu, Ba);
+		Aku = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Ebu ^ Du, 37);
+		Be = KECCAK_RORX(Ega ^ Da, 28);
+		Bi = KECCAK_RORX(Eke ^ De, 54);
+		Bo = KECCAK_RORX(Emi ^ Di, 49);
+		Bu = KECCAK_RORX(Eso ^ Do, 8);
+		Ama = Ba ^ _andn_u64(Be, Bi);
+		Ame = Be ^ _andn_u64(Bi, Bo);
+		Ami = Bi ^ _andn_u64(Bo, Bu);
+		Amo = Bo ^ _andn_u64(Bu, Ba);
+		Amu = Bu ^ _andn_u64(Ba, Be);
+
+		Ba = KECCAK_RORX(Ebi ^ Di, 2);
+		Be = KECCAK_RORX(Ego ^ Do, 9);
+		Bi = KECCAK_RORX(Eku ^ Du, 25);
+		Bo = KECCAK_RORX(Ema ^ Da, 23);
+		Bu = KECCAK_RORX(Ese ^ De, 62);
+		Asa = Ba ^ _andn_u64(Be, Bi);
+		Ase = Be ^ _andn_u64(Bi, Bo);
+		Asi = Bi ^ _andn_u64(Bo, Bu);
+		Aso = Bo ^ _andn_u64(Bu, Ba);
+		Asu = Bu ^ _andn_u64(Ba, Be);
+	}
+
+	state[0] = Aba;
+	state[1] = Abe;
+	state[2] = Abi;
+	state[3] = Abo;
+	state[4] = Abu;
+	state[5] = Aga;
+	state[6] = Age;
+	state[7] = Agi;
+	state[8] = Ago;
+	state[9] = Agu;
+	state[10] = Aka;
+	state[11] = Ake;
+	state[12] = Aki;
+	state[13] = Ako;
+	state[14] = Aku;
+	state[15] = Ama;
+	state[16] = Ame;
+	state[17] = Ami;
+	state[18] = Amo;
+	state[19] = Amu;
+	state[20] = Asa;
+	state[21] = Ase;
+	state[22] = Asi;
+	state[23] = Aso;
+	state[24] = Asu;
+}
+
+#endif
+
+void keccak_permute(uint64_t* state)
+{
+#if defined(SHA3_BMI2_SUPPORTED)
+	const sha3_backend backend = sha3_active_backend;
+	const cpu_features* cpuf = cpu_features_get();
+
+	/* a single permutation is faster in general purpose registers than as five AVX-512 planes, the planes are used for multi-block absorbs */
+	if (backend == SHA3_BACKEND_BMI2 || (backend == SHA3_BACKEND_AUTO && cpuf->bmi1 == true && cpuf->bmi2 == true))
+	{
+		keccak_permute_bmi2(state);
+	}
+	else
+	{
+		keccak_permute_serial(state);
+	}
+#else
+	keccak_permute_serial(state);
+#endif
+}
+
+#if defined(SHA3_AVX2_SUPPORTED)
+
+#define KECCAK_ROL_X4(x, n) _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+
+SHA3_AVX2_TARGET
+static void keccak_permute_x4_avx2(uint64_t* state)
+{
+	__m256i A[SHA3_STATESIZE];
+	__m256i B[SHA3_STATESIZE];
+	__m256i C[5];
+	__m256i D[5];
+	size_t i;
+
+	/* word i of the four lanes is one register, so each step of the round runs on the four states at once */
+	for (i = 0; i < SHA3_STATESIZE; ++i)
+	{
+		A[i] = _mm256_loadu_si256((const __m256i*)(state + (i * 4)));
+	}
+
+	for (i = 0; i < KECCAK_ROUND_COUNT; ++i)
+	{
+		/* theta */
+		C[0] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[0], A[5]), _mm256_xor_si256(A[10], A[15])), A[20]);
+		C[1] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[1], A[6]), _mm256_xor_si256(A[11], A[16])), A[21]);
+		C[2] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[2], A[7]), _mm256_xor_si256(A[12], A[17])), A[22]);
+		C[3] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[3], A[8]), _mm256_xor_si256(A[13], A[18])), A[23]);
+		C[4] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[4], A[9]), _mm256_xor_si256(A[14], A[19])), A[24]);
+		D[0] = _mm256_xor_si256(C[4], KECCAK_ROL_X4(C[1], 1));
+		D[1] = _mm256_xor_si256(C[0], KECCAK_ROL_X4(C[2], 1));
+		D[2] = _mm256_xor_si256(C[1], KECCAK_ROL_X4(C[3], 1));
+		D[3] = _mm256_xor_si256(C[2], KECCAK_ROL_X4(C[4], 1));
+		D[4] = _mm256_xor_si256(C[3], KECCAK_ROL_X4(C[0], 1));
+
+		/* rho and pi */
+		B[0] = _mm256_xor_si256(A[0], D[0]);
+		B[10] = _mm256_xor_si256(A[1], D[1]);
+		B[10] = KECCAK_ROL_X4(B[10], 1);
+		B[20] = _mm256_xor_si256(A[2], D[2]);
+		B[20] = KECCAK_ROL_X4(B[20], 62);
+		B[5] = _mm256_xor_si256(A[3], D[3]);
+		B[5] = KECCAK_ROL_X4(B[5], 28);
+		B[15] = _mm256_xor_si256(A[4], D[4]);
+		B[15] = KECCAK_ROL_X4(B[15], 27);
+		B[16] = _mm256_xor_si256(A[5], D[0]);
+		B[16] = KECCAK_ROL_X4(B[16], 36);
+		B[1] = _mm256_xor_si256(A[6], D[1]);
+		B[1] = KECCAK_ROL_X4(B[1], 44);
+		B[11] = _mm256_xor_si256(A[7], D[2]);
+		B[11] = KECCAK_ROL_X4(B[11], 6);
+		B[21] = _mm256_xor_si256(A[8], D[3]);
+		B[21] = KECCAK_ROL_X4(B[21], 55);
+		B[6] = _mm256_xor_si256(A[9], D[4]);
+		B[6] = KECCAK_ROL_X4(B[6], 20);
+		B[7] = _mm256_xor_si256(A[10], D[0]);
+		B[7] = KECCAK_ROL_X4(B[7], 3);
+		B[17] = _mm256_xor_si256(A[11], D[1]);
+		B[17] = KECCAK_ROL_X4(B[17], 10);
+		B[2] = _mm256_xor_si256(A[12], D[2]);
+		B[2] = KECCAK_ROL_X4(B[2], 43);
+		B[12] = _mm256_xor_si256(A[13], D[3]);
+		B[12] = KECCAK_ROL_X4(B[12], 25);
+		B[22] = _mm256_xor_si256(A[14], D[4]);
+		B[22] = KECCAK_ROL_X4(B[22], 39);
+		B[23] = _mm256_xor_si256(A[15], D[0]);
+		B[23] = KECCAK_ROL_X4(B[23], 41);
+		B[8] = _mm256_xor_si256(A[16], D[1]);
+		B[8] = KECCAK_ROL_X4(B[8], 45);
+		B[18] = _mm256_xor_si256(A[17], D[2]);
+		B[18] = KECCAK_ROL_X4(B[18], 15);
+		B[3] = _mm256_xor_si256(A[18], D[3]);
+		B[3] = KECCAK_ROL_X4(B[3], 21);
+		B[13] = _mm256_xor_si256(A[19], D[4]);
+		B[13] = KECCAK_ROL_X4(B[13], 8);
+		B[14] = _mm256_xor_si256(A[20], D[0]);
+		B[14] = KECCAK_ROL_X4(B[14], 18);
+		B[24] = _mm256_xor_si256(A[21], D[1]);
+		B[24] = KECCAK_ROL_X4(B[24], 2);
+		B[9] = _mm256_xor_si256(A[22], D[2]);
+		B[9] = KECCAK_ROL_X4(B[9], 61);
+		B[19] = _mm256_xor_si256(A[23], D[3]);
+		B[19] = KECCAK_ROL_X4(B[19], 56);
+		B[4] = _mm256_xor_si256(A[24], D[4]);
+		B[4] = KECCAK_ROL_X4(B[4], 14);
+
+		/* chi */
+		A[0] = _mm256_xor_si256(B[0], _mm256_andnot_si256(B[1], B[2]));
+		A[1] = _mm256_xor_si256(B[1], _mm256_andnot_si256(B[2], B[3]));
+		A[2] = _mm256_xor_si256(B[2], _mm256_andnot_si256(B[3], B[4]));
+		A[3] = _mm256_xor_si256(B[3], _mm256_andnot_si256(B[4], B[0]));
+		A[4] = _mm256_xor_si256(B[4], _mm256_andnot_si256(B[0], B[1]));
+		A[5] = _mm256_xor_si256(B[5], _mm256_andnot_si256(B[6], B[7]));
+		A[6] = _mm256_xor_si256(B[6], _mm256_andnot_si256(B[7], B[8]));
+		A[7] = _mm256_xor_si256(B[7], _mm256_andnot_si256(B[8], B[9]));
+		A[8] = _mm256_xor_si256(B[8], _mm256_andnot_si256(B[9], B[5]));
+		A[9] = _mm256_xor_si256(B[9], _mm256_andnot_si256(B[5], B[6]));
+		A[10] = _mm256_xor_si256(B[10], _mm256_andnot_si256(B[11], B[12]));
+		A[11] = _mm256_xor_si256(B[11], _mm256_andnot_si256(B[12], B[13]));
+		A[12] = _mm256_xor_si256(B[12], _mm256_andnot_si256(B[13], B[14]));
+		A[13] = _mm256_xor_si256(B[13], _mm256_andnot_si256(B[14], B[10]));
+		A[14] = _mm256_xor_si256(B[14], _mm256_andnot_si256(B[10], B[11]));
+		A[15] = _mm256_xor_si256(B[15], _mm256_andnot_si256(B[16], B[17]));
+		A[16] = _mm256_xor_si256(B[16], _mm256_andnot_si256(B[17], B[18]));
+		A[17] = _mm256_xor_si256(B[17], _mm256_andnot_si256(B[18], B[19]));
+		A[18] = _mm256_xor_si256(B[18], _mm256_andnot_si256(B[19], B[15]));
+		A[19] = _mm256_xor_si256(B[19], _mm256_andnot_si256(B[15], B[16]));
+		A[20] = _mm256_xor_si256(B[20], _mm256_andnot_si256(B[21], B[22]));
+		A[21] = _mm256_xor_si256(B[21], _mm256_andnot_si256(B[22], B[23]));
+		A[22] = _mm256_xor_si256(B[22], _mm256_andnot_si256(B[23], B[24]));
+		A[23] = _mm256_xor_si256(B[23], _mm256_andnot_si256(B[24], B[20]));
+		A[24] = _mm256_xor_si256(B[24], _mm256_andnot_si256(B[20], B[21]));
+
+		/* iota */
+		A[0] = _mm256_xor_si256(A[0], _mm256_set1_epi64x((long long)keccak_round_constants[i]));
+	}
+
+	for (i = 0; i < SHA3_STATESIZE; ++i)
+	{
+		_mm256_storeu_si256((__m256i*)(state + (i * 4)), A[i]);
+	}
+}
+
+#endif
+
+static void keccak_permute_x4_serial(uint64_t* state)
+{
+	uint64_t tmps[SHA3_STATESIZE];
+	size_t i;
+	size_t j;
+
+	/* the portable form permutes the four lanes one after another */
+	for (j = 0; j < 4; ++j)
+	{
+		for (i = 0; i < SHA3_STATESIZE; ++i)
+		{
+			tmps[i] = state[(i * 4) + j];
+		}
+
+		keccak_permute(tmps);
+
+		for (i = 0; i < SHA3_STATESIZE; ++i)
+		{
+			state[(i * 4) + j] = tmps[i];
+		}
+	}
+
+	clear64(tmps, SHA3_STATESIZE);
+}
+
+void keccak_permute_x4(uint64_t* state)
+{
+#if defined(SHA3_AVX2_SUPPORTED)
+	if (sha3_active_backend != SHA3_BACKEND_PORTABLE && cpu_features_get()->avx2 == true)
+	{
+		keccak_permute_x4_avx2(state);
+	}
+	else
+	{
+		keccak_permute_x4_serial(state);
+	}
+#else
+	keccak_permute_x4_serial(state);
+#endif
+}
+
+sha3_backend sha3_backend_get()
+{
+	return sha3_active_backend;
+}
+
+bool sha3_backend_set(sha3_backend backend)
+{
+#if defined(SHA3_BMI2_SUPPORTED) || defined(SHA3_AVX512_SUPPORTED)
+	const cpu_features* cpuf = cpu_features_get();
+#endif
+	bool res;
+
+	res = false;
+
+	switch (backend)
+	{
+		case SHA3_BACKEND_AUTO:
+		case SHA3_BACKEND_PORTABLE:
+		{
+			res = true;
+			break;
+		}
+#if defined(SHA3_BMI2_SUPPORTED)
+		case SHA3_BACKEND_BMI2:
+		{
+			res = (cpuf->bmi1 == true && cpuf->bmi2 == true);
+			break;
+		}
+#endif
+#if defined(SHA3_AVX512_SUPPORTED)
+		case SHA3_BACKEND_AVX512:
+		{
+			res = cpuf->avx512f;
+			break;
+		}
+#endif
+		default:
+		{
+			break;
+		}
+	}
+
+	if (res == true)
+	{
+		sha3_active_backend = backend;
+	}
+
+	return res;
+}
+
 void sha3_compute256(uint8_t* output, const uint8_t* message, size_t messagelen)
 {
 	uint64_t state[SHA3_STATESIZE];
@@ -2408,24 +3272,11 @@ void sha3_compute512(uint8_t* output, const uint8_t* message, size_t messagelen)
 
 void sha3_blockupdate(uint64_t* state, size_t rate, const uint8_t* message, size_t nblocks)
 {
-	size_t i;
-
-	while (nblocks > 0)
-	{
-		for (i = 0; i < rate / 8; ++i)
-		{
-			state[i] ^= load64(message + (8 * i));
-		}
-
-		keccak_permute(state);
-		message += rate;
-		--nblocks;
-	}
+	keccak_absorb_blocks(state, rate, message, nblocks);
 }
 
 void sha3_finalize(uint64_t* state, size_t rate, const uint8_t* message, size_t messagelen, uint8_t* output)
 {
-	uint8_t msg[200];
 	size_t i;
 
 	if (messagelen >= rate)
@@ -2435,25 +3286,7 @@ void sha3_finalize(uint64_t* state, size_t rate, const uint8_t* message, size_t
 		messagelen = (messagelen % rate);
 	}
 
-	for (i = 0; i < messagelen; ++i)
-	{
-		msg[i] = message[i];
-	}
-
-	msg[messagelen] = SHA3_DOMAIN;
-
-	for (i = messagelen + 1; i < rate; ++i)
-	{
-		msg[i] = 0;
-	}
-
-	msg[rate - 1] |= 128;
-
-	for (i = 0; i < rate / 8; ++i)
-	{
-		state[i] ^= load64(msg + (8 * i));
-	}
-
+	keccak_absorb_tail(state, rate, message, messagelen, SHA3_DOMAIN);
 	keccak_permute(state);
 	messagelen = (((200 - rate) / 2) / 8);
 
@@ -2464,6 +3297,27 @@ void sha3_finalize(uint64_t* state, size_t rate, const uint8_t* message, size_t
 	}
 }
 
+void sha3_ctx_finalize(sha3_ctx* ctx, uint8_t* output)
+{
+	sha3_finalize(ctx->state, ctx->rate, ctx->buffer, ctx->position, output);
+	clear64(ctx->state, SHA3_STATESIZE);
+	clear8(ctx->buffer, sizeof(ctx->buffer));
+	ctx->position = 0;
+}
+
+void sha3_ctx_initialize(sha3_ctx* ctx, size_t rate)
+{
+	clear64(ctx->state, SHA3_STATESIZE);
+	clear8(ctx->buffer, sizeof(ctx->buffer));
+	ctx->position = 0;
+	ctx->rate = rate;
+}
+
+void sha3_ctx_update(sha3_ctx* ctx, const uint8_t* message, size_t messagelen)
+{
+	keccak_buffered_update(ctx->state, ctx->rate, ctx->buffer, &ctx->position, message, messagelen);
+}
+
 /* SHAKE */
 
 void shake128(uint8_t* output, size_t outputlen, const uint8_t* seed, size_t seedlen)
@@ -2501,6 +3355,26 @@ void shake128_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks)
 	keccak_squeezeblocks(state, output, nblocks, SHAKE128_RATE);
 }
 
+void shake128_x4(uint8_t** outputs, size_t outputlen, const uint8_t** seeds, size_t seedlen)
+{
+	uint64_t state[SHA3_STATESIZE * 4];
+
+	clear64(state, SHA3_STATESIZE * 4);
+	keccak_absorb_x4(state, SHAKE128_RATE, seeds, seedlen, SHAKE_DOMAIN);
+	keccak_squeeze_x4(state, outputs, outputlen, SHAKE128_RATE);
+	clear64(state, SHA3_STATESIZE * 4);
+}
+
+void shake128_initialize_x4(uint64_t* state, const uint8_t** seeds, size_t seedlen)
+{
+	keccak_absorb_x4(state, SHAKE128_RATE, seeds, seedlen, SHAKE_DOMAIN);
+}
+
+void shake128_squeezeblocks_x4(uint64_t* state, uint8_t** outputs, size_t nblocks)
+{
+	keccak_squeezeblocks_x4(state, outputs, nblocks, SHAKE128_RATE);
+}
+
 void shake256(uint8_t* output, size_t outputlen, const uint8_t* seed, size_t seedlen)
 {
 	size_t nblocks = outputlen / SHAKE256_RATE;
@@ -2536,6 +3410,84 @@ void shake256_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks)
 	keccak_squeezeblocks(state, output, nblocks, SHAKE256_RATE);
 }
 
+void shake256_x4(uint8_t** outputs, size_t outputlen, const uint8_t** seeds, size_t seedlen)
+{
+	uint64_t state[SHA3_STATESIZE * 4];
+
+	clear64(state, SHA3_STATESIZE * 4);
+	keccak_absorb_x4(state, SHAKE256_RATE, seeds, seedlen, SHAKE_DOMAIN);
+	keccak_squeeze_x4(state, outputs, outputlen, SHAKE256_RATE);
+	clear64(state, SHA3_STATESIZE * 4);
+}
+
+void shake256_initialize_x4(uint64_t* state, const uint8_t** seeds, size_t seedlen)
+{
+	keccak_absorb_x4(state, SHAKE256_RATE, seeds, seedlen, SHAKE_DOMAIN);
+}
+
+void shake256_squeezeblocks_x4(uint64_t* state, uint8_t** outputs, size_t nblocks)
+{
+	keccak_squeezeblocks_x4(state, outputs, nblocks, SHAKE256_RATE);
+}
+
+void shake_ctx_finalize(shake_ctx* ctx, uint8_t* output, size_t outputlen)
+{
+	keccak_absorb_tail(ctx->state, ctx->rate, ctx->buffer, ctx->position, SHAKE_DOMAIN);
+	clear8(ctx->buffer, sizeof(ctx->buffer));
+	/* the buffer now holds squeezed output, and is empty */
+	ctx->position = ctx->rate;
+	shake_ctx_squeeze(ctx, output, outputlen);
+}
+
+void shake_ctx_initialize(shake_ctx* ctx, size_t rate)
+{
+	clear64(ctx->state, SHA3_STATESIZE);
+	clear8(ctx->buffer, sizeof(ctx->buffer));
+	ctx->position = 0;
+	ctx->rate = rate;
+}
+
+void shake_ctx_squeeze(shake_ctx* ctx, uint8_t* output, size_t outputlen)
+{
+	size_t nblocks;
+	size_t rmd;
+
+	/* output left over from the previous call */
+	rmd = ctx->rate - ctx->position;
+
+	if (rmd > outputlen)
+	{
+		rmd = outputlen;
+	}
+
+	memcpy(output, ctx->buffer + ctx->position, rmd);
+	ctx->position += rmd;
+	output += rmd;
+	outputlen -= rmd;
+
+	/* whole blocks are squeezed straight to the output */
+	nblocks = outputlen / ctx->rate;
+
+	if (nblocks != 0)
+	{
+		keccak_squeezeblocks(ctx->state, output, nblocks, ctx->rate);
+		output += nblocks * ctx->rate;
+		outputlen -= nblocks * ctx->rate;
+	}
+
+	if (outputlen != 0)
+	{
+		keccak_squeezeblocks(ctx->state, ctx->buffer, 1, ctx->rate);
+		memcpy(output, ctx->buffer, outputlen);
+		ctx->position = outputlen;
+	}
+}
+
+void shake_ctx_update(shake_ctx* ctx, const uint8_t* seed, size_t seedlen)
+{
+	keccak_buffered_update(ctx->state, ctx->rate, ctx->buffer, &ctx->position, seed, seedlen);
+}
+
 /* cSHAKE */
 
 void cshake128(uint8_t* output, size_t outputlen, const uint8_t* seed, size_t seedlen, const uint8_t* name, size_t namelen, const uint8_t* custom, size_t customlen)
@@ -2825,6 +3777,34 @@ void cshake256_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks)
 	keccak_squeezeblocks(state, output, nblocks, CSHAKE256_RATE);
 }
 
+void cshake256_x4(uint8_t** outputs, size_t outputlen, const uint8_t** seeds, size_t seedlen, const uint8_t* name, size_t namelen, const uint8_t* custom, size_t customlen)
+{
+	uint64_t prefix[SHA3_STATESIZE];
+	uint64_t state[SHA3_STATESIZE * 4];
+	uint8_t domain;
+	size_t i;
+
+	clear64(prefix, SHA3_STATESIZE);
+	domain = SHAKE_DOMAIN;
+
+	/* the name and customization string are the same in every lane, so the prefix is permuted once and copied to each state */
+	if (customlen + namelen != 0)
+	{
+		cshake256_initialize(prefix, name, namelen, custom, customlen);
+		domain = CSHAKE_DOMAIN;
+	}
+
+	for (i = 0; i < SHA3_STATESIZE * 4; ++i)
+	{
+		state[i] = prefix[i / 4];
+	}
+
+	keccak_absorb_x4(state, CSHAKE256_RATE, seeds, seedlen, domain);
+	keccak_squeeze_x4(state, outputs, outputlen, CSHAKE256_RATE);
+	clear64(prefix, SHA3_STATESIZE);
+	clear64(state, SHA3_STATESIZE * 4);
+}
+
 /* Simple cSHAKE */
 
 void cshake128_simple(uint8_t* output, size_t outputlen, uint16_t custom, const uint8_t* seed, size_t seedlen)
@@ -3008,30 +3988,18 @@ void kmac128_initialize(uint64_t* state, const uint8_t* key, size_t keylen, cons
 
 void kmac128_blockupdate(uint64_t* state, const uint8_t* message, size_t nblocks)
 {
-	size_t i;
-
-	while (nblocks > 0)
-	{
-		for (i = 0; i < CSHAKE128_RATE / 8; ++i)
-		{
-			state[i] ^= load64(message + (8 * i));
-		}
-
-		keccak_permute(state);
-
-		--nblocks;
-		message += CSHAKE128_RATE;
-	}
+	keccak_absorb_blocks(state, CSHAKE128_RATE, message, nblocks);
 }
 
 void kmac128_finalize(uint64_t* state, uint8_t* output, size_t outputlen, const uint8_t* message, size_t messagelen)
 {
 	uint8_t buf[sizeof(size_t) + 1];
-	uint8_t pad[CSHAKE128_RATE];
+	uint8_t pad[2 * CSHAKE128_RATE];
 	size_t outbitlen;
+	size_t plen;
 	size_t i;
 
-	clear8(pad, CSHAKE128_RATE);
+	clear8(pad, 2 * CSHAKE128_RATE);
 
 	for (i = 0; i < messagelen; i++)
 	{
@@ -3046,11 +4014,24 @@ void kmac128_finalize(uint64_t* state, uint8_t* output, size_t outputlen, const
 	}
 
 	pad[messagelen + outbitlen] = CSHAKE_DOMAIN;
-	pad[CSHAKE128_RATE - 1] |= 128;
+
+	/* a message tail close to the rate pushes the length encoding and padding into a second block */
+	plen = (messagelen + outbitlen + 1 > CSHAKE128_RATE) ? 2 * CSHAKE128_RATE : CSHAKE128_RATE;
+	pad[plen - 1] |= 128;
+
+	if (plen != CSHAKE128_RATE)
+	{
+		for (i = 0; i < CSHAKE128_RATE / 8; i++)
+		{
+			state[i] ^= load64(pad + (i * 8));
+		}
+
+		keccak_permute(state);
+	}
 
 	for (i = 0; i < CSHAKE128_RATE / 8; i++)
 	{
-		state[i] ^= load64(pad + (i * 8));
+		state[i] ^= load64(pad + (plen - CSHAKE128_RATE) + (i * 8));
 	}
 
 	while (outputlen >= CSHAKE128_RATE)
@@ -3150,30 +4131,18 @@ void kmac256_initialize(uint64_t* state, const uint8_t* key, size_t keylen, cons
 
 void kmac256_blockupdate(uint64_t* state, const uint8_t* message, size_t nblocks)
 {
-	size_t i;
-
-	while (nblocks > 0)
-	{
-		for (i = 0; i < CSHAKE256_RATE / 8; ++i)
-		{
-			state[i] ^= load64(message + (8 * i));
-		}
-
-		keccak_permute(state);
-
-		--nblocks;
-		message += CSHAKE256_RATE;
-	}
+	keccak_absorb_blocks(state, CSHAKE256_RATE, message, nblocks);
 }
 
 void kmac256_finalize(uint64_t* state, uint8_t* output, size_t outputlen, const uint8_t* message, size_t messagelen)
 {
 	uint8_t buf[sizeof(size_t) + 1];
-	uint8_t pad[CSHAKE256_RATE];
+	uint8_t pad[2 * CSHAKE256_RATE];
 	size_t outbitlen;
+	size_t plen;
 	size_t i;
 
-	clear8(pad, CSHAKE256_RATE);
+	clear8(pad, 2 * CSHAKE256_RATE);
 
 	for (i = 0; i < messagelen; i++)
 	{
@@ -3188,11 +4157,24 @@ void kmac256_finalize(uint64_t* state, uint8_t* output, size_t outputlen, const
 	}
 
 	pad[messagelen + outbitlen] = CSHAKE_DOMAIN;
-	pad[CSHAKE256_RATE - 1] |= 128;
+
+	/* a message tail close to the rate pushes the length encoding and padding into a second block */
+	plen = (messagelen + outbitlen + 1 > CSHAKE256_RATE) ? 2 * CSHAKE256_RATE : CSHAKE256_RATE;
+	pad[plen - 1] |= 128;
+
+	if (plen != CSHAKE256_RATE)
+	{
+		for (i = 0; i < CSHAKE256_RATE / 8; i++)
+		{
+			state[i] ^= load64(pad + (i * 8));
+		}
+
+		keccak_permute(state);
+	}
 
 	for (i = 0; i < CSHAKE256_RATE / 8; i++)
 	{
-		state[i] ^= load64(pad + (i * 8));
+		state[i] ^= load64(pad + (plen - CSHAKE256_RATE) + (i * 8));
 	}
 
 	while (outputlen >= CSHAKE256_RATE)
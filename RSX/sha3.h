@@ -73,6 +73,39 @@
 */
 #define SHA3_STATESIZE 25
 
+/*! \enum sha3_backend
+* The Keccak permutation implementations, selected at runtime
+*/
+typedef enum
+{
+	SHA3_BACKEND_AUTO = 0,	/*!< the fastest permutations supported by the processor */
+	SHA3_BACKEND_PORTABLE = 1,	/*!< the portable C permutations, for single, four lane and multi-block calls */
+	SHA3_BACKEND_BMI2 = 2,	/*!< the BMI1 and BMI2 scalar permutation */
+	SHA3_BACKEND_AVX512 = 3,	/*!< the AVX-512 multi-block absorb, with the portable permutation for single calls */
+} sha3_backend;
+
+/*! \struct sha3_ctx
+* The incremental SHA3 state; accepts message updates of any length
+*/
+typedef struct sha3_ctx
+{
+	uint64_t state[SHA3_STATESIZE];	/*!< the Keccak state */
+	uint8_t buffer[SHAKE128_RATE];	/*!< the partial block not yet absorbed */
+	size_t position;				/*!< the number of buffered bytes */
+	size_t rate;					/*!< the absorption rate, SHA3_256_RATE or SHA3_512_RATE */
+} sha3_ctx;
+
+/*! \struct shake_ctx
+* The incremental SHAKE state; accepts seed updates and output requests of any length
+*/
+typedef struct shake_ctx
+{
+	uint64_t state[SHA3_STATESIZE];	/*!< the Keccak state */
+	uint8_t buffer[SHAKE128_RATE];	/*!< the partial input block, or the unread output block after finalize */
+	size_t position;				/*!< the number of buffered input bytes, or the offset of the next output byte */
+	size_t rate;					/*!< the absorption rate, SHAKE128_RATE or SHAKE256_RATE */
+} shake_ctx;
+
 /* SHA3 */
 
 /**
@@ -99,7 +132,8 @@ void sha3_compute512(uint8_t* output, const uint8_t* message, size_t messagelen)
 
 /**
 * \brief Update SHA3 with blocks of input.
-* Absorbs (rate) block sized lengths of input message into the state.
+* Absorbs (rate) block sized lengths of input message into the state. \n
+* On the AVX-512 path the state is loaded once and kept in registers for all of the blocks.
 *
 * \warning Message length must be a multiple of the rate size. \n
 * State must be initialized (and zeroed) by the caller.
@@ -127,14 +161,70 @@ void sha3_blockupdate(uint64_t* state, size_t rate, const uint8_t* message, size
 */
 void sha3_finalize(uint64_t* state, size_t rate, const uint8_t* message, size_t messagelen, uint8_t* output);
 
+/**
+* \brief Initialize an incremental SHA3 context.
+*
+* \param ctx The SHA3 context
+* \param rate The rate of absorption; SHA3_256_RATE or SHA3_512_RATE
+*/
+void sha3_ctx_initialize(sha3_ctx* ctx, size_t rate);
+
+/**
+* \brief Add message bytes to an incremental SHA3 context.
+* The message can be any length; whole blocks are absorbed from the message array,
+* and only a partial block is copied to the context buffer.
+*
+* \param ctx The SHA3 context, initialized with sha3_ctx_initialize
+* \param message The input message byte array
+* \param messagelen The number of message bytes to process
+*/
+void sha3_ctx_update(sha3_ctx* ctx, const uint8_t* message, size_t messagelen);
+
+/**
+* \brief Finalize an incremental SHA3 context and return the hash value in output.
+* Produces a 32 byte output code using SHA3_256_RATE, 64 bytes with SHA3_512_RATE. \n
+* The context is zeroized, and must be initialized again before reuse.
+*
+* \param ctx The SHA3 context
+* \param output The output byte array; receives the hash code
+*/
+void sha3_ctx_finalize(sha3_ctx* ctx, uint8_t* output);
+
 /**
 * \brief The Keccak permute function.
-* Permutes the state array, can be used in conjunction with the keccak_absorb function.
+* Permutes the state array, can be used in conjunction with the keccak_absorb function. \n
+* Uses the BMI1 andn and BMI2 rorx instructions, two rounds per loop iteration, when the processor supports them.
 *
 * \param state The function state; must be initialized
 */
 void keccak_permute(uint64_t* state);
 
+/**
+* \brief Permute four independent Keccak states.
+* The states are interleaved by word; word i of lane j is state[(i * 4) + j]. \n
+* Uses AVX2, with the same word of the four states in one register, when the processor supports it.
+*
+* \param state The four interleaved states, 100 words; must be initialized
+*/
+void keccak_permute_x4(uint64_t* state);
+
+/**
+* \brief Get the Keccak permutation selection.
+*
+* \return Returns the backend set with sha3_backend_set, SHA3_BACKEND_AUTO by default
+*/
+sha3_backend sha3_backend_get();
+
+/**
+* \brief Force the Keccak permutation used by the SHA3, SHAKE, cSHAKE and KMAC functions,
+* so that every permutation can be tested on one processor. \n
+* All of the permutations produce the same output, so the selection can be changed between calls on a running hash.
+*
+* \param backend The permutation to use, or SHA3_BACKEND_AUTO for the fastest supported permutations
+* \return Returns false if the permutation is not supported by this processor or compiler
+*/
+bool sha3_backend_set(sha3_backend backend);
+
 /* SHAKE */
 
 /**
@@ -176,6 +266,42 @@ void shake128_initialize(uint64_t* state, const uint8_t* seed, size_t seedlen);
 */
 void shake128_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks);
 
+/**
+* \brief Seed four SHAKE-128 instances with inputs of equal length, and generate pseudo-random output from each.
+* The instances run in lock step over four interleaved states; each output is identical to shake128 with the same seed.
+*
+* \param outputs The four output byte arrays, each outputlen bytes
+* \param outputlen The number of output bytes to generate per instance
+* \param seeds The four input seed byte arrays
+* \param seedlen The number of bytes in each seed
+*/
+void shake128_x4(uint8_t** outputs, size_t outputlen, const uint8_t** seeds, size_t seedlen);
+
+/**
+* \brief The four lane SHAKE-128 initialize function.
+* Absorb and finalize four input seeds of equal length into the interleaved states.
+* Should be used in conjunction with the shake128_squeezeblocks_x4 function.
+*
+* \warning State must be initialized (and zeroed) by the caller.
+*
+* \param state The four interleaved states, SHA3_STATESIZE * 4 words; must be pre-initialized
+* \param seeds The four input seed byte arrays
+* \param seedlen The number of bytes in each seed
+*/
+void shake128_initialize_x4(uint64_t* state, const uint8_t** seeds, size_t seedlen);
+
+/**
+* \brief The four lane SHAKE-128 squeeze function.
+* Permutes the four states and extracts a block from each to its output array.
+*
+* \warning Each output array must be initialized to a multiple of the byte rate.
+*
+* \param state The four interleaved states, initialized with shake128_initialize_x4
+* \param outputs The four output byte arrays
+* \param nblocks The number of blocks to extract to each output
+*/
+void shake128_squeezeblocks_x4(uint64_t* state, uint8_t** outputs, size_t nblocks);
+
 /**
 * \brief Seed a SHAKE-256 instance, and generate an array of pseudo-random bytes.
 *
@@ -214,6 +340,86 @@ void shake256_initialize(uint64_t* state, const uint8_t* seed, size_t seedlen);
 */
 void shake256_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks);
 
+/**
+* \brief Seed four SHAKE-256 instances with inputs of equal length, and generate pseudo-random output from each.
+* The instances run in lock step over four interleaved states; each output is identical to shake256 with the same seed.
+*
+* \param outputs The four output byte arrays, each outputlen bytes
+* \param outputlen The number of output bytes to generate per instance
+* \param seeds The four input seed byte arrays
+* \param seedlen The number of bytes in each seed
+*/
+void shake256_x4(uint8_t** outputs, size_t outputlen, const uint8_t** seeds, size_t seedlen);
+
+/**
+* \brief The four lane SHAKE-256 initialize function.
+* Absorb and finalize four input seeds of equal length into the interleaved states.
+* Should be used in conjunction with the shake256_squeezeblocks_x4 function.
+*
+* \warning State must be initialized (and zeroed) by the caller.
+*
+* \param state The four interleaved states, SHA3_STATESIZE * 4 words; must be pre-initialized
+* \param seeds The four input seed byte arrays
+* \param seedlen The number of bytes in each seed
+*/
+void shake256_initialize_x4(uint64_t* state, const uint8_t** seeds, size_t seedlen);
+
+/**
+* \brief The four lane SHAKE-256 squeeze function.
+* Permutes the four states and extracts a block from each to its output array.
+*
+* \warning Each output array must be initialized to a multiple of the byte rate.
+*
+* \param state The four interleaved states, initialized with shake256_initialize_x4
+* \param outputs The four output byte arrays
+* \param nblocks The number of blocks to extract to each output
+*/
+void shake256_squeezeblocks_x4(uint64_t* state, uint8_t** outputs, size_t nblocks);
+
+/**
+* \brief Initialize an incremental SHAKE context.
+*
+* \param ctx The SHAKE context
+* \param rate The rate of absorption; SHAKE128_RATE or SHAKE256_RATE
+*/
+void shake_ctx_initialize(shake_ctx* ctx, size_t rate);
+
+/**
+* \brief Add seed bytes to an incremental SHAKE context.
+* The seed can be any length; whole blocks are absorbed from the seed array,
+* and only a partial block is copied to the context buffer.
+*
+* \warning Can not be called after shake_ctx_finalize.
+*
+* \param ctx The SHAKE context, initialized with shake_ctx_initialize
+* \param seed The input seed byte array
+* \param seedlen The number of seed bytes to process
+*/
+void shake_ctx_update(shake_ctx* ctx, const uint8_t* seed, size_t seedlen);
+
+/**
+* \brief Finalize the seed of an incremental SHAKE context and generate output.
+* More output can be read from the same stream with shake_ctx_squeeze.
+*
+* \param ctx The SHAKE context
+* \param output The output byte array
+* \param outputlen The number of output bytes to generate
+*/
+void shake_ctx_finalize(shake_ctx* ctx, uint8_t* output, size_t outputlen);
+
+/**
+* \brief Generate more output from a finalized SHAKE context.
+* The output continues the stream, so any sequence of requests yields the same bytes as one request of the total length;
+* whole blocks are squeezed directly to the output array.
+*
+* \warning The context must be finalized with shake_ctx_finalize.
+*
+* \param ctx The SHAKE context
+* \param output The output byte array
+* \param outputlen The number of output bytes to generate
+*/
+void shake_ctx_squeeze(shake_ctx* ctx, uint8_t* output, size_t outputlen);
+
 /* cSHAKE */
 
 /**
@@ -360,6 +566,22 @@ void cshake256_update(uint64_t* state, const uint8_t* seed, size_t seedlen);
 */
 void cshake256_squeezeblocks(uint64_t* state, uint8_t* output, size_t nblocks);
 
+/**
+* \brief Seed four cSHAKE-256 instances with inputs of equal length, and generate pseudo-random output from each.
+* The instances share the name and customization string, and run in lock step over four interleaved states. \n
+* Each output is identical to cshake256 with the same seed.
+*
+* \param outputs The four output byte arrays, each outputlen bytes
+* \param outputlen The number of output bytes to generate per instance (L)
+* \param seeds The four input seed byte arrays (X)
+* \param seedlen The number of bytes in each seed
+* \param name The function name string (N)
+* \param namelen The byte length of the function name
+* \param custom The customization string (S)
+* \param customlen The byte length of the customization string
+*/
+void cshake256_x4(uint8_t** outputs, size_t outputlen, const uint8_t** seeds, size_t seedlen, const uint8_t* name, size_t namelen, const uint8_t* custom, size_t customlen);
+
 /* Simple cSHAKE */
 
 /**
@@ -484,7 +706,7 @@ void kmac128_blockupdate(uint64_t* state, const uint8_t* message, size_t nblocks
 * \param output The output byte array
 * \param outputlen The number of bytes to extract
 * \param message The message input byte array
-* \param messagelen The number of message bytes to process
+* \param messagelen The number of message bytes to process; less than the rate (CSHAKE128_RATE)
 */
 void kmac128_finalize(uint64_t* state, uint8_t* output, size_t outputlen, const uint8_t* message, size_t messagelen);
 
@@ -538,7 +760,7 @@ void kmac256_blockupdate(uint64_t* state, const uint8_t* message, size_t nblocks
 * \param output The output byte array
 * \param outputlen The number of bytes to extract
 * \param message The message input byte array
-* \param messagelen The number of message bytes to process
+* \param messagelen The number of message bytes to process; less than the rate (CSHAKE256_RATE)
 */
 void kmac256_finalize(uint64_t* state, uint8_t* output, size_t outputlen, const uint8_t* message, size_t messagelen);
 
@@ -65,6 +65,100 @@ static void hex_to_bin(const char* hexstr, uint8_t* output, size_t length)
 	}
 }
 
+static void sha3_ctx_chunked(sha3_ctx* ctx, const uint8_t* message, size_t messagelen)
+{
+	const size_t chunks[8] = { 1, 3, 0, 7, 64, 136, 291, 13 };
+	size_t len;
+	size_t pos;
+	size_t i;
+
+	/* updates of mixed lengths, that start and end on and off the block boundaries */
+	pos = 0;
+	i = 0;
+
+	while (pos < messagelen)
+	{
+		len = chunks[i % 8];
+
+		if (len > messagelen - pos)
+		{
+			len = messagelen - pos;
+		}
+
+		sha3_ctx_update(ctx, message + pos, len);
+		pos += len;
+		++i;
+	}
+}
+
+static bool sha3_ctx_equivalence(size_t rate, const uint8_t* msg1600, const uint8_t* exp1600)
+{
+	uint8_t msg[1000];
+	uint8_t exp[64];
+	uint8_t hash[64];
+	sha3_ctx ctx;
+	size_t hashlen;
+	size_t i;
+	bool status;
+
+	status = true;
+	hashlen = (200 - rate) / 2;
+
+	/* the sample message against the vector */
+	sha3_ctx_initialize(&ctx, rate);
+	sha3_ctx_chunked(&ctx, msg1600, 200);
+	sha3_ctx_finalize(&ctx, hash);
+
+	if (are_equal8(hash, exp1600, hashlen) == false)
+	{
+		status = false;
+	}
+
+	/* a message of several blocks, and the empty message, against the compact api */
+	for (i = 0; i < sizeof(msg); ++i)
+	{
+		msg[i] = (uint8_t)(msg1600[i % 200] + i);
+	}
+
+	sha3_ctx_initialize(&ctx, rate);
+	sha3_ctx_chunked(&ctx, msg, sizeof(msg));
+	sha3_ctx_finalize(&ctx, hash);
+
+	if (rate == SHA3_256_RATE)
+	{
+		sha3_compute256(exp, msg, sizeof(msg));
+	}
+	else
+	{
+		sha3_compute512(exp, msg, sizeof(msg));
+	}
+
+	if (are_equal8(hash, exp, hashlen) == false)
+	{
+		status = false;
+	}
+
+	sha3_ctx_initialize(&ctx, rate);
+	sha3_ctx_update(&ctx, msg, 0);
+	sha3_ctx_finalize(&ctx, hash);
+
+	if (rate == SHA3_256_RATE)
+	{
+		sha3_compute256(exp, msg, 0);
+	}
+	else
+	{
+		sha3_compute512(exp, msg, 0);
+	}
+
+	if (are_equal8(hash, exp, hashlen) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
 bool sha3_256_kat_test()
 {
 	uint8_t exp0[32];
@@ -179,6 +273,13 @@ bool sha3_256_kat_test()
 		status = false;
 	}
 
+	/* test the incremental api */
+
+	if (sha3_ctx_equivalence(SHA3_256_RATE, msg1600, exp1600) == false)
+	{
+		status = false;
+	}
+
 	return status;
 }
 
@@ -298,6 +399,208 @@ bool sha3_512_kat_test()
 		status = false;
 	}
 
+	/* test the incremental api */
+
+	if (sha3_ctx_equivalence(SHA3_512_RATE, msg1600, exp1600) == false)
+	{
+		status = false;
+	}
+
+	return status;
+}
+
+static bool shake_x4_equivalence(size_t rate, const uint8_t* msg1600, const uint8_t* exp1600)
+{
+	uint8_t lanemsg[4][1000];
+	uint8_t laneout[4][512];
+	uint8_t expl[512];
+	uint8_t* outputs[4];
+	const uint8_t* seeds[4];
+	uint64_t state[SHA3_STATESIZE * 4];
+	size_t nblocks;
+	size_t i;
+	size_t j;
+	bool status;
+
+	status = true;
+
+	for (i = 0; i < 4; ++i)
+	{
+		for (j = 0; j < 1000; ++j)
+		{
+			lanemsg[i][j] = (i == 2) ? msg1600[j % 200] : (uint8_t)(msg1600[j % 200] + (i * 31) + 1 + (j / 200));
+		}
+
+		outputs[i] = laneout[i];
+		seeds[i] = lanemsg[i];
+	}
+
+	/* the sample message in lane two against the vector, and the other lanes against the single instance */
+	if (rate == SHAKE128_RATE)
+	{
+		shake128_x4(outputs, 512, seeds, 200);
+	}
+	else
+	{
+		shake256_x4(outputs, 512, seeds, 200);
+	}
+
+	for (j = 0; j < 4; ++j)
+	{
+		if (rate == SHAKE128_RATE)
+		{
+			shake128(expl, 512, lanemsg[j], 200);
+		}
+		else
+		{
+			shake256(expl, 512, lanemsg[j], 200);
+		}
+
+		if (are_equal8(laneout[j], (j == 2) ? exp1600 : expl, 512) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* the long-form api, with seeds shorter than one block */
+	nblocks = 512 / rate;
+	clear64(state, SHA3_STATESIZE * 4);
+
+	if (rate == SHAKE128_RATE)
+	{
+		shake128_initialize_x4(state, seeds, 77);
+		shake128_squeezeblocks_x4(state, outputs, nblocks);
+	}
+	else
+	{
+		shake256_initialize_x4(state, seeds, 77);
+		shake256_squeezeblocks_x4(state, outputs, nblocks);
+	}
+
+	for (j = 0; j < 4; ++j)
+	{
+		if (rate == SHAKE128_RATE)
+		{
+			shake128(expl, nblocks * rate, lanemsg[j], 77);
+		}
+		else
+		{
+			shake256(expl, nblocks * rate, lanemsg[j], 77);
+		}
+
+		if (are_equal8(laneout[j], expl, nblocks * rate) == false)
+		{
+			status = false;
+		}
+	}
+
+	/* seeds of several blocks; the single instance absorbs them in one call, with the state kept in registers when it can */
+	if (rate == SHAKE128_RATE)
+	{
+		shake128_x4(outputs, 512, seeds, 1000);
+	}
+	else
+	{
+		shake256_x4(outputs, 512, seeds, 1000);
+	}
+
+	for (j = 0; j < 4; ++j)
+	{
+		if (rate == SHAKE128_RATE)
+		{
+			shake128(expl, 512, lanemsg[j], 1000);
+		}
+		else
+		{
+			shake256(expl, 512, lanemsg[j], 1000);
+		}
+
+		if (are_equal8(laneout[j], expl, 512) == false)
+		{
+			status = false;
+		}
+	}
+
+	return status;
+}
+
+static bool shake_ctx_equivalence(size_t rate, const uint8_t* msg1600, const uint8_t* exp1600)
+{
+	const size_t chunks[8] = { 1, 3, 0, 7, 64, 136, 291, 13 };
+	uint8_t msg[1000];
+	uint8_t exp[1000];
+	uint8_t output[1000];
+	shake_ctx ctx;
+	size_t len;
+	size_t pos;
+	size_t i;
+	size_t j;
+	bool status;
+
+	status = true;
+
+	for (i = 0; i < sizeof(msg); ++i)
+	{
+		msg[i] = (uint8_t)(msg1600[i % 200] + i);
+	}
+
+	/* the sample message against the vector, then a message of several blocks against the compact api */
+	for (j = 0; j < 2; ++j)
+	{
+		const uint8_t* seed = (j == 0) ? msg1600 : msg;
+		const size_t seedlen = (j == 0) ? 200 : sizeof(msg);
+		const size_t outlen = (j == 0) ? 512 : sizeof(output);
+
+		shake_ctx_initialize(&ctx, rate);
+		pos = 0;
+		i = 0;
+
+		while (pos < seedlen)
+		{
+			len = (chunks[i % 8] < seedlen - pos) ? chunks[i % 8] : seedlen - pos;
+			shake_ctx_update(&ctx, seed + pos, len);
+			pos += len;
+			++i;
+		}
+
+		/* the output is read in pieces that cross the block boundaries */
+		shake_ctx_finalize(&ctx, output, 5);
+		pos = 5;
+		i = 0;
+
+		while (pos < outlen)
+		{
+			len = (chunks[(i + 3) % 8] < outlen - pos) ? chunks[(i + 3) % 8] : outlen - pos;
+			shake_ctx_squeeze(&ctx, output + pos, len);
+			pos += len;
+			++i;
+		}
+
+		if (j == 0)
+		{
+			if (are_equal8(output, exp1600, 512) == false)
+			{
+				status = false;
+			}
+		}
+		else
+		{
+			if (rate == SHAKE128_RATE)
+			{
+				shake128(exp, outlen, msg, seedlen);
+			}
+			else
+			{
+				shake256(exp, outlen, msg, seedlen);
+			}
+
+			if (are_equal8(output, exp, outlen) == false)
+			{
+				status = false;
+			}
+		}
+	}
+
 	return status;
 }
 
@@ -387,6 +690,20 @@ bool shake_128_kat_test()
 		status = false;
 	}
 
+	/* test the four lane api */
+
+	if (shake_x4_equivalence(SHAKE128_RATE, msg1600, exp1600) == false)
+	{
+		status = false;
+	}
+
+	/* test the incremental api */
+
+	if (shake_ctx_equivalence(SHAKE128_RATE, msg1600, exp1600) == false)
+	{
+		status = false;
+	}
+
 	return status;
 }
 
@@ -476,6 +793,20 @@ bool shake_256_kat_test()
 		status = false;
 	}
 
+	/* test the four lane api */
+
+	if (shake_x4_equivalence(SHAKE256_RATE, msg1600, exp1600) == false)
+	{
+		status = false;
+	}
+
+	/* test the incremental api */
+
+	if (shake_ctx_equivalence(SHAKE256_RATE, msg1600, exp1600) == false)
+	{
+		status = false;
+	}
+
 	return status;
 }
 
@@ -604,6 +935,50 @@ bool cshake_256_kat_test()
 		status = false;
 	}
 
+
+	/* test the four lane api; the sample message in lane two, and the other lanes against the single instance */
+
+	uint8_t lanemsg[4][200];
+	uint8_t laneout[4][300];
+	uint8_t expl[300];
+	uint8_t* outputs[4];
+	const uint8_t* seeds[4];
+	size_t i;
+	size_t j;
+
+	for (i = 0; i < 4; ++i)
+	{
+		for (j = 0; j < 200; ++j)
+		{
+			lanemsg[i][j] = (i == 2) ? msg1600[j] : (uint8_t)(msg1600[j] + (i * 31) + 1);
+		}
+
+		outputs[i] = laneout[i];
+		seeds[i] = lanemsg[i];
+	}
+
+	cshake256_x4(outputs, 64, seeds, 200, name, 0, cust, 15);
+
+	if (are_equal8(laneout[2], exp512b, 64) == false)
+	{
+		status = false;
+	}
+
+	/* more than two rate blocks of output, with and without a customization string */
+	for (i = 0; i < 2; ++i)
+	{
+		cshake256_x4(outputs, 300, seeds, 200 - (i * 71), name, 0, cust, (i == 0) ? 15 : 0);
+
+		for (j = 0; j < 4; ++j)
+		{
+			cshake256(expl, 300, lanemsg[j], 200 - (i * 71), name, 0, cust, (i == 0) ? 15 : 0);
+
+			if (are_equal8(laneout[j], expl, 300) == false)
+			{
+				status = false;
+			}
+		}
+	}
 	return status;
 }
 
@@ -938,4 +1313,88 @@ bool kmac_256_kat_test()
 	}
 
 	return status;
-}
\ No newline at end of file
+}
+static void backend_digest(size_t func, uint8_t* output, const uint8_t* message, size_t messagelen)
+{
+	const uint8_t key[32] = { 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+		0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F };
+
+	/* one digest function for each absorption rate, with a long output so the squeeze is compared as well */
+	switch (func)
+	{
+		case 0:
+		{
+			sha3_compute256(output, message, messagelen);
+			break;
+		}
+		case 1:
+		{
+			sha3_compute512(output, message, messagelen);
+			break;
+		}
+		case 2:
+		{
+			shake128(output, 512, message, messagelen);
+			break;
+		}
+		default:
+		{
+			kmac256(output, 512, message, messagelen, key, sizeof(key), NULL, 0);
+			break;
+		}
+	}
+}
+
+bool sha3_backend_kat_test()
+{
+	const sha3_backend backends[3] = { SHA3_BACKEND_BMI2, SHA3_BACKEND_AVX512, SHA3_BACKEND_AUTO };
+	const size_t rates[4] = { SHA3_256_RATE, SHA3_512_RATE, SHAKE128_RATE, CSHAKE256_RATE };
+	uint8_t msg[13 * SHAKE128_RATE];
+	uint8_t exp[512];
+	uint8_t output[512];
+	sha3_backend saved;
+	size_t func;
+	size_t len;
+	size_t i;
+	size_t j;
+	size_t k;
+	bool status;
+
+	saved = sha3_backend_get();
+	status = true;
+
+	for (i = 0; i < sizeof(msg); ++i)
+	{
+		msg[i] = (uint8_t)((i * 167) + 13);
+	}
+
+	for (func = 0; func < 4; ++func)
+	{
+		/* zero to twelve full blocks, each with a partial block of a different length */
+		for (k = 0; k <= 12; ++k)
+		{
+			len = (k * rates[func]) + ((k * 29) % rates[func]);
+			sha3_backend_set(SHA3_BACKEND_PORTABLE);
+			clear8(exp, sizeof(exp));
+			backend_digest(func, exp, msg, len);
+
+			for (j = 0; j < 3; ++j)
+			{
+				if (sha3_backend_set(backends[j]) == true)
+				{
+					clear8(output, sizeof(output));
+					backend_digest(func, output, msg, len);
+
+					if (are_equal8(output, exp, sizeof(output)) == false)
+					{
+						status = false;
+					}
+				}
+			}
+		}
+	}
+
+	sha3_backend_set(saved);
+
+	return status;
+}
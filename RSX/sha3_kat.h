@@ -14,7 +14,8 @@
 
 /**
 * \brief Tests the 256 bit version of the keccak message digest for correct operation,
-* using selected vectors from the NIST Fips202 and alternative references.
+* using selected vectors from the NIST Fips202 and alternative references. \n
+* Also runs the incremental sha3_ctx api, with updates of mixed lengths, against the vectors and the compact api.
 *
 * \return Returns true for success
 *
@@ -28,7 +29,8 @@ bool sha3_256_kat_test();
 
 /**
 * \brief Tests the 512 bit version of the keccak message digest for correct operation,
-* using selected vectors from NIST Fips202 and alternative references.
+* using selected vectors from NIST Fips202 and alternative references. \n
+* Also runs the incremental sha3_ctx api, with updates of mixed lengths, against the vectors and the compact api.
 *
 * \return Returns true for success
 *
@@ -42,7 +44,9 @@ bool sha3_512_kat_test();
 
 /**
 * \brief Tests the 128 bit version of the SHAKE XOF function for correct operation,
-* using selected vectors from the NIST reference package.
+* using selected vectors from the NIST reference package. \n
+* Also runs the four lane shake128_x4 and its long-form api against the vectors and the single instance function. \n
+* Also runs the incremental shake_ctx api, with seed updates and output requests of mixed lengths.
 *
 * \return Returns true for success
 *
@@ -55,7 +59,9 @@ bool shake_128_kat_test();
 
 /**
 * \brief Tests the 256 bit version of the SHAKE XOF function for correct operation,
-* using selected vectors from the NIST reference package.
+* using selected vectors from the NIST reference package. \n
+* Also runs the four lane shake256_x4 and its long-form api against the vectors and the single instance function. \n
+* Also runs the incremental shake_ctx api, with seed updates and output requests of mixed lengths.
 *
 * \return Returns true for success
 *
@@ -80,7 +86,8 @@ bool cshake_128_kat_test();
 
 /**
 * \brief Tests the 256 bit version of the cSHAKE function for correct operation,
-* using the NIST vectors.
+* using the NIST vectors. \n
+* Also runs the four lane cshake256_x4 against the NIST vectors and the single instance function.
 *
 * \return Returns true for success
 *
@@ -138,4 +145,13 @@ bool kmac_128_kat_test();
 */
 bool kmac_256_kat_test();
 
+/**
+* \brief Compares every Keccak permutation supported by this processor with the portable permutation. \n
+* SHA3-256, SHA3-512, SHAKE-128 and KMAC-256 digests of zero to twelve blocks are computed with the portable permutation,
+* and again with the BMI2 permutation, the AVX-512 multi-block absorb, and the automatic selection.
+*
+* \return Returns true for success
+*/
+bool sha3_backend_kat_test();
+
 #endif
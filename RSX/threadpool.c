@@ -0,0 +1,291 @@
+#include "threadpool.h"
+#include <stdlib.h>
+
+#if defined(WINDOWS)
+#	include <windows.h>
+#else
+#	include <pthread.h>
+#	include <unistd.h>
+#endif
+
+struct threadpool_state
+{
+#if defined(WINDOWS)
+	SRWLOCK lock;
+	CONDITION_VARIABLE work;
+	CONDITION_VARIABLE done;
+	HANDLE workers[THREADPOOL_MAX_THREADS];
+#else
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	pthread_t workers[THREADPOOL_MAX_THREADS];
+#endif
+	threadpool_task task;
+	void* context;
+	size_t count;
+	size_t next;
+	size_t completed;
+	size_t generation;
+	size_t nworkers;
+	size_t threads;
+	bool busy;
+	bool shutdown;
+};
+
+#if defined(WINDOWS)
+
+static void pool_lock(threadpool_state* pool)
+{
+	AcquireSRWLockExclusive(&pool->lock);
+}
+
+static void pool_unlock(threadpool_state* pool)
+{
+	ReleaseSRWLockExclusive(&pool->lock);
+}
+
+static void pool_wait(threadpool_state* pool, CONDITION_VARIABLE* cond)
+{
+	SleepConditionVariableSRW(cond, &pool->lock, INFINITE, 0);
+}
+
+static void pool_broadcast(CONDITION_VARIABLE* cond)
+{
+	WakeAllConditionVariable(cond);
+}
+
+static size_t processor_count()
+{
+	SYSTEM_INFO info;
+
+	GetSystemInfo(&info);
+
+	return (size_t)info.dwNumberOfProcessors;
+}
+
+#else
+
+static void pool_lock(threadpool_state* pool)
+{
+	pthread_mutex_lock(&pool->lock);
+}
+
+static void pool_unlock(threadpool_state* pool)
+{
+	pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_wait(threadpool_state* pool, pthread_cond_t* cond)
+{
+	pthread_cond_wait(cond, &pool->lock);
+}
+
+static void pool_broadcast(pthread_cond_t* cond)
+{
+	pthread_cond_broadcast(cond);
+}
+
+static size_t processor_count()
+{
+	long res;
+
+	res = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return (res > 0) ? (size_t)res : 1;
+}
+
+#endif
+
+static void pool_run_tasks(threadpool_state* pool)
+{
+	size_t index;
+
+	/* called with the lock held; the lock is released while a task runs */
+	while (pool->next < pool->count)
+	{
+		index = pool->next;
+		++pool->next;
+		pool_unlock(pool);
+		pool->task(pool->context, index);
+		pool_lock(pool);
+		++pool->completed;
+
+		if (pool->completed == pool->count)
+		{
+			pool_broadcast(&pool->done);
+		}
+	}
+}
+
+static void pool_worker(threadpool_state* pool)
+{
+	size_t seen;
+
+	pool_lock(pool);
+	seen = pool->generation;
+
+	while (true)
+	{
+		while (pool->shutdown == false && pool->generation == seen)
+		{
+			pool_wait(pool, &pool->work);
+		}
+
+		if (pool->shutdown == true)
+		{
+			break;
+		}
+
+		seen = pool->generation;
+		pool_run_tasks(pool);
+	}
+
+	pool_unlock(pool);
+}
+
+#if defined(WINDOWS)
+static DWORD WINAPI pool_thread(LPVOID arg)
+{
+	pool_worker((threadpool_state*)arg);
+
+	return 0;
+}
+#else
+static void* pool_thread(void* arg)
+{
+	pool_worker((threadpool_state*)arg);
+
+	return NULL;
+}
+#endif
+
+threadpool_state* threadpool_create(size_t threads)
+{
+	threadpool_state* pool;
+	bool res;
+	size_t i;
+
+	if (threads == 0)
+	{
+		threads = processor_count();
+	}
+
+	if (threads > THREADPOOL_MAX_THREADS)
+	{
+		threads = THREADPOOL_MAX_THREADS;
+	}
+
+	pool = (threadpool_state*)calloc(1, sizeof(threadpool_state));
+
+	if (pool != NULL)
+	{
+		res = true;
+		pool->threads = threads;
+
+#if defined(WINDOWS)
+		InitializeSRWLock(&pool->lock);
+		InitializeConditionVariable(&pool->work);
+		InitializeConditionVariable(&pool->done);
+#else
+		pthread_mutex_init(&pool->lock, NULL);
+		pthread_cond_init(&pool->work, NULL);
+		pthread_cond_init(&pool->done, NULL);
+#endif
+
+		for (i = 0; i < threads - 1; ++i)
+		{
+#if defined(WINDOWS)
+			pool->workers[i] = CreateThread(NULL, 0, pool_thread, pool, 0, NULL);
+			res = (pool->workers[i] != NULL);
+#else
+			res = (pthread_create(&pool->workers[i], NULL, pool_thread, pool) == 0);
+#endif
+			if (res == false)
+			{
+				break;
+			}
+
+			++pool->nworkers;
+		}
+
+		if (res == false)
+		{
+			threadpool_destroy(pool);
+			pool = NULL;
+		}
+	}
+
+	return pool;
+}
+
+void threadpool_destroy(threadpool_state* pool)
+{
+	size_t i;
+
+	if (pool != NULL)
+	{
+		pool_lock(pool);
+		pool->shutdown = true;
+		pool_broadcast(&pool->work);
+		pool_unlock(pool);
+
+		for (i = 0; i < pool->nworkers; ++i)
+		{
+#if defined(WINDOWS)
+			WaitForSingleObject(pool->workers[i], INFINITE);
+			CloseHandle(pool->workers[i]);
+#else
+			pthread_join(pool->workers[i], NULL);
+#endif
+		}
+
+#if !defined(WINDOWS)
+		pthread_cond_destroy(&pool->done);
+		pthread_cond_destroy(&pool->work);
+		pthread_mutex_destroy(&pool->lock);
+#endif
+
+		free(pool);
+	}
+}
+
+void threadpool_dispatch(threadpool_state* pool, threadpool_task task, void* context, size_t count)
+{
+	if (count != 0)
+	{
+		pool_lock(pool);
+
+		/* one dispatch at a time; a second caller waits for the running range to finish */
+		while (pool->busy == true)
+		{
+			pool_wait(pool, &pool->done);
+		}
+
+		pool->busy = true;
+		pool->task = task;
+		pool->context = context;
+		pool->count = count;
+		pool->next = 0;
+		pool->completed = 0;
+		++pool->generation;
+		pool_broadcast(&pool->work);
+
+		/* the calling thread takes tasks alongside the workers */
+		pool_run_tasks(pool);
+
+		while (pool->completed != pool->count)
+		{
+			pool_wait(pool, &pool->done);
+		}
+
+		pool->busy = false;
+		pool_broadcast(&pool->done);
+		pool_unlock(pool);
+	}
+}
+
+size_t threadpool_threads(const threadpool_state* pool)
+{
+	return pool->threads;
+}
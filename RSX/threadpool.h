@@ -0,0 +1,78 @@
+/**
+* \file threadpool.h
+* \brief <b>Worker thread pool</b> \n
+* A fixed set of worker threads that is created once and reused, so the cost of starting threads
+* is not paid on every parallel call. Work is submitted as a count of indexed tasks; the calling
+* thread runs tasks alongside the workers, and the dispatch returns when every task has completed.
+*
+* <b>Example</b> \n
+* \code
+* // four threads in total: the caller and three workers
+* threadpool_state* pool = threadpool_create(4);
+*
+* // runs task(context, 0) .. task(context, 15), and waits for them to finish
+* threadpool_dispatch(pool, task, context, 16);
+*
+* threadpool_destroy(pool);
+* \endcode
+*
+* \remarks Uses Windows threads and condition variables when WINDOWS is defined, otherwise posix threads. \n
+* A pool runs one dispatch at a time, concurrent calls to threadpool_dispatch on the same pool are serialized.
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "common.h"
+
+/*! \def THREADPOOL_MAX_THREADS
+* The maximum number of threads in a pool, including the calling thread
+*/
+#define THREADPOOL_MAX_THREADS 64
+
+/*! \typedef threadpool_task
+* A task function; called once for each index in the dispatch range, with the caller supplied context
+*/
+typedef void (*threadpool_task)(void* context, size_t index);
+
+/*! \struct threadpool_state
+* The pool state, an opaque type created with threadpool_create
+*/
+typedef struct threadpool_state threadpool_state;
+
+/**
+* \brief Create a worker pool. \n
+* The pool starts threads - 1 workers, the thread that calls threadpool_dispatch is the last member.
+*
+* \param threads The total number of threads; zero selects the number of online processors
+* \return Returns the pool, or NULL if the pool or its threads could not be created
+*/
+threadpool_state* threadpool_create(size_t threads);
+
+/**
+* \brief Stop the workers and release the pool
+*
+* \param pool The pool to destroy, can be NULL
+*/
+void threadpool_destroy(threadpool_state* pool);
+
+/**
+* \brief Run a range of tasks on the pool, and wait for them to complete. \n
+* Each index from zero to count - 1 is passed to exactly one call of the task function.
+*
+* \param pool The worker pool
+* \param task The task function
+* \param context The caller state passed to every task
+* \param count The number of tasks
+*/
+void threadpool_dispatch(threadpool_state* pool, threadpool_task task, void* context, size_t count);
+
+/**
+* \brief Get the number of threads in the pool, including the calling thread
+*
+* \param pool The worker pool
+* \return Returns the thread count
+*/
+size_t threadpool_threads(const threadpool_state* pool);
+
+#endif